@@ -19,7 +19,166 @@
 #include "meta/parser.c"
 #include "meta/code_builder.c"
 
-int main()
+internal b32 param_has_attribute(StructField *param, const char *name)
+{
+  arr_foreach_ptr(param->attributes, FieldAttribute, attr)
+  {
+    if (str_equal(attr->name.value, name))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+internal b32 param_is_field(StructField *param)
+{
+  return param_has_attribute(param, "HZ_READ") ||
+         param_has_attribute(param, "HZ_WRITE");
+}
+
+// HZ_SYSTEM() void Move(EcsIter *it, HZ_WRITE() Position *p, HZ_READ() const Velocity *v);
+// every HZ_READ/HZ_WRITE parameter is one query field, in parameter order.
+// the system is called once per table run with the columns already fetched
+internal b32 gen_system(CodeStringBuilder *csb, ReflectedFunction *f)
+{
+  char *name = f->function_name.value;
+
+  u32 field_count = 0;
+  u32 read_fields = 0;
+  u32 write_fields = 0;
+  arr_foreach_ptr(f->params, StructField, param)
+  {
+    b32 reads = param_has_attribute(param, "HZ_READ");
+    b32 writes = param_has_attribute(param, "HZ_WRITE");
+    if (!reads && !writes)
+    {
+      if (!str_equal(param->type_name.value, "EcsIter") ||
+          param->pointer_depth != 1)
+      {
+        printf("ERROR: system %s parameter %s needs HZ_READ() or HZ_WRITE()\n",
+               name, param->field_name.value);
+        return false;
+      }
+      continue;
+    }
+    if (param->pointer_depth != 1)
+    {
+      printf("ERROR: system %s parameter %s must be a column pointer\n", name,
+             param->field_name.value);
+      return false;
+    }
+    if (reads)
+    {
+      read_fields |= 1u << field_count;
+    }
+    if (writes)
+    {
+      write_fields |= 1u << field_count;
+    }
+    field_count++;
+  }
+
+  if (field_count == 0 || field_count > 16)
+  {
+    printf("ERROR: system %s needs between 1 and 16 HZ_READ/HZ_WRITE "
+           "parameters\n",
+           name);
+    return false;
+  }
+
+  // access metadata, laid out like EcsQuery read_fields/write_fields
+  csb_append_line_format(csb, "#define %_TERM_COUNT %", FMT_STR(name),
+                         FMT_UINT(field_count));
+  csb_append_line_format(csb, "#define %_READ_FIELDS %u", FMT_STR(name),
+                         FMT_UINT(read_fields));
+  csb_append_line_format(csb, "#define %_WRITE_FIELDS %u\n", FMT_STR(name),
+                         FMT_UINT(write_fields));
+
+  // Run wrapper, one ecs_field per column instead of per row
+  csb_append_line_format(csb, "void _%_Run(EcsIter* it) {", FMT_STR(name));
+  csb_add_indent(csb);
+  u32 field_index = 0;
+  arr_foreach_ptr(f->params, StructField, param)
+  {
+    if (!param_is_field(param))
+    {
+      continue;
+    }
+    csb_append_line_format(csb, "%%* % = ecs_field(it, %, %);",
+                           FMT_STR(param->is_const ? "const " : ""),
+                           FMT_STR(param->type_name.value),
+                           FMT_STR(param->field_name.value),
+                           FMT_STR(param->type_name.value),
+                           FMT_UINT(field_index));
+    field_index++;
+  }
+
+  char args_buffer[1024];
+  StringBuilder args;
+  sb_init(&args, args_buffer, sizeof(args_buffer));
+  arr_foreach_ptr(f->params, StructField, param)
+  {
+    if (sb_length(&args) > 0)
+    {
+      sb_append(&args, ", ");
+    }
+    sb_append(&args,
+              param_is_field(param) ? param->field_name.value : "it");
+  }
+  csb_append_line_format(csb, "%(%);", FMT_STR(name), FMT_STR(sb_get(&args)));
+  csb_remove_indent(csb);
+  csb_append_line(csb, "}\n");
+
+  // Terms, HZ_READ is in, HZ_WRITE is out, both is inout
+  csb_append_line_format(csb, "void %_Terms(EcsTerm* terms) {", FMT_STR(name));
+  csb_add_indent(csb);
+  field_index = 0;
+  arr_foreach_ptr(f->params, StructField, param)
+  {
+    if (!param_is_field(param))
+    {
+      continue;
+    }
+    u32 field_bit = 1u << field_index;
+    const char *term_fn = (read_fields & field_bit) && (write_fields & field_bit)
+                              ? "ecs_term_inout"
+                          : (write_fields & field_bit) ? "ecs_term_out"
+                                                       : "ecs_term_in";
+    csb_append_line_format(csb, "terms[%] = %(ecs_id(%));",
+                           FMT_UINT(field_index), FMT_STR(term_fn),
+                           FMT_STR(param->type_name.value));
+    field_index++;
+  }
+  csb_remove_indent(csb);
+  csb_append_line(csb, "}\n");
+
+  // Register, desc carries the optional settings (sync mode, ctx, ...)
+  csb_append_line_format(csb,
+                         "EcsSystem* %_Register(EcsWorld* world, "
+                         "const EcsSystemDesc* desc) {",
+                         FMT_STR(name));
+  csb_add_indent(csb);
+  csb_append_line(csb, "EcsSystemDesc system_desc = {0};");
+  csb_append_line(csb, "if (desc) {");
+  csb_add_indent(csb);
+  csb_append_line(csb, "system_desc = *desc;");
+  csb_remove_indent(csb);
+  csb_append_line(csb, "}");
+  csb_append_line_format(csb, "EcsTerm terms[%_TERM_COUNT];", FMT_STR(name));
+  csb_append_line_format(csb, "%_Terms(terms);", FMT_STR(name));
+  csb_append_line(csb, "system_desc.terms = terms;");
+  csb_append_line_format(csb, "system_desc.term_count = %_TERM_COUNT;",
+                         FMT_STR(name));
+  csb_append_line_format(csb, "system_desc.callback = _%_Run;", FMT_STR(name));
+  csb_append_line_format(csb, "system_desc.name = \"%\";", FMT_STR(name));
+  csb_append_line(csb, "return ecs_system_init(world, &system_desc);");
+  csb_remove_indent(csb);
+  csb_append_line(csb, "}\n");
+  return true;
+}
+
+int main(int argc, char **argv)
 {
   ArenaAllocator temp_arena = arena_from_buffer(malloc(MB(64)), MB(64));
   Allocator temp_allocator = make_arena_allocator(&temp_arena);
@@ -27,7 +186,29 @@ int main()
   ArenaAllocator arena = arena_from_buffer(malloc(MB(8)), MB(8));
   Allocator allocator = make_arena_allocator(&arena);
 
-  const char *file_name = "./src/multicore_tasks.h";
+  // meta [input header] [output dir]
+  const char *file_name = argc > 1 ? argv[1] : "./src/multicore_tasks.h";
+  const char *output_dir = argc > 2 ? argv[2] : "./generated";
+
+  // generated name is the header's file name without extension
+  char base_name[256];
+  const char *base_start = file_name;
+  for (const char *c = file_name; *c; c++)
+  {
+    if (*c == '/' || *c == '\\')
+    {
+      base_start = c + 1;
+    }
+  }
+  u32 base_len = 0;
+  while (base_start[base_len] && base_start[base_len] != '.' &&
+         base_len < sizeof(base_name) - 1)
+  {
+    base_name[base_len] = base_start[base_len];
+    base_len++;
+  }
+  base_name[base_len] = '\0';
+
   PlatformFileData file = os_read_file(file_name, &allocator);
   if (!file.success)
   {
@@ -37,12 +218,37 @@ int main()
   Parser parser = parser_create(file_name, (char *)file.buffer, file.buffer_len,
                                 &allocator);
 
-  CodeStringBuilder csb = csb_create("multicore_tasks", &temp_allocator, MB(1));
+  CodeStringBuilder csb = csb_create(base_name, &temp_allocator, MB(1));
+  b32 has_error = false;
 
   while (!parser_current_token_is(&parser, TOKEN_EOF) && !parser.has_error)
   {
     parser_skip_to_next_attribute(&parser);
-    if (parser_current_token_is(&parser, TOKEN_IDENTIFIER))
+    if (parser_current_token_is(&parser, TOKEN_IDENTIFIER) &&
+        !parser_attribute_targets_struct(&parser))
+    {
+      ReflectedFunction f = {0};
+      if (parse_function(&parser, &f))
+      {
+        arr_foreach_ptr(f.attributes, FunctionAttribute, attr)
+        {
+          if (str_equal(attr->name.value, "HZ_SYSTEM"))
+          {
+            if (!gen_system(&csb, &f))
+            {
+              has_error = true;
+            }
+            break;
+          }
+        }
+      }
+      else
+      {
+        printf("ERROR: %s\n", parser.error_message.value);
+        has_error = true;
+      }
+    }
+    else if (parser_current_token_is(&parser, TOKEN_IDENTIFIER))
     {
       ReflectedStruct s = {0};
       if (parse_struct(&parser, &s))
@@ -127,16 +333,24 @@ int main()
       else
       {
         printf("ERROR: %s\n", parser.error_message.value);
+        has_error = true;
       }
     }
   }
 
+  // keep the last good output instead of writing a partial one
+  if (has_error || parser.has_error)
+  {
+    parser_destroy(&parser);
+    return 1;
+  }
+
   char *generated = csb_finish(&csb);
 
-  os_create_dir("./generated");
+  os_create_dir(output_dir);
   char temp_buffer[512];
-  FMT_TO_STR(temp_buffer, sizeof(temp_buffer), "./generated/%_generated.h",
-             FMT_STR(csb.file_name));
+  FMT_TO_STR(temp_buffer, sizeof(temp_buffer), "%/%_generated.h",
+             FMT_STR(output_dir), FMT_STR(csb.file_name));
   os_write_file(temp_buffer, (u8 *)generated, csb.sb.len);
   parser_destroy(&parser);
 
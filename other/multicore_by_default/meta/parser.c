@@ -250,6 +250,42 @@ internal void collect_field_attributes(Parser *parser,
   }
 }
 
+internal void
+collect_function_attributes(Parser *parser,
+                            FunctionAttribute_DynArray *out_attributes) {
+  // Same IDENTIFIER() patterns as structs, in front of the return type
+
+  while (parser->current_token.type != TOKEN_EOF) {
+    if (parser->current_token.type != TOKEN_IDENTIFIER) {
+      break;
+    }
+
+    Token identifier_token = parser->current_token;
+    Tokenizer saved_tokenizer = parser->tokenizer;
+
+    parser_advance_token(parser);
+
+    if (parser->current_token.type != TOKEN_LPAREN) {
+      parser->tokenizer = saved_tokenizer;
+      parser->current_token = identifier_token;
+      break;
+    }
+
+    parser_advance_token(parser);
+
+    if (parser->current_token.type != TOKEN_RPAREN) {
+      parser_error(parser, "Expected ')' after '(' in attribute");
+      break;
+    }
+
+    String attr_name = token_to_string(identifier_token, parser->allocator);
+    FunctionAttribute attr = {.name = attr_name, .parent_function = NULL};
+    arr_append(*out_attributes, attr);
+
+    parser_advance_token(parser); // Move past ')'
+  }
+}
+
 void parser_skip_to_next_attribute(Parser *parser) {
   while (!parser_current_token_is(parser, TOKEN_EOF)) {
     // try parse attribute in the format {attr_name}()
@@ -432,6 +468,185 @@ b32 parse_struct(Parser *parser, ReflectedStruct *out_struct) {
   return true;
 }
 
+b32 parser_attribute_targets_struct(Parser *parser) {
+  // Look past the attributes without consuming them
+  Parser saved_parser = *parser;
+  while (parser_current_token_is(parser, TOKEN_IDENTIFIER)) {
+    Parser before_attribute = *parser;
+    parser_advance_token(parser);
+    if (!parser_expect_token_and_advance(parser, TOKEN_LPAREN) ||
+        !parser_expect_token_and_advance(parser, TOKEN_RPAREN)) {
+      *parser = before_attribute;
+      break;
+    }
+  }
+  b32 is_struct = parser_current_token_is(parser, TOKEN_TYPEDEF) ||
+                  parser_current_token_is(parser, TOKEN_STRUCT);
+  *parser = saved_parser;
+  return is_struct;
+}
+
+internal b32 parser_current_token_is_const(Parser *parser) {
+  return parser_current_token_is(parser, TOKEN_IDENTIFIER) &&
+         str_equal_len(parser->current_token.lexeme,
+                       parser->current_token.length, "const", 5);
+}
+
+internal b32 parse_function_param(Parser *parser, StructField *out_param) {
+  FieldAttribute_DynArray param_attributes =
+      dyn_arr_new_alloc(parser->allocator, FieldAttribute, 4);
+  collect_field_attributes(parser, &param_attributes);
+
+  b32 is_const = false;
+  if (parser_current_token_is_const(parser)) {
+    is_const = true;
+    parser_advance_token(parser);
+  }
+
+  if (!parser_current_token_is(parser, TOKEN_IDENTIFIER)) {
+    parser_error(parser, "Expected type name for function parameter");
+    return false;
+  }
+  String type_name = token_to_string(parser->current_token, parser->allocator);
+  parser_advance_token(parser);
+
+  // east const, T const *p
+  if (parser_current_token_is_const(parser)) {
+    is_const = true;
+    parser_advance_token(parser);
+  }
+
+  u32 pointer_depth = 0;
+  while (parser_current_token_is(parser, TOKEN_ASTERISK)) {
+    pointer_depth++;
+    parser_advance_token(parser);
+    // a const pointer doesn't change what the parameter points at
+    if (parser_current_token_is_const(parser)) {
+      parser_advance_token(parser);
+    }
+  }
+
+  if (!parser_current_token_is(parser, TOKEN_IDENTIFIER)) {
+    parser_error(parser, "Expected parameter name after type");
+    return false;
+  }
+  String param_name = token_to_string(parser->current_token, parser->allocator);
+  parser_advance_token(parser);
+
+  *out_param = (StructField){.type_name = type_name,
+                             .field_name = param_name,
+                             .pointer_depth = pointer_depth,
+                             .is_const = is_const,
+                             .attributes = param_attributes};
+  return true;
+}
+
+b32 parse_function(Parser *parser, ReflectedFunction *out_function) {
+  FunctionAttribute_DynArray function_attributes =
+      dyn_arr_new_alloc(parser->allocator, FunctionAttribute, 8);
+  collect_function_attributes(parser, &function_attributes);
+
+  // Return type
+  if (!parser_current_token_is(parser, TOKEN_IDENTIFIER)) {
+    parser_error(parser, "Expected return type");
+    return false;
+  }
+  String return_type = token_to_string(parser->current_token, parser->allocator);
+  parser_advance_token(parser);
+
+  u32 return_pointer_depth = 0;
+  while (parser_current_token_is(parser, TOKEN_ASTERISK)) {
+    return_pointer_depth++;
+    parser_advance_token(parser);
+  }
+
+  if (!parser_current_token_is(parser, TOKEN_IDENTIFIER)) {
+    parser_error(parser, "Expected function name after return type");
+    return false;
+  }
+  String function_name =
+      token_to_string(parser->current_token, parser->allocator);
+  parser_advance_token(parser);
+
+  if (!parser_expect_token_and_advance(parser, TOKEN_LPAREN)) {
+    parser_error(parser, "Expected '(' after function name");
+    return false;
+  }
+
+  StructField_DynArray params =
+      dyn_arr_new_alloc(parser->allocator, StructField, 16);
+
+  // f(void) has no parameters
+  if (parser_current_token_is(parser, TOKEN_IDENTIFIER) &&
+      str_equal_len(parser->current_token.lexeme, parser->current_token.length,
+                    "void", 4)) {
+    Parser saved_parser = *parser;
+    parser_advance_token(parser);
+    if (!parser_current_token_is(parser, TOKEN_RPAREN)) {
+      *parser = saved_parser;
+    }
+  }
+
+  while (!parser_current_token_is(parser, TOKEN_RPAREN) &&
+         !parser_current_token_is(parser, TOKEN_EOF)) {
+    StructField param = {0};
+    if (!parse_function_param(parser, &param)) {
+      return false;
+    }
+    arr_append(params, param);
+
+    if (!parser_current_token_is(parser, TOKEN_RPAREN) &&
+        !parser_expect_token_and_advance(parser, TOKEN_COMMA)) {
+      parser_error(parser, "Expected ',' or ')' after function parameter");
+      return false;
+    }
+  }
+
+  if (!parser_expect_token_and_advance(parser, TOKEN_RPAREN)) {
+    parser_error(parser, "Expected ')' at end of parameter list");
+    return false;
+  }
+
+  // Declaration or definition, the body is skipped
+  if (parser_current_token_is(parser, TOKEN_LBRACE)) {
+    u32 depth = 0;
+    do {
+      if (parser_current_token_is(parser, TOKEN_LBRACE)) {
+        depth++;
+      } else if (parser_current_token_is(parser, TOKEN_RBRACE)) {
+        depth--;
+      }
+      parser_advance_token(parser);
+    } while (depth > 0 && !parser_current_token_is(parser, TOKEN_EOF));
+
+    if (depth > 0) {
+      parser_error(parser, "Expected '}' at end of function body");
+      return false;
+    }
+  } else if (!parser_expect_token_and_advance(parser, TOKEN_SEMICOLON)) {
+    parser_error(parser, "Expected ';' after function declaration");
+    return false;
+  }
+
+  out_function->return_type = return_type;
+  out_function->return_pointer_depth = return_pointer_depth;
+  out_function->function_name = function_name;
+  out_function->attributes = function_attributes;
+  out_function->params = params;
+
+  for (u32 i = 0; i < out_function->attributes.len; i++) {
+    out_function->attributes.items[i].parent_function = out_function;
+  }
+  for (u32 i = 0; i < out_function->params.len; i++) {
+    StructField *param = &out_function->params.items[i];
+    for (u32 j = 0; j < param->attributes.len; j++) {
+      param->attributes.items[j].parent_field = param;
+    }
+  }
+
+  return true;
+}
+
 void parser_destroy(Parser *parser) {
   tokenizer_destroy(&parser->tokenizer);
   parser->has_error = false;
@@ -10,6 +10,7 @@
 // Forward declarations
 typedef struct StructField StructField;
 typedef struct ReflectedStruct ReflectedStruct;
+typedef struct ReflectedFunction ReflectedFunction;
 
 // Attribute types
 typedef struct {
@@ -24,11 +25,18 @@ typedef struct {
 } StructAttribute;
 arr_define(StructAttribute);
 
+typedef struct {
+  String name;
+  ReflectedFunction *parent_function;
+} FunctionAttribute;
+arr_define(FunctionAttribute);
+
 // Main struct definitions
 struct StructField {
   String type_name;
   String field_name;
   u32 pointer_depth;
+  b32 is_const;
   b32 is_array;
   u32 array_size;
   FieldAttribute_DynArray attributes;
@@ -44,6 +52,17 @@ struct ReflectedStruct {
 };
 arr_define(ReflectedStruct);
 
+// Function declarations, parameters reuse StructField (field_name is the
+// parameter name)
+struct ReflectedFunction {
+  String return_type;
+  u32 return_pointer_depth;
+  String function_name;
+  FunctionAttribute_DynArray attributes;
+  StructField_DynArray params;
+};
+arr_define(ReflectedFunction);
+
 
 #define PARSER_TOKEN_HISTORY_SIZE 16
 
@@ -59,6 +78,8 @@ Parser parser_create(const char *filename, const char *source, u32 source_length
                      Allocator *allocator);
 b32 parse_file(Parser *parser, ReflectedStruct_DynArray *out_structs);
 b32 parse_struct(Parser *parser, ReflectedStruct *out_struct);
+b32 parse_function(Parser *parser, ReflectedFunction *out_function);
+b32 parser_attribute_targets_struct(Parser *parser);
 void parser_destroy(Parser *parser);
 void parser_reset_type_id();
 
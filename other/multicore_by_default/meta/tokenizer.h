@@ -17,6 +17,7 @@
   TOKEN_TYPE(TOKEN_RBRACKET, "]")                                              \
   TOKEN_TYPE(TOKEN_SEMICOLON, ";")                                             \
   TOKEN_TYPE(TOKEN_ASTERISK, "*")                                              \
+  TOKEN_TYPE(TOKEN_COMMA, ",")                                                 \
   TOKEN_TYPE(TOKEN_NUMBER, "number")                                           \
   TOKEN_TYPE(TOKEN_EOF, "EOF")                                                 \
   TOKEN_TYPE(TOKEN_INVALID, "INVALID")
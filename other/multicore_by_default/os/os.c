@@ -8,6 +8,8 @@
 #if defined (BUILD_SYSTEM) || defined (TOOLING) || defined (TESTS)
   #if defined(_WIN32)
     #include "os/os_win32.c"
+  #elif defined(__linux__)
+    #include "os/os_linux.c"
   #else
     #include "os/os_darwin_time.c"
     #include "os/os_macos.c"
@@ -0,0 +1,181 @@
+/*
+  Linux backend for the tooling builds (meta, build system, tests): time,
+  logging and whole-file io. The engine itself doesn't run on Linux, the rest
+  of os.h is left out until something on Linux needs it.
+*/
+#undef internal
+
+#include "os.h"
+#include "lib/string.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static struct {
+  u64 start;
+  b32 initialized;
+} g_time_state = {0};
+
+static u64 os_linux_monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+void os_time_init(void) {
+  g_time_state.start = os_linux_monotonic_ns();
+  g_time_state.initialized = true;
+}
+
+u64 os_time_now(void) {
+  assert(g_time_state.initialized);
+  return os_linux_monotonic_ns() - g_time_state.start;
+}
+
+u64 os_time_diff(u64 new_ticks, u64 old_ticks) {
+  if (new_ticks > old_ticks) {
+    return new_ticks - old_ticks;
+  } else {
+    return 1;
+  }
+}
+
+f64 os_ticks_to_ms(u64 ticks) { return (f64)ticks / 1000000.0; }
+
+f64 os_ticks_to_us(u64 ticks) { return (f64)ticks / 1000.0; }
+
+f64 os_ticks_to_ns(u64 ticks) { return (f64)ticks; }
+
+void assert_log(u8 log_level, const char *fmt, const FmtArgs *args,
+                const char *file_name, uint32 line_number) {
+  os_log(log_level, fmt, args, file_name, line_number);
+}
+
+void os_log(LogLevel log_level, const char *fmt, const FmtArgs *args,
+            const char *file_name, uint32 line_number) {
+  char buffer[1024];
+  fmt_string(buffer, sizeof(buffer), fmt, args);
+
+  const char *level_str;
+  const char *color_start = "";
+  const char *color_end = "";
+  FILE *output = stderr;
+
+  switch (log_level) {
+  case LOGLEVEL_INFO:
+    level_str = "INFO";
+    output = stdout;
+    break;
+  case LOGLEVEL_WARN:
+    level_str = "WARN";
+    color_start = "\033[33m";
+    break;
+  case LOGLEVEL_ERROR:
+    level_str = "ERROR";
+    color_start = "\033[31m";
+    break;
+  default:
+    level_str = "UNKNOWN";
+    break;
+  }
+  if (*color_start && isatty(fileno(output))) {
+    color_end = "\033[0m";
+  } else {
+    color_start = "";
+  }
+
+  fprintf(output, "%s[%s] %s:%u: %s%s\n", color_start, level_str, file_name,
+          line_number, buffer, color_end);
+  fflush(output);
+}
+
+bool32 os_write_file(const char *file_path, u8 *buffer, size_t buffer_len) {
+  FILE *file = fopen(file_path, "wb");
+  if (file == NULL) {
+    LOG_ERROR("Error opening file for writing: %", FMT_STR(file_path));
+    return false;
+  }
+
+  size_t written = fwrite(buffer, 1, buffer_len, file);
+  if (written != buffer_len) {
+    LOG_ERROR("Error writing to file: %", FMT_STR(file_path));
+    fclose(file);
+    return false;
+  }
+
+  fclose(file);
+  return true;
+}
+
+bool32 os_create_dir(const char *dir_path) {
+  if (mkdir(dir_path, 0755) == 0) {
+    return true;
+  }
+
+  struct stat st;
+  if (stat(dir_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+    return true;
+  }
+
+  LOG_ERROR("Failed to create directory: %", FMT_STR(dir_path));
+  return false;
+}
+
+PlatformFileData os_read_file(const char *file_path, Allocator *allocator) {
+  PlatformFileData result = {0};
+
+  FILE *file = fopen(file_path, "rb");
+  if (file == NULL) {
+    LOG_ERROR("Failed to open file: %", FMT_STR(file_path));
+    return result;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  if (file_size < 0) {
+    LOG_ERROR("Failed to get file size: %", FMT_STR(file_path));
+    fclose(file);
+    return result;
+  }
+
+  result.buffer = ALLOC_ARRAY(allocator, uint8, file_size);
+  if (!result.buffer) {
+    LOG_ERROR("Failed to allocate memory for file: %", FMT_STR(file_path));
+    fclose(file);
+    return result;
+  }
+
+  size_t bytes_read = fread(result.buffer, 1, file_size, file);
+  fclose(file);
+
+  if (bytes_read != (size_t)file_size) {
+    LOG_ERROR("Failed to read entire file: %", FMT_STR(file_path));
+    result.buffer = NULL;
+    result.buffer_len = 0;
+    return result;
+  }
+
+  result.buffer_len = file_size;
+  result.success = true;
+  return result;
+}
+
+OsFileInfo os_file_info(const char *path) {
+  OsFileInfo info = {0};
+  struct stat file_stat;
+  if (stat(path, &file_stat) == 0) {
+    info.modification_time = file_stat.st_mtime;
+    info.exists = true;
+  }
+  return info;
+}
+
+b32 os_file_exists(const char *path) {
+  struct stat file_stat;
+  return stat(path, &file_stat) == 0;
+}
+
+#define internal static
@@ -592,3 +592,108 @@ void test_parse_struct_comprehensive(TestContext *ctx)
 
   parser_destroy(&parser);
 }
+
+// ============================================================================
+// Function Parsing Tests
+// ============================================================================
+
+void test_parse_function_with_attributes(TestContext *ctx)
+{
+  Allocator *allocator = &ctx->allocator;
+
+  const char *source =
+      "HZ_SYSTEM() void Move(EcsIter *it, HZ_READ() HZ_WRITE() Position *p, "
+      "HZ_READ() const Velocity *v);";
+  Parser parser = parser_create("test.h", source, str_len(source), allocator);
+
+  assert_false(parser_attribute_targets_struct(&parser));
+
+  ReflectedFunction f = {0};
+  b32 success = parse_function(&parser, &f);
+
+  assert_true(success);
+  assert_str_eq(f.return_type.value, "void");
+  assert_eq(f.return_pointer_depth, 0);
+  assert_str_eq(f.function_name.value, "Move");
+  assert_eq(f.attributes.len, 1);
+  assert_str_eq(f.attributes.items[0].name.value, "HZ_SYSTEM");
+  assert_eq(f.params.len, 3);
+
+  StructField it = f.params.items[0];
+  assert_str_eq(it.type_name.value, "EcsIter");
+  assert_str_eq(it.field_name.value, "it");
+  assert_eq(it.pointer_depth, 1);
+  assert_eq(it.attributes.len, 0);
+
+  StructField p = f.params.items[1];
+  assert_str_eq(p.type_name.value, "Position");
+  assert_false(p.is_const);
+  assert_eq(p.attributes.len, 2);
+  assert_str_eq(p.attributes.items[0].name.value, "HZ_READ");
+  assert_str_eq(p.attributes.items[1].name.value, "HZ_WRITE");
+  assert_true(p.attributes.items[1].parent_field == &f.params.items[1]);
+
+  StructField v = f.params.items[2];
+  assert_str_eq(v.type_name.value, "Velocity");
+  assert_str_eq(v.field_name.value, "v");
+  assert_true(v.is_const);
+  assert_eq(v.pointer_depth, 1);
+
+  assert_true(parser_current_token_is(&parser, TOKEN_EOF));
+  parser_destroy(&parser);
+}
+
+void test_parse_function_void_params_and_body(TestContext *ctx)
+{
+  Allocator *allocator = &ctx->allocator;
+
+  const char *source = "u8 **Get(void) { if (x) { y; } } struct After {}";
+  Parser parser = parser_create("test.h", source, str_len(source), allocator);
+
+  ReflectedFunction f = {0};
+  b32 success = parse_function(&parser, &f);
+
+  assert_true(success);
+  assert_str_eq(f.return_type.value, "u8");
+  assert_eq(f.return_pointer_depth, 2);
+  assert_str_eq(f.function_name.value, "Get");
+  assert_eq(f.params.len, 0);
+
+  // the whole body is skipped
+  assert_true(parser_current_token_is(&parser, TOKEN_STRUCT));
+  parser_destroy(&parser);
+}
+
+void test_parse_attribute_targets_struct(TestContext *ctx)
+{
+  Allocator *allocator = &ctx->allocator;
+
+  const char *source = "HZ_TASK() typedef struct { u64 x; } Task;";
+  Parser parser = parser_create("test.h", source, str_len(source), allocator);
+
+  assert_true(parser_attribute_targets_struct(&parser));
+  // nothing consumed
+  assert_true(parser_current_token_is(&parser, TOKEN_IDENTIFIER));
+
+  ReflectedStruct s = {0};
+  assert_true(parse_struct(&parser, &s));
+  assert_str_eq(s.typedef_name.value, "Task");
+
+  parser_destroy(&parser);
+}
+
+void test_parse_function_error_missing_comma(TestContext *ctx)
+{
+  Allocator *allocator = &ctx->allocator;
+
+  const char *source = "void f(int a int b);";
+  Parser parser = parser_create("test.h", source, str_len(source), allocator);
+
+  ReflectedFunction f = {0};
+  b32 success = parse_function(&parser, &f);
+
+  assert_false(success);
+  assert_true(parser.has_error);
+
+  parser_destroy(&parser);
+}
@@ -29,6 +29,7 @@ int main() {
   RUN_TEST(test_invalid_character, &ctx);
   RUN_TEST(test_asterisk_token, &ctx);
   RUN_TEST(test_multiple_asterisks, &ctx);
+  RUN_TEST(test_comma_token, &ctx);
 
   // Parser basic tests
   RUN_TEST(test_parse_struct_basic, &ctx);
@@ -69,6 +70,12 @@ int main() {
   // Parser comprehensive test
   RUN_TEST(test_parse_struct_comprehensive, &ctx);
 
+  // Parser function tests
+  RUN_TEST(test_parse_function_with_attributes, &ctx);
+  RUN_TEST(test_parse_function_void_params_and_body, &ctx);
+  RUN_TEST(test_parse_attribute_targets_struct, &ctx);
+  RUN_TEST(test_parse_function_error_missing_comma, &ctx);
+
   print_test_results();
   return 0;
 }
\ No newline at end of file
@@ -201,3 +201,28 @@ void test_multiple_asterisks(TestContext* ctx) {
 
   tokenizer_destroy(&tokenizer);
 }
+
+void test_comma_token(TestContext* ctx) {
+  Allocator* allocator = &ctx->allocator;
+
+  const char *source = "f(a, b)";
+  Tokenizer tokenizer = tokenizer_create("test.c", source, str_len(source), allocator);
+
+  Token token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_IDENTIFIER);
+  token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_LPAREN);
+  token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_IDENTIFIER);
+
+  token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_COMMA);
+  assert_eq(token.length, 1);
+
+  token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_IDENTIFIER);
+  token = tokenizer_next_token(&tokenizer);
+  assert_eq(token.type, TOKEN_RPAREN);
+
+  tokenizer_destroy(&tokenizer);
+}
@@ -207,13 +207,17 @@ void asset_system_update(AssetSystem *s) {
         }
       } else {
         LOG_ERROR("Failed to get file data for asset");
+        os_release_file_op(entry->file_op);
         entry->state = ASSET_STATE_FAILED;
       }
+      entry->file_op = NULL;
 
       dyn_arr_remove_swap(s->pending_loads, i);
 
     } else if (file_state == OS_FILE_READ_STATE_ERROR) {
       LOG_ERROR("File read error for asset");
+      os_release_file_op(entry->file_op);
+      entry->file_op = NULL;
       entry->state = ASSET_STATE_FAILED;
       dyn_arr_remove_swap(s->pending_loads, i);
     }
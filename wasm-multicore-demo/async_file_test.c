@@ -14,9 +14,12 @@
 #include "lib/string_builder.c"
 #include "lib/thread.c"
 #include "lib/thread_context.c"
-#include "lib/task.c"
 #include "lib/multicore_runtime.c"
+#if defined(_WIN32)
 #include "os/os_win32.c"
+#else
+#include "os/os_linux.c"
+#endif
 
 typedef struct {
     OsFileOp *op;
@@ -51,7 +54,7 @@ void entrypoint(void) {
         g_files_loaded = 0;
         g_errors = 0;
 
-        LOG_INFO("=== Async File Load Test (IOCP + MCR) ===");
+        LOG_INFO("=== Async File Load Test (MCR) ===");
         LOG_INFO("Threads: %, Files: %",
                  FMT_UINT(tctx_current()->thread_count),
                  FMT_INT(g_files.count));
@@ -98,12 +101,14 @@ void entrypoint(void) {
 
             if (state == OS_FILE_READ_STATE_COMPLETED) {
                 load->size = (u32)os_get_file_size(load->op);
+                os_release_file_op(load->op);
                 load->completed = true;
                 my_pending--;
 
                 ins_atomic_u64_add_eval(&g_total_bytes, load->size);
                 ins_atomic_u32_add_eval(&g_files_loaded, 1);
             } else if (state == OS_FILE_READ_STATE_ERROR) {
+                os_release_file_op(load->op);
                 load->completed = true;
                 load->error = true;
                 my_pending--;
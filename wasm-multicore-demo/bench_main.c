@@ -0,0 +1,16 @@
+#include "lib/string.c"
+#include "lib/common.c"
+#include "lib/memory.c"
+#include "lib/allocator_block.c"
+#include "lib/string_builder.c"
+#include "lib/thread_context.h"
+#include "os/os.h"
+#include "os/os_wasm.c"
+#include "lib/thread.c"
+#include "lib/thread_context.c"
+#include "lib/multicore_runtime.c"
+#include "lib/handle.c"
+#include "lib/random.c"
+#include "lib/math.h"
+#include "context.c"
+#include "benchmarks/bench_runner.c"
@@ -0,0 +1,103 @@
+#include "lib/string.c"
+#include "lib/common.c"
+#include "lib/memory.c"
+#include "lib/allocator_block.c"
+#include "lib/allocator_pool.c"
+#include "lib/string_builder.c"
+#include "lib/thread_context.h"
+#include "os/os.h"
+#include "os/os_linux.c"
+#include "lib/thread.c"
+#include "lib/thread_context.c"
+#include "lib/multicore_runtime.c"
+#include "lib/handle.c"
+#include "lib/random.c"
+#include "lib/math.h"
+#include "context.c"
+#include "benchmarks/bench_runner.c"
+
+/*
+    Native bench runner, no GPU or browser needed.
+
+    usage: bench [--threads 1,2,4,8] [--out bench.json]
+
+    The first lane count runs every bench, the others only rerun the multicore ones. Without
+    --threads the sweep doubles from 1 up to the processor count, capped at BENCH_MAX_LANES.
+*/
+
+#define BENCH_LINUX_HEAP_SIZE GB(4)
+#define BENCH_LINUX_TEMP_ARENA_SIZE MB(16)
+#define BENCH_LINUX_JSON_SIZE MB(1)
+
+internal u32 bench_parse_threads(const char *list, u8 *out, u32 max_count) {
+    u32 count = 0;
+    u32 value = 0;
+    for (const char *c = list;; c++) {
+        if (char_is_digit(*c)) {
+            value = value * 10 + (u32)(*c - '0');
+        } else {
+            if (value > 0 && value <= BENCH_MAX_LANES && count < max_count) {
+                out[count++] = (u8)value;
+            }
+            value = 0;
+            if (*c == 0) {
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    os_init();
+    os_time_init();
+
+    u8 thread_counts[BENCH_MAX_LANES];
+    u32 sweep_count = 0;
+    const char *out_path = "bench.json";
+    for (i32 i = 1; i < argc; i++) {
+        if (str_equal(argv[i], "--threads") && i + 1 < argc) {
+            sweep_count = bench_parse_threads(argv[++i], thread_counts, BENCH_MAX_LANES);
+        } else if (str_equal(argv[i], "--out") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            LOG_ERROR("unknown argument %, usage: bench [--threads 1,2,4] [--out bench.json]", FMT_STR(argv[i]));
+            return 1;
+        }
+    }
+    if (sweep_count == 0) {
+        i32 max_lanes = MIN(os_get_processor_count(), BENCH_MAX_LANES);
+        for (i32 lanes = 1; lanes < max_lanes; lanes *= 2) {
+            thread_counts[sweep_count++] = (u8)lanes;
+        }
+        thread_counts[sweep_count++] = (u8)max_lanes;
+    }
+
+    u8 *heap = os_reserve_memory(BENCH_LINUX_HEAP_SIZE);
+    if (!heap || !os_commit_memory(heap, BENCH_LINUX_HEAP_SIZE)) {
+        return 1;
+    }
+    g_bench_app_ctx.arena = arena_from_buffer(heap, BENCH_LINUX_HEAP_SIZE);
+    app_ctx_set(&g_bench_app_ctx);
+
+    bench_runner_init(&g_bench_app_ctx.arena, MB(1024));
+    bench_runner_json_init(&g_bench_app_ctx.arena, BENCH_LINUX_JSON_SIZE);
+    register_benches();
+
+    for (u32 s = 0; s < sweep_count; s++) {
+        g_bench_app_ctx.num_threads = thread_counts[s];
+        g_bench_runner.multicore_only = s > 0;
+        LOG_INFO("=== Bench pass: % threads ===", FMT_UINT(thread_counts[s]));
+
+        // thread contexts and temp arenas of a pass are dropped before the next one
+        size_t arena_offset = g_bench_app_ctx.arena.offset;
+        mcr_run(thread_counts[s], BENCH_LINUX_TEMP_ARENA_SIZE, bench_main, &g_bench_app_ctx.arena);
+        g_bench_app_ctx.arena.offset = arena_offset;
+    }
+
+    if (!bench_runner_write_json(out_path)) {
+        return 1;
+    }
+    LOG_INFO("=== Bench results written to % ===", FMT_STR(out_path));
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <sys/resource.h>
+
+#define BENCH_ARENA_SIZE MB(256)
+#define BENCH_ARENA_ROUNDS 5
+#define BENCH_ARENA_RANDOM_READS (1u << 22)
+
+global volatile u64 g_bench_arena_sink;
+
+internal u64 bench_arena_minor_faults(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return (u64)usage.ru_minflt;
+}
+
+// process wide AnonHugePages, so the delta over one arena's life is what it got.
+// explicit huge pages come from hugetlbfs and never show up here
+internal u64 bench_arena_huge_kb(void) {
+    char buffer[4096];
+    u32 len = os_lnx_read_sys_file("/proc/self/smaps_rollup", buffer, sizeof(buffer));
+    const char *key = "AnonHugePages:";
+    u32 key_len = (u32)strlen(key);
+    for (u32 i = 0; i + key_len < len; i++) {
+        if (memcmp(buffer + i, key, key_len) == 0) {
+            u64 kb = 0;
+            for (u32 c = i + key_len; c < len && buffer[c] != '\n'; c++) {
+                if (char_is_digit(buffer[c])) {
+                    kb = kb * 10 + (u64)(buffer[c] - '0');
+                }
+            }
+            return kb;
+        }
+    }
+    return 0;
+}
+
+// one BENCH_ARENA_SIZE arena per mode: faults and time to create it and touch every byte,
+// then sequential sums and dependent random reads over it. random reads chase an index
+// through the data so the loads can't overlap and each one pays its TLB miss
+void bench_arena_pages(void) {
+    struct { const char *name; ArenaDesc desc; } runs[] = {
+        { "arena_default", { .pages = ARENA_PAGES_DEFAULT } },
+        { "arena_default_prefault", { .pages = ARENA_PAGES_DEFAULT, .prefault = true } },
+        { "arena_transparent_huge", { .pages = ARENA_PAGES_TRANSPARENT_HUGE } },
+        { "arena_transparent_huge_prefault", { .pages = ARENA_PAGES_TRANSPARENT_HUGE, .prefault = true } },
+        { "arena_explicit_huge", { .pages = ARENA_PAGES_EXPLICIT_HUGE } },
+        { "arena_numa_bind_node0", { .pages = ARENA_PAGES_DEFAULT, .numa_bind = true, .numa_node = 0 } },
+    };
+    u64 count = BENCH_ARENA_SIZE / sizeof(u64);
+
+    for (u32 r = 0; r < ARRAY_SIZE(runs); r++) {
+        ArenaDesc desc = runs[r].desc;
+        desc.reserve_size = BENCH_ARENA_SIZE;
+
+        u64 huge_kb_start = bench_arena_huge_kb();
+        u64 faults_start = bench_arena_minor_faults();
+        u64 start = os_time_now();
+        ArenaAllocator arena = arena_create_desc(&desc);
+        if (!arena.buffer) {
+            LOG_WARN("bench_arena_pages: % failed to reserve, skipped", FMT_STR(runs[r].name));
+            continue;
+        }
+        // arena_alloc zeroes, which is the first touch
+        u64 *values = ARENA_ALLOC_ARRAY(&arena, u64, count);
+        u64 touch_ns = os_time_diff(os_time_now(), start);
+        u64 faults = bench_arena_minor_faults() - faults_start;
+        u64 huge_kb_end = bench_arena_huge_kb();
+        u64 huge_kb = huge_kb_end > huge_kb_start ? huge_kb_end - huge_kb_start : 0;
+
+        UnityRandom rng = unity_random_new(42);
+        for (u64 i = 0; i < count; i++) {
+            values[i] = unity_random_next(&rng) & (count - 1);
+        }
+
+        BenchSamples seq = bench_samples_make(bench_arena(), BENCH_ARENA_ROUNDS);
+        BenchSamples random = bench_samples_make(bench_arena(), BENCH_ARENA_ROUNDS);
+        u64 sum = 0;
+        for (u32 round = 0; round < BENCH_ARENA_ROUNDS; round++) {
+            u64 seq_start = os_time_now();
+            for (u64 i = 0; i < count; i++) {
+                sum += values[i];
+            }
+            bench_samples_push(&seq, os_time_diff(os_time_now(), seq_start));
+
+            u64 index = round;
+            u64 random_start = os_time_now();
+            for (u32 i = 0; i < BENCH_ARENA_RANDOM_READS; i++) {
+                index = values[(index + i) & (count - 1)];
+            }
+            bench_samples_push(&random, os_time_diff(os_time_now(), random_start));
+            sum += index;
+        }
+        g_bench_arena_sink = sum;
+        arena_release(&arena);
+
+        BenchStats seq_stats = bench_samples_stats(&seq);
+        BenchStats random_stats = bench_samples_stats(&random);
+        bench_report(runs[r].name, &seq);
+        LOG_INFO("[BENCH] % faults=% touch=%us huge_kb=% seq_gbps=% random_read=%ns",
+                 FMT_STR(runs[r].name), FMT_UINT(faults), FMT_UINT(touch_ns / 1000),
+                 FMT_UINT(huge_kb),
+                 FMT_FLOAT((f32)BENCH_ARENA_SIZE / (f32)MAX(seq_stats.median_ns, 1)),
+                 FMT_FLOAT((f32)random_stats.median_ns / (f32)BENCH_ARENA_RANDOM_READS));
+    }
+
+    LOG_INFO("arena pages: % MB per arena, samples are sequential passes, huge page size % KB",
+             FMT_UINT(BENCH_ARENA_SIZE / MB(1)), FMT_UINT(os_get_huge_page_size() / 1024));
+}
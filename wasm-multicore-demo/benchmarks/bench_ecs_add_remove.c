@@ -0,0 +1,104 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchARPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchARVelocity;
+typedef struct { f32 value[16]; } BenchARTransform;
+typedef struct { u8 dummy; } BenchARSelected;
+
+#define BENCH_ADD_REMOVE_ENTITIES 1024
+#define BENCH_ADD_REMOVE_ROUNDS 100
+
+internal void bench_ecs_add_remove_hi_ids(i32 hi_id_count, const char *name) {
+    ArenaAllocator *arena = bench_arena();
+    size_t arena_offset = arena->offset;
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+
+    ECS_COMPONENT(world, BenchARPosition);
+
+    EcsEntity *tags = ARENA_ALLOC_ARRAY(arena, EcsEntity, hi_id_count);
+    for (i32 i = 0; i < hi_id_count; i++) {
+        tags[i] = ecs_entity_new(world);
+        debug_assert(ecs_entity_index(tags[i]) >= ECS_HI_COMPONENT_ID);
+    }
+
+    EcsEntity entities[BENCH_ADD_REMOVE_ENTITIES];
+    for (i32 i = 0; i < BENCH_ADD_REMOVE_ENTITIES; i++) {
+        entities[i] = ecs_entity_new(world);
+        ecs_add(world, entities[i], ecs_id(BenchARPosition));
+    }
+
+    // warm up: every tag gets its add edge from the base table and its remove edge back
+    for (i32 i = 0; i < hi_id_count; i++) {
+        ecs_add(world, entities[0], tags[i]);
+        ecs_remove(world, entities[0], tags[i]);
+    }
+
+    Xorshift32_State rng;
+    xorshift32_seed(&rng, 42);
+
+    BenchSamples samples = bench_samples_make(arena, BENCH_ADD_REMOVE_ROUNDS);
+    for (i32 round = 0; round < BENCH_ADD_REMOVE_ROUNDS; round++) {
+        u64 start = os_time_now();
+        for (i32 i = 0; i < BENCH_ADD_REMOVE_ENTITIES; i++) {
+            EcsEntity tag = tags[xorshift32_next(&rng) % (u32)hi_id_count];
+            ecs_add(world, entities[i], tag);
+            ecs_remove(world, entities[i], tag);
+        }
+        bench_samples_push(&samples, os_time_diff(os_time_now(), start) / BENCH_ADD_REMOVE_ENTITIES);
+    }
+    bench_report(name, &samples);
+
+    arena->offset = arena_offset;
+}
+
+// a transient tag flipped on a third of the entities every round, like selection or "in combat"
+internal void bench_ecs_add_remove_tag(b32 sparse, const char *name) {
+    ArenaAllocator *arena = bench_arena();
+    size_t arena_offset = arena->offset;
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+
+    ECS_COMPONENT(world, BenchARPosition);
+    ECS_COMPONENT(world, BenchARVelocity);
+    ECS_COMPONENT(world, BenchARTransform);
+    ECS_COMPONENT(world, BenchARSelected);
+    if (sparse) {
+        ecs_component_set_sparse(world, ecs_id(BenchARSelected));
+    }
+
+    EcsEntity entities[BENCH_ADD_REMOVE_ENTITIES];
+    for (i32 i = 0; i < BENCH_ADD_REMOVE_ENTITIES; i++) {
+        entities[i] = ecs_entity_new(world);
+        ecs_add(world, entities[i], ecs_id(BenchARPosition));
+        ecs_add(world, entities[i], ecs_id(BenchARVelocity));
+        ecs_add(world, entities[i], ecs_id(BenchARTransform));
+    }
+
+    BenchSamples samples = bench_samples_make(arena, BENCH_ADD_REMOVE_ROUNDS);
+    for (i32 round = 0; round < BENCH_ADD_REMOVE_ROUNDS; round++) {
+        u64 start = os_time_now();
+        for (i32 i = round % 3; i < BENCH_ADD_REMOVE_ENTITIES; i += 3) {
+            ecs_add(world, entities[i], ecs_id(BenchARSelected));
+        }
+        for (i32 i = round % 3; i < BENCH_ADD_REMOVE_ENTITIES; i += 3) {
+            ecs_remove(world, entities[i], ecs_id(BenchARSelected));
+        }
+        bench_samples_push(&samples, os_time_diff(os_time_now(), start) / BENCH_ADD_REMOVE_ENTITIES);
+    }
+    bench_report(name, &samples);
+
+    arena->offset = arena_offset;
+}
+
+void bench_ecs_add_remove(void) {
+    bench_ecs_add_remove_hi_ids(8, "add_remove_pair_hi_ids_8");
+    bench_ecs_add_remove_hi_ids(64, "add_remove_pair_hi_ids_64");
+    bench_ecs_add_remove_hi_ids(256, "add_remove_pair_hi_ids_256");
+    bench_ecs_add_remove_hi_ids(1024, "add_remove_pair_hi_ids_1024");
+    bench_ecs_add_remove_hi_ids(4096, "add_remove_pair_hi_ids_4096");
+    bench_ecs_add_remove_tag(false, "toggle_tag_archetype");
+    bench_ecs_add_remove_tag(true, "toggle_tag_sparse");
+}
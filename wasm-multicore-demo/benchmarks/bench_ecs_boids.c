@@ -0,0 +1,135 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchBoidPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchBoidHeading;
+
+#define BENCH_BOID_FLOCKS 8
+#define BENCH_BOID_BIG_FLOCKS 4
+#define BENCH_BOID_BIG 48000
+#define BENCH_BOID_SMALL 700
+#define BENCH_BOID_ROUNDS 100
+#define BENCH_BOID_CHUNK_SIZE KB(16)
+
+global EcsWorld *g_bench_boid_worlds[2];
+
+// turns each boid a bit towards the origin, the flock center of every table
+internal void BenchBoidSteer(EcsIter *it) {
+    u64 start = os_time_now();
+    BenchBoidPosition *p = ecs_field(it, BenchBoidPosition, 0);
+    BenchBoidHeading *h = ecs_field(it, BenchBoidHeading, 1);
+    for (i32 i = 0; i < it->count; i++) {
+        f32 x = h[i].x - p[i].x * 0.01f;
+        f32 y = h[i].y - p[i].y * 0.01f;
+        f32 z = h[i].z - p[i].z * 0.01f;
+        f32 inv_len = 1.0f / sqrtf(x * x + y * y + z * z + 1e-6f);
+        h[i] = (BenchBoidHeading){ x * inv_len, y * inv_len, z * inv_len };
+    }
+    bench_lane_busy_add(os_time_diff(os_time_now(), start));
+}
+
+internal void BenchBoidMove(EcsIter *it) {
+    u64 start = os_time_now();
+    BenchBoidPosition *p = ecs_field(it, BenchBoidPosition, 0);
+    BenchBoidHeading *h = ecs_field(it, BenchBoidHeading, 1);
+    f32 step = it->delta_time * 4.0f;
+    for (i32 i = 0; i < it->count; i++) {
+        p[i].x += h[i].x * step;
+        p[i].y += h[i].y * step;
+        p[i].z += h[i].z * step;
+    }
+    bench_lane_busy_add(os_time_diff(os_time_now(), start));
+}
+
+// four big flocks and every pair of the four small ones, so a frame walks a few big tables and
+// several that fit in a chunk or two
+internal EcsWorld* bench_boid_world_make(ArenaAllocator *arena, u32 chunk_size) {
+    local_persist const char *flock_names[BENCH_BOID_FLOCKS] = {
+        "BenchBoidFlock0", "BenchBoidFlock1", "BenchBoidFlock2", "BenchBoidFlock3",
+        "BenchBoidFlock4", "BenchBoidFlock5", "BenchBoidFlock6", "BenchBoidFlock7",
+    };
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+    ecs_world_set_chunk_size(world, chunk_size);
+
+    EcsEntity position = ecs_component_register(world, sizeof(BenchBoidPosition), _Alignof(BenchBoidPosition), "BenchBoidPosition");
+    EcsEntity heading = ecs_component_register(world, sizeof(BenchBoidHeading), _Alignof(BenchBoidHeading), "BenchBoidHeading");
+    EcsEntity flocks[BENCH_BOID_FLOCKS];
+    for (i32 f = 0; f < BENCH_BOID_FLOCKS; f++) {
+        flocks[f] = ecs_component_register(world, 1, 1, flock_names[f]);
+    }
+
+    BenchBoidPosition *positions = ARENA_ALLOC_ARRAY(arena, BenchBoidPosition, BENCH_BOID_BIG);
+    BenchBoidHeading *headings = ARENA_ALLOC_ARRAY(arena, BenchBoidHeading, BENCH_BOID_BIG);
+    for (i32 i = 0; i < BENCH_BOID_BIG; i++) {
+        positions[i] = (BenchBoidPosition){ (f32)(i % 97) - 48.0f, (f32)(i % 53) - 26.0f, (f32)(i % 31) - 15.0f };
+        headings[i] = (BenchBoidHeading){ 1.0f, 0.0f, 0.0f };
+    }
+    const void *data[] = { positions, headings, NULL, NULL };
+
+    for (i32 f = 0; f < BENCH_BOID_BIG_FLOCKS; f++) {
+        EcsEntity ids[] = { position, heading, flocks[f] };
+        ecs_bulk_new(world, &(EcsBulkDesc){ .ids = ids, .id_count = 3, .data = data, .count = BENCH_BOID_BIG });
+    }
+    for (i32 a = BENCH_BOID_BIG_FLOCKS; a < BENCH_BOID_FLOCKS; a++) {
+        for (i32 b = a + 1; b < BENCH_BOID_FLOCKS; b++) {
+            EcsEntity ids[] = { position, heading, flocks[a], flocks[b] };
+            ecs_bulk_new(world, &(EcsBulkDesc){ .ids = ids, .id_count = 4, .data = data, .count = BENCH_BOID_SMALL });
+        }
+    }
+
+    EcsTerm steer_terms[] = { ecs_term_in(position), ecs_term_inout(heading) };
+    ecs_system_init(world, &(EcsSystemDesc){
+        .terms = steer_terms,
+        .term_count = 2,
+        .callback = BenchBoidSteer,
+        .name = "BenchBoidSteer",
+    });
+    EcsTerm move_terms[] = { ecs_term_inout(position), ecs_term_in(heading) };
+    ecs_system_init(world, &(EcsSystemDesc){
+        .terms = move_terms,
+        .term_count = 2,
+        .callback = BenchBoidMove,
+        .name = "BenchBoidMove",
+    });
+
+    return world;
+}
+
+void bench_ecs_boids(void) {
+    ThreadContext *tctx = tctx_current();
+
+    if (is_main_thread()) {
+        g_bench_boid_worlds[0] = bench_boid_world_make(bench_arena(), 0);
+        g_bench_boid_worlds[1] = bench_boid_world_make(bench_arena(), BENCH_BOID_CHUNK_SIZE);
+    }
+    lane_sync();
+
+    const char *names[2] = { "boids_even_rows", "boids_chunked_16k" };
+    for (i32 w = 0; w < 2; w++) {
+        EcsWorld *world = g_bench_boid_worlds[w];
+        BenchSamples samples = {0};
+        if (is_main_thread()) {
+            bench_lane_busy_reset();
+            samples = bench_samples_make(bench_arena(), BENCH_BOID_ROUNDS);
+        }
+
+        for (i32 round = 0; round < BENCH_BOID_ROUNDS; round++) {
+            lane_sync();
+            u64 start = os_time_now();
+            ecs_progress(world, 0.016f);
+            if (is_main_thread()) {
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start));
+            }
+        }
+
+        if (is_main_thread()) {
+            bench_report_lanes(names[w], &samples);
+        }
+    }
+
+    if (is_main_thread()) {
+        LOG_INFO("boids: % entities in % tables, % lanes",
+                 FMT_UINT(BENCH_BOID_BIG * BENCH_BOID_BIG_FLOCKS + BENCH_BOID_SMALL * 6),
+                 FMT_UINT(BENCH_BOID_BIG_FLOCKS + 6), FMT_UINT(tctx->thread_count));
+    }
+}
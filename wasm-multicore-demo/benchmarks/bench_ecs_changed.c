@@ -0,0 +1,95 @@
+typedef struct { f32 value[16]; } BenchChangedTransform;
+
+#define BENCH_CHANGED_STATIC 100000
+#define BENCH_CHANGED_DYNAMIC 1000
+#define BENCH_CHANGED_ROUNDS 200
+
+// instance buffer slot of each table's first row, by table id
+global i32 g_bench_changed_base[64];
+
+internal void bench_changed_move(EcsQuery *query) {
+    EcsIter it = ecs_query_iter(query);
+    while (ecs_iter_next(&it)) {
+        BenchChangedTransform *t = ecs_field(&it, BenchChangedTransform, 0);
+        for (i32 i = 0; i < it.count; i++) {
+            t[i].value[12] += 0.01f;
+        }
+        ecs_iter_mark_dirty(&it, 0);
+    }
+}
+
+// copies what the query yields into the instance buffer, returns the rows copied
+internal i32 bench_changed_upload(EcsQuery *query, BenchChangedTransform *instances) {
+    i32 rows = 0;
+    EcsIter it = ecs_query_iter(query);
+    while (ecs_iter_next(&it)) {
+        BenchChangedTransform *t = ecs_field(&it, BenchChangedTransform, 0);
+        memcpy(instances + g_bench_changed_base[it.table->id] + it.offset, t, sizeof(BenchChangedTransform) * it.count);
+        rows += it.count;
+    }
+    return rows;
+}
+
+// a mostly static scene: per frame a few movers change and the renderer mirrors every transform
+void bench_ecs_changed(void) {
+    ArenaAllocator *arena = bench_arena();
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+    EcsEntity transform = ecs_component_register(world, sizeof(BenchChangedTransform), _Alignof(BenchChangedTransform), "BenchChangedTransform");
+    EcsEntity dynamic = ecs_component_register(world, 1, 1, "BenchChangedDynamic");
+
+    EcsEntity static_ids[] = { transform };
+    ecs_bulk_new(world, &(EcsBulkDesc){ .ids = static_ids, .id_count = 1, .count = BENCH_CHANGED_STATIC });
+    EcsEntity dynamic_ids[] = { transform, dynamic };
+    ecs_bulk_new(world, &(EcsBulkDesc){ .ids = dynamic_ids, .id_count = 2, .count = BENCH_CHANGED_DYNAMIC });
+
+    EcsQuery move_query;
+    EcsTerm move_terms[] = { ecs_term_inout(transform), ecs_term_none(dynamic) };
+    ecs_query_init_terms(&move_query, world, move_terms, 2);
+    ecs_query_cache_init(&move_query);
+
+    EcsQuery full_query;
+    EcsTerm full_terms[] = { ecs_term_in(transform) };
+    ecs_query_init_terms(&full_query, world, full_terms, 1);
+    ecs_query_cache_init(&full_query);
+
+    EcsQuery changed_query;
+    EcsTerm changed_terms[] = { ecs_term_changed(transform) };
+    ecs_query_init_terms(&changed_query, world, changed_terms, 1);
+    ecs_query_cache_init(&changed_query);
+
+    i32 total = 0;
+    EcsIter it = ecs_query_iter(&full_query);
+    while (ecs_iter_next(&it)) {
+        debug_assert(it.table->id < ARRAY_SIZE(g_bench_changed_base));
+        g_bench_changed_base[it.table->id] = total;
+        total += it.count;
+    }
+    BenchChangedTransform *instances = ARENA_ALLOC_ARRAY(arena, BenchChangedTransform, total);
+
+    BenchSamples full_samples = bench_samples_make(arena, BENCH_CHANGED_ROUNDS);
+    BenchSamples changed_samples = bench_samples_make(arena, BENCH_CHANGED_ROUNDS);
+    // the first changed upload copies everything once
+    bench_changed_upload(&changed_query, instances);
+
+    i32 changed_rows = 0;
+    for (i32 round = 0; round < BENCH_CHANGED_ROUNDS; round++) {
+        bench_changed_move(&move_query);
+
+        u64 start = os_time_now();
+        i32 rows = bench_changed_upload(&full_query, instances);
+        bench_samples_push(&full_samples, os_time_diff(os_time_now(), start));
+        debug_assert(rows == total);
+        UNUSED(rows);
+
+        start = os_time_now();
+        changed_rows = bench_changed_upload(&changed_query, instances);
+        bench_samples_push(&changed_samples, os_time_diff(os_time_now(), start));
+    }
+
+    bench_report("upload_all_101k", &full_samples);
+    bench_report("upload_changed_101k", &changed_samples);
+    LOG_INFO("changed upload: % of % rows per frame", FMT_INT(changed_rows), FMT_INT(total));
+}
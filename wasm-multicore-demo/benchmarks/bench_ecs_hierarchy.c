@@ -0,0 +1,97 @@
+#define BENCH_HIER_NODES 100000
+#define BENCH_HIER_FANOUT 8
+#define BENCH_HIER_ROUNDS 50
+
+global EcsWorld *g_bench_hier_world;
+global EcsEntity *g_bench_hier_nodes;
+
+// first child / next sibling links for the recursive baseline
+typedef struct {
+    i32 first_child;
+    i32 next_sibling;
+} BenchHierLinks;
+
+global BenchHierLinks *g_bench_hier_links;
+
+// what hierarchies do outside the ecs today: depth first, one record lookup per node
+internal void bench_hier_walk_recursive(EcsWorld *world, i32 node, mat4 parent_world) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    EcsEntity e = g_bench_hier_nodes[node];
+    EcsLocalTransform *local = (EcsLocalTransform *)ecs_get(world, e, hierarchy->local_transform);
+    EcsWorldTransform *out = (EcsWorldTransform *)ecs_get(world, e, hierarchy->world_transform);
+    glm_mat4_mul(parent_world, local->value, out->value);
+
+    for (i32 c = g_bench_hier_links[node].first_child; c >= 0; c = g_bench_hier_links[c].next_sibling) {
+        bench_hier_walk_recursive(world, c, out->value);
+    }
+}
+
+void bench_ecs_hierarchy(void) {
+    ThreadContext *tctx = tctx_current();
+
+    if (is_main_thread()) {
+        ArenaAllocator *arena = bench_arena();
+        EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+        ecs_world_init(world, arena);
+        ecs_store_init(world);
+        EcsHierarchy *hierarchy = ecs_hierarchy_init(world);
+
+        g_bench_hier_nodes = ARENA_ALLOC_ARRAY(arena, EcsEntity, BENCH_HIER_NODES);
+        g_bench_hier_links = ARENA_ALLOC_ARRAY(arena, BenchHierLinks, BENCH_HIER_NODES);
+
+        // spawned in bulk so children don't end up in parent order, then linked level by level
+        EcsEntity ids[] = { hierarchy->local_transform, hierarchy->world_transform };
+        ecs_bulk_new(world, &(EcsBulkDesc){
+            .ids = ids,
+            .id_count = 2,
+            .count = BENCH_HIER_NODES,
+            .entities = g_bench_hier_nodes,
+        });
+
+        for (i32 i = 0; i < BENCH_HIER_NODES; i++) {
+            EcsLocalTransform *local = (EcsLocalTransform *)ecs_get(world, g_bench_hier_nodes[i], hierarchy->local_transform);
+            glm_translate_make(local->value, (vec3){ 1.0f, (f32)(i % 7), 0.0f });
+            g_bench_hier_links[i] = (BenchHierLinks){ -1, -1 };
+        }
+        for (i32 i = BENCH_HIER_NODES - 1; i > 0; i--) {
+            i32 parent = (i - 1) / BENCH_HIER_FANOUT;
+            g_bench_hier_links[i].next_sibling = g_bench_hier_links[parent].first_child;
+            g_bench_hier_links[parent].first_child = i;
+        }
+        for (i32 i = 1; i < BENCH_HIER_NODES; i++) {
+            ecs_child_of(world, g_bench_hier_nodes[i], g_bench_hier_nodes[(i - 1) / BENCH_HIER_FANOUT]);
+        }
+
+        g_bench_hier_world = world;
+    }
+    lane_sync();
+
+    EcsWorld *world = g_bench_hier_world;
+    BenchSamples propagate_samples = {0};
+    if (is_main_thread()) {
+        propagate_samples = bench_samples_make(bench_arena(), BENCH_HIER_ROUNDS);
+    }
+
+    for (i32 round = 0; round < BENCH_HIER_ROUNDS; round++) {
+        lane_sync();
+        u64 start = os_time_now();
+        ecs_transform_propagate(world);
+        if (is_main_thread()) {
+            bench_samples_push(&propagate_samples, os_time_diff(os_time_now(), start));
+        }
+    }
+
+    if (is_main_thread()) {
+        BenchSamples recursive_samples = bench_samples_make(bench_arena(), BENCH_HIER_ROUNDS);
+        for (i32 round = 0; round < BENCH_HIER_ROUNDS; round++) {
+            u64 start = os_time_now();
+            bench_hier_walk_recursive(world, 0, GLM_MAT4_IDENTITY);
+            bench_samples_push(&recursive_samples, os_time_diff(os_time_now(), start));
+        }
+
+        bench_report("transform_propagate_100k", &propagate_samples);
+        bench_report("transform_recursive_100k", &recursive_samples);
+        LOG_INFO("hierarchy: % levels, % lanes", FMT_UINT(world->hierarchy->max_depth + 1),
+                 FMT_UINT(tctx->thread_count));
+    }
+}
@@ -0,0 +1,71 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchQueryPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchQueryVelocity;
+
+#define BENCH_QUERY_TABLES 512
+#define BENCH_QUERY_ROWS_PER_TABLE 16
+#define BENCH_QUERY_ROUNDS 200
+
+internal f32 bench_ecs_query_walk(EcsQuery *query) {
+    f32 sum = 0.0f;
+    EcsIter it = ecs_query_iter(query);
+    while (ecs_iter_next(&it)) {
+        BenchQueryPosition *p = ecs_field(&it, BenchQueryPosition, 0);
+        BenchQueryVelocity *v = ecs_field(&it, BenchQueryVelocity, 1);
+        for (i32 i = 0; i < it.count; i++) {
+            p[i].x += v[i].x;
+            sum += p[i].x;
+        }
+    }
+    return sum;
+}
+
+void bench_ecs_query(void) {
+    ArenaAllocator *arena = bench_arena();
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+
+    ECS_COMPONENT(world, BenchQueryPosition);
+    ECS_COMPONENT(world, BenchQueryVelocity);
+
+    // one hi-id tag per table: hundreds of small archetypes that all match
+    EcsEntity ids[3] = { ecs_id(BenchQueryPosition), ecs_id(BenchQueryVelocity), 0 };
+    for (i32 t = 0; t < BENCH_QUERY_TABLES; t++) {
+        ids[2] = ecs_entity_new(world);
+        ecs_bulk_new(world, &(EcsBulkDesc){ .ids = ids, .id_count = 3, .count = BENCH_QUERY_ROWS_PER_TABLE });
+    }
+
+    // half of the matched tables are empty, the cached walk never visits them
+    for (i32 t = 0; t < BENCH_QUERY_TABLES; t++) {
+        ids[2] = ecs_entity_new(world);
+        EcsType type = { .array = ids, .count = 3 };
+        ecs_table_find_or_create(world, &type);
+    }
+
+    EcsEntity terms[] = { ecs_id(BenchQueryPosition), ecs_id(BenchQueryVelocity) };
+    EcsQuery uncached;
+    ecs_query_init(&uncached, world, terms, 2);
+    EcsQuery cached;
+    ecs_query_init(&cached, world, terms, 2);
+    ecs_query_cache_init(&cached);
+
+    BenchSamples uncached_samples = bench_samples_make(arena, BENCH_QUERY_ROUNDS);
+    BenchSamples cached_samples = bench_samples_make(arena, BENCH_QUERY_ROUNDS);
+    f32 sink = 0.0f;
+
+    for (i32 round = 0; round < BENCH_QUERY_ROUNDS; round++) {
+        u64 start = os_time_now();
+        sink += bench_ecs_query_walk(&uncached);
+        bench_samples_push(&uncached_samples, os_time_diff(os_time_now(), start) / BENCH_QUERY_TABLES);
+
+        start = os_time_now();
+        sink += bench_ecs_query_walk(&cached);
+        bench_samples_push(&cached_samples, os_time_diff(os_time_now(), start) / BENCH_QUERY_TABLES);
+    }
+
+    bench_report("query_walk_uncached_512_tables", &uncached_samples);
+    bench_report("query_walk_cached_512_tables", &cached_samples);
+    LOG_INFO("query cache: % matches, % active (sink %)", FMT_UINT(cached.cache.match_count),
+             FMT_UINT(cached.cache.active_count), FMT_UINT((u64)sink));
+}
@@ -0,0 +1,84 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchSnapPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchSnapVelocity;
+typedef struct { u32 index; } BenchSnapIndex;
+
+#define BENCH_SNAP_ENTITIES 1000000
+#define BENCH_SNAP_TABLES 4
+#define BENCH_SNAP_ROUNDS 8
+#define BENCH_SNAP_WORLD_ARENA MB(256)
+
+// returns the first id, the other two follow it
+internal EcsEntity bench_snap_register(EcsWorld *world) {
+    EcsEntity first = ecs_component_register(world, sizeof(BenchSnapPosition), _Alignof(BenchSnapPosition), "BenchSnapPosition");
+    ecs_component_register(world, sizeof(BenchSnapVelocity), _Alignof(BenchSnapVelocity), "BenchSnapVelocity");
+    ecs_component_register(world, sizeof(BenchSnapIndex), _Alignof(BenchSnapIndex), "BenchSnapIndex");
+    return first;
+}
+
+void bench_ecs_snapshot(void) {
+    ArenaAllocator *arena = bench_arena();
+    const i32 per_table = BENCH_SNAP_ENTITIES / BENCH_SNAP_TABLES;
+
+    BenchSnapPosition *positions = ARENA_ALLOC_ARRAY(arena, BenchSnapPosition, per_table);
+    BenchSnapVelocity *velocities = ARENA_ALLOC_ARRAY(arena, BenchSnapVelocity, per_table);
+    BenchSnapIndex *indices = ARENA_ALLOC_ARRAY(arena, BenchSnapIndex, per_table);
+    EcsEntity *entities = ARENA_ALLOC_ARRAY(arena, EcsEntity, per_table);
+    for (i32 i = 0; i < per_table; i++) {
+        positions[i] = (BenchSnapPosition){ (f32)i, 0.0f, 0.0f };
+        velocities[i] = (BenchSnapVelocity){ 0.0f, 1.0f, 0.0f };
+        indices[i] = (BenchSnapIndex){ (u32)i };
+    }
+
+    // worlds are rebuilt every round, each in a scratch arena that is reset in between
+    u8 *world_memory = ARENA_ALLOC_ARRAY(arena, u8, BENCH_SNAP_WORLD_ARENA);
+    ArenaAllocator world_arena = arena_from_buffer(world_memory, BENCH_SNAP_WORLD_ARENA);
+
+    BenchSamples spawn_samples = bench_samples_make(arena, BENCH_SNAP_ROUNDS);
+    BenchSamples snapshot_samples = bench_samples_make(arena, BENCH_SNAP_ROUNDS);
+    BenchSamples restore_samples = bench_samples_make(arena, BENCH_SNAP_ROUNDS);
+    EcsSnapshotHeader *snapshot = NULL;
+    u64 snapshot_size = 0;
+
+    for (i32 round = 0; round < BENCH_SNAP_ROUNDS; round++) {
+        arena_reset(&world_arena);
+        EcsWorld *world = ARENA_ALLOC(&world_arena, EcsWorld);
+        ecs_world_init(world, &world_arena);
+        ecs_store_init(world);
+        EcsEntity first = bench_snap_register(world);
+
+        // the gameplay path: bulk spawn with initial values, one hi-id tag per table
+        u64 start = os_time_now();
+        EcsEntity ids[4] = { first, first + 1, first + 2, 0 };
+        const void *data[4] = { positions, velocities, indices, NULL };
+        for (i32 t = 0; t < BENCH_SNAP_TABLES; t++) {
+            ids[3] = ecs_entity_new(world);
+            ecs_bulk_new(world, &(EcsBulkDesc){ .ids = ids, .id_count = 4, .data = data,
+                                           .count = per_table, .entities = entities });
+        }
+        bench_samples_push(&spawn_samples, os_time_diff(os_time_now(), start));
+
+        start = os_time_now();
+        snapshot = ecs_world_snapshot(world, arena);
+        bench_samples_push(&snapshot_samples, os_time_diff(os_time_now(), start));
+        snapshot_size = snapshot->size;
+    }
+
+    for (i32 round = 0; round < BENCH_SNAP_ROUNDS; round++) {
+        arena_reset(&world_arena);
+        EcsWorld *world = ARENA_ALLOC(&world_arena, EcsWorld);
+        ecs_world_init(world, &world_arena);
+        ecs_store_init(world);
+        bench_snap_register(world);
+
+        u64 start = os_time_now();
+        b32 ok = ecs_world_restore(world, snapshot);
+        bench_samples_push(&restore_samples, os_time_diff(os_time_now(), start));
+        debug_assert(ok && ecs_entity_count(world) >= BENCH_SNAP_ENTITIES);
+        UNUSED(ok);
+    }
+
+    bench_report("world_spawn_1m", &spawn_samples);
+    bench_report("world_snapshot_1m", &snapshot_samples);
+    bench_report("world_restore_1m", &restore_samples);
+    LOG_INFO("snapshot: % kb for % entities", FMT_UINT(snapshot_size >> 10), FMT_UINT(BENCH_SNAP_ENTITIES));
+}
@@ -0,0 +1,77 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchSpawnPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchSpawnHeading;
+typedef struct { u32 index; } BenchSpawnIndex;
+
+#define BENCH_SPAWN_ENTITIES 100000
+#define BENCH_SPAWN_ROUNDS 10
+
+void bench_ecs_spawn(void) {
+    ArenaAllocator *arena = bench_arena();
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+
+    ECS_COMPONENT(world, BenchSpawnPosition);
+    ECS_COMPONENT(world, BenchSpawnHeading);
+    ECS_COMPONENT(world, BenchSpawnIndex);
+
+    BenchSpawnPosition *positions = ARENA_ALLOC_ARRAY(arena, BenchSpawnPosition, BENCH_SPAWN_ENTITIES);
+    BenchSpawnHeading *headings = ARENA_ALLOC_ARRAY(arena, BenchSpawnHeading, BENCH_SPAWN_ENTITIES);
+    BenchSpawnIndex *indices = ARENA_ALLOC_ARRAY(arena, BenchSpawnIndex, BENCH_SPAWN_ENTITIES);
+    EcsEntity *entities = ARENA_ALLOC_ARRAY(arena, EcsEntity, BENCH_SPAWN_ENTITIES);
+    for (u32 i = 0; i < BENCH_SPAWN_ENTITIES; i++) {
+        positions[i] = (BenchSpawnPosition){ (f32)i, 0.0f, 0.0f };
+        headings[i] = (BenchSpawnHeading){ 0.0f, 1.0f, 0.0f };
+        indices[i] = (BenchSpawnIndex){ i };
+    }
+
+    BenchSamples spawn_single = bench_samples_make(arena, BENCH_SPAWN_ROUNDS);
+    BenchSamples despawn_single = bench_samples_make(arena, BENCH_SPAWN_ROUNDS);
+    BenchSamples spawn_bulk = bench_samples_make(arena, BENCH_SPAWN_ROUNDS);
+    BenchSamples despawn_bulk = bench_samples_make(arena, BENCH_SPAWN_ROUNDS);
+
+    for (i32 round = 0; round < BENCH_SPAWN_ROUNDS; round++) {
+        u64 start = os_time_now();
+        for (u32 i = 0; i < BENCH_SPAWN_ENTITIES; i++) {
+            EcsEntity e = ecs_entity_new(world);
+            ecs_set_ptr(world, e, ecs_id(BenchSpawnPosition), &positions[i]);
+            ecs_set_ptr(world, e, ecs_id(BenchSpawnHeading), &headings[i]);
+            ecs_set_ptr(world, e, ecs_id(BenchSpawnIndex), &indices[i]);
+            entities[i] = e;
+        }
+        bench_samples_push(&spawn_single, os_time_diff(os_time_now(), start) / BENCH_SPAWN_ENTITIES);
+
+        start = os_time_now();
+        for (u32 i = 0; i < BENCH_SPAWN_ENTITIES; i++) {
+            ecs_entity_delete(world, entities[i]);
+        }
+        bench_samples_push(&despawn_single, os_time_diff(os_time_now(), start) / BENCH_SPAWN_ENTITIES);
+    }
+
+    EcsEntity ids[] = { ecs_id(BenchSpawnPosition), ecs_id(BenchSpawnHeading), ecs_id(BenchSpawnIndex) };
+    const void *data[] = { positions, headings, indices };
+
+    for (i32 round = 0; round < BENCH_SPAWN_ROUNDS; round++) {
+        u64 start = os_time_now();
+        ecs_bulk_new(world, &(EcsBulkDesc){
+            .ids = ids,
+            .id_count = 3,
+            .data = data,
+            .count = BENCH_SPAWN_ENTITIES,
+            .entities = entities,
+        });
+        bench_samples_push(&spawn_bulk, os_time_diff(os_time_now(), start) / BENCH_SPAWN_ENTITIES);
+
+        start = os_time_now();
+        ecs_bulk_delete(world, entities, BENCH_SPAWN_ENTITIES);
+        bench_samples_push(&despawn_bulk, os_time_diff(os_time_now(), start) / BENCH_SPAWN_ENTITIES);
+
+        arena_reset(&tctx_current()->temp_arena);
+    }
+
+    bench_report("spawn_single_100k", &spawn_single);
+    bench_report("despawn_single_100k", &despawn_single);
+    bench_report("spawn_bulk_100k", &spawn_bulk);
+    bench_report("despawn_bulk_100k", &despawn_bulk);
+}
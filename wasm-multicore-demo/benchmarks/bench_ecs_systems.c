@@ -0,0 +1,115 @@
+typedef struct { f32 x; f32 y; f32 z; } BenchSysPosition;
+typedef struct { f32 x; f32 y; f32 z; } BenchSysVelocity;
+
+#define BENCH_SYS_GROUPS 8
+#define BENCH_SYS_PASSES 4
+#define BENCH_SYS_PER_GROUP 8192
+#define BENCH_SYS_ROUNDS 100
+
+global EcsWorld *g_bench_sys_worlds[3];
+
+internal void BenchSysIntegrate(EcsIter *it) {
+    u64 start = os_time_now();
+    BenchSysPosition *p = ecs_field(it, BenchSysPosition, 0);
+    BenchSysVelocity *v = ecs_field(it, BenchSysVelocity, 1);
+    for (i32 i = 0; i < it->count; i++) {
+        p[i].x += v[i].x * it->delta_time;
+        p[i].y += v[i].y * it->delta_time;
+        p[i].z += v[i].z * it->delta_time;
+    }
+    bench_lane_busy_add(os_time_diff(os_time_now(), start));
+}
+
+// BENCH_SYS_PASSES rounds of one system per group, every system writes Position on its own group.
+// serial chains the systems like a scheduler that only compares component ids would
+internal EcsWorld* bench_sys_world_make(ArenaAllocator *arena, b32 serial) {
+    local_persist const char *tag_names[BENCH_SYS_GROUPS] = {
+        "BenchSysTag0", "BenchSysTag1", "BenchSysTag2", "BenchSysTag3",
+        "BenchSysTag4", "BenchSysTag5", "BenchSysTag6", "BenchSysTag7",
+    };
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+    EcsEntity position = ecs_component_register(world, sizeof(BenchSysPosition), _Alignof(BenchSysPosition), "BenchSysPosition");
+    EcsEntity velocity = ecs_component_register(world, sizeof(BenchSysVelocity), _Alignof(BenchSysVelocity), "BenchSysVelocity");
+
+    EcsEntity tags[BENCH_SYS_GROUPS];
+    for (i32 g = 0; g < BENCH_SYS_GROUPS; g++) {
+        tags[g] = ecs_component_register(world, 1, 1, tag_names[g]);
+        EcsEntity ids[] = { position, velocity, tags[g] };
+        ecs_bulk_new(world, &(EcsBulkDesc){ .ids = ids, .id_count = 3, .count = BENCH_SYS_PER_GROUP });
+    }
+
+    EcsSystem *prev = NULL;
+    for (i32 pass = 0; pass < BENCH_SYS_PASSES; pass++) {
+        for (i32 g = 0; g < BENCH_SYS_GROUPS; g++) {
+            EcsTerm terms[] = { ecs_term_inout(position), ecs_term_in(velocity), ecs_term_none(tags[g]) };
+            EcsSystem *sys = ecs_system_init(world, &(EcsSystemDesc){
+                .terms = terms,
+                .term_count = 3,
+                .callback = BenchSysIntegrate,
+                .name = "BenchSysIntegrate",
+            });
+            if (serial && prev) {
+                ecs_system_depends_on(sys, prev);
+            }
+            prev = sys;
+        }
+    }
+
+    return world;
+}
+
+void bench_ecs_systems(void) {
+    ThreadContext *tctx = tctx_current();
+
+    if (is_main_thread()) {
+        g_bench_sys_worlds[0] = bench_sys_world_make(bench_arena(), false);
+        g_bench_sys_worlds[1] = bench_sys_world_make(bench_arena(), true);
+        // what recording per system timings costs
+        g_bench_sys_worlds[2] = bench_sys_world_make(bench_arena(), false);
+        ecs_profile_enable(g_bench_sys_worlds[2], BENCH_SYS_ROUNDS);
+    }
+    lane_sync();
+
+    const char *names[3] = { "progress_table_graph", "progress_serial_chain", "progress_table_graph_profiled" };
+    for (i32 w = 0; w < 3; w++) {
+        EcsWorld *world = g_bench_sys_worlds[w];
+        BenchSamples samples = {0};
+        if (is_main_thread()) {
+            bench_lane_busy_reset();
+            samples = bench_samples_make(bench_arena(), BENCH_SYS_ROUNDS);
+        }
+
+        for (i32 round = 0; round < BENCH_SYS_ROUNDS; round++) {
+            lane_sync();
+            u64 start = os_time_now();
+            ecs_progress(world, 0.016f);
+            if (is_main_thread()) {
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start));
+            }
+        }
+
+        if (is_main_thread()) {
+            bench_report_lanes(names[w], &samples);
+            LOG_INFO("%: % systems, critical path %, % lanes", FMT_STR(names[w]), FMT_INT(world->system_count),
+                     FMT_INT(ecs_system_graph_critical_path(world)), FMT_UINT(tctx->thread_count));
+        }
+    }
+
+    if (is_main_thread()) {
+        EcsProfileCapture capture = ecs_profile_capture(g_bench_sys_worlds[2], BENCH_SYS_ROUNDS, bench_arena());
+        for (i32 l = 0; l < capture.lane_count; l++) {
+            u64 wall_ns = 0;
+            u64 wait_ns = 0;
+            for (i32 f = 0; f < capture.frame_count; f++) {
+                wall_ns += capture.frames[l * capture.frame_count + f].wall_ns;
+                wait_ns += capture.frames[l * capture.frame_count + f].wait_ns;
+            }
+            LOG_INFO("progress_table_graph_profiled lane %: % frames, %us per frame, %us at barriers", FMT_INT(l),
+                     FMT_INT(capture.frame_count), FMT_UINT((u32)(wall_ns / MAX(capture.frame_count, 1) / 1000)),
+                     FMT_UINT((u32)(wait_ns / MAX(capture.frame_count, 1) / 1000)));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#define BENCH_TABLE_MAP_COMPONENTS 17
+#define BENCH_TABLE_MAP_ARCHETYPES 100000
+// timer resolution in the browser is coarse, so time batches and record ns per op
+#define BENCH_TABLE_MAP_BATCH 1000
+
+internal EcsType *bench_table_map_make_types(ArenaAllocator *arena, EcsEntity *components, i32 type_count) {
+    EcsType *types = ARENA_ALLOC_ARRAY(arena, EcsType, type_count);
+
+    // archetype i has the components of the set bits of i + 1, ids ascending so types stay sorted
+    for (i32 i = 0; i < type_count; i++) {
+        u32 bits = (u32)(i + 1);
+        EcsType *type = &types[i];
+        type->array = ARENA_ALLOC_ARRAY(arena, EcsEntity, BENCH_TABLE_MAP_COMPONENTS);
+        type->count = 0;
+        for (i32 c = 0; c < BENCH_TABLE_MAP_COMPONENTS; c++) {
+            if (bits & (1u << c)) {
+                type->array[type->count++] = components[c];
+            }
+        }
+    }
+
+    return types;
+}
+
+void bench_ecs_table_map(void) {
+    ArenaAllocator *arena = bench_arena();
+
+    EcsWorld *world = ARENA_ALLOC(arena, EcsWorld);
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+
+    EcsEntity components[BENCH_TABLE_MAP_COMPONENTS + 1];
+    for (i32 i = 0; i < BENCH_TABLE_MAP_COMPONENTS + 1; i++) {
+        components[i] = ecs_component_register(world, sizeof(f32), _Alignof(f32), "BenchComponent");
+    }
+
+    EcsType *types = bench_table_map_make_types(arena, components, BENCH_TABLE_MAP_ARCHETYPES);
+    u32 batch_count = BENCH_TABLE_MAP_ARCHETYPES / BENCH_TABLE_MAP_BATCH;
+
+    // full archetype creation through the store (map lookup miss + table init + map insert)
+    BenchSamples create_samples = bench_samples_make(arena, batch_count);
+    EcsTable **tables = ARENA_ALLOC_ARRAY(arena, EcsTable*, BENCH_TABLE_MAP_ARCHETYPES);
+    for (u32 b = 0; b < batch_count; b++) {
+        u64 start = os_time_now();
+        for (u32 i = b * BENCH_TABLE_MAP_BATCH; i < (b + 1) * BENCH_TABLE_MAP_BATCH; i++) {
+            tables[i] = ecs_table_find_or_create(world, &types[i]);
+        }
+        bench_samples_push(&create_samples, os_time_diff(os_time_now(), start) / BENCH_TABLE_MAP_BATCH);
+    }
+    bench_report("table_create_100k", &create_samples);
+
+    // raw map insert, includes the rehashes on the way up to 100k
+    EcsTableMap map;
+    ecs_table_map_init(&map, &world->allocator);
+    BenchSamples insert_samples = bench_samples_make(arena, batch_count);
+    for (u32 b = 0; b < batch_count; b++) {
+        u64 start = os_time_now();
+        for (u32 i = b * BENCH_TABLE_MAP_BATCH; i < (b + 1) * BENCH_TABLE_MAP_BATCH; i++) {
+            ecs_table_map_set(&map, &tables[i]->type, tables[i]);
+        }
+        bench_samples_push(&insert_samples, os_time_diff(os_time_now(), start) / BENCH_TABLE_MAP_BATCH);
+    }
+    bench_report("table_map_insert_100k", &insert_samples);
+
+    u32 *order = ARENA_ALLOC_ARRAY(arena, u32, BENCH_TABLE_MAP_ARCHETYPES);
+    Xorshift32_State rng;
+    xorshift32_seed(&rng, 1234);
+    for (u32 i = 0; i < BENCH_TABLE_MAP_ARCHETYPES; i++) {
+        order[i] = xorshift32_next(&rng) % BENCH_TABLE_MAP_ARCHETYPES;
+    }
+
+    BenchSamples hit_samples = bench_samples_make(arena, batch_count);
+    u32 found = 0;
+    for (u32 b = 0; b < batch_count; b++) {
+        u64 start = os_time_now();
+        for (u32 i = b * BENCH_TABLE_MAP_BATCH; i < (b + 1) * BENCH_TABLE_MAP_BATCH; i++) {
+            found += ecs_table_map_get(world->store.table_map, &types[order[i]]) != NULL;
+        }
+        bench_samples_push(&hit_samples, os_time_diff(os_time_now(), start) / BENCH_TABLE_MAP_BATCH);
+    }
+    bench_report("table_map_lookup_hit_100k", &hit_samples);
+    assert(found == BENCH_TABLE_MAP_ARCHETYPES);
+
+    // same types plus a component that no archetype has
+    for (u32 i = 0; i < BENCH_TABLE_MAP_ARCHETYPES; i++) {
+        EcsType *type = &types[i];
+        type->array[type->count++] = components[BENCH_TABLE_MAP_COMPONENTS];
+    }
+
+    BenchSamples miss_samples = bench_samples_make(arena, batch_count);
+    found = 0;
+    for (u32 b = 0; b < batch_count; b++) {
+        u64 start = os_time_now();
+        for (u32 i = b * BENCH_TABLE_MAP_BATCH; i < (b + 1) * BENCH_TABLE_MAP_BATCH; i++) {
+            found += ecs_table_map_get(world->store.table_map, &types[order[i]]) != NULL;
+        }
+        bench_samples_push(&miss_samples, os_time_diff(os_time_now(), start) / BENCH_TABLE_MAP_BATCH);
+    }
+    bench_report("table_map_lookup_miss_100k", &miss_samples);
+    assert(found == 0);
+
+    LOG_INFO("table map: % archetypes, capacity %", FMT_UINT(world->store.table_map->count),
+             FMT_UINT(world->store.table_map->capacity));
+}
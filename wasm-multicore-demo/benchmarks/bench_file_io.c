@@ -0,0 +1,110 @@
+#define BENCH_FILE_IO_ASSETS 10000
+#define BENCH_FILE_IO_MIN_SIZE 256
+#define BENCH_FILE_IO_MAX_SIZE 4096
+#define BENCH_FILE_IO_ROUNDS 5
+#define BENCH_FILE_IO_DIR "/tmp/hz_bench_file_io"
+#define BENCH_FILE_IO_PATH_SIZE 64
+
+// one round starts every read up front, then polls the pending list like
+// asset_system_update does each frame and copies finished files out. time to
+// last byte runs from the first start to the last copy
+internal u64 bench_file_io_round(char **paths, OsFileOp **ops, u32 *pending, u32 *errors) {
+    Allocator allocator = make_arena_allocator(bench_arena());
+
+    u64 start = os_time_now();
+    for (u32 i = 0; i < BENCH_FILE_IO_ASSETS; i++) {
+        ops[i] = os_start_read_file(paths[i]);
+        pending[i] = i;
+    }
+
+    u32 pending_count = BENCH_FILE_IO_ASSETS;
+    while (pending_count > 0) {
+        u32 frame_start_count = pending_count;
+        for (i32 i = (i32)pending_count - 1; i >= 0; i--) {
+            OsFileOp *op = ops[pending[i]];
+            OsFileReadState state = os_check_read_file(op);
+            if (state == OS_FILE_READ_STATE_IN_PROGRESS) {
+                continue;
+            }
+            PlatformFileData data = {0};
+            if (state == OS_FILE_READ_STATE_ERROR || !os_get_file_data(op, &data, &allocator)) {
+                os_release_file_op(op);
+                (*errors)++;
+            }
+            pending[i] = pending[--pending_count];
+        }
+        // a frame with nothing new, leave the core to the kernel's io workers
+        if (pending_count == frame_start_count) {
+            os_sleep(10);
+        }
+    }
+    return os_time_diff(os_time_now(), start);
+}
+
+// BENCH_FILE_IO_ASSETS small files of random size, read back with each async backend
+// from a warm page cache. syscalls are the ones the backend makes for the reads, so
+// the sleeps between polling frames don't count
+void bench_file_io(void) {
+    struct { const char *name; OsLinuxFileIoBackend backend; } runs[] = {
+        { "file_io_uring", OS_LNX_FILE_IO_URING },
+        { "file_io_threads", OS_LNX_FILE_IO_THREADS },
+    };
+
+    os_directory_remove(BENCH_FILE_IO_DIR);
+    if (!os_create_dir(BENCH_FILE_IO_DIR)) {
+        LOG_ERROR("bench_file_io: can't create %", FMT_STR(BENCH_FILE_IO_DIR));
+        return;
+    }
+
+    char **paths = ARENA_ALLOC_ARRAY(bench_arena(), char *, BENCH_FILE_IO_ASSETS);
+    OsFileOp **ops = ARENA_ALLOC_ARRAY(bench_arena(), OsFileOp *, BENCH_FILE_IO_ASSETS);
+    u32 *pending = ARENA_ALLOC_ARRAY(bench_arena(), u32, BENCH_FILE_IO_ASSETS);
+    u8 *contents = ARENA_ALLOC_ARRAY(bench_arena(), u8, BENCH_FILE_IO_MAX_SIZE);
+    UnityRandom rng = unity_random_new(1234);
+    for (u32 i = 0; i < BENCH_FILE_IO_MAX_SIZE; i++) {
+        contents[i] = (u8)unity_random_next(&rng);
+    }
+    u64 total_bytes = 0;
+    for (u32 i = 0; i < BENCH_FILE_IO_ASSETS; i++) {
+        StringBuilder sb;
+        paths[i] = ARENA_ALLOC_ARRAY(bench_arena(), char, BENCH_FILE_IO_PATH_SIZE);
+        sb_init(&sb, paths[i], BENCH_FILE_IO_PATH_SIZE);
+        sb_append_format(&sb, "%/asset_%.bin", FMT_STR(BENCH_FILE_IO_DIR), FMT_UINT(i));
+        u32 size = BENCH_FILE_IO_MIN_SIZE +
+                   unity_random_next(&rng) % (BENCH_FILE_IO_MAX_SIZE - BENCH_FILE_IO_MIN_SIZE + 1);
+        if (!os_write_file(paths[i], contents, size)) {
+            LOG_ERROR("bench_file_io: can't write %", FMT_STR(paths[i]));
+            os_directory_remove(BENCH_FILE_IO_DIR);
+            return;
+        }
+        total_bytes += size;
+    }
+
+    for (u32 r = 0; r < ARRAY_SIZE(runs); r++) {
+        pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+        b32 available = os_lnx_file_io_use(runs[r].backend);
+        pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+        if (!available) {
+            LOG_WARN("bench_file_io: % backend unavailable, skipped", FMT_STR(runs[r].name));
+            continue;
+        }
+
+        BenchSamples samples = bench_samples_make(bench_arena(), BENCH_FILE_IO_ROUNDS);
+        u64 syscalls = 0;
+        u32 errors = 0;
+        for (u32 round = 0; round < BENCH_FILE_IO_ROUNDS; round++) {
+            u64 syscalls_start = ins_atomic_load_acquire64(&os_lnx_state.file_io_syscalls);
+            bench_samples_push(&samples, bench_file_io_round(paths, ops, pending, &errors));
+            syscalls += ins_atomic_load_acquire64(&os_lnx_state.file_io_syscalls) - syscalls_start;
+        }
+
+        bench_report(runs[r].name, &samples);
+        LOG_INFO("[BENCH] % syscalls_per_asset=% errors=%", FMT_STR(runs[r].name),
+                 FMT_FLOAT((f32)syscalls / (f32)(BENCH_FILE_IO_ASSETS * BENCH_FILE_IO_ROUNDS)),
+                 FMT_UINT(errors));
+    }
+
+    os_directory_remove(BENCH_FILE_IO_DIR);
+    LOG_INFO("file io: % assets, % KB total, time to last byte per round",
+             FMT_UINT(BENCH_FILE_IO_ASSETS), FMT_UINT(total_bytes / 1024));
+}
@@ -0,0 +1,79 @@
+#define BENCH_PFOR_ITEMS 65536
+#define BENCH_PFOR_SPINS 64
+// the crowded first BENCH_PFOR_ITEMS / BENCH_PFOR_HOT_SHARE items cost BENCH_PFOR_HOT_FACTOR times more
+#define BENCH_PFOR_HOT_SHARE 8
+#define BENCH_PFOR_HOT_FACTOR 16
+#define BENCH_PFOR_ROUNDS 50
+
+global u32 *g_bench_pfor_spins;
+global volatile u32 g_bench_pfor_sink;
+
+internal void bench_pfor_work(Range_u64 range, void *user_data) {
+    UNUSED(user_data);
+    u64 start = os_time_now();
+    u32 acc = 0;
+    for (u64 i = range.min; i < range.max; i++) {
+        for (u32 s = 0; s < g_bench_pfor_spins[i]; s++) {
+            acc = acc * 1664525u + 1013904223u;
+        }
+    }
+    g_bench_pfor_sink = acc;
+    bench_lane_busy_add(os_time_diff(os_time_now(), start));
+}
+
+typedef enum {
+    BENCH_PFOR_STATIC,
+    BENCH_PFOR_GUIDED,
+    BENCH_PFOR_GUIDED_COSTS,
+} BenchPforMode;
+
+void bench_lane_parallel_for(void) {
+    if (is_main_thread()) {
+        g_bench_pfor_spins = ARENA_ALLOC_ARRAY(bench_arena(), u32, BENCH_PFOR_ITEMS);
+    }
+    lane_sync();
+
+    struct { const char *name; b32 skewed; BenchPforMode mode; } runs[] = {
+        { "pfor_uniform_static", false, BENCH_PFOR_STATIC },
+        { "pfor_uniform_guided", false, BENCH_PFOR_GUIDED },
+        { "pfor_skewed_static", true, BENCH_PFOR_STATIC },
+        { "pfor_skewed_guided", true, BENCH_PFOR_GUIDED },
+        { "pfor_skewed_guided_costs", true, BENCH_PFOR_GUIDED_COSTS },
+    };
+
+    for (u32 r = 0; r < ARRAY_SIZE(runs); r++) {
+        BenchSamples samples = {0};
+        if (is_main_thread()) {
+            bench_lane_busy_reset();
+            samples = bench_samples_make(bench_arena(), BENCH_PFOR_ROUNDS);
+            for (u32 i = 0; i < BENCH_PFOR_ITEMS; i++) {
+                b32 hot = runs[r].skewed && i < BENCH_PFOR_ITEMS / BENCH_PFOR_HOT_SHARE;
+                g_bench_pfor_spins[i] = hot ? BENCH_PFOR_SPINS * BENCH_PFOR_HOT_FACTOR : BENCH_PFOR_SPINS;
+            }
+        }
+        lane_sync();
+
+        LaneForDesc desc = { .count = BENCH_PFOR_ITEMS, .min_grain = 16 };
+        if (runs[r].mode == BENCH_PFOR_GUIDED_COSTS) {
+            desc.costs = g_bench_pfor_spins;
+        }
+
+        for (u32 round = 0; round < BENCH_PFOR_ROUNDS; round++) {
+            lane_sync();
+            u64 start = os_time_now();
+            if (runs[r].mode == BENCH_PFOR_STATIC) {
+                bench_pfor_work(lane_range(BENCH_PFOR_ITEMS), NULL);
+                lane_sync();
+            } else {
+                lane_parallel_for(&desc, bench_pfor_work, NULL);
+            }
+            if (is_main_thread()) {
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start));
+            }
+        }
+
+        if (is_main_thread()) {
+            bench_report_lanes(runs[r].name, &samples);
+        }
+    }
+}
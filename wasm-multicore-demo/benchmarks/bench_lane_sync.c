@@ -0,0 +1,92 @@
+#define BENCH_SYNC_ROUNDS 200
+#define BENCH_SYNC_PER_ROUND 100
+
+#if defined(__linux__) && !defined(WASM)
+#include <pthread.h>
+// what lane_sync ran on before the futex barrier
+global pthread_barrier_t g_bench_sync_pthread_barrier;
+#endif
+
+typedef enum {
+    BENCH_SYNC_LANE_SYNC,
+    BENCH_SYNC_LANE_SYNC_U64,
+    // lane_sync_u64 as it was: a sync to publish the value, one to read it
+    BENCH_SYNC_TWO_BARRIER_U64,
+    BENCH_SYNC_PTHREAD_BARRIER,
+} BenchSyncKind;
+
+// one sample is BENCH_SYNC_PER_ROUND back to back round trips, reported per round trip
+void bench_lane_sync(void) {
+    ThreadContext *tctx = tctx_current();
+
+    struct { const char *name; BenchSyncKind kind; } runs[] = {
+        { "lane_sync", BENCH_SYNC_LANE_SYNC },
+        { "lane_sync_u64", BENCH_SYNC_LANE_SYNC_U64 },
+        { "lane_sync_u64_two_barriers", BENCH_SYNC_TWO_BARRIER_U64 },
+#if defined(__linux__) && !defined(WASM)
+        { "pthread_barrier", BENCH_SYNC_PTHREAD_BARRIER },
+#endif
+    };
+
+#if defined(__linux__) && !defined(WASM)
+    if (is_main_thread()) {
+        pthread_barrier_init(&g_bench_sync_pthread_barrier, NULL, tctx->thread_count);
+    }
+    lane_sync();
+#endif
+
+    for (u32 r = 0; r < ARRAY_SIZE(runs); r++) {
+        BenchSamples samples = {0};
+        if (is_main_thread()) {
+            samples = bench_samples_make(bench_arena(), BENCH_SYNC_ROUNDS);
+        }
+
+        u64 value = 0;
+        for (u32 round = 0; round < BENCH_SYNC_ROUNDS; round++) {
+            lane_sync();
+            u64 start = os_time_now();
+            for (u32 i = 0; i < BENCH_SYNC_PER_ROUND; i++) {
+                switch (runs[r].kind) {
+                case BENCH_SYNC_LANE_SYNC:
+                    lane_sync();
+                    break;
+                case BENCH_SYNC_LANE_SYNC_U64:
+                    value = i;
+                    lane_sync_u64(0, &value);
+                    break;
+                case BENCH_SYNC_TWO_BARRIER_U64:
+                    if (is_main_thread()) {
+                        *tctx->broadcast_memory = i;
+                    }
+                    lane_sync();
+                    value = *tctx->broadcast_memory;
+                    lane_sync();
+                    break;
+                case BENCH_SYNC_PTHREAD_BARRIER:
+#if defined(__linux__) && !defined(WASM)
+                    pthread_barrier_wait(&g_bench_sync_pthread_barrier);
+#endif
+                    break;
+                }
+                debug_assert(runs[r].kind < BENCH_SYNC_LANE_SYNC_U64 || runs[r].kind > BENCH_SYNC_TWO_BARRIER_U64 || value == i);
+            }
+            if (is_main_thread()) {
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start) / BENCH_SYNC_PER_ROUND);
+            }
+        }
+
+        if (is_main_thread()) {
+            bench_report(runs[r].name, &samples);
+        }
+    }
+
+#if defined(__linux__) && !defined(WASM)
+    lane_sync();
+    if (is_main_thread()) {
+        pthread_barrier_destroy(&g_bench_sync_pthread_barrier);
+    }
+#endif
+    if (is_main_thread()) {
+        LOG_INFO("lane sync round trips: % lanes", FMT_UINT(tctx->thread_count));
+    }
+}
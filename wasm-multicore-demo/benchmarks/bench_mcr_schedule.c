@@ -0,0 +1,107 @@
+#define BENCH_MCR_CHAINS 64
+#define BENCH_MCR_DEPTH 32
+#define BENCH_MCR_SHORT_SPINS 2000
+// one task in BENCH_MCR_LONG_EVERY runs BENCH_MCR_LONG_FACTOR times longer
+#define BENCH_MCR_LONG_EVERY 16
+#define BENCH_MCR_LONG_FACTOR 32
+#define BENCH_MCR_ROUNDS 50
+
+global MCRTaskQueue g_bench_mcr_queue;
+global u32 *g_bench_mcr_spins;
+global u64 *g_bench_mcr_cells;
+global volatile u32 g_bench_mcr_sink;
+
+internal void bench_mcr_task(u32 *spins) {
+    u64 start = os_time_now();
+    u32 acc = 0;
+    for (u32 i = 0; i < *spins; i++) {
+        acc = acc * 1664525u + 1013904223u;
+    }
+    g_bench_mcr_sink = acc;
+    bench_lane_busy_add(os_time_diff(os_time_now(), start));
+}
+
+// BENCH_MCR_CHAINS chains BENCH_MCR_DEPTH tasks deep, each task also waits on the
+// neighbour chain's previous task, so one long task holds up its neighbours a step later
+// but not the rest of its wave. tasks declare a write to their own cell and reads of
+// the cells their deps wrote, which the race check has to prove ordered
+internal void bench_mcr_dag_append(void) {
+    MCRTaskHandle prev[BENCH_MCR_CHAINS];
+    MCRTaskHandle next[BENCH_MCR_CHAINS];
+    for (u32 d = 0; d < BENCH_MCR_DEPTH; d++) {
+        for (u32 c = 0; c < BENCH_MCR_CHAINS; c++) {
+            u32 neighbour = (c + 1) % BENCH_MCR_CHAINS;
+            // the first row only declares its write
+            u32 prev_row = d > 0 ? d - 1 : 0;
+            MCRTaskHandle deps[2] = { prev[c], prev[neighbour] };
+            MCRResourceAccess resources[3] = {
+                MCR_ACCESS_WRITE(&g_bench_mcr_cells[d * BENCH_MCR_CHAINS + c], sizeof(u64)),
+                MCR_ACCESS_READ(&g_bench_mcr_cells[prev_row * BENCH_MCR_CHAINS + c], sizeof(u64)),
+                MCR_ACCESS_READ(&g_bench_mcr_cells[prev_row * BENCH_MCR_CHAINS + neighbour], sizeof(u64)),
+            };
+            next[c] = mcr_queue_append(&g_bench_mcr_queue, bench_mcr_task,
+                                       &g_bench_mcr_spins[d * BENCH_MCR_CHAINS + c], resources, d > 0 ? 3 : 1,
+                                       deps, d > 0 ? 2 : 0);
+        }
+        memcpy(prev, next, sizeof(prev));
+    }
+}
+
+void bench_mcr_schedule(void) {
+    ThreadContext *tctx = tctx_current();
+    u32 task_count = BENCH_MCR_CHAINS * BENCH_MCR_DEPTH;
+
+    if (is_main_thread()) {
+        memset(&g_bench_mcr_queue, 0, sizeof(MCRTaskQueue));
+        g_bench_mcr_queue.arena = bench_arena();
+        g_bench_mcr_spins = ARENA_ALLOC_ARRAY(bench_arena(), u32, task_count);
+        g_bench_mcr_cells = ARENA_ALLOC_ARRAY(bench_arena(), u64, task_count);
+    }
+    lane_sync();
+
+    struct { const char *name; b32 unbalanced; MCRSchedule schedule; MCRRaceCheck race_check; } runs[] = {
+        { "dag_balanced_waves", false, MCR_SCHEDULE_WAVES, MCR_RACE_CHECK_OFF },
+        { "dag_balanced_steal", false, MCR_SCHEDULE_STEAL, MCR_RACE_CHECK_OFF },
+        { "dag_unbalanced_waves", true, MCR_SCHEDULE_WAVES, MCR_RACE_CHECK_OFF },
+        { "dag_unbalanced_steal", true, MCR_SCHEDULE_STEAL, MCR_RACE_CHECK_OFF },
+        // what checking the declared accesses for races adds to a frame
+        { "dag_unbalanced_steal_race_check", true, MCR_SCHEDULE_STEAL, MCR_RACE_CHECK_LOG },
+    };
+    for (u32 run = 0; run < ARRAY_SIZE(runs); run++) {
+        b32 unbalanced = runs[run].unbalanced;
+
+        BenchSamples samples = {0};
+        if (is_main_thread()) {
+            bench_lane_busy_reset();
+            samples = bench_samples_make(bench_arena(), BENCH_MCR_ROUNDS);
+            g_bench_mcr_queue.schedule = runs[run].schedule;
+            g_bench_mcr_queue.race_check = runs[run].race_check;
+            for (u32 i = 0; i < task_count; i++) {
+                u32 hash = (i + 1) * 2654435761u;
+                b32 is_long = unbalanced && (hash >> 16) % BENCH_MCR_LONG_EVERY == 0;
+                g_bench_mcr_spins[i] = is_long ? BENCH_MCR_SHORT_SPINS * BENCH_MCR_LONG_FACTOR : BENCH_MCR_SHORT_SPINS;
+            }
+        }
+
+        for (u32 round = 0; round < BENCH_MCR_ROUNDS; round++) {
+            if (is_main_thread()) {
+                bench_mcr_dag_append();
+            }
+            lane_sync();
+            u64 start = os_time_now();
+            mcr_queue_process(&g_bench_mcr_queue);
+            if (is_main_thread()) {
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start));
+            }
+        }
+
+        if (is_main_thread()) {
+            bench_report_lanes(runs[run].name, &samples);
+        }
+    }
+
+    if (is_main_thread()) {
+        LOG_INFO("mcr dag: % tasks, % chains, % lanes, % races found", FMT_UINT(task_count), FMT_UINT(BENCH_MCR_CHAINS),
+                 FMT_UINT(tctx->thread_count), FMT_UINT(g_bench_mcr_queue.races_found));
+    }
+}
@@ -0,0 +1,82 @@
+#include "context.h"
+#include "app.h"
+#include "lib/bench.h"
+#include "lib/multicore_runtime.h"
+#include "lib/random.h"
+#include "os/os.h"
+
+#include "ecs/ecs_entity.c"
+#include "ecs/ecs_table.c"
+#include "ecs/ecs_hierarchy.c"
+#include "ecs/ecs_snapshot.c"
+
+#include "benchmarks/bench_ecs_table_map.c"
+#include "benchmarks/bench_ecs_add_remove.c"
+#include "benchmarks/bench_ecs_spawn.c"
+#include "benchmarks/bench_ecs_query.c"
+#include "benchmarks/bench_ecs_hierarchy.c"
+#include "benchmarks/bench_ecs_snapshot.c"
+#include "benchmarks/bench_ecs_systems.c"
+#include "benchmarks/bench_ecs_boids.c"
+#include "benchmarks/bench_ecs_changed.c"
+#include "benchmarks/bench_mcr_schedule.c"
+#include "benchmarks/bench_lane_parallel_for.c"
+#include "benchmarks/bench_lane_sync.c"
+#if defined(__linux__) && !defined(WASM)
+// drives the os_linux.c async read backends and page options directly
+#include "benchmarks/bench_file_io.c"
+#include "benchmarks/bench_arena_pages.c"
+#endif
+
+global AppContext g_bench_app_ctx;
+
+void register_benches(void) {
+    REGISTER_BENCH(bench_ecs_table_map);
+    REGISTER_BENCH(bench_ecs_add_remove);
+    REGISTER_BENCH(bench_ecs_spawn);
+    REGISTER_BENCH(bench_ecs_query);
+    REGISTER_BENCH_MULTICORE(bench_ecs_hierarchy);
+    REGISTER_BENCH(bench_ecs_snapshot);
+    REGISTER_BENCH_MULTICORE(bench_ecs_systems);
+    REGISTER_BENCH_MULTICORE(bench_ecs_boids);
+    REGISTER_BENCH(bench_ecs_changed);
+    REGISTER_BENCH_MULTICORE(bench_mcr_schedule);
+    REGISTER_BENCH_MULTICORE(bench_lane_parallel_for);
+    REGISTER_BENCH_MULTICORE(bench_lane_sync);
+#if defined(__linux__) && !defined(WASM)
+    REGISTER_BENCH(bench_file_io);
+    REGISTER_BENCH(bench_arena_pages);
+#endif
+}
+
+void bench_main(void)
+{
+    bench_runner_run();
+}
+
+WASM_EXPORT(wasm_init)
+int wasm_init(AppMemory *memory)
+{
+    LOG_INFO("=== Bench Runner Starting ===");
+
+    g_bench_app_ctx.arena = arena_from_buffer(memory->heap, memory->heap_size);
+    g_bench_app_ctx.num_threads = os_get_processor_count();
+    app_ctx_set(&g_bench_app_ctx);
+
+    os_time_init();
+    bench_runner_init(&g_bench_app_ctx.arena, MB(1024));
+    register_benches();
+
+    LOG_INFO("Thread count: %", FMT_UINT(g_bench_app_ctx.num_threads));
+
+    mcr_run(g_bench_app_ctx.num_threads, MB(16), bench_main, &g_bench_app_ctx.arena);
+
+    LOG_INFO("=== Bench Runner Complete ===");
+    return 0;
+}
+
+WASM_EXPORT(wasm_frame)
+void wasm_frame(AppMemory *memory)
+{
+    UNUSED(memory);
+}
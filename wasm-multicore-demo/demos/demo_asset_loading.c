@@ -117,10 +117,12 @@ void app_update_and_render(AppMemory *memory) {
                 log_mesh_data(model, g_state.asset_data);
             } else {
                 LOG_ERROR("Failed to get file data");
+                os_release_file_op(g_state.file_op);
                 g_state.load_state = LOAD_STATE_ERROR;
             }
         } else if (read_state == OS_FILE_READ_STATE_ERROR) {
             LOG_ERROR("File read error");
+            os_release_file_op(g_state.file_op);
             g_state.load_state = LOAD_STATE_ERROR;
         }
     }
@@ -878,9 +878,13 @@ void app_init(AppMemory *memory) {
   f32 spawn_center_x = 20.0f;
   f32 spawn_center_y = 5.0f;
   f32 spawn_center_z = -120.0f;
+  Position *spawn_positions =
+      ARENA_ALLOC_ARRAY(&tctx->temp_arena, Position, NUM_BOIDS);
+  Heading *spawn_headings =
+      ARENA_ALLOC_ARRAY(&tctx->temp_arena, Heading, NUM_BOIDS);
+  BoidIndex *spawn_indices =
+      ARENA_ALLOC_ARRAY(&tctx->temp_arena, BoidIndex, NUM_BOIDS);
   for (i32 i = 0; i < NUM_BOIDS; i++) {
-    EcsEntity e = ecs_entity_new(&state.world);
-
     UnityRandom rng = unity_random_new((u32)(i + 1) * 0x9F6ABC1u);
     f32 rx = unity_random_next_f32(&rng) - 0.5f;
     f32 ry = unity_random_next_f32(&rng) - 0.5f;
@@ -899,16 +903,24 @@ void app_init(AppMemory *memory) {
       hz = 0.0f;
     }
 
-    f32 px = spawn_center_x + hx * spawn_radius;
-    f32 py = spawn_center_y + hy * spawn_radius;
-    f32 pz = spawn_center_z + hz * spawn_radius;
-
-    ecs_set(&state.world, e, Position, {.x = px, .y = py, .z = pz});
-    ecs_set(&state.world, e, Heading, {.x = hx, .y = hy, .z = hz});
-    ecs_set(&state.world, e, BoidIndex, {.index = (u32)i});
-    ecs_add(&state.world, e, ecs_id(BoidTag));
+    spawn_positions[i] = (Position){.x = spawn_center_x + hx * spawn_radius,
+                                    .y = spawn_center_y + hy * spawn_radius,
+                                    .z = spawn_center_z + hz * spawn_radius};
+    spawn_headings[i] = (Heading){.x = hx, .y = hy, .z = hz};
+    spawn_indices[i] = (BoidIndex){.index = (u32)i};
   }
 
+  EcsEntity boid_ids[] = {ecs_id(Position), ecs_id(Heading), ecs_id(BoidIndex),
+                          ecs_id(BoidTag)};
+  const void *boid_data[] = {spawn_positions, spawn_headings, spawn_indices,
+                             NULL};
+  ecs_bulk_new(&state.world, &(EcsBulkDesc){
+                                 .ids = boid_ids,
+                                 .id_count = 4,
+                                 .data = boid_data,
+                                 .count = NUM_BOIDS,
+                             });
+
   const SampledAnimationClip *target_clips[NUM_TARGETS] = {&Target01_animation,
                                                            &Target02_animation};
   for (i32 i = 0; i < NUM_TARGETS; i++) {
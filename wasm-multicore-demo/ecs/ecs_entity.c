@@ -234,8 +234,77 @@ internal EcsEntity ecs_entity_index_new(EcsEntityIndex *index) {
     return id;
 }
 
+// any thread while the world is deferred, nothing else changes the index until the commands apply.
+// dead ids keep their bumped generation in the dense tail, each caller claims the next one
+internal EcsEntity ecs_entity_index_reserve(EcsEntityIndex *index) {
+    i64 slot = (i64)index->alive_count + ins_atomic_u32_inc_eval(&index->deferred_recycled) - 1;
+    if (slot < index->dense_count) {
+        return index->dense[slot];
+    }
+    return (EcsEntity)ins_atomic_u64_inc_eval(&index->max_id);
+}
+
+internal void ecs_entity_index_new_n(EcsEntityIndex *index, EcsEntity *out, i32 count) {
+    i32 recycled = index->dense_count - index->alive_count;
+    if (recycled > count) {
+        recycled = count;
+    }
+
+    // dead entities keep their records, reviving them is just moving alive_count
+    memcpy(out, index->dense + index->alive_count, sizeof(EcsEntity) * recycled);
+    index->alive_count += recycled;
+
+    i32 fresh = count - recycled;
+    if (fresh == 0) {
+        return;
+    }
+
+    debug_assert(index->alive_count == index->dense_count);
+
+    i32 needed = index->dense_count + fresh;
+    if (needed > index->dense_cap) {
+        i32 new_cap = index->dense_cap * 2;
+        while (new_cap < needed) {
+            new_cap *= 2;
+        }
+        EcsEntity *new_dense = ARENA_ALLOC_ARRAY(index->arena, EcsEntity, new_cap);
+        memcpy(new_dense, index->dense, sizeof(EcsEntity) * index->dense_count);
+        index->dense = new_dense;
+        index->dense_cap = new_cap;
+    }
+
+    u32 first_id = (u32)(index->max_id + 1);
+    index->max_id += (u64)fresh;
+
+    EcsEntity *dense = index->dense + index->dense_count;
+    i32 dense_index = index->dense_count;
+    u32 id = first_id;
+    while (id <= (u32)index->max_id) {
+        EcsEntityPage *page = ecs_entity_index_ensure_page(index, id);
+        u32 page_end = (id | ECS_ENTITY_PAGE_MASK) + 1;
+        if (page_end > (u32)index->max_id + 1) {
+            page_end = (u32)index->max_id + 1;
+        }
+
+        for (; id < page_end; id++) {
+            EcsRecord *r = &page->records[id & ECS_ENTITY_PAGE_MASK];
+            debug_assert(r->dense == 0);
+            r->table = NULL;
+            r->row = 0;
+            r->dense = dense_index++;
+            *dense++ = id;
+        }
+    }
+
+    memcpy(out + recycled, index->dense + index->dense_count, sizeof(EcsEntity) * fresh);
+    index->dense_count += fresh;
+    index->alive_count += fresh;
+}
+
 void ecs_world_init(EcsWorld *world, ArenaAllocator *arena) {
+    memset(world, 0, sizeof(EcsWorld));
     world->arena = arena;
+    block_allocator_init(&world->allocator, arena);
     ecs_entity_index_init(&world->entity_index, arena, ECS_FIRST_USER_ENTITY_ID);
     world->last_component_id = ECS_FIRST_USER_COMPONENT_ID;
     world->type_info = ARENA_ALLOC_ARRAY(arena, EcsTypeInfo, ECS_HI_COMPONENT_ID);
@@ -252,10 +321,36 @@ void ecs_world_init(EcsWorld *world, ArenaAllocator *arena) {
 }
 
 EcsEntity ecs_entity_new(EcsWorld *world) {
+    if (world->deferred) {
+        // ids are handed out right away so the caller can keep recording commands on them
+        EcsEntity e = ecs_entity_index_reserve(&world->entity_index);
+        ecs_defer_push(world, EcsCmdCreate, e, 0, NULL);
+        return e;
+    }
     return ecs_entity_index_new(&world->entity_index);
 }
 
+void ecs_entity_new_n(EcsWorld *world, EcsEntity *out, i32 count) {
+    ecs_entity_index_new_n(&world->entity_index, out, count);
+}
+
+internal void ecs_sparse_remove_entity(EcsWorld *world, EcsEntity entity);
+
 void ecs_entity_delete(EcsWorld *world, EcsEntity entity) {
+    if (world->deferred) {
+        ecs_defer_push(world, EcsCmdDelete, entity, 0, NULL);
+        return;
+    }
+
+    EcsRecord *record = ecs_entity_get_record(world, entity);
+    if (!record) {
+        return;
+    }
+
+    ecs_sparse_remove_entity(world, entity);
+    if (record->table) {
+        ecs_table_delete(world, record->table, (i32)record->row);
+    }
     ecs_entity_index_remove(&world->entity_index, entity);
 }
 
@@ -270,6 +365,38 @@ b32 ecs_entity_is_valid(EcsWorld *world, EcsEntity entity) {
     return ecs_entity_is_alive(world, entity);
 }
 
+void ecs_entity_index_restore(EcsWorld *world, const EcsEntity *dense, i32 dense_count, i32 alive_count, u64 max_id) {
+    EcsEntityIndex *index = &world->entity_index;
+    debug_assert(dense_count >= 1 && alive_count <= dense_count);
+
+    if (dense_count > index->dense_cap) {
+        i32 new_cap = index->dense_cap * 2;
+        while (new_cap < dense_count) {
+            new_cap *= 2;
+        }
+        index->dense = ARENA_ALLOC_ARRAY(index->arena, EcsEntity, new_cap);
+        index->dense_cap = new_cap;
+    }
+
+    // records of the current ids are dropped, the restored ones start without a table
+    for (i32 p = 0; p < index->page_count; p++) {
+        if (index->pages[p]) {
+            memset(index->pages[p], 0, sizeof(EcsEntityPage));
+        }
+    }
+
+    memcpy(index->dense, dense, sizeof(EcsEntity) * dense_count);
+    for (i32 i = 1; i < dense_count; i++) {
+        u32 id = ecs_entity_index(dense[i]);
+        EcsEntityPage *page = ecs_entity_index_ensure_page(index, id);
+        page->records[id & ECS_ENTITY_PAGE_MASK].dense = i;
+    }
+
+    index->dense_count = dense_count;
+    index->alive_count = alive_count;
+    index->max_id = max_id;
+}
+
 EcsRecord* ecs_entity_get_record(EcsWorld *world, EcsEntity entity) {
     return ecs_entity_index_try_get(&world->entity_index, entity);
 }
@@ -337,6 +464,16 @@ const EcsTypeInfo* ecs_type_info_get(EcsWorld *world, EcsEntity component) {
     return ti;
 }
 
+void ecs_component_set_hooks(EcsWorld *world, EcsEntity component, const EcsTypeHooks *hooks) {
+    u32 id = ecs_entity_index(component);
+    debug_assert(id < ECS_HI_COMPONENT_ID);
+
+    EcsTypeInfo *ti = &world->type_info[id];
+    debug_assert_msg(world->component_records[id].table_count == 0,
+        "hooks for % set after tables were created", FMT_STR(ti->name));
+    ti->hooks = *hooks;
+}
+
 EcsComponentRecord* ecs_component_record_get(EcsWorld *world, EcsEntity component) {
     u32 id = ecs_entity_index(component);
     if (id >= ECS_HI_COMPONENT_ID) {
@@ -363,3 +500,132 @@ EcsTableRecord* ecs_component_record_get_table(EcsComponentRecord *cr, EcsTable
 
     return cr->table_map[table_id];
 }
+
+#define ECS_SPARSE_INITIAL_CAP 64
+
+b32 ecs_component_set_sparse(EcsWorld *world, EcsEntity component) {
+    EcsComponentRecord *cr = ecs_component_record_get(world, component);
+    debug_assert_msg(cr, "ecs_component_set_sparse on an unregistered component");
+    debug_assert_msg(cr->table_count == 0, "% set sparse after tables were created", FMT_STR(cr->type_info->name));
+    if (cr->sparse) {
+        return true;
+    }
+    if (world->sparse_count >= ECS_MAX_SPARSE_COMPONENTS) {
+        LOG_ERROR("% can't be sparse, the world already has % sparse components",
+                  FMT_STR(cr->type_info->name), FMT_UINT(ECS_MAX_SPARSE_COMPONENTS));
+        return false;
+    }
+
+    EcsSparseSet *set = ARENA_ALLOC(world->arena, EcsSparseSet);
+    memset(set, 0, sizeof(EcsSparseSet));
+    set->ti = cr->type_info;
+    set->arena = world->arena;
+    set->count = 1;
+    cr->sparse = set;
+    world->sparse_sets[world->sparse_count++] = set;
+    return true;
+}
+
+EcsSparseSet* ecs_component_sparse(EcsWorld *world, EcsEntity component) {
+    u32 id = ecs_entity_index(component);
+    return id < ECS_HI_COMPONENT_ID ? world->component_records[id].sparse : NULL;
+}
+
+internal i32* ecs_sparse_ensure_page(EcsSparseSet *set, u32 id) {
+    i32 page_index = (i32)(id >> ECS_ENTITY_PAGE_BITS);
+
+    if (page_index >= set->page_cap) {
+        i32 new_cap = set->page_cap == 0 ? ECS_INITIAL_PAGE_CAP : set->page_cap * 2;
+        while (new_cap <= page_index) {
+            new_cap *= 2;
+        }
+        EcsSparsePage **new_pages = ARENA_ALLOC_ARRAY(set->arena, EcsSparsePage*, new_cap);
+        memset(new_pages, 0, sizeof(EcsSparsePage*) * new_cap);
+        if (set->pages) {
+            memcpy(new_pages, set->pages, sizeof(EcsSparsePage*) * set->page_count);
+        }
+        set->pages = new_pages;
+        set->page_cap = new_cap;
+    }
+    set->page_count = MAX(set->page_count, page_index + 1);
+
+    EcsSparsePage *page = set->pages[page_index];
+    if (!page) {
+        page = ARENA_ALLOC(set->arena, EcsSparsePage);
+        memset(page, 0, sizeof(EcsSparsePage));
+        set->pages[page_index] = page;
+    }
+
+    return &page->dense[id & ECS_ENTITY_PAGE_MASK];
+}
+
+// returns the value, constructed when the entity wasn't a member yet. *out_added tells which
+internal void* ecs_sparse_add(EcsSparseSet *set, EcsEntity entity, b32 *out_added) {
+    i32 slot = ecs_sparse_slot(set, entity);
+    if (out_added) {
+        *out_added = slot == 0;
+    }
+    if (slot) {
+        return set->data ? set->data + (size_t)set->ti->size * slot : NULL;
+    }
+
+    if (set->count >= set->cap) {
+        i32 new_cap = set->cap == 0 ? ECS_SPARSE_INITIAL_CAP : set->cap * 2;
+        EcsEntity *dense = ARENA_ALLOC_ARRAY(set->arena, EcsEntity, new_cap);
+        dense[0] = 0;
+        if (set->dense) {
+            memcpy(dense, set->dense, sizeof(EcsEntity) * set->count);
+        }
+        set->dense = dense;
+        if (set->ti->size > 0) {
+            u8 *data = (u8*)arena_alloc_align(set->arena, (size_t)set->ti->size * new_cap, MAX(set->ti->alignment, 1));
+            if (set->data) {
+                u32 size = set->ti->size;
+                ecs_type_move(set->ti, data + size, set->data + size, set->count - 1);
+            }
+            set->data = data;
+        }
+        set->cap = new_cap;
+    }
+
+    slot = set->count++;
+    set->dense[slot] = entity;
+    *ecs_sparse_ensure_page(set, ecs_entity_index(entity)) = slot;
+
+    if (!set->data) {
+        return NULL;
+    }
+    void *value = set->data + (size_t)set->ti->size * slot;
+    ecs_type_ctor(set->ti, value, 1);
+    return value;
+}
+
+// the last member fills the hole, returns false when the entity wasn't a member
+internal b32 ecs_sparse_remove(EcsSparseSet *set, EcsEntity entity) {
+    i32 slot = ecs_sparse_slot(set, entity);
+    if (!slot) {
+        return false;
+    }
+
+    i32 last = --set->count;
+    if (set->data) {
+        u32 size = set->ti->size;
+        ecs_type_dtor(set->ti, set->data + (size_t)size * slot, 1);
+        if (slot != last) {
+            ecs_type_move(set->ti, set->data + (size_t)size * slot, set->data + (size_t)size * last, 1);
+        }
+    }
+    if (slot != last) {
+        EcsEntity moved = set->dense[last];
+        set->dense[slot] = moved;
+        *ecs_sparse_ensure_page(set, ecs_entity_index(moved)) = slot;
+    }
+    *ecs_sparse_ensure_page(set, ecs_entity_index(entity)) = 0;
+    return true;
+}
+
+internal void ecs_sparse_remove_entity(EcsWorld *world, EcsEntity entity) {
+    for (i32 i = 0; i < world->sparse_count; i++) {
+        ecs_sparse_remove(world->sparse_sets[i], entity);
+    }
+}
@@ -18,6 +18,9 @@
 #define ECS_FIRST_USER_COMPONENT_ID 8
 #define ECS_FIRST_USER_ENTITY_ID (ECS_HI_COMPONENT_ID + 128)
 
+#define ECS_MAX_THREADS 64
+#define ECS_MAX_SPARSE_COMPONENTS 32
+
 typedef u64 EcsEntity;
 
 typedef struct EcsTable EcsTable;
@@ -25,6 +28,8 @@ typedef struct EcsTablePage EcsTablePage;
 typedef struct EcsTableMap EcsTableMap;
 typedef struct EcsQuery EcsQuery;
 typedef struct EcsSystem EcsSystem;
+typedef struct EcsHierarchy EcsHierarchy;
+typedef struct EcsProfiler EcsProfiler;
 
 typedef struct EcsRecord {
     EcsTable *table;
@@ -45,20 +50,66 @@ typedef struct EcsEntityIndex {
     i32 page_count;
     i32 page_cap;
     u64 max_id;
+    // dead ids deferred ecs_entity_new calls took, from dense[alive_count] on. they come back to
+    // life when the commands are applied
+    u32 deferred_recycled;
     ArenaAllocator *arena;
 } EcsEntityIndex;
 
-// TODO: add type hooks for complex types (ctor/dtor/copy/move callbacks)
-// void (*ctor)(void *ptr, i32 count, const EcsTypeInfo *ti);
-// void (*dtor)(void *ptr, i32 count, const EcsTypeInfo *ti);
-// void (*copy)(void *dst, const void *src, i32 count, const EcsTypeInfo *ti);
-// void (*move)(void *dst, void *src, i32 count, const EcsTypeInfo *ti);
-typedef struct EcsTypeInfo {
+typedef struct EcsTypeInfo EcsTypeInfo;
+
+/* hooks work on count contiguous elements. ctor: constructs raw memory, dtor: destroys.
+   copy: dst is constructed, assigns from src. move: dst is raw, src is relocated into it and
+   counts as raw afterwards. NULL hooks fall back to memset 0 / nothing / memcpy / memcpy */
+typedef void (*EcsXtorHook)(void *ptr, i32 count, const EcsTypeInfo *ti);
+typedef void (*EcsCopyHook)(void *dst, const void *src, i32 count, const EcsTypeInfo *ti);
+typedef void (*EcsMoveHook)(void *dst, void *src, i32 count, const EcsTypeInfo *ti);
+
+typedef struct EcsTypeHooks {
+    EcsXtorHook ctor;
+    EcsXtorHook dtor;
+    EcsCopyHook copy;
+    EcsMoveHook move;
+    void *ctx;
+} EcsTypeHooks;
+
+struct EcsTypeInfo {
     u32 size;
     u32 alignment;
     EcsEntity component;
     const char *name;
-} EcsTypeInfo;
+    EcsTypeHooks hooks;
+};
+
+force_inline void ecs_type_ctor(const EcsTypeInfo *ti, void *ptr, i32 count) {
+    if (ti->hooks.ctor) {
+        ti->hooks.ctor(ptr, count, ti);
+    } else {
+        memset(ptr, 0, (size_t)ti->size * count);
+    }
+}
+
+force_inline void ecs_type_dtor(const EcsTypeInfo *ti, void *ptr, i32 count) {
+    if (ti->hooks.dtor) {
+        ti->hooks.dtor(ptr, count, ti);
+    }
+}
+
+force_inline void ecs_type_copy(const EcsTypeInfo *ti, void *dst, const void *src, i32 count) {
+    if (ti->hooks.copy) {
+        ti->hooks.copy(dst, src, count, ti);
+    } else {
+        memcpy(dst, src, (size_t)ti->size * count);
+    }
+}
+
+force_inline void ecs_type_move(const EcsTypeInfo *ti, void *dst, void *src, i32 count) {
+    if (ti->hooks.move) {
+        ti->hooks.move(dst, src, count, ti);
+    } else {
+        memcpy(dst, src, (size_t)ti->size * count);
+    }
+}
 
 typedef struct EcsTableRecord {
     EcsTable *table;
@@ -68,6 +119,25 @@ typedef struct EcsTableRecord {
     struct EcsTableRecord *next;
 } EcsTableRecord;
 
+typedef struct EcsSparsePage {
+    i32 dense[ECS_ENTITY_PAGE_SIZE];
+} EcsSparsePage;
+
+/* members of a sparse component, paged like the entity index: pages[id >> ECS_ENTITY_PAGE_BITS]
+   maps an entity id to its slot in dense (0 = not a member, slot 0 is never used). data holds one
+   value per slot, NULL for zero sized components */
+typedef struct EcsSparseSet {
+    EcsSparsePage **pages;
+    i32 page_count;
+    i32 page_cap;
+    EcsEntity *dense;
+    u8 *data;
+    i32 count;
+    i32 cap;
+    const EcsTypeInfo *ti;
+    ArenaAllocator *arena;
+} EcsSparseSet;
+
 typedef struct EcsComponentRecord {
     EcsEntity id;
     const EcsTypeInfo *type_info;
@@ -76,9 +146,34 @@ typedef struct EcsComponentRecord {
     i32 table_count;
     EcsTableRecord **table_map;
     i32 table_map_cap;
+    // set with ecs_component_set_sparse, the component then never shows up in a table
+    EcsSparseSet *sparse;
 } EcsComponentRecord;
 
 
+typedef enum {
+    EcsCmdCreate = 0,
+    EcsCmdAdd,
+    EcsCmdRemove,
+    EcsCmdSet,
+    EcsCmdDelete,
+    EcsCmdSkip,
+} EcsCmdKind;
+
+/* structural change recorded while the world is deferred, value points into the recording thread's temp arena */
+typedef struct EcsCmd {
+    EcsEntity entity;
+    EcsEntity component;
+    void *value;
+    i32 kind;
+} EcsCmd;
+
+typedef struct EcsCmdBuffer {
+    EcsCmd *cmds;
+    i32 count;
+    i32 cap;
+} EcsCmdBuffer;
+
 typedef struct EcsStore {
     EcsTablePage **pages;
     i32 page_count;
@@ -91,6 +186,7 @@ typedef struct EcsStore {
 typedef struct EcsWorld {
     EcsEntityIndex entity_index;
     ArenaAllocator *arena;
+    BlockAllocator allocator;
     EcsEntity last_component_id;
     EcsTypeInfo *type_info;
     EcsComponentRecord *component_records;
@@ -99,9 +195,25 @@ typedef struct EcsWorld {
     EcsQuery **cached_queries;
     i32 cached_query_count;
     i32 cached_query_cap;
-    EcsSystem *systems;
+    EcsSystem **systems;
     i32 system_count;
     i32 system_cap;
+    // row s of each matrix is a bitset over systems registered before s, system_graph_cap bits wide
+    u64 *system_hazards;
+    u64 *system_reach_all;
+    u64 *system_reach_lane;
+    i32 system_graph_cap;
+    b32 deferred;
+    u32 chunk_size;
+    // last change tick handed out, every column write takes the next one (see ecs_table_mark_dirty)
+    u32 change_tick;
+    EcsCmdBuffer cmd_buffers[ECS_MAX_THREADS];
+    EcsHierarchy *hierarchy;
+    // set by ecs_profile_enable, ecs_progress records nothing while it's NULL
+    EcsProfiler *profiler;
+    // deleting an entity drops it from each of these
+    EcsSparseSet *sparse_sets[ECS_MAX_SPARSE_COMPONENTS];
+    i32 sparse_count;
 } EcsWorld;
 
 force_inline u32 ecs_entity_index(EcsEntity entity) {
@@ -119,18 +231,53 @@ force_inline EcsEntity ecs_entity_make(u32 index, u32 generation) {
 void ecs_world_init(EcsWorld *world, ArenaAllocator *arena);
 EcsEntity ecs_entity_new(EcsWorld *world);
 EcsEntity ecs_entity_new_low_id(EcsWorld *world);
+/* reserves count ids at once, recycled ids first, writes them to out */
+void ecs_entity_new_n(EcsWorld *world, EcsEntity *out, i32 count);
 void ecs_entity_delete(EcsWorld *world, EcsEntity entity);
 b32 ecs_entity_is_alive(EcsWorld *world, EcsEntity entity);
 b32 ecs_entity_is_valid(EcsWorld *world, EcsEntity entity);
 b32 ecs_entity_exists(EcsWorld *world, EcsEntity entity);
 EcsRecord* ecs_entity_get_record(EcsWorld *world, EcsEntity entity);
+/* replaces the entity index with a saved dense array (alive ids first, then recycled ones),
+   every record starts without a table */
+void ecs_entity_index_restore(EcsWorld *world, const EcsEntity *dense, i32 dense_count, i32 alive_count, u64 max_id);
 i32 ecs_entity_count(EcsWorld *world);
 
 EcsEntity ecs_component_register(EcsWorld *world, u32 size, u32 alignment, const char *name);
 const EcsTypeInfo* ecs_type_info_get(EcsWorld *world, EcsEntity component);
+/* must be called before any table holds the component */
+void ecs_component_set_hooks(EcsWorld *world, EcsEntity component, const EcsTypeHooks *hooks);
 EcsComponentRecord* ecs_component_record_get(EcsWorld *world, EcsEntity component);
 EcsTableRecord* ecs_component_record_get_table(EcsComponentRecord *cr, EcsTable *table);
 
+/* stores component in a sparse set instead of archetype tables, for tags that flip every few frames:
+   ecs_add/remove/has/get/set become O(1) set operations and never move the entity to another table.
+   queries still filter on it per row, but get no field for it (use ecs_get). systems with a term on it
+   conflict over the whole set, a term declared as written against any other term on it. call before any entity has it and before queries using it are created.
+   false when the world already has ECS_MAX_SPARSE_COMPONENTS sparse components, it stays a table component */
+b32 ecs_component_set_sparse(EcsWorld *world, EcsEntity component);
+/* NULL unless component is sparse */
+EcsSparseSet* ecs_component_sparse(EcsWorld *world, EcsEntity component);
+
+force_inline i32 ecs_sparse_slot(const EcsSparseSet *set, EcsEntity entity) {
+    u32 id = ecs_entity_index(entity);
+    i32 page_index = (i32)(id >> ECS_ENTITY_PAGE_BITS);
+    if (page_index >= set->page_count || !set->pages[page_index]) {
+        return 0;
+    }
+    i32 slot = set->pages[page_index]->dense[id & ECS_ENTITY_PAGE_MASK];
+    return slot && set->dense[slot] == entity ? slot : 0;
+}
+
+force_inline b32 ecs_sparse_has(const EcsSparseSet *set, EcsEntity entity) {
+    return ecs_sparse_slot(set, entity) != 0;
+}
+
+force_inline void* ecs_sparse_get(const EcsSparseSet *set, EcsEntity entity) {
+    i32 slot = ecs_sparse_slot(set, entity);
+    return slot && set->data ? set->data + (size_t)set->ti->size * slot : NULL;
+}
+
 #define ecs_id(T) FLECS_ID##T##ID_
 
 #define ECS_COMPONENT_DECLARE(T) \
@@ -0,0 +1,291 @@
+#include "ecs_hierarchy.h"
+#include "lib/assert.h"
+#include "lib/multicore_runtime.h"
+#include "lib/fmt.h"
+
+// group = depth, read from the depth tag in the table type
+internal u64 ecs_hierarchy_group_by_depth(EcsWorld *world, EcsTable *table, EcsEntity group_id, void *ctx) {
+    UNUSED(world);
+    UNUSED(group_id);
+    EcsHierarchy *hierarchy = (EcsHierarchy *)ctx;
+    if (!ecs_table_has_component(table, hierarchy->child_of)) {
+        return 0;
+    }
+    for (i32 d = 1; d < ECS_MAX_HIERARCHY_DEPTH; d++) {
+        if (ecs_table_has_component(table, hierarchy->depth_tags[d])) {
+            return (u64)d;
+        }
+    }
+    return 0;
+}
+
+EcsHierarchy* ecs_hierarchy_init(EcsWorld *world) {
+    debug_assert_msg(world->hierarchy == NULL, "hierarchy already initialized");
+
+    EcsHierarchy *hierarchy = ARENA_ALLOC(world->arena, EcsHierarchy);
+    memset(hierarchy, 0, sizeof(EcsHierarchy));
+
+    hierarchy->child_of = ecs_component_register(world, sizeof(EcsChildOf), _Alignof(EcsChildOf), "EcsChildOf");
+    hierarchy->local_transform = ecs_component_register(world, sizeof(EcsLocalTransform),
+        _Alignof(EcsLocalTransform), "EcsLocalTransform");
+    hierarchy->world_transform = ecs_component_register(world, sizeof(EcsWorldTransform),
+        _Alignof(EcsWorldTransform), "EcsWorldTransform");
+
+    // depth 0 has no tag, roots are the tables without EcsChildOf
+    for (i32 d = 1; d < ECS_MAX_HIERARCHY_DEPTH; d++) {
+        hierarchy->depth_tags[d] = ecs_entity_new(world);
+    }
+
+    EcsTerm parent_term = ecs_term_optional(hierarchy->child_of);
+    parent_term.inout = EcsIn;
+    EcsTerm terms[] = {
+        ecs_term_in(hierarchy->local_transform),
+        ecs_term_out(hierarchy->world_transform),
+        parent_term,
+    };
+    ecs_query_init_terms(&hierarchy->query, world, terms, 3);
+    ecs_query_group_by(&hierarchy->query, 0, ecs_hierarchy_group_by_depth, hierarchy);
+    ecs_query_cache_init(&hierarchy->query);
+
+    world->hierarchy = hierarchy;
+    return hierarchy;
+}
+
+EcsEntity ecs_parent(EcsWorld *world, EcsEntity entity) {
+    EcsChildOf *child_of = (EcsChildOf *)ecs_get(world, entity, world->hierarchy->child_of);
+    return child_of ? child_of->parent : ECS_ENTITY_INVALID;
+}
+
+i32 ecs_depth(EcsWorld *world, EcsEntity entity) {
+    EcsChildOf *child_of = (EcsChildOf *)ecs_get(world, entity, world->hierarchy->child_of);
+    return child_of ? child_of->depth : 0;
+}
+
+internal u32* ecs_hierarchy_child_count(EcsWorld *world, EcsEntity entity) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    i32 index = (i32)ecs_entity_index(entity);
+
+    if (index >= hierarchy->child_count_cap) {
+        i32 new_cap = hierarchy->child_count_cap == 0 ? 1024 : hierarchy->child_count_cap * 2;
+        while (new_cap <= index) {
+            new_cap *= 2;
+        }
+        u32 *new_counts = ARENA_ALLOC_ARRAY(world->arena, u32, new_cap);
+        memset(new_counts, 0, sizeof(u32) * new_cap);
+        if (hierarchy->child_counts) {
+            memcpy(new_counts, hierarchy->child_counts, sizeof(u32) * hierarchy->child_count_cap);
+        }
+        hierarchy->child_counts = new_counts;
+        hierarchy->child_count_cap = new_cap;
+    }
+
+    return &hierarchy->child_counts[index];
+}
+
+internal void ecs_hierarchy_set_depth(EcsWorld *world, EcsEntity entity, EcsEntity parent, i32 depth) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    debug_assert_msg(depth < ECS_MAX_HIERARCHY_DEPTH, "hierarchy deeper than % levels", FMT_INT(ECS_MAX_HIERARCHY_DEPTH));
+
+    i32 old_depth = ecs_depth(world, entity);
+    if (old_depth != depth && old_depth > 0) {
+        ecs_remove(world, entity, hierarchy->depth_tags[old_depth]);
+    }
+
+    if (parent == ECS_ENTITY_INVALID) {
+        ecs_remove(world, entity, hierarchy->child_of);
+        return;
+    }
+
+    if (old_depth != depth) {
+        ecs_add(world, entity, hierarchy->depth_tags[depth]);
+    }
+    ecs_set_ptr(world, entity, hierarchy->child_of, &(EcsChildOf){ parent, depth });
+
+    if (depth > hierarchy->max_depth) {
+        hierarchy->max_depth = depth;
+    }
+}
+
+typedef struct EcsDepthFix {
+    EcsEntity entity;
+    EcsEntity parent;
+    i32 depth;
+} EcsDepthFix;
+
+// stale counts only ever overshoot, deleted children aren't subtracted
+internal u32 ecs_hierarchy_children(EcsHierarchy *hierarchy, EcsEntity entity) {
+    u32 index = ecs_entity_index(entity);
+    return index < (u32)hierarchy->child_count_cap ? hierarchy->child_counts[index] : 0;
+}
+
+// walks the subtree under root one level at a time, root just moved from old_depth to depth.
+// children lists aren't kept, but each level sits in its own depth tag tables, so a level only
+// scans the tables of its old depth, and stops once the parents' child counts are all found.
+// leaves are never expanded
+internal void ecs_hierarchy_fix_depths(EcsWorld *world, EcsEntity root, i32 old_depth, i32 depth) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    EcsComponentRecord *cr = ecs_component_record_get(world, hierarchy->child_of);
+    ArenaAllocator *temp = &tctx_current()->temp_arena;
+
+    i32 total = 0;
+    for (EcsTableRecord *tr = cr->first; tr; tr = tr->next) {
+        total += tr->table->data.count;
+    }
+    EcsDepthFix *fixes = ARENA_ALLOC_ARRAY(temp, EcsDepthFix, total);
+    // level + 1 for the parents whose children the level looks for, only parents with a count are marked
+    u32 *marks = ARENA_ALLOC_ARRAY(temp, u32, hierarchy->child_count_cap);
+    memset(marks, 0, sizeof(u32) * hierarchy->child_count_cap);
+
+    marks[ecs_entity_index(root)] = 1;
+    u32 expected = ecs_hierarchy_children(hierarchy, root);
+    for (i32 level = 1; expected > 0 && old_depth + level < ECS_MAX_HIERARCHY_DEPTH; level++) {
+        EcsEntity level_tag = hierarchy->depth_tags[old_depth + level];
+        u32 found = 0;
+        i32 fix_count = 0;
+        for (EcsTableRecord *tr = cr->first; tr && found < expected; tr = tr->next) {
+            EcsTable *table = tr->table;
+            if (!ecs_table_has_component(table, level_tag)) {
+                continue;
+            }
+            EcsChildOf *child_of = (EcsChildOf *)table->data.columns[tr->column].data;
+            for (i32 i = 0; i < table->data.count && found < expected; i++) {
+                u32 parent_index = ecs_entity_index(child_of[i].parent);
+                if (parent_index < (u32)hierarchy->child_count_cap && marks[parent_index] == (u32)level) {
+                    fixes[fix_count++] = (EcsDepthFix){ table->data.entities[i], child_of[i].parent, depth + level };
+                    found++;
+                }
+            }
+        }
+
+        // applied after the scan, re-tagging moves the rows to other tables
+        expected = 0;
+        for (i32 i = 0; i < fix_count; i++) {
+            ecs_hierarchy_set_depth(world, fixes[i].entity, fixes[i].parent, fixes[i].depth);
+            u32 children = ecs_hierarchy_children(hierarchy, fixes[i].entity);
+            if (children > 0) {
+                marks[ecs_entity_index(fixes[i].entity)] = (u32)level + 1;
+                expected += children;
+            }
+        }
+    }
+}
+
+void ecs_child_of(EcsWorld *world, EcsEntity child, EcsEntity parent) {
+    debug_assert_msg(world->hierarchy != NULL, "ecs_hierarchy_init has not been called");
+    debug_assert_msg(!world->deferred, "ecs_child_of can't be deferred");
+    debug_assert(child != parent);
+
+    EcsEntity old_parent = ecs_parent(world, child);
+    if (old_parent == parent) {
+        return;
+    }
+
+    i32 old_depth = ecs_depth(world, child);
+    i32 depth = 0;
+    if (parent != ECS_ENTITY_INVALID) {
+#ifdef DEBUG
+        for (EcsEntity p = parent; p != ECS_ENTITY_INVALID; p = ecs_parent(world, p)) {
+            debug_assert_msg(p != child, "ecs_child_of would create a cycle");
+        }
+#endif
+        depth = ecs_depth(world, parent) + 1;
+    }
+
+    if (old_parent != ECS_ENTITY_INVALID) {
+        u32 *old_count = ecs_hierarchy_child_count(world, old_parent);
+        if (*old_count > 0) {
+            (*old_count)--;
+        }
+    }
+    if (parent != ECS_ENTITY_INVALID) {
+        (*ecs_hierarchy_child_count(world, parent))++;
+    }
+
+    ecs_hierarchy_set_depth(world, child, parent, depth);
+
+    if (depth != old_depth && *ecs_hierarchy_child_count(world, child) > 0) {
+        ecs_hierarchy_fix_depths(world, child, old_depth, depth);
+    }
+}
+
+void ecs_hierarchy_rebuild(EcsWorld *world) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    if (hierarchy->child_counts) {
+        memset(hierarchy->child_counts, 0, sizeof(u32) * hierarchy->child_count_cap);
+    }
+    hierarchy->max_depth = 0;
+
+    EcsComponentRecord *cr = ecs_component_record_get(world, hierarchy->child_of);
+    for (EcsTableRecord *tr = cr->first; tr; tr = tr->next) {
+        EcsTable *table = tr->table;
+        EcsChildOf *child_of = (EcsChildOf *)table->data.columns[tr->column].data;
+        for (i32 i = 0; i < table->data.count; i++) {
+            (*ecs_hierarchy_child_count(world, child_of[i].parent))++;
+            if (child_of[i].depth > hierarchy->max_depth) {
+                hierarchy->max_depth = child_of[i].depth;
+            }
+        }
+    }
+}
+
+void ecs_transform_propagate(EcsWorld *world) {
+    EcsHierarchy *hierarchy = world->hierarchy;
+    EcsQuery *query = &hierarchy->query;
+    ThreadContext *tctx = tctx_current();
+
+    // after this every lane only reads the group order. the level count is broadcast instead of read
+    // in the loop, the main thread may already change the world once it is past the last level
+    u64 level_count = 0;
+    if (is_main_thread()) {
+        ecs_query_cache_prepare(query);
+        EcsQueryCache *cache = &query->cache;
+        level_count = cache->group_count > 0 ? cache->groups[cache->group_count - 1].id + 1 : 0;
+    }
+    lane_sync_u64(0, &level_count);
+
+    for (i32 depth = 0; depth < (i32)level_count; depth++) {
+        EcsIter it = ecs_query_iter(query);
+        ecs_iter_set_group(&it, (u64)depth);
+        // same answer on every lane, empty levels skip the sync
+        if (it.cache_index == it.cache_end) {
+            continue;
+        }
+
+        while (ecs_iter_next(&it)) {
+            Range_u64 range = lane_range_for(tctx->thread_idx, tctx->thread_count, (u64)it.count);
+            if (range.max <= range.min) {
+                continue;
+            }
+
+            EcsLocalTransform *local = ecs_field(&it, EcsLocalTransform, 0);
+            EcsWorldTransform *out = ecs_field(&it, EcsWorldTransform, 1);
+            EcsChildOf *child_of = ecs_field(&it, EcsChildOf, 2);
+
+            if (!child_of) {
+                for (u64 i = range.min; i < range.max; i++) {
+                    glm_mat4_copy(local[i].value, out[i].value);
+                }
+            } else {
+                // siblings are usually adjacent, only look the parent up when it changes
+                EcsEntity last_parent = ECS_ENTITY_INVALID;
+                EcsWorldTransform *parent_world = NULL;
+                for (u64 i = range.min; i < range.max; i++) {
+                    if (child_of[i].parent != last_parent) {
+                        last_parent = child_of[i].parent;
+                        parent_world = (EcsWorldTransform *)ecs_get(world, last_parent, hierarchy->world_transform);
+                    }
+                    if (parent_world) {
+                        glm_mat4_mul(parent_world->value, local[i].value, out[i].value);
+                    } else {
+                        glm_mat4_copy(local[i].value, out[i].value);
+                    }
+                }
+            }
+
+            ecs_table_mark_dirty_rows(world, it.table, it.columns[1], it.offset + (i32)range.min,
+                                      (i32)(range.max - range.min));
+        }
+
+        lane_sync();
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ECS_HIERARCHY_H
+#define ECS_HIERARCHY_H
+
+#include "ecs_table.h"
+#include "lib/math.h"
+
+#define ECS_MAX_HIERARCHY_DEPTH 32
+
+/* parent of an entity and its depth (parent depth + 1). roots have no EcsChildOf and sit at depth 0 */
+typedef struct EcsChildOf {
+    EcsEntity parent;
+    i32 depth;
+} EcsChildOf;
+
+typedef struct EcsLocalTransform {
+    mat4 value;
+} EcsLocalTransform;
+
+/* written by ecs_transform_propagate: parent world * local, local for roots */
+typedef struct EcsWorldTransform {
+    mat4 value;
+} EcsWorldTransform;
+
+/* children also carry the tag of their depth, so a table only ever holds one level and the
+   propagation query groups its tables by depth */
+struct EcsHierarchy {
+    EcsEntity child_of;
+    EcsEntity local_transform;
+    EcsEntity world_transform;
+    EcsEntity depth_tags[ECS_MAX_HIERARCHY_DEPTH];
+    i32 max_depth;
+
+    // indexed by entity index, > 0 when the entity may still have children
+    u32 *child_counts;
+    i32 child_count_cap;
+
+    EcsQuery query;
+};
+
+/* registers the built-in components, depth tags and the propagation query. after ecs_store_init */
+EcsHierarchy* ecs_hierarchy_init(EcsWorld *world);
+/* moves child under parent, parent == ECS_ENTITY_INVALID detaches it. descendants of child are
+   re-tagged when its depth changes. not deferrable, the new depth comes from the parent's current one */
+void ecs_child_of(EcsWorld *world, EcsEntity child, EcsEntity parent);
+/* recomputes child counts and the max depth from the EcsChildOf columns, e.g. after ecs_world_restore */
+void ecs_hierarchy_rebuild(EcsWorld *world);
+EcsEntity ecs_parent(EcsWorld *world, EcsEntity entity);
+i32 ecs_depth(EcsWorld *world, EcsEntity entity);
+
+/* called by every lane with no structural changes in flight, e.g. right after ecs_progress.
+   levels run in depth order with a lane_sync in between, the rows of each level are split across
+   lanes. children of deleted parents are treated as roots */
+void ecs_transform_propagate(EcsWorld *world);
+
+#endif
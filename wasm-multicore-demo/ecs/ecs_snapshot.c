@@ -0,0 +1,226 @@
+#include "ecs_snapshot.h"
+#include "ecs_hierarchy.h"
+#include "lib/assert.h"
+#include "lib/fmt.h"
+
+// base == NULL only measures, the same walk then runs again to fill the blob
+typedef struct EcsSnapshotWriter {
+    u8 *base;
+    u64 offset;
+} EcsSnapshotWriter;
+
+internal u64 ecs_snapshot_reserve(EcsSnapshotWriter *writer, u64 size, u64 alignment) {
+    u64 offset = ALIGN_POW2(writer->offset, alignment);
+    writer->offset = offset + size;
+    return offset;
+}
+
+internal BlobPtr ecs_snapshot_push(EcsSnapshotWriter *writer, const void *data, i32 count, u32 type_size,
+                                   u32 typehash, u64 alignment) {
+    u32 size = (u32)count * type_size;
+    u64 offset = ecs_snapshot_reserve(writer, size, alignment);
+    if (writer->base && data && size > 0) {
+        memcpy(writer->base + offset, data, size);
+    }
+    return (BlobPtr){ (u32)offset, size, type_size, typehash };
+}
+
+force_inline u32 ecs_snapshot_type_hash(const EcsTypeInfo *ti) {
+    return (ti->name ? fnv1a_hash(ti->name) : 0) ^ ti->size;
+}
+
+internal u64 ecs_snapshot_write(EcsWorld *world, u8 *base) {
+    EcsSnapshotWriter writer = { base, 0 };
+    ecs_snapshot_reserve(&writer, sizeof(EcsSnapshotHeader), ECS_SNAPSHOT_ALIGNMENT);
+
+    EcsEntityIndex *index = &world->entity_index;
+    BlobPtr dense = ecs_snapshot_push(&writer, index->dense, index->dense_count, sizeof(EcsEntity),
+                                      TYPE_HASH(EcsEntity), _Alignof(EcsEntity));
+
+    i32 component_count = 0;
+    for (i32 id = 0; id < ECS_HI_COMPONENT_ID; id++) {
+        component_count += world->type_info[id].component != 0;
+    }
+    BlobPtr components = ecs_snapshot_push(&writer, NULL, component_count, sizeof(EcsSnapshotComponent),
+                                           TYPE_HASH(EcsSnapshotComponent), _Alignof(EcsSnapshotComponent));
+    if (base) {
+        EcsSnapshotComponent *out = blob_array_get(EcsSnapshotComponent, base, components);
+        for (i32 id = 0; id < ECS_HI_COMPONENT_ID; id++) {
+            EcsTypeInfo *ti = &world->type_info[id];
+            if (ti->component) {
+                *out++ = (EcsSnapshotComponent){ ti->component, ti->size, ti->alignment, ecs_snapshot_type_hash(ti) };
+            }
+        }
+    }
+
+    i32 table_count = 0;
+    for (i32 t = 0; t < world->store.table_count; t++) {
+        table_count += ecs_store_get_table(world, t)->data.count > 0;
+    }
+    BlobPtr tables = ecs_snapshot_push(&writer, NULL, table_count, sizeof(EcsSnapshotTable),
+                                       TYPE_HASH(EcsSnapshotTable), _Alignof(EcsSnapshotTable));
+
+    i32 written = 0;
+    for (i32 t = 0; t < world->store.table_count; t++) {
+        EcsTable *table = ecs_store_get_table(world, t);
+        i32 count = table->data.count;
+        if (count == 0) {
+            continue;
+        }
+
+        EcsSnapshotTable entry = {0};
+        entry.count = count;
+        entry.type = ecs_snapshot_push(&writer, table->type.array, table->type.count, sizeof(EcsEntity),
+                                       TYPE_HASH(EcsEntity), _Alignof(EcsEntity));
+        entry.entities = ecs_snapshot_push(&writer, table->data.entities, count, sizeof(EcsEntity),
+                                           TYPE_HASH(EcsEntity), _Alignof(EcsEntity));
+        entry.columns = ecs_snapshot_push(&writer, NULL, table->column_count, sizeof(BlobPtr),
+                                          TYPE_HASH(BlobPtr), _Alignof(BlobPtr));
+
+        for (i32 c = 0; c < table->column_count; c++) {
+            EcsColumn *column = &table->data.columns[c];
+            const EcsTypeInfo *ti = column->ti;
+            debug_assert_msg(!ti->hooks.ctor && !ti->hooks.dtor && !ti->hooks.copy && !ti->hooks.move,
+                "% has hooks, its columns can't be snapshotted", FMT_STR(ti->name));
+
+            BlobPtr data = ecs_snapshot_push(&writer, column->data, count, ti->size,
+                                             ecs_snapshot_type_hash(ti), ECS_SNAPSHOT_ALIGNMENT);
+            if (base) {
+                blob_array_get(BlobPtr, base, entry.columns)[c] = data;
+            }
+        }
+
+        if (base) {
+            blob_array_get(EcsSnapshotTable, base, tables)[written] = entry;
+        }
+        written++;
+    }
+
+    BlobPtr sparse = ecs_snapshot_push(&writer, NULL, world->sparse_count, sizeof(EcsSnapshotSparse),
+                                       TYPE_HASH(EcsSnapshotSparse), _Alignof(EcsSnapshotSparse));
+    for (i32 i = 0; i < world->sparse_count; i++) {
+        EcsSparseSet *set = world->sparse_sets[i];
+        const EcsTypeInfo *ti = set->ti;
+        debug_assert_msg(!ti->hooks.ctor && !ti->hooks.dtor && !ti->hooks.copy && !ti->hooks.move,
+            "% has hooks, it can't be snapshotted", FMT_STR(ti->name));
+
+        // slot 0 is unused
+        i32 count = set->count - 1;
+        EcsSnapshotSparse entry = { .id = ti->component };
+        entry.entities = ecs_snapshot_push(&writer, set->dense + 1, count, sizeof(EcsEntity),
+                                           TYPE_HASH(EcsEntity), _Alignof(EcsEntity));
+        entry.data = ecs_snapshot_push(&writer, set->data ? set->data + ti->size : NULL, set->data ? count : 0,
+                                       ti->size, ecs_snapshot_type_hash(ti), ECS_SNAPSHOT_ALIGNMENT);
+        if (base) {
+            blob_array_get(EcsSnapshotSparse, base, sparse)[i] = entry;
+        }
+    }
+
+    if (base) {
+        EcsSnapshotHeader *header = (EcsSnapshotHeader *)base;
+        header->magic = ECS_SNAPSHOT_MAGIC;
+        header->version = ECS_SNAPSHOT_VERSION;
+        header->size = writer.offset;
+        header->max_id = index->max_id;
+        header->dense_count = index->dense_count;
+        header->alive_count = index->alive_count;
+        header->dense = dense;
+        header->components = components;
+        header->tables = tables;
+        header->sparse = sparse;
+    }
+
+    return writer.offset;
+}
+
+EcsSnapshotHeader* ecs_world_snapshot(EcsWorld *world, ArenaAllocator *arena) {
+    debug_assert_msg(!world->deferred, "ecs_world_snapshot while deferred");
+
+    u64 size = ecs_snapshot_write(world, NULL);
+    debug_assert_msg(size <= 0xFFFFFFFFull, "snapshot of % mb doesn't fit 32 bit blob offsets", FMT_UINT(size >> 20));
+
+    u8 *base = (u8 *)arena_alloc_align(arena, size, ECS_SNAPSHOT_ALIGNMENT);
+    u64 written = ecs_snapshot_write(world, base);
+    debug_assert(written == size);
+    UNUSED(written);
+
+    return (EcsSnapshotHeader *)base;
+}
+
+b32 ecs_world_restore(EcsWorld *world, const EcsSnapshotHeader *snapshot) {
+    debug_assert_msg(!world->deferred, "ecs_world_restore while deferred");
+
+    if (snapshot->magic != ECS_SNAPSHOT_MAGIC || snapshot->version != ECS_SNAPSHOT_VERSION) {
+        LOG_ERROR("ecs snapshot: bad header, version % (expected %)", FMT_UINT(snapshot->version),
+                  FMT_UINT(ECS_SNAPSHOT_VERSION));
+        return false;
+    }
+
+    void *base = (void *)snapshot;
+    EcsSnapshotComponent *components = blob_array_get(EcsSnapshotComponent, base, snapshot->components);
+    for (u32 i = 0; i < blobptr_len(snapshot->components); i++) {
+        EcsSnapshotComponent *saved = &components[i];
+        const EcsTypeInfo *ti = ecs_type_info_get(world, saved->id);
+        if (!ti || ti->size != saved->size || ti->alignment != saved->alignment ||
+            ecs_snapshot_type_hash(ti) != saved->name_hash) {
+            LOG_ERROR("ecs snapshot: component % isn't registered the same way in this world", FMT_UINT(saved->id));
+            return false;
+        }
+    }
+
+    EcsSnapshotSparse *sparse = blob_array_get(EcsSnapshotSparse, base, snapshot->sparse);
+    for (u32 i = 0; i < blobptr_len(snapshot->sparse); i++) {
+        if (!ecs_component_sparse(world, sparse[i].id)) {
+            LOG_ERROR("ecs snapshot: component % isn't sparse in this world", FMT_UINT(sparse[i].id));
+            return false;
+        }
+    }
+
+    for (i32 t = 0; t < world->store.table_count; t++) {
+        debug_assert_msg(ecs_store_get_table(world, t)->data.count == 0, "ecs_world_restore into a world with rows");
+    }
+    for (i32 i = 0; i < world->sparse_count; i++) {
+        debug_assert_msg(world->sparse_sets[i]->count == 1, "ecs_world_restore into a world with sparse members");
+    }
+
+    EcsEntity *dense = blob_array_get(EcsEntity, base, snapshot->dense);
+    ecs_entity_index_restore(world, dense, snapshot->dense_count, snapshot->alive_count, snapshot->max_id);
+
+    EcsSnapshotTable *tables = blob_array_get(EcsSnapshotTable, base, snapshot->tables);
+    for (u32 t = 0; t < blobptr_len(snapshot->tables); t++) {
+        EcsSnapshotTable *saved = &tables[t];
+        EcsType type = { blob_array_get(EcsEntity, base, saved->type), (i32)blobptr_len(saved->type) };
+        EcsTable *table = ecs_table_find_or_create(world, &type);
+
+        // fills the entity column and points every record at its row
+        EcsEntity *entities = blob_array_get(EcsEntity, base, saved->entities);
+        ecs_table_grow_n(world, table, entities, saved->count);
+
+        BlobPtr *columns = blob_array_get(BlobPtr, base, saved->columns);
+        debug_assert((i32)blobptr_len(saved->columns) == table->column_count);
+        for (i32 c = 0; c < table->column_count; c++) {
+            EcsColumn *column = &table->data.columns[c];
+            debug_assert(columns[c].typehash == ecs_snapshot_type_hash(column->ti));
+            memcpy(column->data, blob_array_get_void(base, columns[c]), columns[c].size);
+            ecs_table_mark_dirty(world, table, c);
+        }
+    }
+
+    for (u32 i = 0; i < blobptr_len(snapshot->sparse); i++) {
+        EcsSparseSet *set = ecs_component_sparse(world, sparse[i].id);
+        EcsEntity *entities = blob_array_get(EcsEntity, base, sparse[i].entities);
+        u8 *data = sparse[i].data.size ? (u8 *)blob_array_get_void(base, sparse[i].data) : NULL;
+        for (u32 e = 0; e < blobptr_len(sparse[i].entities); e++) {
+            void *value = ecs_sparse_add(set, entities[e], NULL);
+            if (value && data) {
+                memcpy(value, data + (size_t)set->ti->size * e, set->ti->size);
+            }
+        }
+    }
+
+    if (world->hierarchy) {
+        ecs_hierarchy_rebuild(world);
+    }
+
+    return true;
+}
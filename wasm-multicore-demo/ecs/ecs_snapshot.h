@@ -0,0 +1,57 @@
+#ifndef ECS_SNAPSHOT_H
+#define ECS_SNAPSHOT_H
+
+#include "ecs_table.h"
+#include "blob_asset.h"
+
+#define ECS_SNAPSHOT_MAGIC 0x53534345u
+#define ECS_SNAPSHOT_VERSION 2
+#define ECS_SNAPSHOT_ALIGNMENT 64
+
+/* registered component the snapshot was taken with, restore checks the target world agrees */
+typedef struct EcsSnapshotComponent {
+    EcsEntity id;
+    u32 size;
+    u32 alignment;
+    u32 name_hash;
+} EcsSnapshotComponent;
+
+/* one non-empty table. columns[i] holds count rows of the table's i-th column */
+typedef struct EcsSnapshotTable {
+    BlobArray(EcsEntity) type;
+    BlobArray(EcsEntity) entities;
+    BlobArray(BlobPtr) columns;
+    i32 count;
+} EcsSnapshotTable;
+
+/* members of one sparse component, data holds one value per entity (empty for zero sized ones) */
+typedef struct EcsSnapshotSparse {
+    EcsEntity id;
+    BlobArray(EcsEntity) entities;
+    BlobPtr data;
+} EcsSnapshotSparse;
+
+/* every offset is relative to the header, so the blob can be written to disk and loaded anywhere.
+   column data starts ECS_SNAPSHOT_ALIGNMENT aligned */
+typedef struct EcsSnapshotHeader {
+    u32 magic;
+    u32 version;
+    u64 size;
+    u64 max_id;
+    i32 dense_count;
+    i32 alive_count;
+    BlobArray(EcsEntity) dense;
+    BlobArray(EcsSnapshotComponent) components;
+    BlobArray(EcsSnapshotTable) tables;
+    BlobArray(EcsSnapshotSparse) sparse;
+} EcsSnapshotHeader;
+
+/* copies the entity index, table types and raw column data into one blob allocated from arena.
+   components with hooks can't be snapshotted, their bytes aren't relocatable. not while deferred */
+EcsSnapshotHeader* ecs_world_snapshot(EcsWorld *world, ArenaAllocator *arena);
+/* target: initialized like the source (same components registered in the same order, the same ones
+   sparse) with no rows in any table and empty sparse sets. one bulk copy per column, then the entity records are pointed at their new rows.
+   returns false when the blob doesn't match the world */
+b32 ecs_world_restore(EcsWorld *world, const EcsSnapshotHeader *snapshot);
+
+#endif
@@ -36,61 +36,87 @@ internal void ecs_component_record_insert_table(EcsWorld *world, EcsComponentRec
     cr->table_map[table_id] = tr;
 }
 
-void ecs_table_map_init(EcsTableMap *map, ArenaAllocator *arena) {
-    map->arena = arena;
-    map->bucket_count = ECS_TABLE_MAP_INITIAL_CAPACITY;
-    map->buckets = ARENA_ALLOC_ARRAY(arena, EcsTableMapBucket, map->bucket_count);
-    memset(map->buckets, 0, sizeof(EcsTableMapBucket) * map->bucket_count);
+internal void ecs_table_map_alloc(EcsTableMap *map, i32 capacity) {
+    map->capacity = capacity;
+    map->hashes = (u64*)block_alloc(map->allocator, sizeof(u64) * capacity);
+    map->keys = (EcsType*)block_alloc(map->allocator, sizeof(EcsType) * capacity);
+    map->values = (EcsTable**)block_alloc(map->allocator, sizeof(EcsTable*) * capacity);
+    memset(map->hashes, 0, sizeof(u64) * capacity);
 }
 
-EcsTable* ecs_table_map_get(EcsTableMap *map, const EcsType *type) {
-    u64 hash = ecs_type_hash(type);
-    i32 bucket_idx = (i32)(hash % (u64)map->bucket_count);
-    EcsTableMapBucket *bucket = &map->buckets[bucket_idx];
+internal i32 ecs_table_map_find_slot(EcsTableMap *map, u64 hash, const EcsType *type) {
+    u32 mask = (u32)map->capacity - 1;
+    u32 slot = (u32)hash & mask;
 
-    for (i32 i = 0; i < bucket->count; i++) {
-        if (ecs_type_compare(&bucket->keys[i], type) == 0) {
-            return bucket->values[i];
+    for (;;) {
+        u64 slot_hash = map->hashes[slot];
+        if (slot_hash == 0) {
+            return (i32)slot;
         }
+        if (slot_hash == hash && ecs_type_compare(&map->keys[slot], type) == 0) {
+            return (i32)slot;
+        }
+        slot = (slot + 1) & mask;
     }
-
-    return NULL;
 }
 
-void ecs_table_map_set(EcsTableMap *map, const EcsType *type, EcsTable *table) {
-    u64 hash = ecs_type_hash(type);
-    i32 bucket_idx = (i32)(hash % (u64)map->bucket_count);
-    EcsTableMapBucket *bucket = &map->buckets[bucket_idx];
+internal void ecs_table_map_grow(EcsTableMap *map) {
+    u64 *old_hashes = map->hashes;
+    EcsType *old_keys = map->keys;
+    EcsTable **old_values = map->values;
+    i32 old_capacity = map->capacity;
 
-    for (i32 i = 0; i < bucket->count; i++) {
-        if (ecs_type_compare(&bucket->keys[i], type) == 0) {
-            bucket->values[i] = table;
-            return;
+    ecs_table_map_alloc(map, old_capacity * 2);
+
+    // hashes are stored, so rehashing never touches the type arrays
+    u32 mask = (u32)map->capacity - 1;
+    for (i32 i = 0; i < old_capacity; i++) {
+        u64 hash = old_hashes[i];
+        if (hash == 0) {
+            continue;
+        }
+        u32 slot = (u32)hash & mask;
+        while (map->hashes[slot] != 0) {
+            slot = (slot + 1) & mask;
         }
+        map->hashes[slot] = hash;
+        map->keys[slot] = old_keys[i];
+        map->values[slot] = old_values[i];
     }
 
-    if (bucket->count >= bucket->capacity) {
-        i32 new_cap = bucket->capacity == 0 ? 4 : bucket->capacity * 2;
-        EcsType *new_keys = ARENA_ALLOC_ARRAY(map->arena, EcsType, new_cap);
-        EcsTable **new_values = ARENA_ALLOC_ARRAY(map->arena, EcsTable*, new_cap);
+    block_free(map->allocator, old_hashes, sizeof(u64) * old_capacity);
+    block_free(map->allocator, old_keys, sizeof(EcsType) * old_capacity);
+    block_free(map->allocator, old_values, sizeof(EcsTable*) * old_capacity);
+}
 
-        if (bucket->keys) {
-            memcpy(new_keys, bucket->keys, sizeof(EcsType) * bucket->count);
-            memcpy(new_values, bucket->values, sizeof(EcsTable*) * bucket->count);
-        }
+void ecs_table_map_init(EcsTableMap *map, BlockAllocator *allocator) {
+    map->allocator = allocator;
+    map->count = 0;
+    ecs_table_map_alloc(map, ECS_TABLE_MAP_INITIAL_CAPACITY);
+}
 
-        bucket->keys = new_keys;
-        bucket->values = new_values;
-        bucket->capacity = new_cap;
+EcsTable* ecs_table_map_get(EcsTableMap *map, const EcsType *type) {
+    u64 hash = ecs_type_hash(type);
+    i32 slot = ecs_table_map_find_slot(map, hash, type);
+    if (map->hashes[slot] == 0) {
+        return NULL;
     }
+    return map->values[slot];
+}
 
-    EcsType *key = &bucket->keys[bucket->count];
-    key->count = type->count;
-    key->array = ARENA_ALLOC_ARRAY(map->arena, EcsEntity, type->count);
-    memcpy(key->array, type->array, sizeof(EcsEntity) * type->count);
+void ecs_table_map_set(EcsTableMap *map, const EcsType *type, EcsTable *table) {
+    if ((map->count + 1) * 100 > map->capacity * ECS_TABLE_MAP_MAX_LOAD_PCT) {
+        ecs_table_map_grow(map);
+    }
 
-    bucket->values[bucket->count] = table;
-    bucket->count++;
+    u64 hash = ecs_type_hash(type);
+    i32 slot = ecs_table_map_find_slot(map, hash, type);
+    if (map->hashes[slot] == 0) {
+        map->hashes[slot] = hash;
+        map->keys[slot] = *type;
+        map->count++;
+    }
+    map->values[slot] = table;
 }
 
 internal i32 ecs_type_index_of(const EcsType *type, EcsEntity component) {
@@ -102,6 +128,82 @@ internal i32 ecs_type_index_of(const EcsType *type, EcsEntity component) {
     return -1;
 }
 
+internal void ecs_system_graph_add_table(EcsWorld *world, EcsTable *table);
+
+// a multiple of 64 / (largest power of two dividing the element size) keeps the chunks of that
+// column on ECS_COLUMN_ALIGNMENT, the widest column decides for the table
+internal void ecs_table_update_chunk_rows(EcsWorld *world, EcsTable *table) {
+    if (world->chunk_size == 0) {
+        table->chunk_rows = 0;
+        return;
+    }
+
+    i32 row_size = sizeof(EcsEntity);
+    i32 row_align = ECS_COLUMN_ALIGNMENT / sizeof(EcsEntity);
+    for (i32 c = 0; c < table->column_count; c++) {
+        i32 size = (i32)table->data.columns[c].ti->size;
+        row_size += size;
+        i32 pow2 = MIN(size & -size, ECS_COLUMN_ALIGNMENT);
+        row_align = MAX(row_align, ECS_COLUMN_ALIGNMENT / pow2);
+    }
+
+    i32 rows = ((i32)world->chunk_size / row_size) / row_align * row_align;
+    table->chunk_rows = MAX(rows, row_align);
+}
+
+force_inline i32 ecs_table_block_count(EcsTable *table, i32 rows) {
+    return (rows + table->block_rows - 1) / table->block_rows;
+}
+
+internal void ecs_table_resize_blocks(EcsWorld *world, EcsTable *table, i32 block_cap) {
+    i32 slots = 1 + table->column_count;
+    u32 *ticks = NULL;
+    if (block_cap > 0) {
+        ticks = (u32*)block_alloc(&world->allocator, sizeof(u32) * slots * block_cap);
+        memset(ticks, 0, sizeof(u32) * slots * block_cap);
+        i32 keep = MIN(block_cap, table->block_cap);
+        for (i32 slot = 0; keep > 0 && slot < slots; slot++) {
+            memcpy(ticks + (size_t)slot * block_cap, table->block_ticks + (size_t)slot * table->block_cap,
+                   sizeof(u32) * keep);
+        }
+    }
+    block_free(&world->allocator, table->block_ticks, sizeof(u32) * slots * table->block_cap);
+    table->block_ticks = ticks;
+    table->block_cap = block_cap;
+}
+
+// one world wide counter, so "changed since the last run" is a single compare per block. stores are
+// atomic, lanes may stamp the same block or the same table
+internal void ecs_table_stamp(EcsWorld *world, EcsTable *table, i32 slot, i32 row, i32 count) {
+    u32 tick = ins_atomic_u32_inc_eval(&world->change_tick);
+    ins_atomic_u32_eval_assign(&table->dirty_state[slot], tick);
+    if (count <= 0) {
+        return;
+    }
+
+    debug_assert(row >= 0 && row + count <= table->data.count);
+    u32 *ticks = table->block_ticks + (size_t)slot * table->block_cap;
+    i32 last = (row + count - 1) / table->block_rows;
+    for (i32 b = row / table->block_rows; b <= last; b++) {
+        ins_atomic_u32_eval_assign(&ticks[b], tick);
+    }
+}
+
+// change blocks follow chunks. the old ticks don't map onto a new layout, every row counts as changed
+internal void ecs_table_update_blocks(EcsWorld *world, EcsTable *table) {
+    i32 block_rows = table->chunk_rows ? table->chunk_rows : ECS_CHANGE_BLOCK_ROWS;
+    if (block_rows == table->block_rows) {
+        return;
+    }
+
+    ecs_table_resize_blocks(world, table, 0);
+    table->block_rows = block_rows;
+    ecs_table_resize_blocks(world, table, ecs_table_block_count(table, table->data.size));
+    for (i32 slot = 0; slot <= table->column_count; slot++) {
+        ecs_table_stamp(world, table, slot, 0, table->data.count);
+    }
+}
+
 void ecs_table_init(EcsWorld *world, EcsTable *table, const EcsType *type) {
     table->type.count = type ? type->count : 0;
 
@@ -166,11 +268,16 @@ void ecs_table_init(EcsWorld *world, EcsTable *table, const EcsType *type) {
     table->data.count = 0;
     table->data.size = 0;
 
+    // ticks start at 1, 0 is never changed
     i32 dirty_state_count = 1 + table->column_count;
-    table->dirty_state = ARENA_ALLOC_ARRAY(world->arena, i32, dirty_state_count);
-    for (i32 i = 0; i < dirty_state_count; i++) {
-        table->dirty_state[i] = 1;
-    }
+    table->dirty_state = ARENA_ALLOC_ARRAY(world->arena, u32, dirty_state_count);
+    memset(table->dirty_state, 0, sizeof(u32) * dirty_state_count);
+    table->block_ticks = NULL;
+    table->block_rows = 0;
+    table->block_cap = 0;
+
+    ecs_table_update_chunk_rows(world, table);
+    ecs_table_update_blocks(world, table);
 
     for (i32 i = 0; i < table->type.count; i++) {
         EcsEntity comp = table->type.array[i];
@@ -184,62 +291,113 @@ void ecs_table_init(EcsWorld *world, EcsTable *table, const EcsType *type) {
     for (i32 i = 0; i < world->cached_query_count; i++) {
         ecs_query_cache_add_table(world->cached_queries[i], table);
     }
+
+    if (world->system_count > 1) {
+        ecs_system_graph_add_table(world, table);
+    }
 }
 
-i32 ecs_table_append(EcsWorld *world, EcsTable *table, EcsEntity entity) {
-    i32 count = table->data.count;
+internal void ecs_table_resize(EcsWorld *world, EcsTable *table, i32 new_size) {
     i32 size = table->data.size;
 
-    if (count >= size) {
-        i32 new_size = size == 0 ? ECS_TABLE_INITIAL_CAPACITY : size * 2;
+    table->data.entities = (EcsEntity*)block_realloc(&world->allocator, table->data.entities,
+        sizeof(EcsEntity) * size, sizeof(EcsEntity) * new_size);
+
+    for (i32 i = 0; i < table->column_count; i++) {
+        EcsColumn *column = &table->data.columns[i];
+        const EcsTypeInfo *ti = column->ti;
+        size_t elem_size = ti->size;
 
-        EcsEntity *new_entities = ARENA_ALLOC_ARRAY(world->arena, EcsEntity, new_size);
-        if (table->data.entities) {
-            memcpy(new_entities, table->data.entities, sizeof(EcsEntity) * count);
+        if (!ti->hooks.move) {
+            column->data = block_realloc(&world->allocator, column->data,
+                elem_size * size, elem_size * new_size);
+            continue;
         }
-        table->data.entities = new_entities;
 
-        for (i32 i = 0; i < table->column_count; i++) {
-            EcsColumn *column = &table->data.columns[i];
-            EcsTypeInfo *ti = column->ti;
-            u32 elem_size = ti->size;
+        // types with a move hook can't be relocated by the allocator
+        void *data = new_size > 0 ? block_alloc(&world->allocator, elem_size * new_size) : NULL;
+        i32 live = MIN(table->data.count, new_size);
+        if (live > 0) {
+            ecs_type_move(ti, data, column->data, live);
+        }
+        block_free(&world->allocator, column->data, elem_size * size);
+        column->data = data;
+    }
 
-            void *new_data = ARENA_ALLOC_ARRAY(world->arena, u8, elem_size * new_size);
-            if (column->data) {
-                memcpy(new_data, column->data, elem_size * count);
-            }
-            column->data = new_data;
+    table->data.size = new_size;
+    ecs_table_resize_blocks(world, table, ecs_table_block_count(table, new_size));
+}
+
+internal void ecs_table_cache_activate(EcsTable *table, b32 active);
+
+// appends rows and points the records at them, columns are left unconstructed
+i32 ecs_table_grow_n(EcsWorld *world, EcsTable *table, const EcsEntity *entities, i32 count) {
+    i32 first_row = table->data.count;
+    i32 needed = first_row + count;
+
+    if (needed > table->data.size) {
+        i32 new_size = table->data.size == 0 ? ECS_TABLE_INITIAL_CAPACITY : table->data.size * 2;
+        while (new_size < needed) {
+            new_size *= 2;
         }
+        ecs_table_resize(world, table, new_size);
+    }
 
-        table->data.size = new_size;
+    memcpy(table->data.entities + first_row, entities, sizeof(EcsEntity) * count);
+
+    for (i32 i = 0; i < count; i++) {
+        EcsRecord *record = ecs_entity_get_record(world, entities[i]);
+        if (record) {
+            record->table = table;
+            record->row = (u32)(first_row + i);
+        }
     }
 
-    table->data.entities[count] = entity;
+    table->data.count = needed;
+    ecs_table_stamp(world, table, 0, first_row, count);
 
-    for (i32 i = 0; i < table->column_count; i++) {
-        EcsColumn *column = &table->data.columns[i];
-        EcsTypeInfo *ti = column->ti;
-        void *ptr = (u8*)column->data + (ti->size * count);
-        memset(ptr, 0, ti->size);
+    if (first_row == 0 && count > 0) {
+        ecs_table_cache_activate(table, true);
     }
 
-    table->data.count = count + 1;
-    table->dirty_state[0]++;
+    return first_row;
+}
 
-    EcsRecord *record = ecs_entity_get_record(world, entity);
-    if (record) {
-        record->table = table;
-        record->row = (u32)count;
+i32 ecs_table_append(EcsWorld *world, EcsTable *table, EcsEntity entity) {
+    return ecs_table_append_n(world, table, &entity, 1);
+}
+
+i32 ecs_table_append_n(EcsWorld *world, EcsTable *table, const EcsEntity *entities, i32 count) {
+    i32 first_row = ecs_table_grow_n(world, table, entities, count);
+
+    for (i32 i = 0; i < table->column_count; i++) {
+        EcsColumn *column = &table->data.columns[i];
+        ecs_type_ctor(column->ti, (u8*)column->data + ((size_t)column->ti->size * first_row), count);
     }
 
-    return count;
+    return first_row;
 }
 
-void ecs_table_delete(EcsWorld *world, EcsTable *table, i32 row) {
+// fills the hole at row with the last row. destruct == false when the row was already moved out
+internal void ecs_table_remove_row(EcsWorld *world, EcsTable *table, i32 row, b32 destruct) {
     debug_assert(row >= 0 && row < table->data.count);
 
     i32 last_row = table->data.count - 1;
 
+    for (i32 i = 0; i < table->column_count; i++) {
+        EcsColumn *column = &table->data.columns[i];
+        const EcsTypeInfo *ti = column->ti;
+        u32 elem_size = ti->size;
+        void *dst = (u8*)column->data + ((size_t)elem_size * row);
+
+        if (destruct) {
+            ecs_type_dtor(ti, dst, 1);
+        }
+        if (row != last_row) {
+            ecs_type_move(ti, dst, (u8*)column->data + ((size_t)elem_size * last_row), 1);
+        }
+    }
+
     if (row != last_row) {
         table->data.entities[row] = table->data.entities[last_row];
 
@@ -248,20 +406,105 @@ void ecs_table_delete(EcsWorld *world, EcsTable *table, i32 row) {
         if (record) {
             record->row = (u32)row;
         }
+    }
+
+    table->data.count--;
+    // the last row's block only shrinks, the hole got new contents
+    ecs_table_stamp(world, table, 0, row, row < table->data.count ? 1 : 0);
+
+    if (table->data.count == 0) {
+        ecs_table_cache_activate(table, false);
+    }
+}
+
+void ecs_table_delete(EcsWorld *world, EcsTable *table, i32 row) {
+    ecs_table_remove_row(world, table, row, true);
+}
+
+internal void ecs_table_compact(EcsWorld *world, EcsTable *table, i32 first_hole, b32 destruct) {
+    EcsEntity *entities = table->data.entities;
+    i32 count = table->data.count;
+    i32 dst = first_hole;
+    i32 src = first_hole;
+
+    // rows marked with entity 0 are dropped, runs of kept rows slide down with one memmove per column
+    while (src < count) {
+        i32 hole_start = src;
+        while (src < count && entities[src] == 0) {
+            src++;
+        }
+        if (destruct && src > hole_start) {
+            for (i32 i = 0; i < table->column_count; i++) {
+                EcsColumn *column = &table->data.columns[i];
+                ecs_type_dtor(column->ti, (u8*)column->data + ((size_t)column->ti->size * hole_start),
+                              src - hole_start);
+            }
+        }
+        i32 run_start = src;
+        while (src < count && entities[src] != 0) {
+            src++;
+        }
+        i32 run_count = src - run_start;
+        if (run_count == 0) {
+            break;
+        }
 
+        memmove(entities + dst, entities + run_start, sizeof(EcsEntity) * run_count);
         for (i32 i = 0; i < table->column_count; i++) {
             EcsColumn *column = &table->data.columns[i];
-            EcsTypeInfo *ti = column->ti;
+            const EcsTypeInfo *ti = column->ti;
             u32 elem_size = ti->size;
+            u8 *base = (u8*)column->data;
+
+            if (dst == run_start) {
+                continue;
+            }
+            if (!ti->hooks.move) {
+                memmove(base + ((size_t)elem_size * dst), base + ((size_t)elem_size * run_start),
+                        (size_t)elem_size * run_count);
+                continue;
+            }
+
+            // move hooks don't allow overlap, slide in steps no longer than the gap
+            i32 gap = run_start - dst;
+            for (i32 moved = 0; moved < run_count; moved += gap) {
+                i32 n = MIN(gap, run_count - moved);
+                ecs_type_move(ti, base + ((size_t)elem_size * (dst + moved)),
+                              base + ((size_t)elem_size * (run_start + moved)), n);
+            }
+        }
 
-            void *dst = (u8*)column->data + (elem_size * row);
-            void *src = (u8*)column->data + (elem_size * last_row);
-            memcpy(dst, src, elem_size);
+        for (i32 i = 0; i < run_count; i++) {
+            EcsRecord *record = ecs_entity_get_record(world, entities[dst + i]);
+            if (record) {
+                record->row = (u32)(dst + i);
+            }
         }
+        dst += run_count;
     }
 
-    table->data.count--;
-    table->dirty_state[0]++;
+    table->data.count = dst;
+    ecs_table_stamp(world, table, 0, first_hole, dst - first_hole);
+
+    if (dst == 0 && count > 0) {
+        ecs_table_cache_activate(table, false);
+    }
+}
+
+void ecs_table_shrink(EcsWorld *world, EcsTable *table) {
+    i32 count = table->data.count;
+    i32 new_size = 0;
+
+    if (count > 0) {
+        new_size = ECS_TABLE_INITIAL_CAPACITY;
+        while (new_size < count) {
+            new_size *= 2;
+        }
+    }
+
+    if (new_size < table->data.size) {
+        ecs_table_resize(world, table, new_size);
+    }
 }
 
 void* ecs_table_get_column(EcsTable *table, EcsEntity component, i32 *out_column_index) {
@@ -382,13 +625,28 @@ void ecs_store_init(EcsWorld *world) {
     EcsStore *store = &world->store;
 
     store->table_map = ARENA_ALLOC(world->arena, EcsTableMap);
-    ecs_table_map_init(store->table_map, world->arena);
+    ecs_table_map_init(store->table_map, &world->allocator);
 
     EcsTable *root = ecs_store_new_table(world);
     ecs_table_init(world, root, NULL);
     store->root = root;
 }
 
+void ecs_store_shrink(EcsWorld *world) {
+    for (i32 i = 0; i < world->store.table_count; i++) {
+        ecs_table_shrink(world, ecs_store_get_table(world, i));
+    }
+}
+
+void ecs_world_set_chunk_size(EcsWorld *world, u32 chunk_size) {
+    world->chunk_size = chunk_size;
+    for (i32 i = 0; i < world->store.table_count; i++) {
+        EcsTable *table = ecs_store_get_table(world, i);
+        ecs_table_update_chunk_rows(world, table);
+        ecs_table_update_blocks(world, table);
+    }
+}
+
 EcsTable* ecs_table_find_or_create(EcsWorld *world, const EcsType *type) {
     if (type == NULL || type->count == 0) {
         return world->store.root;
@@ -406,6 +664,41 @@ EcsTable* ecs_table_find_or_create(EcsWorld *world, const EcsType *type) {
     return table;
 }
 
+force_inline u32 ecs_graph_edge_hash(EcsEntity id) {
+    return (u32)((id * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+internal EcsGraphEdge* ecs_graph_edge_hi_find(EcsGraphEdges *edges, EcsEntity id) {
+    u32 mask = (u32)edges->hi_cap - 1;
+    u32 slot = ecs_graph_edge_hash(id) & mask;
+
+    for (;;) {
+        EcsGraphEdge *edge = &edges->hi[slot];
+        if (edge->id == id || edge->id == 0) {
+            return edge;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+internal void ecs_graph_edge_hi_grow(EcsWorld *world, EcsGraphEdges *edges) {
+    EcsGraphEdge *old_hi = edges->hi;
+    i32 old_cap = edges->hi_cap;
+    i32 new_cap = old_cap == 0 ? ECS_GRAPH_EDGE_HI_INITIAL_CAPACITY : old_cap * 2;
+
+    edges->hi = (EcsGraphEdge*)block_alloc(&world->allocator, sizeof(EcsGraphEdge) * new_cap);
+    memset(edges->hi, 0, sizeof(EcsGraphEdge) * new_cap);
+    edges->hi_cap = new_cap;
+
+    for (i32 i = 0; i < old_cap; i++) {
+        if (old_hi[i].id != 0) {
+            *ecs_graph_edge_hi_find(edges, old_hi[i].id) = old_hi[i];
+        }
+    }
+
+    block_free(&world->allocator, old_hi, sizeof(EcsGraphEdge) * old_cap);
+}
+
 internal EcsGraphEdge* ecs_graph_edge_get(EcsWorld *world, EcsGraphEdges *edges, EcsEntity id) {
     u32 comp_id = ecs_entity_index(id);
 
@@ -420,12 +713,15 @@ internal EcsGraphEdge* ecs_graph_edge_get(EcsWorld *world, EcsGraphEdges *edges,
         return edge;
     }
 
-    for (i32 i = 0; i < edges->hi_count; i++) {
-        if (edges->hi[i].id == id) {
-            return &edges->hi[i];
-        }
+    if (edges->hi_count == 0) {
+        return NULL;
+    }
+
+    EcsGraphEdge *edge = ecs_graph_edge_hi_find(edges, id);
+    if (edge->id == 0) {
+        return NULL;
     }
-    return NULL;
+    return edge;
 }
 
 internal EcsGraphEdge* ecs_graph_edge_ensure(EcsWorld *world, EcsGraphEdges *edges, EcsEntity id) {
@@ -439,24 +735,18 @@ internal EcsGraphEdge* ecs_graph_edge_ensure(EcsWorld *world, EcsGraphEdges *edg
         return &edges->lo[comp_id];
     }
 
-    for (i32 i = 0; i < edges->hi_count; i++) {
-        if (edges->hi[i].id == id) {
-            return &edges->hi[i];
-        }
+    // keep the load factor at or below 1/2 so probe sequences stay short
+    if ((edges->hi_count + 1) * 2 > edges->hi_cap) {
+        ecs_graph_edge_hi_grow(world, edges);
     }
 
-    if (edges->hi_count >= edges->hi_cap) {
-        i32 new_cap = edges->hi_cap == 0 ? 4 : edges->hi_cap * 2;
-        EcsGraphEdge *new_hi = ARENA_ALLOC_ARRAY(world->arena, EcsGraphEdge, new_cap);
-        if (edges->hi) {
-            memcpy(new_hi, edges->hi, sizeof(EcsGraphEdge) * edges->hi_count);
-        }
-        edges->hi = new_hi;
-        edges->hi_cap = new_cap;
+    EcsGraphEdge *edge = ecs_graph_edge_hi_find(edges, id);
+    if (edge->id == 0) {
+        edge->id = id;
+        edge->to = NULL;
+        edge->diff = NULL;
+        edges->hi_count++;
     }
-
-    EcsGraphEdge *edge = &edges->hi[edges->hi_count++];
-    memset(edge, 0, sizeof(EcsGraphEdge));
     return edge;
 }
 
@@ -574,51 +864,51 @@ EcsTable* ecs_table_traverse_remove(EcsWorld *world, EcsTable *table, EcsEntity
 }
 
 void ecs_table_move(EcsWorld *world, EcsEntity entity, EcsTable *dst_table, EcsTable *src_table, i32 src_row, EcsTableDiff *diff) {
-    i32 dst_row = ecs_table_append(world, dst_table, entity);
-
-    if (diff) {
-        for (i32 src_col = 0; src_col < diff->column_count; src_col++) {
-            i16 dst_col = diff->src_to_dst[src_col];
-            if (dst_col < 0) {
-                continue;
-            }
-
-            EcsColumn *src_column = &src_table->data.columns[src_col];
-            EcsColumn *dst_column = &dst_table->data.columns[dst_col];
-            u32 size = src_column->ti->size;
+    i32 dst_row = ecs_table_grow_n(world, dst_table, &entity, 1);
 
-            void *src_ptr = (u8*)src_column->data + (size * src_row);
-            void *dst_ptr = (u8*)dst_column->data + (size * dst_row);
-            memcpy(dst_ptr, src_ptr, size);
+    // columns the source doesn't have start out constructed
+    for (i32 dst_col = 0; dst_col < dst_table->column_count; dst_col++) {
+        EcsColumn *dst_column = &dst_table->data.columns[dst_col];
+        if (ecs_table_get_column_index(src_table, dst_column->ti->component) < 0) {
+            ecs_type_ctor(dst_column->ti, (u8*)dst_column->data + ((size_t)dst_column->ti->size * dst_row), 1);
         }
-    } else {
-        for (i32 src_col = 0; src_col < src_table->column_count; src_col++) {
-            EcsColumn *src_column = &src_table->data.columns[src_col];
-            EcsEntity comp = src_column->ti->component;
-
-            i32 dst_col = ecs_table_get_column_index(dst_table, comp);
-            if (dst_col < 0) {
-                continue;
-            }
+    }
 
-            EcsColumn *dst_column = &dst_table->data.columns[dst_col];
-            u32 size = src_column->ti->size;
+    for (i32 src_col = 0; src_col < src_table->column_count; src_col++) {
+        EcsColumn *src_column = &src_table->data.columns[src_col];
+        const EcsTypeInfo *ti = src_column->ti;
+        void *src_ptr = (u8*)src_column->data + ((size_t)ti->size * src_row);
 
-            void *src_ptr = (u8*)src_column->data + (size * src_row);
-            void *dst_ptr = (u8*)dst_column->data + (size * dst_row);
-            memcpy(dst_ptr, src_ptr, size);
+        i32 dst_col = diff ? diff->src_to_dst[src_col] : ecs_table_get_column_index(dst_table, ti->component);
+        if (dst_col < 0) {
+            ecs_type_dtor(ti, src_ptr, 1);
+            continue;
         }
+
+        EcsColumn *dst_column = &dst_table->data.columns[dst_col];
+        ecs_type_move(ti, (u8*)dst_column->data + ((size_t)ti->size * dst_row), src_ptr, 1);
     }
 
-    ecs_table_delete(world, src_table, src_row);
+    ecs_table_remove_row(world, src_table, src_row, false);
 }
 
 void ecs_add(EcsWorld *world, EcsEntity entity, EcsEntity component) {
+    if (world->deferred) {
+        ecs_defer_push(world, EcsCmdAdd, entity, component, NULL);
+        return;
+    }
+
     EcsRecord *record = ecs_entity_get_record(world, entity);
     if (!record) {
         return;
     }
 
+    EcsSparseSet *sparse = ecs_component_sparse(world, component);
+    if (sparse) {
+        ecs_sparse_add(sparse, entity, NULL);
+        return;
+    }
+
     EcsTable *src_table = record->table;
     if (!src_table) {
         src_table = world->store.root;
@@ -640,6 +930,17 @@ void ecs_add(EcsWorld *world, EcsEntity entity, EcsEntity component) {
 }
 
 void ecs_remove(EcsWorld *world, EcsEntity entity, EcsEntity component) {
+    if (world->deferred) {
+        ecs_defer_push(world, EcsCmdRemove, entity, component, NULL);
+        return;
+    }
+
+    EcsSparseSet *sparse = ecs_component_sparse(world, component);
+    if (sparse) {
+        ecs_sparse_remove(sparse, entity);
+        return;
+    }
+
     EcsRecord *record = ecs_entity_get_record(world, entity);
     if (!record || !record->table) {
         return;
@@ -657,85 +958,546 @@ void ecs_remove(EcsWorld *world, EcsEntity entity, EcsEntity component) {
     ecs_table_move(world, entity, dst_table, src_table, src_row, diff);
 }
 
-b32 ecs_has(EcsWorld *world, EcsEntity entity, EcsEntity component) {
-    EcsRecord *record = ecs_entity_get_record(world, entity);
-    if (!record || !record->table) {
-        return false;
+i32 ecs_bulk_new(EcsWorld *world, const EcsBulkDesc *desc) {
+    debug_assert(desc->count > 0);
+    debug_assert(desc->id_count >= 0 && desc->id_count <= ECS_BULK_MAX_IDS);
+
+    EcsEntity sorted_ids[ECS_BULK_MAX_IDS];
+    i32 id_count = 0;
+    for (i32 i = 0; i < desc->id_count; i++) {
+        EcsEntity id = desc->ids[i];
+        debug_assert_msg(!ecs_component_sparse(world, id), "ecs_bulk_new with a sparse component");
+        i32 pos = id_count;
+        while (pos > 0 && sorted_ids[pos - 1] > id) {
+            sorted_ids[pos] = sorted_ids[pos - 1];
+            pos--;
+        }
+        sorted_ids[pos] = id;
+        id_count++;
     }
 
-    u32 comp_id = ecs_entity_index(component);
-    if (comp_id < ECS_HI_COMPONENT_ID) {
-        return record->table->column_map[comp_id] != 0;
+    EcsType type = { .array = sorted_ids, .count = id_count };
+    EcsTable *table = ecs_table_find_or_create(world, &type);
+
+    ThreadContext *tctx = tctx_current();
+    EcsEntity *entities = desc->entities;
+    if (!entities) {
+        entities = ARENA_ALLOC_ARRAY(&tctx->temp_arena, EcsEntity, desc->count);
     }
 
-    return ecs_type_index_of(&record->table->type, component) >= 0;
+    ecs_entity_new_n(world, entities, desc->count);
+    i32 first_row = ecs_table_append_n(world, table, entities, desc->count);
+
+    if (desc->data) {
+        for (i32 i = 0; i < desc->id_count; i++) {
+            if (!desc->data[i]) {
+                continue;
+            }
+            i32 col = ecs_table_get_column_index(table, desc->ids[i]);
+            if (col < 0) {
+                continue;
+            }
+            EcsColumn *column = &table->data.columns[col];
+            ecs_type_copy(column->ti, (u8*)column->data + ((size_t)column->ti->size * first_row),
+                          desc->data[i], desc->count);
+            ecs_table_mark_dirty_rows(world, table, col, first_row, desc->count);
+        }
+    }
+
+    return first_row;
 }
 
-void* ecs_get(EcsWorld *world, EcsEntity entity, EcsEntity component) {
-    EcsRecord *record = ecs_entity_get_record(world, entity);
-    if (!record || !record->table) {
-        return NULL;
+void ecs_bulk_delete(EcsWorld *world, const EcsEntity *entities, i32 count) {
+    ThreadContext *tctx = tctx_current();
+    i32 table_count = world->store.table_count;
+
+    // first marked row per table, -1 = untouched
+    i32 *first_hole = ARENA_ALLOC_ARRAY(&tctx->temp_arena, i32, table_count);
+    memset(first_hole, 0xFF, sizeof(i32) * table_count);
+    EcsTable **touched = ARENA_ALLOC_ARRAY(&tctx->temp_arena, EcsTable*, MIN(count, table_count));
+    i32 touched_count = 0;
+
+    for (i32 i = 0; i < count; i++) {
+        EcsRecord *record = ecs_entity_get_record(world, entities[i]);
+        if (!record || !record->table) {
+            continue;
+        }
+
+        EcsTable *table = record->table;
+        i32 row = (i32)record->row;
+        if (table->data.entities[row] == 0) {
+            continue;
+        }
+        table->data.entities[row] = 0;
+
+        i32 table_id = (i32)table->id;
+        if (first_hole[table_id] < 0) {
+            first_hole[table_id] = row;
+            touched[touched_count++] = table;
+        } else if (row < first_hole[table_id]) {
+            first_hole[table_id] = row;
+        }
     }
 
-    i32 col_idx = ecs_table_get_column_index(record->table, component);
-    if (col_idx < 0) {
-        return NULL;
+    for (i32 i = 0; i < count; i++) {
+        if (world->sparse_count > 0) {
+            ecs_sparse_remove_entity(world, entities[i]);
+        }
+        ecs_entity_index_remove(&world->entity_index, entities[i]);
     }
 
-    return ecs_table_get_component(record->table, (i32)record->row, col_idx);
+    for (i32 i = 0; i < touched_count; i++) {
+        EcsTable *table = touched[i];
+        ecs_table_compact(world, table, first_hole[table->id], true);
+    }
 }
 
-void* ecs_get_mut(EcsWorld *world, EcsEntity entity, EcsEntity component) {
-    EcsRecord *record = ecs_entity_get_record(world, entity);
-    if (!record) {
-        return NULL;
-    }
+void ecs_defer_begin(EcsWorld *world) {
+    world->deferred = true;
+}
 
-    if (!record->table || !ecs_has(world, entity, component)) {
-        ecs_add(world, entity, component);
-        record = ecs_entity_get_record(world, entity);
-    }
+b32 ecs_is_deferred(EcsWorld *world) {
+    return world->deferred;
+}
 
-    i32 col_idx = ecs_table_get_column_index(record->table, component);
-    if (col_idx < 0) {
-        return NULL;
+void ecs_defer_push(EcsWorld *world, EcsCmdKind kind, EcsEntity entity, EcsEntity component, const void *value) {
+    ThreadContext *tctx = tctx_current();
+    debug_assert(tctx->thread_idx < ECS_MAX_THREADS);
+
+    // each thread only ever touches its own buffer, storage comes from its temp arena
+    EcsCmdBuffer *buffer = &world->cmd_buffers[tctx->thread_idx];
+    if (buffer->count >= buffer->cap) {
+        i32 new_cap = buffer->cap == 0 ? ECS_CMD_BUFFER_INITIAL_CAPACITY : buffer->cap * 2;
+        EcsCmd *new_cmds = ARENA_ALLOC_ARRAY(&tctx->temp_arena, EcsCmd, new_cap);
+        if (buffer->count > 0) {
+            memcpy(new_cmds, buffer->cmds, sizeof(EcsCmd) * buffer->count);
+        }
+        buffer->cmds = new_cmds;
+        buffer->cap = new_cap;
     }
 
-    return ecs_table_get_component(record->table, (i32)record->row, col_idx);
+    EcsCmd *cmd = &buffer->cmds[buffer->count++];
+    cmd->entity = entity;
+    cmd->component = component;
+    cmd->value = NULL;
+    cmd->kind = (i32)kind;
+
+    if (value) {
+        const EcsTypeInfo *ti = ecs_type_info_get(world, component);
+        if (ti && ti->size > 0) {
+            // the recorded value is a constructed copy, released after the merge
+            cmd->value = ARENA_ALLOC_ARRAY(&tctx->temp_arena, u8, ti->size);
+            if (ti->hooks.copy) {
+                ecs_type_ctor(ti, cmd->value, 1);
+            }
+            ecs_type_copy(ti, cmd->value, value, 1);
+        }
+    }
 }
 
-void ecs_set_ptr(EcsWorld *world, EcsEntity entity, EcsEntity component, const void *ptr) {
-    void *dst = ecs_get_mut(world, entity, component);
-    if (!dst) {
-        return;
+typedef struct EcsSortItem {
+    u64 key;
+    i32 value;
+} EcsSortItem;
+
+// bottom up merge sort, stable so commands on one entity keep their recording order
+internal void ecs_sort_items(EcsSortItem *items, EcsSortItem *scratch, i32 count) {
+    EcsSortItem *src = items;
+    EcsSortItem *dst = scratch;
+
+    for (i32 width = 1; width < count; width *= 2) {
+        for (i32 lo = 0; lo < count; lo += width * 2) {
+            i32 mid = MIN(lo + width, count);
+            i32 hi = MIN(lo + width * 2, count);
+            i32 a = lo, b = mid, out = lo;
+            while (a < mid && b < hi) {
+                dst[out++] = src[b].key < src[a].key ? src[b++] : src[a++];
+            }
+            while (a < mid) dst[out++] = src[a++];
+            while (b < hi) dst[out++] = src[b++];
+        }
+        EcsSortItem *tmp = src;
+        src = dst;
+        dst = tmp;
     }
 
-    const EcsTypeInfo *ti = ecs_type_info_get(world, component);
-    if (ti) {
-        memcpy(dst, ptr, ti->size);
+    if (src != items) {
+        memcpy(items, src, sizeof(EcsSortItem) * count);
     }
+}
 
-    EcsRecord *record = ecs_entity_get_record(world, entity);
-    if (record && record->table) {
-        i32 col = ecs_table_get_column_index(record->table, component);
-        ecs_table_mark_dirty(record->table, col);
+// rows come in entity order, so source rows are often contiguous: one hook call per run
+internal void ecs_column_move_rows(const EcsTypeInfo *ti, u8 *dst, u8 *src_base, const i32 *src_rows, i32 count) {
+    for (i32 i = 0; i < count;) {
+        i32 run = 1;
+        while (i + run < count && src_rows[i + run] == src_rows[i] + run) {
+            run++;
+        }
+        ecs_type_move(ti, dst + ((size_t)ti->size * i), src_base + ((size_t)ti->size * src_rows[i]), run);
+        i += run;
     }
 }
 
-void ecs_query_init(EcsQuery *query, EcsWorld *world, EcsEntity *terms, i32 term_count) {
-    debug_assert(term_count > 0 && term_count <= ECS_QUERY_MAX_TERMS);
+internal void ecs_column_dtor_rows(const EcsTypeInfo *ti, u8 *base, const i32 *rows, i32 count) {
+    if (!ti->hooks.dtor) {
+        return;
+    }
+    for (i32 i = 0; i < count;) {
+        i32 run = 1;
+        while (i + run < count && rows[i + run] == rows[i] + run) {
+            run++;
+        }
+        ecs_type_dtor(ti, base + ((size_t)ti->size * rows[i]), run);
+        i += run;
+    }
+}
+
+typedef struct EcsDeferMove {
+    EcsEntity entity;
+    EcsTable *src;
+    EcsTable *dst;
+} EcsDeferMove;
+
+void ecs_defer_end(EcsWorld *world) {
+    ThreadContext *tctx = tctx_current();
+    ArenaAllocator *temp = &tctx->temp_arena;
+    world->deferred = false;
+    // the reserved dead ids are revived by their create commands below
+    world->entity_index.deferred_recycled = 0;
+
+    i32 total = 0;
+    for (i32 t = 0; t < ECS_MAX_THREADS; t++) {
+        total += world->cmd_buffers[t].count;
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // flatten in thread order, then group by entity
+    EcsCmd *cmds = ARENA_ALLOC_ARRAY(temp, EcsCmd, total);
+    EcsSortItem *items = ARENA_ALLOC_ARRAY(temp, EcsSortItem, total);
+    EcsSortItem *scratch = ARENA_ALLOC_ARRAY(temp, EcsSortItem, total);
+    i32 cmd_count = 0;
+    for (i32 t = 0; t < ECS_MAX_THREADS; t++) {
+        EcsCmdBuffer *buffer = &world->cmd_buffers[t];
+        if (buffer->count > 0) {
+            memcpy(cmds + cmd_count, buffer->cmds, sizeof(EcsCmd) * buffer->count);
+            cmd_count += buffer->count;
+        }
+        buffer->cmds = NULL;
+        buffer->count = 0;
+        buffer->cap = 0;
+    }
+    for (i32 i = 0; i < total; i++) {
+        items[i].key = cmds[i].entity;
+        items[i].value = i;
+    }
+    ecs_sort_items(items, scratch, total);
+
+    // fold each entity's commands into a single destination table
+    EcsEntity *deletes = ARENA_ALLOC_ARRAY(temp, EcsEntity, total);
+    i32 delete_count = 0;
+    EcsDeferMove *moves = ARENA_ALLOC_ARRAY(temp, EcsDeferMove, total);
+    i32 move_count = 0;
+    i32 *sets = ARENA_ALLOC_ARRAY(temp, i32, total);
+    i32 set_count = 0;
+
+    for (i32 start = 0; start < total;) {
+        EcsEntity entity = (EcsEntity)items[start].key;
+        i32 end = start + 1;
+        while (end < total && items[end].key == entity) {
+            end++;
+        }
+
+        b32 deleted = false;
+        for (i32 i = start; i < end; i++) {
+            EcsCmd *cmd = &cmds[items[i].value];
+            if (cmd->kind == EcsCmdCreate) {
+                ecs_entity_index_ensure(&world->entity_index, entity);
+            } else if (cmd->kind == EcsCmdDelete) {
+                deleted = true;
+            }
+        }
+
+        if (!ecs_entity_is_alive(world, entity)) {
+            start = end;
+            continue;
+        }
+        if (deleted) {
+            deletes[delete_count++] = entity;
+            start = end;
+            continue;
+        }
+
+        EcsRecord *record = ecs_entity_get_record(world, entity);
+        EcsTable *src = record->table;
+        EcsTable *dst = src ? src : world->store.root;
+        i32 first_set = set_count;
+
+        for (i32 i = start; i < end; i++) {
+            EcsCmd *cmd = &cmds[items[i].value];
+            // sparse components never change the destination, they apply right away in recording order
+            EcsSparseSet *sparse = ecs_component_sparse(world, cmd->component);
+            if (sparse) {
+                if (cmd->kind == EcsCmdRemove) {
+                    ecs_sparse_remove(sparse, entity);
+                } else if (cmd->kind == EcsCmdAdd || cmd->kind == EcsCmdSet) {
+                    void *value = ecs_sparse_add(sparse, entity, NULL);
+                    if (value && cmd->value && cmd->kind == EcsCmdSet) {
+                        ecs_type_copy(sparse->ti, value, cmd->value, 1);
+                    }
+                }
+                continue;
+            }
+
+            switch (cmd->kind) {
+            case EcsCmdAdd:
+                dst = ecs_table_traverse_add(world, dst, cmd->component, NULL);
+                break;
+            case EcsCmdSet:
+                dst = ecs_table_traverse_add(world, dst, cmd->component, NULL);
+                sets[set_count++] = items[i].value;
+                break;
+            case EcsCmdRemove:
+                dst = ecs_table_traverse_remove(world, dst, cmd->component, NULL);
+                // a remove after a set throws the value away
+                for (i32 s = first_set; s < set_count; s++) {
+                    EcsCmd *set = &cmds[sets[s]];
+                    if (set->component == cmd->component) {
+                        set->kind = EcsCmdSkip;
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (dst != src && !(src == NULL && dst == world->store.root)) {
+            moves[move_count++] = (EcsDeferMove){ entity, src, dst };
+        }
+        start = end;
+    }
+
+    if (delete_count > 0) {
+        ecs_bulk_delete(world, deletes, delete_count);
+    }
+
+    if (move_count > 0) {
+        // group moves by (src, dst) so each pair appends once and copies column by column
+        EcsSortItem *move_items = ARENA_ALLOC_ARRAY(temp, EcsSortItem, move_count);
+        for (i32 i = 0; i < move_count; i++) {
+            u64 src_key = moves[i].src ? moves[i].src->id + 1 : 0;
+            move_items[i].key = (src_key << 32) | moves[i].dst->id;
+            move_items[i].value = i;
+        }
+        ecs_sort_items(move_items, scratch, move_count);
+
+        i32 table_count = world->store.table_count;
+        i32 *first_hole = ARENA_ALLOC_ARRAY(temp, i32, table_count);
+        memset(first_hole, 0xFF, sizeof(i32) * table_count);
+        EcsTable **touched = ARENA_ALLOC_ARRAY(temp, EcsTable*, MIN(move_count, table_count));
+        i32 touched_count = 0;
+
+        EcsEntity *entities = ARENA_ALLOC_ARRAY(temp, EcsEntity, move_count);
+        i32 *src_rows = ARENA_ALLOC_ARRAY(temp, i32, move_count);
+
+        for (i32 start = 0; start < move_count;) {
+            i32 end = start + 1;
+            while (end < move_count && move_items[end].key == move_items[start].key) {
+                end++;
+            }
+
+            EcsTable *src = moves[move_items[start].value].src;
+            EcsTable *dst = moves[move_items[start].value].dst;
+            i32 n = end - start;
+
+            // rows are read here, after the deletes compacted their tables
+            for (i32 i = 0; i < n; i++) {
+                EcsEntity entity = moves[move_items[start + i].value].entity;
+                entities[i] = entity;
+                src_rows[i] = src ? (i32)ecs_entity_get_record(world, entity)->row : -1;
+            }
+
+            i32 dst_row = ecs_table_grow_n(world, dst, entities, n);
+
+            for (i32 c = 0; c < dst->column_count; c++) {
+                EcsColumn *dst_column = &dst->data.columns[c];
+                const EcsTypeInfo *ti = dst_column->ti;
+                u8 *dst_base = (u8*)dst_column->data + ((size_t)ti->size * dst_row);
+                i32 src_col = src ? ecs_table_get_column_index(src, ti->component) : -1;
+                if (src_col < 0) {
+                    ecs_type_ctor(ti, dst_base, n);
+                } else {
+                    ecs_column_move_rows(ti, dst_base, (u8*)src->data.columns[src_col].data, src_rows, n);
+                }
+            }
+
+            if (src) {
+                for (i32 c = 0; c < src->column_count; c++) {
+                    EcsColumn *src_column = &src->data.columns[c];
+                    if (ecs_table_get_column_index(dst, src_column->ti->component) < 0) {
+                        ecs_column_dtor_rows(src_column->ti, (u8*)src_column->data, src_rows, n);
+                    }
+                }
+
+                i32 table_id = (i32)src->id;
+                for (i32 i = 0; i < n; i++) {
+                    src->data.entities[src_rows[i]] = 0;
+                    if (first_hole[table_id] < 0) {
+                        first_hole[table_id] = src_rows[i];
+                        touched[touched_count++] = src;
+                    } else if (src_rows[i] < first_hole[table_id]) {
+                        first_hole[table_id] = src_rows[i];
+                    }
+                }
+            }
+
+            start = end;
+        }
+
+        for (i32 i = 0; i < touched_count; i++) {
+            EcsTable *table = touched[i];
+            ecs_table_compact(world, table, first_hole[table->id], false);
+        }
+    }
+
+    for (i32 i = 0; i < set_count; i++) {
+        EcsCmd *cmd = &cmds[sets[i]];
+        if (cmd->kind != EcsCmdSet || !cmd->value) {
+            continue;
+        }
+        EcsRecord *record = ecs_entity_get_record(world, cmd->entity);
+        i32 col = ecs_table_get_column_index(record->table, cmd->component);
+        if (col < 0) {
+            continue;
+        }
+        ecs_type_copy(record->table->data.columns[col].ti,
+                      ecs_table_get_component(record->table, (i32)record->row, col), cmd->value, 1);
+        ecs_table_mark_dirty_rows(world, record->table, col, (i32)record->row, 1);
+    }
+
+    // recorded values own resources when the type has hooks, including the ones never applied
+    for (i32 i = 0; i < total; i++) {
+        EcsCmd *cmd = &cmds[i];
+        if (cmd->value && (cmd->kind == EcsCmdSet || cmd->kind == EcsCmdSkip)) {
+            const EcsTypeInfo *ti = ecs_type_info_get(world, cmd->component);
+            if (ti->hooks.dtor) {
+                ecs_type_dtor(ti, cmd->value, 1);
+            }
+        }
+    }
+}
+
+b32 ecs_has(EcsWorld *world, EcsEntity entity, EcsEntity component) {
+    EcsSparseSet *sparse = ecs_component_sparse(world, component);
+    if (sparse) {
+        return ecs_sparse_has(sparse, entity);
+    }
+
+    EcsRecord *record = ecs_entity_get_record(world, entity);
+    if (!record || !record->table) {
+        return false;
+    }
+
+    u32 comp_id = ecs_entity_index(component);
+    if (comp_id < ECS_HI_COMPONENT_ID) {
+        return record->table->column_map[comp_id] != 0;
+    }
+
+    return ecs_type_index_of(&record->table->type, component) >= 0;
+}
+
+void* ecs_get(EcsWorld *world, EcsEntity entity, EcsEntity component) {
+    EcsSparseSet *sparse = ecs_component_sparse(world, component);
+    if (sparse) {
+        return ecs_sparse_get(sparse, entity);
+    }
+
+    EcsRecord *record = ecs_entity_get_record(world, entity);
+    if (!record || !record->table) {
+        return NULL;
+    }
+
+    i32 col_idx = ecs_table_get_column_index(record->table, component);
+    if (col_idx < 0) {
+        return NULL;
+    }
+
+    return ecs_table_get_component(record->table, (i32)record->row, col_idx);
+}
+
+void* ecs_get_mut(EcsWorld *world, EcsEntity entity, EcsEntity component) {
+    EcsRecord *record = ecs_entity_get_record(world, entity);
+    if (!record) {
+        return NULL;
+    }
+
+    EcsSparseSet *sparse = ecs_component_sparse(world, component);
+    if (sparse) {
+        void *value = ecs_sparse_get(sparse, entity);
+        return value || world->deferred ? value : ecs_sparse_add(sparse, entity, NULL);
+    }
+
+    if (!record->table || !ecs_has(world, entity, component)) {
+        if (world->deferred) {
+            // the add only lands at the merge, there is nothing to point at yet
+            return NULL;
+        }
+        ecs_add(world, entity, component);
+        record = ecs_entity_get_record(world, entity);
+    }
+
+    i32 col_idx = ecs_table_get_column_index(record->table, component);
+    if (col_idx < 0) {
+        return NULL;
+    }
+
+    return ecs_table_get_component(record->table, (i32)record->row, col_idx);
+}
+
+void ecs_set_ptr(EcsWorld *world, EcsEntity entity, EcsEntity component, const void *ptr) {
+    if (world->deferred) {
+        ecs_defer_push(world, EcsCmdSet, entity, component, ptr);
+        return;
+    }
+
+    void *dst = ecs_get_mut(world, entity, component);
+    if (!dst) {
+        return;
+    }
+
+    const EcsTypeInfo *ti = ecs_type_info_get(world, component);
+    if (ti) {
+        ecs_type_copy(ti, dst, ptr, 1);
+    }
+
+    EcsRecord *record = ecs_entity_get_record(world, entity);
+    if (record && record->table) {
+        i32 col = ecs_table_get_column_index(record->table, component);
+        ecs_table_mark_dirty_rows(world, record->table, col, (i32)record->row, 1);
+    }
+}
+
+void ecs_query_init(EcsQuery *query, EcsWorld *world, EcsEntity *terms, i32 term_count) {
+    debug_assert(term_count > 0 && term_count <= ECS_QUERY_MAX_TERMS);
 
     query->world = world;
     query->term_count = term_count;
     query->field_count = term_count;
     query->is_cached = false;
-    query->cache.first = NULL;
-    query->cache.last = NULL;
-    query->cache.match_count = 0;
+    query->cache = (EcsQueryCache){0};
+    query->group_by = NULL;
+    query->group_by_id = 0;
+    query->group_by_ctx = NULL;
+    query->order_by = NULL;
+    query->order_by_component = 0;
 
     query->bloom_filter = 0;
     query->read_fields = 0;
     query->write_fields = 0;
+    query->changed_fields = 0;
+    query->sparse_terms = 0;
 
     for (i32 i = 0; i < term_count; i++) {
         query->terms[i].id = terms[i];
@@ -743,7 +1505,11 @@ void ecs_query_init(EcsQuery *query, EcsWorld *world, EcsEntity *terms, i32 term
         query->terms[i].inout = EcsInOutDefault;
         query->terms[i].field_index = (i8)i;
         query->terms[i].or_chain_length = 0;
-        query->bloom_filter |= ecs_bloom_bit(terms[i]);
+        if (ecs_component_sparse(world, terms[i])) {
+            query->sparse_terms |= 1u << i;
+        } else {
+            query->bloom_filter |= ecs_bloom_bit(terms[i]);
+        }
 
         u32 field_bit = 1u << i;
         query->read_fields |= field_bit;
@@ -757,13 +1523,18 @@ void ecs_query_init_terms(EcsQuery *query, EcsWorld *world, EcsTerm *terms, i32
     query->world = world;
     query->term_count = term_count;
     query->is_cached = false;
-    query->cache.first = NULL;
-    query->cache.last = NULL;
-    query->cache.match_count = 0;
+    query->cache = (EcsQueryCache){0};
+    query->group_by = NULL;
+    query->group_by_id = 0;
+    query->group_by_ctx = NULL;
+    query->order_by = NULL;
+    query->order_by_component = 0;
 
     query->bloom_filter = 0;
     query->read_fields = 0;
     query->write_fields = 0;
+    query->changed_fields = 0;
+    query->sparse_terms = 0;
 
     i32 field_index = 0;
     for (i32 i = 0; i < term_count; i++) {
@@ -786,11 +1557,18 @@ void ecs_query_init_terms(EcsQuery *query, EcsWorld *world, EcsTerm *terms, i32
             if (inout != EcsIn && inout != EcsInOutNone) {
                 query->write_fields |= field_bit;
             }
+            if (terms[i].changed) {
+                query->changed_fields |= field_bit;
+            }
 
             field_index++;
         }
 
-        if (terms[i].oper == EcsOperAnd) {
+        if (ecs_component_sparse(world, terms[i].id)) {
+            debug_assert_msg(terms[i].oper != EcsOperOr && !terms[i].changed,
+                "sparse components can't be in or chains or changed-only terms");
+            query->sparse_terms |= 1u << i;
+        } else if (terms[i].oper == EcsOperAnd) {
             query->bloom_filter |= ecs_bloom_bit(terms[i].id);
         }
     }
@@ -803,7 +1581,7 @@ internal i32 ecs_query_find_pivot_term(EcsQuery *query) {
 
     for (i32 i = 0; i < query->term_count; i++) {
         EcsTerm *term = &query->terms[i];
-        if (term->oper == EcsOperAnd) {
+        if (term->oper == EcsOperAnd && !(query->sparse_terms & (1u << i))) {
             EcsComponentRecord *cr = ecs_component_record_get(query->world, term->id);
             i32 table_count = cr ? cr->table_count : 0;
             if (table_count < min_tables) {
@@ -824,7 +1602,8 @@ internal i32 ecs_query_find_pivot_term(EcsQuery *query) {
         }
     }
 
-    return 0;
+    // no term narrows the tables down, e.g. only sparse ones
+    return -1;
 }
 
 EcsIter ecs_query_iter(EcsQuery *query) {
@@ -837,6 +1616,8 @@ EcsIter ecs_query_iter(EcsQuery *query) {
     it.entities = NULL;
     it.cur = NULL;
     it.cache_cur = NULL;
+    it.cache_index = 0;
+    it.cache_end = -1;
     it.set_fields = 0;
     it.delta_time = 0.0f;
     it.ctx = NULL;
@@ -845,12 +1626,70 @@ EcsIter ecs_query_iter(EcsQuery *query) {
         it.columns[i] = -1;
     }
 
+    // systems iterate from several threads at once, ecs_progress prepares up front instead
+    if (!query->world->deferred) {
+        ecs_query_cache_prepare(query);
+    }
+    it.changed_row = 0;
+    it.changed_since = query->cache.changed_since;
+
     return it;
 }
 
 internal b32 ecs_iter_next_uncached(EcsIter *it);
 internal b32 ecs_iter_next_cached(EcsIter *it);
 
+internal b32 ecs_query_sparse_match(EcsQuery *query, EcsEntity entity) {
+    for (i32 t = 0; t < query->term_count; t++) {
+        if (!(query->sparse_terms & (1u << t))) {
+            continue;
+        }
+        EcsTerm *term = &query->terms[t];
+        if (term->oper == EcsOperOptional) {
+            continue;
+        }
+        b32 has = ecs_sparse_has(ecs_component_sparse(query->world, term->id), entity);
+        if (has != (term->oper == EcsOperAnd)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// splits each table run into the runs of rows that pass every sparse term
+internal b32 ecs_iter_next_sparse(EcsIter *it) {
+    EcsQuery *query = it->query;
+
+    for (;;) {
+        if (it->sparse_row >= it->sparse_end) {
+            b32 next = query->is_cached ? ecs_iter_next_cached(it) : ecs_iter_next_uncached(it);
+            if (!next) {
+                return false;
+            }
+            it->sparse_row = it->offset;
+            it->sparse_end = it->offset + it->count;
+        }
+
+        EcsEntity *entities = it->table->data.entities;
+        i32 row = it->sparse_row;
+        while (row < it->sparse_end && !ecs_query_sparse_match(query, entities[row])) {
+            row++;
+        }
+        i32 end = row;
+        while (end < it->sparse_end && ecs_query_sparse_match(query, entities[end])) {
+            end++;
+        }
+        it->sparse_row = end;
+
+        if (row < end) {
+            it->offset = row;
+            it->count = end - row;
+            it->entities = entities + row;
+            return true;
+        }
+    }
+}
+
 b32 ecs_iter_next(EcsIter *it) {
     EcsQuery *query = it->query;
 
@@ -858,6 +1697,10 @@ b32 ecs_iter_next(EcsIter *it) {
         return false;
     }
 
+    if (query->sparse_terms) {
+        return ecs_iter_next_sparse(it);
+    }
+
     if (query->is_cached) {
         return ecs_iter_next_cached(it);
     }
@@ -865,11 +1708,36 @@ b32 ecs_iter_next(EcsIter *it) {
     return ecs_iter_next_uncached(it);
 }
 
+// walks every table of the store like ecs_query_cache_populate
+internal b32 ecs_iter_next_uncached_store(EcsIter *it) {
+    EcsQuery *query = it->query;
+    EcsWorld *world = it->world;
+
+    while (it->store_index < world->store.table_count) {
+        EcsTable *table = ecs_store_get_table(world, it->store_index++);
+        if (table->data.count == 0) {
+            continue;
+        }
+        if (ecs_query_table_matches(query, table, it->columns, &it->set_fields)) {
+            it->table = table;
+            it->offset = 0;
+            it->count = table->data.count;
+            it->entities = table->data.entities;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 internal b32 ecs_iter_next_uncached(EcsIter *it) {
     EcsQuery *query = it->query;
     EcsWorld *world = it->world;
 
     i32 pivot_term = ecs_query_find_pivot_term(query);
+    if (pivot_term < 0) {
+        return ecs_iter_next_uncached_store(it);
+    }
     EcsTerm *first_term = &query->terms[pivot_term];
 
     EcsComponentRecord *cr_first = ecs_component_record_get(world, first_term->id);
@@ -905,7 +1773,7 @@ internal b32 ecs_iter_next_uncached(EcsIter *it) {
         }
 
         for (i32 t = 0; t < query->term_count && match; t++) {
-            if (t == pivot_term) {
+            if (t == pivot_term || (query->sparse_terms & (1u << t))) {
                 continue;
             }
 
@@ -985,6 +1853,7 @@ internal b32 ecs_iter_next_uncached(EcsIter *it) {
         if (match) {
             it->cur = tr;
             it->table = table;
+            it->offset = 0;
             it->count = table->data.count;
             it->entities = table->data.entities;
             it->set_fields = set_fields;
@@ -1001,6 +1870,11 @@ void* ecs_iter_field(EcsIter *it, i32 field_index) {
     debug_assert(field_index >= 0 && field_index < it->query->field_count);
     debug_assert(it->table != NULL);
 
+    if (it->cache_cur) {
+        EcsColumn *column = it->cache_cur->field_columns[field_index];
+        return column ? (u8 *)column->data + ((size_t)it->offset * it->cache_cur->field_sizes[field_index]) : NULL;
+    }
+
     i16 column = it->columns[field_index];
     if (column < 0) {
         return NULL;
@@ -1029,6 +1903,10 @@ b32 ecs_query_table_matches(EcsQuery *query, EcsTable *table, i16 *out_columns,
     *out_set_fields = 0;
 
     for (i32 t = 0; t < query->term_count; t++) {
+        if (query->sparse_terms & (1u << t)) {
+            continue;
+        }
+
         EcsTerm *term = &query->terms[t];
         EcsComponentRecord *cr = ecs_component_record_get(world, term->id);
         b32 has_component = false;
@@ -1106,9 +1984,7 @@ b32 ecs_query_table_matches(EcsQuery *query, EcsTable *table, i16 *out_columns,
 void ecs_query_cache_init(EcsQuery *query) {
     EcsWorld *world = query->world;
 
-    query->cache.first = NULL;
-    query->cache.last = NULL;
-    query->cache.match_count = 0;
+    query->cache = (EcsQueryCache){0};
     query->is_cached = true;
 
     if (world->cached_query_count >= world->cached_query_cap) {
@@ -1126,6 +2002,61 @@ void ecs_query_cache_init(EcsQuery *query) {
     ecs_query_cache_populate(query);
 }
 
+// swaps two matches and repoints their tables' back references
+internal void ecs_query_cache_swap(EcsQuery *query, i32 a, i32 b) {
+    if (a == b) {
+        return;
+    }
+
+    EcsQueryCacheMatch *matches = query->cache.matches;
+    EcsQueryCacheMatch tmp = matches[a];
+    matches[a] = matches[b];
+    matches[b] = tmp;
+
+    matches[a].table->cache_refs[matches[a].ref_index].match_index = a;
+    matches[b].table->cache_refs[matches[b].ref_index].match_index = b;
+}
+
+// called when a table gains its first row or loses its last one
+internal void ecs_table_cache_activate(EcsTable *table, b32 active) {
+    for (i32 i = 0; i < table->cache_ref_count; i++) {
+        EcsTableCacheRef *ref = &table->cache_refs[i];
+        EcsQueryCache *cache = &ref->query->cache;
+        b32 is_active = ref->match_index < cache->active_count;
+
+        cache->order_dirty |= active != is_active;
+        if (active && !is_active) {
+            ecs_query_cache_swap(ref->query, ref->match_index, cache->active_count);
+            cache->active_count++;
+        } else if (!active && is_active) {
+            cache->active_count--;
+            ecs_query_cache_swap(ref->query, ref->match_index, cache->active_count);
+        }
+    }
+}
+
+// sorting is physical, two orders on one table undo each other and it's re-sorted every prepare
+internal void ecs_query_cache_check_order(EcsQuery *query, EcsTable *table) {
+    EcsQueryCache *cache = &query->cache;
+    if (!query->order_by || cache->order_conflict) {
+        return;
+    }
+    for (i32 r = 0; r < table->cache_ref_count; r++) {
+        EcsQuery *other = table->cache_refs[r].query;
+        if (other == query || !other->order_by) {
+            continue;
+        }
+        if (other->order_by != query->order_by || other->order_by_component != query->order_by_component) {
+            cache->order_conflict = true;
+            LOG_WARN("ecs query: ordered by component % but another cached query orders table % by component % "
+                     "another way, it's re-sorted every frame",
+                     FMT_UINT(query->order_by_component), FMT_UINT(table->id),
+                     FMT_UINT(other->order_by_component));
+            return;
+        }
+    }
+}
+
 void ecs_query_cache_add_table(EcsQuery *query, EcsTable *table) {
     i16 columns[ECS_QUERY_MAX_TERMS];
     u32 set_fields;
@@ -1135,90 +2066,552 @@ void ecs_query_cache_add_table(EcsQuery *query, EcsTable *table) {
     }
 
     EcsWorld *world = query->world;
-    EcsQueryCacheMatch *match = ARENA_ALLOC(world->arena, EcsQueryCacheMatch);
+    EcsQueryCache *cache = &query->cache;
+
+    if (cache->match_count >= cache->match_cap) {
+        i32 new_cap = cache->match_cap == 0 ? 16 : cache->match_cap * 2;
+        EcsQueryCacheMatch *new_matches = ARENA_ALLOC_ARRAY(world->arena, EcsQueryCacheMatch, new_cap);
+        if (cache->matches) {
+            memcpy(new_matches, cache->matches, sizeof(EcsQueryCacheMatch) * cache->match_count);
+        }
+        cache->matches = new_matches;
+        cache->match_cap = new_cap;
+    }
+
+    if (table->cache_ref_count >= table->cache_ref_cap) {
+        i32 new_cap = table->cache_ref_cap == 0 ? 4 : table->cache_ref_cap * 2;
+        EcsTableCacheRef *new_refs = ARENA_ALLOC_ARRAY(world->arena, EcsTableCacheRef, new_cap);
+        if (table->cache_refs) {
+            memcpy(new_refs, table->cache_refs, sizeof(EcsTableCacheRef) * table->cache_ref_count);
+        }
+        table->cache_refs = new_refs;
+        table->cache_ref_cap = new_cap;
+    }
+
+    i32 index = cache->match_count++;
+    EcsQueryCacheMatch *match = &cache->matches[index];
+    memset(match, 0, sizeof(EcsQueryCacheMatch));
     match->table = table;
     memcpy(match->columns, columns, sizeof(columns));
     match->set_fields = set_fields;
-    match->next = NULL;
+
+    for (i32 i = 0; i < query->field_count; i++) {
+        if (columns[i] >= 0) {
+            EcsColumn *column = &table->data.columns[columns[i]];
+            match->field_columns[i] = column;
+            match->field_sizes[i] = column->ti->size;
+        }
+    }
 
     i32 monitor_count = 1 + table->column_count;
-    match->monitor = ARENA_ALLOC_ARRAY(world->arena, i32, monitor_count);
-    memcpy(match->monitor, table->dirty_state, sizeof(i32) * monitor_count);
+    match->monitor = ARENA_ALLOC_ARRAY(world->arena, u32, monitor_count);
+    memcpy(match->monitor, table->dirty_state, sizeof(u32) * monitor_count);
 
-    if (query->cache.last) {
-        query->cache.last->next = match;
-    } else {
-        query->cache.first = match;
+    if (query->group_by) {
+        match->group_id = query->group_by(world, table, query->group_by_id, query->group_by_ctx);
     }
-    query->cache.last = match;
-    query->cache.match_count++;
-}
-
-void ecs_query_cache_remove_table(EcsQuery *query, EcsTable *table) {
-    EcsQueryCacheMatch *prev = NULL;
-    EcsQueryCacheMatch *cur = query->cache.first;
+    cache->order_dirty = true;
 
-    while (cur) {
-        if (cur->table == table) {
-            if (prev) {
-                prev->next = cur->next;
-            } else {
-                query->cache.first = cur->next;
-            }
+    ecs_query_cache_check_order(query, table);
 
-            if (cur == query->cache.last) {
-                query->cache.last = prev;
-            }
+    match->ref_index = table->cache_ref_count;
+    table->cache_refs[table->cache_ref_count++] = (EcsTableCacheRef){ query, index };
 
-            query->cache.match_count--;
-            return;
-        }
-        prev = cur;
-        cur = cur->next;
+    // appended past the active part, moved across if the table already has rows
+    if (table->data.count > 0) {
+        ecs_query_cache_swap(query, index, cache->active_count);
+        cache->active_count++;
     }
 }
 
-void ecs_query_cache_populate(EcsQuery *query) {
-    EcsWorld *world = query->world;
+void ecs_query_cache_remove_table(EcsQuery *query, EcsTable *table) {
+    EcsQueryCache *cache = &query->cache;
 
-    query->cache.first = NULL;
-    query->cache.last = NULL;
-    query->cache.match_count = 0;
+    i32 ref_index = -1;
+    for (i32 i = 0; i < table->cache_ref_count; i++) {
+        if (table->cache_refs[i].query == query) {
+            ref_index = i;
+            break;
+        }
+    }
+    if (ref_index < 0) {
+        return;
+    }
 
+    i32 index = table->cache_refs[ref_index].match_index;
+    if (index < cache->active_count) {
+        cache->active_count--;
+        ecs_query_cache_swap(query, index, cache->active_count);
+        index = cache->active_count;
+    }
+    ecs_query_cache_swap(query, index, cache->match_count - 1);
+    cache->match_count--;
+    cache->order_dirty = true;
+
+    // swap remove the back reference, the ref that takes its place gets its match repointed
+    i32 last_ref = --table->cache_ref_count;
+    if (ref_index != last_ref) {
+        EcsTableCacheRef moved = table->cache_refs[last_ref];
+        table->cache_refs[ref_index] = moved;
+        moved.query->cache.matches[moved.match_index].ref_index = ref_index;
+    }
+}
+
+void ecs_query_cache_populate(EcsQuery *query) {
+    EcsWorld *world = query->world;
+
+    query->cache.match_count = 0;
+    query->cache.active_count = 0;
+
+    // empty tables are matched too, they sit in the inactive part until they get rows
     for (i32 i = 0; i < world->store.table_count; i++) {
         EcsTable *table = ecs_store_get_table(world, i);
-        if (table->data.count == 0) {
+        ecs_query_cache_add_table(query, table);
+    }
+}
+
+void ecs_query_group_by(EcsQuery *query, EcsEntity group_id, EcsGroupByCallback callback, void *ctx) {
+    debug_assert_msg(!query->is_cached, "group_by must be set before ecs_query_cache_init");
+    query->group_by = callback;
+    query->group_by_id = group_id;
+    query->group_by_ctx = ctx;
+}
+
+void ecs_query_order_by(EcsQuery *query, EcsEntity component, EcsOrderByCallback compare) {
+    debug_assert_msg(!query->is_cached, "order_by must be set before ecs_query_cache_init");
+    debug_assert(ecs_entity_index(component) < ECS_HI_COMPONENT_ID);
+    query->order_by = compare;
+    query->order_by_component = component;
+}
+
+typedef struct EcsSortRow {
+    i32 match_index;
+    i32 row;
+    EcsEntity entity;
+    const void *ptr;
+} EcsSortRow;
+
+force_inline b32 ecs_sort_row_less(EcsOrderByCallback compare, const EcsSortRow *a, const EcsSortRow *b) {
+    return compare(a->entity, a->ptr, b->entity, b->ptr) < 0;
+}
+
+// merges neighbouring sorted runs until one is left. runs[] holds run starts, runs[run_count] == count
+internal EcsSortRow* ecs_sort_rows_merge(EcsOrderByCallback compare, EcsSortRow *rows, EcsSortRow *scratch,
+                                         i32 *runs, i32 run_count) {
+    EcsSortRow *src = rows;
+    EcsSortRow *dst = scratch;
+
+    while (run_count > 1) {
+        i32 merged = 0;
+        for (i32 r = 0; r < run_count; r += 2) {
+            i32 lo = runs[r];
+            i32 mid = runs[r + 1];
+            i32 hi = r + 2 <= run_count ? runs[r + 2] : mid;
+            i32 a = lo, b = mid, out = lo;
+            while (a < mid && b < hi) {
+                dst[out++] = ecs_sort_row_less(compare, &src[b], &src[a]) ? src[b++] : src[a++];
+            }
+            while (a < mid) dst[out++] = src[a++];
+            while (b < hi) dst[out++] = src[b++];
+            runs[merged++] = lo;
+        }
+        runs[merged] = runs[run_count];
+        run_count = merged;
+
+        EcsSortRow *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    return src;
+}
+
+// physically reorders a table's rows by the order_by component, records follow their rows
+internal void ecs_table_sort_rows(EcsWorld *world, EcsTable *table, EcsEntity component, EcsOrderByCallback compare) {
+    i32 count = table->data.count;
+    if (count < 2) {
+        return;
+    }
+
+    ArenaAllocator *temp = &tctx_current()->temp_arena;
+    i32 col = ecs_table_get_column_index(table, component);
+    EcsColumn *order_column = col >= 0 ? &table->data.columns[col] : NULL;
+
+    // natural merge sort: rows appended or changed since the last sort break the table into a
+    // few ascending runs, an untouched table is a single run and costs one compare per row
+    EcsSortRow *rows = ARENA_ALLOC_ARRAY(temp, EcsSortRow, count);
+    i32 *runs = ARENA_ALLOC_ARRAY(temp, i32, count + 1);
+    i32 run_count = 0;
+    for (i32 i = 0; i < count; i++) {
+        rows[i].match_index = 0;
+        rows[i].row = i;
+        rows[i].entity = table->data.entities[i];
+        rows[i].ptr = order_column ? (u8*)order_column->data + ((size_t)order_column->ti->size * i) : NULL;
+        if (i == 0 || ecs_sort_row_less(compare, &rows[i], &rows[i - 1])) {
+            runs[run_count++] = i;
+        }
+    }
+    if (run_count == 1) {
+        return;
+    }
+    runs[run_count] = count;
+
+    EcsSortRow *scratch = ARENA_ALLOC_ARRAY(temp, EcsSortRow, count);
+    EcsSortRow *order = ecs_sort_rows_merge(compare, rows, scratch, runs, run_count);
+
+    EcsEntity *entities = ARENA_ALLOC_ARRAY(temp, EcsEntity, count);
+    for (i32 i = 0; i < count; i++) {
+        entities[i] = order[i].entity;
+    }
+    memcpy(table->data.entities, entities, sizeof(EcsEntity) * count);
+
+    for (i32 c = 0; c < table->column_count; c++) {
+        EcsColumn *column = &table->data.columns[c];
+        const EcsTypeInfo *ti = column->ti;
+        u8 *staging = ARENA_ALLOC_ARRAY(temp, u8, (size_t)ti->size * count);
+        for (i32 i = 0; i < count; i++) {
+            ecs_type_move(ti, staging + ((size_t)ti->size * i), (u8*)column->data + ((size_t)ti->size * order[i].row), 1);
+        }
+        ecs_type_move(ti, column->data, staging, count);
+    }
+
+    for (i32 i = 0; i < count; i++) {
+        EcsRecord *record = ecs_entity_get_record(world, table->data.entities[i]);
+        if (record) {
+            record->row = (u32)i;
+        }
+    }
+
+    ecs_table_stamp(world, table, 0, 0, count);
+}
+
+internal void ecs_query_cache_build_groups(EcsQueryCache *cache, i32 walk_count, u64 (*group_of)(EcsQueryCache *, i32)) {
+    cache->group_count = 0;
+    for (i32 i = 0; i < walk_count; i++) {
+        u64 id = group_of(cache, i);
+        if (cache->group_count > 0 && cache->groups[cache->group_count - 1].id == id) {
+            cache->groups[cache->group_count - 1].count++;
             continue;
         }
-        ecs_query_cache_add_table(query, table);
+        debug_assert(cache->group_count < cache->group_cap);
+        cache->groups[cache->group_count++] = (EcsQueryGroup){ id, i, 1 };
     }
 }
 
-internal b32 ecs_iter_next_cached(EcsIter *it) {
-    EcsQueryCacheMatch *match = it->cache_cur ? it->cache_cur->next : it->query->cache.first;
+internal u64 ecs_query_order_group(EcsQueryCache *cache, i32 i) {
+    return cache->matches[cache->order[i]].group_id;
+}
 
-    while (match) {
-        if (match->table->data.count > 0) {
-            it->cache_cur = match;
-            it->table = match->table;
-            it->count = match->table->data.count;
-            it->entities = match->table->data.entities;
-            memcpy(it->columns, match->columns, sizeof(match->columns));
-            it->set_fields = match->set_fields;
+internal u64 ecs_query_slice_group(EcsQueryCache *cache, i32 i) {
+    return cache->matches[cache->slices[i].match_index].group_id;
+}
+
+void ecs_query_cache_prepare(EcsQuery *query) {
+    if (!query->is_cached) {
+        return;
+    }
+
+    EcsWorld *world = query->world;
+    EcsQueryCache *cache = &query->cache;
+
+    // a run sees every stamp after the previous prepare, including the ones earlier systems of the
+    // same frame make while it waits. those show up again the next run: yielded twice, never missed
+    if (query->changed_fields) {
+        debug_assert_msg(!query->order_by, "changed-only terms can't be combined with order_by");
+        cache->changed_since = cache->changed_mark;
+        cache->changed_mark = world->change_tick;
+    }
+
+    if (!query->group_by && !query->order_by) {
+        return;
+    }
+
+    b32 rebuild = cache->order_dirty;
+
+    if (query->order_by) {
+        for (i32 m = 0; m < cache->active_count; m++) {
+            EcsQueryCacheMatch *match = &cache->matches[m];
+            EcsTable *table = match->table;
+            i32 col = ecs_table_get_column_index(table, query->order_by_component);
+            u32 col_state = col >= 0 ? table->dirty_state[col + 1] : 0;
+
+            // only tables whose rows or sort column changed since the last prepare are touched
+            if (match->sorted_state[0] == table->dirty_state[0] && match->sorted_state[1] == col_state) {
+                continue;
+            }
+            ecs_table_sort_rows(world, table, query->order_by_component, query->order_by);
+            match->sorted_state[0] = table->dirty_state[0];
+            match->sorted_state[1] = col_state;
+            rebuild = true;
+        }
+    }
+
+    if (!rebuild) {
+        return;
+    }
+    cache->order_dirty = false;
+
+    i32 active = cache->active_count;
+    if (cache->order_cap < active) {
+        i32 new_cap = cache->order_cap == 0 ? 16 : cache->order_cap;
+        while (new_cap < active) {
+            new_cap *= 2;
+        }
+        cache->order = ARENA_ALLOC_ARRAY(world->arena, i32, new_cap);
+        cache->groups = ARENA_ALLOC_ARRAY(world->arena, EcsQueryGroup, new_cap);
+        cache->order_cap = new_cap;
+        cache->group_cap = new_cap;
+    }
+
+    // active matches by (group, table id), so iteration order doesn't depend on activation history
+    ArenaAllocator *temp = &tctx_current()->temp_arena;
+    EcsSortItem *items = ARENA_ALLOC_ARRAY(temp, EcsSortItem, active);
+    EcsSortItem *scratch = ARENA_ALLOC_ARRAY(temp, EcsSortItem, active);
+    for (i32 m = 0; m < active; m++) {
+        items[m].key = cache->matches[m].table->id;
+        items[m].value = m;
+    }
+    ecs_sort_items(items, scratch, active);
+    for (i32 m = 0; m < active; m++) {
+        items[m].key = cache->matches[items[m].value].group_id;
+    }
+    ecs_sort_items(items, scratch, active);
+    for (i32 m = 0; m < active; m++) {
+        cache->order[m] = items[m].value;
+    }
+
+    if (!query->order_by) {
+        ecs_query_cache_build_groups(cache, active, ecs_query_order_group);
+        return;
+    }
+
+    // merge the sorted tables of each group into slices, runs of rows that come from one table
+    i32 total = 0;
+    for (i32 m = 0; m < active; m++) {
+        total += cache->matches[m].table->data.count;
+    }
+
+    EcsSortRow *rows = ARENA_ALLOC_ARRAY(temp, EcsSortRow, total);
+    EcsSortRow *row_scratch = ARENA_ALLOC_ARRAY(temp, EcsSortRow, total);
+    i32 *runs = ARENA_ALLOC_ARRAY(temp, i32, active + 1);
+
+    if (cache->slice_cap < total) {
+        i32 new_cap = cache->slice_cap == 0 ? 16 : cache->slice_cap;
+        while (new_cap < total) {
+            new_cap *= 2;
+        }
+        cache->slices = ARENA_ALLOC_ARRAY(world->arena, EcsQuerySlice, new_cap);
+        cache->slice_cap = new_cap;
+    }
+    cache->slice_count = 0;
+
+    for (i32 start = 0; start < active;) {
+        u64 group = cache->matches[cache->order[start]].group_id;
+        i32 end = start;
+        i32 row_count = 0;
+        i32 run_count = 0;
+
+        while (end < active && cache->matches[cache->order[end]].group_id == group) {
+            i32 m = cache->order[end];
+            EcsTable *table = cache->matches[m].table;
+            i32 col = ecs_table_get_column_index(table, query->order_by_component);
+            EcsColumn *column = col >= 0 ? &table->data.columns[col] : NULL;
+
+            runs[run_count++] = row_count;
+            for (i32 r = 0; r < table->data.count; r++) {
+                EcsSortRow *row = &rows[row_count++];
+                row->match_index = m;
+                row->row = r;
+                row->entity = table->data.entities[r];
+                row->ptr = column ? (u8*)column->data + ((size_t)column->ti->size * r) : NULL;
+            }
+            end++;
+        }
+        runs[run_count] = row_count;
+
+        EcsSortRow *sorted = ecs_sort_rows_merge(query->order_by, rows, row_scratch, runs, run_count);
+        for (i32 i = 0; i < row_count; i++) {
+            EcsQuerySlice *last = cache->slice_count > 0 ? &cache->slices[cache->slice_count - 1] : NULL;
+            if (last && last->match_index == sorted[i].match_index && last->offset + last->count == sorted[i].row) {
+                last->count++;
+            } else {
+                cache->slices[cache->slice_count++] = (EcsQuerySlice){ sorted[i].match_index, sorted[i].row, 1 };
+            }
+        }
+
+        start = end;
+    }
+
+    if (cache->group_cap < cache->slice_count) {
+        cache->groups = ARENA_ALLOC_ARRAY(world->arena, EcsQueryGroup, cache->slice_count);
+        cache->group_cap = cache->slice_count;
+    }
+    ecs_query_cache_build_groups(cache, cache->slice_count, ecs_query_slice_group);
+}
+
+void ecs_iter_set_group(EcsIter *it, u64 group_id) {
+    EcsQueryCache *cache = &it->query->cache;
+    debug_assert(it->query->is_cached && it->query->group_by);
+
+    // groups are sorted by id
+    i32 lo = 0;
+    i32 hi = cache->group_count;
+    while (lo < hi) {
+        i32 mid = (lo + hi) / 2;
+        if (cache->groups[mid].id < group_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < cache->group_count && cache->groups[lo].id == group_id) {
+        it->cache_index = cache->groups[lo].first;
+        it->cache_end = cache->groups[lo].first + cache->groups[lo].count;
+    } else {
+        it->cache_index = 0;
+        it->cache_end = 0;
+    }
+}
+
+// slot 0 counts for every changed-only query: added or moved rows are new to it
+internal b32 ecs_query_block_changed(EcsQuery *query, EcsQueryCacheMatch *match, i32 block, u32 since) {
+    EcsTable *table = match->table;
+    if (table->block_ticks[block] > since) {
+        return true;
+    }
+
+    u32 fields = query->changed_fields & match->set_fields;
+    for (i32 i = 0; i < query->field_count; i++) {
+        i32 column = match->columns[i];
+        if ((fields & (1u << i)) && column >= 0 &&
+            table->block_ticks[(size_t)(column + 1) * table->block_cap + block] > since) {
             return true;
         }
-        match = match->next;
     }
+    return false;
+}
 
+// dirty_state holds the newest stamp per slot, a table with nothing newer than since has no block to look at
+internal b32 ecs_query_table_changed(EcsQuery *query, EcsQueryCacheMatch *match, u32 since) {
+    EcsTable *table = match->table;
+    if (table->dirty_state[0] > since) {
+        return true;
+    }
+
+    u32 fields = query->changed_fields & match->set_fields;
+    for (i32 i = 0; i < query->field_count; i++) {
+        i32 column = match->columns[i];
+        if ((fields & (1u << i)) && column >= 0 && table->dirty_state[column + 1] > since) {
+            return true;
+        }
+    }
     return false;
 }
 
-void ecs_table_mark_dirty(EcsTable *table, i32 column) {
-    if (table->dirty_state && column >= 0) {
-        table->dirty_state[column + 1]++;
+// one run of adjacent changed blocks per call, in the same match order as the unfiltered walk
+internal b32 ecs_iter_next_changed(EcsIter *it) {
+    EcsQuery *query = it->query;
+    EcsQueryCache *cache = &query->cache;
+    u32 since = it->changed_since;
+
+    for (;;) {
+        EcsQueryCacheMatch *match = it->cache_cur;
+        if (!match || it->changed_row >= match->table->data.count) {
+            if (it->cache_index >= it->cache_end) {
+                return false;
+            }
+            i32 index = it->cache_index++;
+            match = &cache->matches[query->group_by ? cache->order[index] : index];
+            it->cache_cur = match;
+            it->changed_row = ecs_query_table_changed(query, match, since) ? 0 : match->table->data.count;
+            continue;
+        }
+
+        EcsTable *table = match->table;
+        i32 count = table->data.count;
+        i32 block_rows = table->block_rows;
+        i32 row = it->changed_row;
+        while (row < count && !ecs_query_block_changed(query, match, row / block_rows, since)) {
+            row = (row / block_rows + 1) * block_rows;
+        }
+        i32 end = row;
+        while (end < count && ecs_query_block_changed(query, match, end / block_rows, since)) {
+            end = (end / block_rows + 1) * block_rows;
+        }
+        end = MIN(end, count);
+        it->changed_row = end;
+        if (row >= end) {
+            continue;
+        }
+
+        it->table = table;
+        it->offset = row;
+        it->count = end - row;
+        it->entities = table->data.entities + row;
+        memcpy(it->columns, match->columns, sizeof(match->columns));
+        it->set_fields = match->set_fields;
+        return true;
     }
 }
 
+internal b32 ecs_iter_next_cached(EcsIter *it) {
+    EcsQuery *query = it->query;
+    EcsQueryCache *cache = &query->cache;
+
+    if (it->cache_end < 0) {
+        it->cache_end = query->order_by ? cache->slice_count : cache->active_count;
+    }
+    if (query->changed_fields) {
+        return ecs_iter_next_changed(it);
+    }
+    if (it->cache_index >= it->cache_end) {
+        return false;
+    }
+
+    i32 index = it->cache_index++;
+    i32 offset = 0;
+    i32 count;
+    EcsQueryCacheMatch *match;
+
+    if (query->order_by) {
+        EcsQuerySlice *slice = &cache->slices[index];
+        match = &cache->matches[slice->match_index];
+        offset = slice->offset;
+        count = slice->count;
+    } else {
+        match = &cache->matches[query->group_by ? cache->order[index] : index];
+        count = match->table->data.count;
+    }
+    debug_assert(match->table->data.count > 0);
+
+    it->cache_cur = match;
+    it->table = match->table;
+    it->offset = offset;
+    it->count = count;
+    it->entities = match->table->data.entities + offset;
+    memcpy(it->columns, match->columns, sizeof(match->columns));
+    it->set_fields = match->set_fields;
+    return true;
+}
+
+void ecs_table_mark_dirty(EcsWorld *world, EcsTable *table, i32 column) {
+    if (column >= 0) {
+        ecs_table_stamp(world, table, column + 1, 0, table->data.count);
+    }
+}
+
+void ecs_table_mark_dirty_rows(EcsWorld *world, EcsTable *table, i32 column, i32 row, i32 count) {
+    if (column >= 0) {
+        ecs_table_stamp(world, table, column + 1, row, count);
+    }
+}
+
+void ecs_iter_mark_dirty(EcsIter *it, i32 field_index) {
+    debug_assert(field_index >= 0 && field_index < ECS_QUERY_MAX_TERMS);
+    ecs_table_mark_dirty_rows(it->world, it->table, it->columns[field_index], it->offset, it->count);
+}
+
 internal b32 ecs_query_match_changed(EcsQuery *query, EcsQueryCacheMatch *match) {
     EcsTable *table = match->table;
 
@@ -1247,8 +2640,9 @@ b32 ecs_query_changed(EcsQuery *query) {
         return true;
     }
 
-    for (EcsQueryCacheMatch *m = query->cache.first; m; m = m->next) {
-        if (ecs_query_match_changed(query, m)) {
+    // inactive matches count too, emptying a table is a change
+    for (i32 i = 0; i < query->cache.match_count; i++) {
+        if (ecs_query_match_changed(query, &query->cache.matches[i])) {
             return true;
         }
     }
@@ -1267,7 +2661,7 @@ b32 ecs_iter_changed(EcsIter *it) {
 internal void ecs_query_match_sync(EcsQueryCacheMatch *match) {
     EcsTable *table = match->table;
     i32 count = 1 + table->column_count;
-    memcpy(match->monitor, table->dirty_state, sizeof(i32) * count);
+    memcpy(match->monitor, table->dirty_state, sizeof(u32) * count);
 }
 
 void ecs_query_sync(EcsQuery *query) {
@@ -1275,8 +2669,8 @@ void ecs_query_sync(EcsQuery *query) {
         return;
     }
 
-    for (EcsQueryCacheMatch *m = query->cache.first; m; m = m->next) {
-        ecs_query_match_sync(m);
+    for (i32 i = 0; i < query->cache.match_count; i++) {
+        ecs_query_match_sync(&query->cache.matches[i]);
     }
 }
 
@@ -1286,25 +2680,245 @@ void ecs_iter_sync(EcsIter *it) {
     }
 }
 
+force_inline i32 ecs_system_graph_words(EcsWorld *world) {
+    return world->system_graph_cap >> 6;
+}
+
+force_inline b32 ecs_bitset_test(const u64 *bits, i32 bit) {
+    return (b32)((bits[bit >> 6] >> (bit & 63)) & 1);
+}
+
+force_inline void ecs_bitset_set(u64 *bits, i32 bit) {
+    bits[bit >> 6] |= 1ull << (bit & 63);
+}
+
+internal void ecs_system_graph_reserve(EcsWorld *world, i32 system_count) {
+    if (system_count <= world->system_graph_cap) {
+        return;
+    }
+
+    i32 old_words = ecs_system_graph_words(world);
+    i32 new_cap = world->system_graph_cap == 0 ? 64 : world->system_graph_cap * 2;
+    while (new_cap < system_count) {
+        new_cap *= 2;
+    }
+    i32 new_words = new_cap >> 6;
+    size_t bits_size = sizeof(u64) * (size_t)new_cap * new_words;
+
+    u64 *hazards = ARENA_ALLOC_ARRAY(world->arena, u64, (size_t)new_cap * new_words);
+    memset(hazards, 0, bits_size);
+    for (i32 s = 0; s < world->system_graph_cap; s++) {
+        memcpy(&hazards[(size_t)s * new_words], &world->system_hazards[(size_t)s * old_words], sizeof(u64) * old_words);
+    }
+    world->system_hazards = hazards;
+
+    // reach is recomputed from scratch by every reduce
+    world->system_reach_all = ARENA_ALLOC_ARRAY(world->arena, u64, (size_t)new_cap * new_words);
+    world->system_reach_lane = ARENA_ALLOC_ARRAY(world->arena, u64, (size_t)new_cap * new_words);
+    world->system_graph_cap = new_cap;
+}
+
+// both matches of one table touch the same column and at least one side writes it.
+// EcsInOutNone fields and ids without a column never order systems
+internal b32 ecs_system_matches_conflict(EcsQuery *first, EcsQueryCacheMatch *first_match,
+                                         EcsQuery *second, EcsQueryCacheMatch *second_match) {
+    u32 first_fields = first_match->set_fields & (first->read_fields | first->write_fields);
+    u32 second_fields = second_match->set_fields & (second->read_fields | second->write_fields);
+
+    for (i32 a = 0; a < first->field_count; a++) {
+        i16 column = first_match->columns[a];
+        if (!(first_fields & (1u << a)) || column < 0) {
+            continue;
+        }
+        b32 first_writes = (first->write_fields & (1u << a)) != 0;
+
+        for (i32 b = 0; b < second->field_count; b++) {
+            if (!(second_fields & (1u << b)) || second_match->columns[b] != column) {
+                continue;
+            }
+            if (first_writes || (second->write_fields & (1u << b))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+force_inline b32 ecs_query_term_writes(EcsQuery *query, i32 term) {
+    i8 field = query->terms[term].field_index;
+    return field >= 0 && (query->write_fields & (1u << field));
+}
+
+// sparse components have no column for the tables to meet on, a term on one touches the whole set.
+// filters and not terms read membership, only fields declared as written write
+internal b32 ecs_system_sparse_conflict(EcsQuery *first, EcsQuery *second) {
+    for (i32 a = 0; a < first->term_count; a++) {
+        if (!(first->sparse_terms & (1u << a))) {
+            continue;
+        }
+        for (i32 b = 0; b < second->term_count; b++) {
+            if (!(second->sparse_terms & (1u << b)) || second->terms[b].id != first->terms[a].id) {
+                continue;
+            }
+            if (ecs_query_term_writes(first, a) || ecs_query_term_writes(second, b)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// sets the hazard bit of every pair of systems matching table, only pairs ending in system when
+// it's >= 0. returns true when a bit was added
+internal b32 ecs_system_graph_scan_table(EcsWorld *world, EcsTable *table, i32 system) {
+    i32 ref_count = table->cache_ref_count;
+    if (ref_count < 2 || world->system_count < 2) {
+        return false;
+    }
+
+    // owning system of each cached query matching the table, -1 for queries that aren't a system's
+    i32 *owners = ARENA_ALLOC_ARRAY(&tctx_current()->temp_arena, i32, ref_count);
+    for (i32 r = 0; r < ref_count; r++) {
+        owners[r] = -1;
+        for (i32 s = 0; s < world->system_count; s++) {
+            if (&world->systems[s]->query == table->cache_refs[r].query) {
+                owners[r] = s;
+                break;
+            }
+        }
+    }
+
+    i32 words = ecs_system_graph_words(world);
+    b32 added = false;
+    for (i32 a = 0; a < ref_count; a++) {
+        i32 first = owners[a];
+        if (first < 0) {
+            continue;
+        }
+
+        for (i32 b = 0; b < ref_count; b++) {
+            i32 second = owners[b];
+            if (second <= first || (system >= 0 && second != system)) {
+                continue;
+            }
+
+            u64 *row = &world->system_hazards[(size_t)second * words];
+            if (ecs_bitset_test(row, first)) {
+                continue;
+            }
+
+            EcsQuery *first_query = &world->systems[first]->query;
+            EcsQuery *second_query = &world->systems[second]->query;
+            EcsQueryCacheMatch *first_match = &first_query->cache.matches[table->cache_refs[a].match_index];
+            EcsQueryCacheMatch *second_match = &second_query->cache.matches[table->cache_refs[b].match_index];
+            if (ecs_system_matches_conflict(first_query, first_match, second_query, second_match)) {
+                ecs_bitset_set(row, first);
+                added = true;
+            }
+        }
+    }
+
+    return added;
+}
+
+internal void ecs_system_push_dep(EcsWorld *world, EcsSystem *system, EcsSystem *dependency) {
+    if (system->depends_on_count >= system->depends_on_cap) {
+        i32 new_cap = system->depends_on_cap == 0 ? 4 : system->depends_on_cap * 2;
+        EcsSystem **new_deps = ARENA_ALLOC_ARRAY(world->arena, EcsSystem*, new_cap);
+        if (system->depends_on) {
+            memcpy(new_deps, system->depends_on, sizeof(EcsSystem*) * system->depends_on_count);
+        }
+        system->depends_on = new_deps;
+        system->depends_on_cap = new_cap;
+    }
+
+    system->depends_on[system->depends_on_count++] = dependency;
+}
+
+// transitive reduction of the hazard graph into depends_on. edges go from earlier to later systems,
+// so walking a system's hazards from the latest one down, an edge is dropped when a kept edge
+// already orders it. what a wait covers follows ecs_progress: waiting on a single threaded or
+// barrier system waits for all of it (reach_all), waiting on any other system only for its task
+// on the same lane (reach_lane, which includes reach_all)
+internal void ecs_system_graph_reduce(EcsWorld *world) {
+    i32 words = ecs_system_graph_words(world);
+
+    for (i32 j = 0; j < world->system_count; j++) {
+        EcsSystem *sys = world->systems[j];
+        u64 *hazards = &world->system_hazards[(size_t)j * words];
+        u64 *reach_all = &world->system_reach_all[(size_t)j * words];
+        u64 *reach_lane = &world->system_reach_lane[(size_t)j * words];
+        memset(reach_all, 0, sizeof(u64) * words);
+        memset(reach_lane, 0, sizeof(u64) * words);
+        sys->depends_on_count = 0;
+
+        for (i32 i = j - 1; i >= 0; i--) {
+            if (!ecs_bitset_test(hazards, i)) {
+                continue;
+            }
+
+            EcsSystem *dep = world->systems[i];
+            b32 waits_all = dep->thread_mode == ECS_THREAD_SINGLE || dep->sync_mode == ECS_SYNC_BARRIER;
+            if (ecs_bitset_test(waits_all ? reach_all : reach_lane, i)) {
+                continue;
+            }
+
+            ecs_system_push_dep(world, sys, dep);
+
+            u64 *dep_all = &world->system_reach_all[(size_t)i * words];
+            u64 *dep_lane = &world->system_reach_lane[(size_t)i * words];
+            if (waits_all) {
+                // every lane of a multi threaded barrier system finished its lane of dep_lane, a single
+                // threaded one only ran on lane 0
+                const u64 *covered = dep->thread_mode == ECS_THREAD_SINGLE ? dep_all : dep_lane;
+                for (i32 w = 0; w < words; w++) {
+                    reach_all[w] |= covered[w];
+                    reach_lane[w] |= covered[w];
+                }
+                ecs_bitset_set(reach_all, i);
+                ecs_bitset_set(reach_lane, i);
+            } else {
+                for (i32 w = 0; w < words; w++) {
+                    reach_all[w] |= dep_all[w];
+                    reach_lane[w] |= dep_lane[w];
+                }
+                ecs_bitset_set(reach_lane, i);
+            }
+        }
+    }
+}
+
+// called once the cached queries matched a new table
+internal void ecs_system_graph_add_table(EcsWorld *world, EcsTable *table) {
+    if (ecs_system_graph_scan_table(world, table, -1)) {
+        ecs_system_graph_reduce(world);
+    }
+}
+
 EcsSystem* ecs_system_init(EcsWorld *world, const EcsSystemDesc *desc) {
     debug_assert(desc != NULL);
     debug_assert(desc->callback != NULL);
     debug_assert(desc->iter_mode == ECS_ITER_RANGE || desc->term_count > 0);
 
+    // systems are allocated one by one, cached queries and dependents point at them
     if (world->system_count >= world->system_cap) {
         i32 new_cap = world->system_cap == 0 ? 16 : world->system_cap * 2;
-        EcsSystem *new_systems = ARENA_ALLOC_ARRAY(world->arena, EcsSystem, new_cap);
+        EcsSystem **new_systems = ARENA_ALLOC_ARRAY(world->arena, EcsSystem*, new_cap);
         if (world->systems) {
-            memcpy(new_systems, world->systems, sizeof(EcsSystem) * world->system_count);
+            memcpy(new_systems, world->systems, sizeof(EcsSystem*) * world->system_count);
         }
         world->systems = new_systems;
         world->system_cap = new_cap;
     }
+    ecs_system_graph_reserve(world, world->system_count + 1);
 
-    EcsSystem *sys = &world->systems[world->system_count];
+    EcsSystem *sys = ARENA_ALLOC(world->arena, EcsSystem);
     memset(sys, 0, sizeof(EcsSystem));
 
     sys->id = ecs_entity_new(world);
+    sys->index = world->system_count;
     sys->callback = desc->callback;
     sys->ctx = desc->ctx;
     sys->name = desc->name;
@@ -1314,30 +2928,40 @@ EcsSystem* ecs_system_init(EcsWorld *world, const EcsSystemDesc *desc) {
     sys->sync_mode = desc->sync_mode;
     sys->query.world = world;
 
+    world->systems[world->system_count++] = sys;
+
     if (desc->iter_mode == ECS_ITER_QUERY) {
         ecs_query_init_terms(&sys->query, world, desc->terms, desc->term_count);
+        if (desc->order_by) {
+            ecs_query_order_by(&sys->query, desc->order_by_component, desc->order_by);
+        }
         ecs_query_cache_init(&sys->query);
     }
 
-    sys->depends_on = NULL;
-    sys->depends_on_count = 0;
-    sys->depends_on_cap = 0;
-
     ThreadContext *tctx = tctx_current();
     sys->task_handles = ARENA_ALLOC_ARRAY(world->arena, MCRTaskHandle, tctx->thread_count);
     memset(sys->task_handles, 0, sizeof(MCRTaskHandle) * tctx->thread_count);
 
     if (desc->iter_mode == ECS_ITER_QUERY) {
-        for (i32 i = 0; i < world->system_count; i++) {
-            EcsSystem *existing = &world->systems[i];
-            if (ecs_systems_conflict(existing, sys)) {
-                ecs_system_depends_on(sys, existing);
+        b32 added = false;
+        // sparse sets exist before any query on them, their hazards never change
+        if (sys->query.sparse_terms) {
+            u64 *row = &world->system_hazards[(size_t)sys->index * ecs_system_graph_words(world)];
+            for (i32 s = 0; s < sys->index; s++) {
+                if (ecs_system_sparse_conflict(&world->systems[s]->query, &sys->query)) {
+                    ecs_bitset_set(row, s);
+                    added = true;
+                }
             }
         }
+        for (i32 m = 0; m < sys->query.cache.match_count; m++) {
+            added |= ecs_system_graph_scan_table(world, sys->query.cache.matches[m].table, sys->index);
+        }
+        if (added) {
+            ecs_system_graph_reduce(world);
+        }
     }
 
-    world->system_count++;
-
     return sys;
 }
 
@@ -1345,75 +2969,160 @@ EcsSystem* ecs_system_get(EcsWorld *world, i32 index) {
     if (index < 0 || index >= world->system_count) {
         return NULL;
     }
-    return &world->systems[index];
+    return world->systems[index];
 }
 
 void ecs_system_depends_on(EcsSystem *system, EcsSystem *dependency) {
     debug_assert(system != NULL);
     debug_assert(dependency != NULL);
+    debug_assert_msg(dependency->index < system->index, "% must be registered before %",
+        FMT_STR(dependency->name), FMT_STR(system->name));
 
-    if (system->depends_on_count >= system->depends_on_cap) {
-        i32 new_cap = system->depends_on_cap == 0 ? 4 : system->depends_on_cap * 2;
-        if (new_cap > ECS_MAX_SYSTEM_DEPS) {
-            new_cap = ECS_MAX_SYSTEM_DEPS;
-        }
+    EcsWorld *world = system->query.world;
+    ecs_bitset_set(&world->system_hazards[(size_t)system->index * ecs_system_graph_words(world)], dependency->index);
+    ecs_system_graph_reduce(world);
+}
 
-        EcsWorld *world = system->query.world;
-        EcsSystem **new_deps = ARENA_ALLOC_ARRAY(world->arena, EcsSystem*, new_cap);
-        if (system->depends_on) {
-            memcpy(new_deps, system->depends_on, sizeof(EcsSystem*) * system->depends_on_count);
-        }
-        system->depends_on = new_deps;
-        system->depends_on_cap = new_cap;
+b32 ecs_systems_conflict(EcsSystem *first, EcsSystem *second) {
+    if (first->index >= second->index) {
+        return false;
     }
+    EcsWorld *world = second->query.world;
+    return ecs_bitset_test(&world->system_hazards[(size_t)second->index * ecs_system_graph_words(world)], first->index);
+}
 
-    if (system->depends_on_count < ECS_MAX_SYSTEM_DEPS) {
-        system->depends_on[system->depends_on_count++] = dependency;
+i32 ecs_system_graph_critical_path(EcsWorld *world) {
+    if (world->system_count == 0) {
+        return 0;
     }
+
+    i32 *chain = ARENA_ALLOC_ARRAY(&tctx_current()->temp_arena, i32, world->system_count);
+    i32 longest = 0;
+    for (i32 s = 0; s < world->system_count; s++) {
+        EcsSystem *sys = world->systems[s];
+        chain[s] = 1;
+        for (i32 d = 0; d < sys->depends_on_count; d++) {
+            chain[s] = MAX(chain[s], chain[sys->depends_on[d]->index] + 1);
+        }
+        longest = MAX(longest, chain[s]);
+    }
+    return longest;
 }
 
-internal b32 ecs_term_writes(EcsTerm *term) {
-    return term->inout == EcsOut || term->inout == EcsInOut || term->inout == EcsInOutDefault;
+void ecs_system_graph_dump(EcsWorld *world) {
+    char buffer[512];
+    StringBuilder sb;
+
+    for (i32 s = 0; s < world->system_count; s++) {
+        EcsSystem *sys = world->systems[s];
+        sb_init(&sb, buffer, sizeof(buffer));
+        sb_append_format(&sb, "[%] % (%, %):", FMT_INT(s), FMT_STR(sys->name ? sys->name : "?"),
+            FMT_STR(sys->thread_mode == ECS_THREAD_SINGLE ? "single" : "multi"),
+            FMT_STR(sys->sync_mode == ECS_SYNC_BARRIER ? "barrier" : "lane"));
+        for (i32 d = 0; d < sys->depends_on_count; d++) {
+            sb_append_format(&sb, " %", FMT_INT(sys->depends_on[d]->index));
+        }
+        LOG_INFO("%", FMT_STR(sb_get(&sb)));
+    }
+    LOG_INFO("systems: %, critical path: %", FMT_INT(world->system_count),
+             FMT_INT(ecs_system_graph_critical_path(world)));
 }
 
-internal b32 ecs_term_reads(EcsTerm *term) {
-    return term->inout == EcsIn || term->inout == EcsInOut || term->inout == EcsInOutDefault;
+// rows of [offset, offset + count) this lane runs, relative to offset. chunked tables split on chunk
+// boundaries with the lanes rotated by table id, so tables of a chunk or two don't all land on
+// lane 0. only depends on the table and the rows: every system hands a lane the same rows, which
+// the lane local dependencies of ecs_progress rely on
+internal Range_u64 ecs_table_lane_rows(EcsTable *table, i32 offset, i32 count, u32 lane, u32 lane_count) {
+    i32 chunk_rows = table->chunk_rows;
+    if (chunk_rows == 0) {
+        return lane_range_for(lane, lane_count, (u64)count);
+    }
+
+    i32 first_chunk = offset / chunk_rows;
+    i32 end_chunk = (offset + count + chunk_rows - 1) / chunk_rows;
+    Range_u64 chunks = lane_range_for((lane + (u32)table->id) % lane_count, lane_count, (u64)(end_chunk - first_chunk));
+    if (chunks.max <= chunks.min) {
+        return (Range_u64){0, 0};
+    }
+
+    i32 min = MAX(offset, (first_chunk + (i32)chunks.min) * chunk_rows);
+    i32 max = MIN(offset + count, (first_chunk + (i32)chunks.max) * chunk_rows);
+    return (Range_u64){ (u64)(min - offset), (u64)(max - offset) };
 }
 
-b32 ecs_systems_conflict(EcsSystem *writer, EcsSystem *reader) {
-    EcsQuery *q_writer = &writer->query;
-    EcsQuery *q_reader = &reader->query;
+internal b32 ecs_profiler_fits(EcsWorld *world, i32 lane_count) {
+    EcsProfiler *profiler = world->profiler;
+    return profiler->lane_count == lane_count && world->system_count <= profiler->system_cap;
+}
 
-    for (i32 w = 0; w < q_writer->term_count; w++) {
-        EcsTerm *term_w = &q_writer->terms[w];
-        if (!ecs_term_writes(term_w)) {
+// main thread, while no lane is recording. lanes past lane_count give their rings back, a lane's
+// system ring grows with the frames it holds copied over, new lanes join at the others' frame
+internal void ecs_profiler_reserve(EcsWorld *world, i32 lane_count) {
+    EcsProfiler *profiler = world->profiler;
+    i32 frame_cap = profiler->frame_cap;
+    i32 system_cap = profiler->system_cap == 0 ? 16 : profiler->system_cap;
+    while (system_cap < world->system_count) {
+        system_cap *= 2;
+    }
+    u64 head = profiler->lanes[0].head;
+
+    for (i32 l = 0; l < ECS_MAX_THREADS; l++) {
+        EcsProfileLane *lane = &profiler->lanes[l];
+        if (l >= lane_count) {
+            if (lane->frames) {
+                block_free(&world->allocator, lane->frames, sizeof(EcsProfileFrame) * frame_cap);
+                block_free(&world->allocator, lane->systems,
+                           sizeof(EcsSystemProfile) * frame_cap * profiler->system_cap);
+                *lane = (EcsProfileLane){0};
+            }
+            continue;
+        }
+        if (lane->frames && system_cap == profiler->system_cap) {
             continue;
         }
 
-        for (i32 r = 0; r < q_reader->term_count; r++) {
-            EcsTerm *term_r = &q_reader->terms[r];
-            if (!ecs_term_reads(term_r)) {
-                continue;
-            }
-
-            if (term_w->id == term_r->id) {
-                return true;
+        size_t systems_size = sizeof(EcsSystemProfile) * frame_cap * system_cap;
+        EcsSystemProfile *systems = (EcsSystemProfile*)block_alloc(&world->allocator, systems_size);
+        memset(systems, 0, systems_size);
+        if (!lane->frames) {
+            lane->frames = (EcsProfileFrame*)block_alloc(&world->allocator, sizeof(EcsProfileFrame) * frame_cap);
+            memset(lane->frames, 0, sizeof(EcsProfileFrame) * frame_cap);
+            lane->head = head;
+        }
+        for (i32 f = 0; f < frame_cap; f++) {
+            EcsProfileFrame *frame = &lane->frames[f];
+            if (frame->system_count > 0) {
+                memcpy(systems + f * system_cap, frame->systems, sizeof(EcsSystemProfile) * frame->system_count);
             }
+            frame->systems = systems + f * system_cap;
         }
+        block_free(&world->allocator, lane->systems, sizeof(EcsSystemProfile) * frame_cap * profiler->system_cap);
+        lane->systems = systems;
     }
+    profiler->system_cap = system_cap;
+    profiler->lane_count = lane_count;
+}
 
-    return false;
+// the frame the thread is recording, its slot is the one readers skip
+force_inline EcsProfileFrame* ecs_profile_lane_frame(EcsProfiler *profiler, u8 thread_idx) {
+    EcsProfileLane *lane = &profiler->lanes[thread_idx];
+    return &lane->frames[lane->head % (u64)profiler->frame_cap];
 }
 
 internal void ecs_system_run_task(void *arg) {
     EcsSystemRunData *data = (EcsSystemRunData *)arg;
     EcsSystem *sys = data->sys;
     ThreadContext *tctx = tctx_current();
+    EcsProfiler *profiler = sys->query.world->profiler;
+    u64 profile_start = profiler ? os_time_now() : 0;
+    i32 profile_rows = 0;
+    i32 profile_tables = 0;
 
     EcsIter it = {0};
     it.delta_time = data->delta_time;
     it.ctx = sys->ctx;
     it.world = sys->query.world;
+    it.lane = data->thread_idx;
 
     if (sys->iter_mode == ECS_ITER_RANGE) {
         if (sys->thread_mode == ECS_THREAD_SINGLE) {
@@ -1421,6 +3130,7 @@ internal void ecs_system_run_task(void *arg) {
             it.count = sys->iter_count;
             it.frame_offset = 0;
             sys->callback(&it);
+            profile_rows += it.count;
         } else {
             Range_u64 range = lane_range_for(data->thread_idx, tctx->thread_count, (u64)sys->iter_count);
             if (range.max > range.min) {
@@ -1428,36 +3138,61 @@ internal void ecs_system_run_task(void *arg) {
                 it.count = (i32)(range.max - range.min);
                 it.frame_offset = 0;
                 sys->callback(&it);
+                profile_rows += it.count;
             }
         }
     } else {
         it = ecs_query_iter(&sys->query);
         it.delta_time = data->delta_time;
         it.ctx = sys->ctx;
+        it.lane = data->thread_idx;
 
         i32 frame_offset = 0;
         while (ecs_iter_next(&it)) {
             i32 table_total = it.count;
+            // ordered queries hand out slices that start mid-table
+            i32 base_offset = it.offset;
+            EcsEntity *base_entities = it.entities;
 
             if (sys->thread_mode == ECS_THREAD_SINGLE) {
                 it.frame_offset = frame_offset;
                 sys->callback(&it);
+                profile_rows += it.count;
+                profile_tables++;
             } else {
-                Range_u64 range = lane_range_for(data->thread_idx, tctx->thread_count, (u64)table_total);
+                // ecs_progress only orders lane j after lane j of the systems before it, so every
+                // system splits the whole table the same way and a lane keeps the part of its rows
+                // inside the run. filtered runs and ordered slices cover only some of the table
+                Range_u64 range = ecs_table_lane_rows(it.table, 0, it.table->data.count, data->thread_idx,
+                                                      tctx->thread_count);
+                i32 min = MAX((i32)range.min, base_offset);
+                i32 max = MIN((i32)range.max, base_offset + table_total);
+                range = max > min ? (Range_u64){ (u64)(min - base_offset), (u64)(max - base_offset) }
+                                  : (Range_u64){0, 0};
 
                 if (range.max > range.min) {
-                    it.offset = (i32)range.min;
+                    it.offset = base_offset + (i32)range.min;
                     it.count = (i32)(range.max - range.min);
                     it.frame_offset = frame_offset;
-                    it.entities = it.table->data.entities + range.min;
+                    it.entities = base_entities + range.min;
 
                     sys->callback(&it);
+                    profile_rows += it.count;
+                    profile_tables++;
                 }
             }
 
             frame_offset += table_total;
         }
     }
+
+    if (profiler) {
+        // tasks of several lanes can end up on one thread
+        EcsSystemProfile *profile = &ecs_profile_lane_frame(profiler, tctx->thread_idx)->systems[sys->index];
+        profile->wall_ns += os_time_diff(os_time_now(), profile_start);
+        profile->rows += profile_rows;
+        profile->tables += profile_tables;
+    }
 }
 
 void ecs_progress(EcsWorld *world, f32 delta_time) {
@@ -1465,8 +3200,41 @@ void ecs_progress(EcsWorld *world, f32 delta_time) {
 
     local_shared MCRTaskQueue queue = {0};
 
+    EcsProfiler *profiler = world->profiler;
+    u64 profile_start = 0;
+    u64 profile_wait = 0;
+    if (profiler) {
+        // lanes close their last frame after its final sync, so wait for all of them before
+        // touching the rings
+        if (!ecs_profiler_fits(world, tctx->thread_count)) {
+            lane_sync();
+            if (is_main_thread()) {
+                ecs_profiler_reserve(world, tctx->thread_count);
+            }
+        }
+        lane_sync();
+
+        EcsProfileLane *lane = &profiler->lanes[tctx->thread_idx];
+        EcsProfileFrame *frame = ecs_profile_lane_frame(profiler, tctx->thread_idx);
+        frame->frame = lane->head;
+        frame->system_count = world->system_count;
+        frame->systems = lane->systems + (frame - lane->frames) * profiler->system_cap;
+        memset(frame->systems, 0, sizeof(EcsSystemProfile) * world->system_count);
+        profile_start = os_time_now();
+        profile_wait = tctx->sync_wait_ns;
+        tctx->time_syncs = true;
+    }
+
+    // structural changes made by systems are buffered per thread and applied after the last system
+    if (is_main_thread()) {
+        for (i32 s = 0; s < world->system_count; s++) {
+            ecs_query_cache_prepare(&world->systems[s]->query);
+        }
+        ecs_defer_begin(world);
+    }
+
     for (i32 s = 0; s < world->system_count; s++) {
-        EcsSystem *sys = &world->systems[s];
+        EcsSystem *sys = world->systems[s];
         MCRTaskHandle *task_handles = (MCRTaskHandle *)sys->task_handles;
 
         if (sys->thread_mode == ECS_THREAD_SINGLE && tctx->thread_idx != 0) {
@@ -1478,7 +3246,9 @@ void ecs_progress(EcsWorld *world, f32 delta_time) {
         run_data->delta_time = delta_time;
         run_data->thread_idx = tctx->thread_idx;
 
-        MCRTaskHandle deps[ECS_MAX_SYSTEM_DEPS];
+        // depends_on has no limit, a barrier dependency takes one handle per lane
+        MCRTaskHandle *deps = ARENA_ALLOC_ARRAY(&tctx->temp_arena, MCRTaskHandle,
+                                                MAX(sys->depends_on_count * tctx->thread_count, 1));
         i32 dep_count = 0;
 
         for (i32 d = 0; d < sys->depends_on_count; d++) {
@@ -1486,10 +3256,7 @@ void ecs_progress(EcsWorld *world, f32 delta_time) {
             MCRTaskHandle *dep_handles = (MCRTaskHandle *)dep_sys->task_handles;
 
             if (dep_sys->sync_mode == ECS_SYNC_BARRIER) {
-                debug_assert_msg(dep_count + tctx->thread_count <= ECS_MAX_SYSTEM_DEPS,
-                    "ECS_MAX_SYSTEM_DEPS overflow: barrier needs % slots, only % available (max %)",
-                    FMT_INT(tctx->thread_count), FMT_INT(ECS_MAX_SYSTEM_DEPS - dep_count), FMT_INT(ECS_MAX_SYSTEM_DEPS));
-                for (i32 t = 0; t < tctx->thread_count && dep_count < ECS_MAX_SYSTEM_DEPS; t++) {
+                for (i32 t = 0; t < tctx->thread_count; t++) {
                     deps[dep_count++] = dep_handles[t];
                 }
             } else if (dep_sys->thread_mode == ECS_THREAD_SINGLE) {
@@ -1504,7 +3271,7 @@ void ecs_progress(EcsWorld *world, f32 delta_time) {
             ecs_system_run_task,
             run_data,
             NULL, 0,
-            deps, (u8)dep_count
+            deps, (u32)dep_count
         );
 
         if (sys->sync_mode == ECS_SYNC_BARRIER) {
@@ -1513,4 +3280,95 @@ void ecs_progress(EcsWorld *world, f32 delta_time) {
     }
 
     mcr_queue_process(&queue);
+
+    if (is_main_thread()) {
+        ecs_defer_end(world);
+    }
+    lane_sync();
+
+    if (profiler) {
+        EcsProfileLane *lane = &profiler->lanes[tctx->thread_idx];
+        EcsProfileFrame *frame = ecs_profile_lane_frame(profiler, tctx->thread_idx);
+        frame->wall_ns = os_time_diff(os_time_now(), profile_start);
+        frame->wait_ns = tctx->sync_wait_ns - profile_wait;
+        tctx->time_syncs = false;
+        ins_atomic_store_release64(&lane->head, lane->head + 1);
+    }
+}
+
+void ecs_profile_enable(EcsWorld *world, i32 frame_count) {
+    EcsProfiler *profiler = world->profiler;
+    if (profiler) {
+        ecs_profiler_reserve(world, 0);
+    }
+    if (frame_count <= 0) {
+        world->profiler = NULL;
+        return;
+    }
+    if (!profiler) {
+        profiler = ARENA_ALLOC(world->arena, EcsProfiler);
+    }
+    // one more slot than asked for, the one the lane is writing
+    profiler->frame_cap = frame_count + 1;
+    profiler->system_cap = 0;
+    world->profiler = profiler;
+}
+
+EcsProfileCapture ecs_profile_capture(EcsWorld *world, i32 max_frames, ArenaAllocator *arena) {
+    EcsProfileCapture capture = {0};
+    EcsProfiler *profiler = world->profiler;
+    if (!profiler || profiler->lane_count == 0 || max_frames <= 0) {
+        return capture;
+    }
+
+    i32 lane_count = profiler->lane_count;
+    u64 frame_cap = (u64)profiler->frame_cap;
+    u64 min_head = UINT64_MAX;
+    u64 max_head = 0;
+    for (i32 l = 0; l < lane_count; l++) {
+        u64 head = ins_atomic_load_acquire64(&profiler->lanes[l].head);
+        min_head = MIN(min_head, head);
+        max_head = MAX(max_head, head);
+    }
+
+    // a lane can be a frame ahead of the others, only frames every lane finished are taken. a lane
+    // recording frame h writes over frame h - frame_cap
+    u64 first = max_head + 1 > frame_cap ? max_head + 1 - frame_cap : 0;
+    if (min_head <= first) {
+        return capture;
+    }
+    first = MAX(first, min_head > (u64)max_frames ? min_head - (u64)max_frames : 0);
+    i32 frame_count = (i32)(min_head - first);
+
+    EcsProfileFrame *frames = ARENA_ALLOC_ARRAY(arena, EcsProfileFrame, lane_count * frame_count);
+    for (i32 l = 0; l < lane_count; l++) {
+        EcsProfileLane *lane = &profiler->lanes[l];
+        for (i32 f = 0; f < frame_count; f++) {
+            EcsProfileFrame *src = &lane->frames[(first + (u64)f) % frame_cap];
+            EcsProfileFrame *dst = &frames[l * frame_count + f];
+            *dst = *src;
+            dst->systems = ARENA_ALLOC_ARRAY(arena, EcsSystemProfile, src->system_count);
+            memcpy(dst->systems, src->systems, sizeof(EcsSystemProfile) * src->system_count);
+        }
+    }
+
+    // lanes that moved on while copying may have overwritten the oldest frames
+    max_head = 0;
+    for (i32 l = 0; l < lane_count; l++) {
+        max_head = MAX(max_head, ins_atomic_load_acquire64(&profiler->lanes[l].head));
+    }
+    u64 valid = max_head + 1 > frame_cap ? max_head + 1 - frame_cap : 0;
+    i32 dropped = valid > first ? (i32)MIN(valid - first, (u64)frame_count) : 0;
+    if (dropped > 0) {
+        i32 kept = frame_count - dropped;
+        for (i32 l = 0; l < lane_count; l++) {
+            memmove(&frames[l * kept], &frames[l * frame_count + dropped], sizeof(EcsProfileFrame) * kept);
+        }
+        frame_count = kept;
+    }
+
+    capture.lane_count = lane_count;
+    capture.frame_count = frame_count;
+    capture.frames = frames;
+    return capture;
 }
@@ -6,15 +6,22 @@
 
 #define ECS_TABLE_INITIAL_CAPACITY 8
 #define ECS_TABLE_MAP_INITIAL_CAPACITY 64
+#define ECS_TABLE_MAP_MAX_LOAD_PCT 70
+#define ECS_GRAPH_EDGE_HI_INITIAL_CAPACITY 8
+#define ECS_BULK_MAX_IDS 32
+#define ECS_CMD_BUFFER_INITIAL_CAPACITY 64
 #define ECS_TABLE_PAGE_BITS 6
 #define ECS_TABLE_PAGE_SIZE (1 << ECS_TABLE_PAGE_BITS)
 #define ECS_TABLE_PAGE_MASK (ECS_TABLE_PAGE_SIZE - 1)
+#define ECS_CHANGE_BLOCK_ROWS 256
 
 typedef struct EcsType {
     EcsEntity *array;
     i32 count;
 } EcsType;
 
+#define ECS_COLUMN_ALIGNMENT BLOCK_ALLOCATOR_ALIGNMENT
+
 typedef struct EcsColumn {
     void *data;
     EcsTypeInfo *ti;
@@ -38,7 +45,8 @@ typedef struct EcsGraphEdge {
     EcsTableDiff *diff;
 } EcsGraphEdge;
 
-// TODO: use hash map for hi edges instead of array (O(1) vs O(n) lookup)
+/* lo: direct array indexed by component id, hi: open addressing hash map keyed
+   by id (id == 0 is an empty slot), hi_cap is a power of two */
 typedef struct EcsGraphEdges {
     EcsGraphEdge *lo;
     EcsGraphEdge *hi;
@@ -51,36 +59,54 @@ typedef struct EcsGraphNode {
     EcsGraphEdges remove;
 } EcsGraphNode;
 
+/* back reference from a table to its slot in a cached query's match array */
+typedef struct EcsTableCacheRef {
+    EcsQuery *query;
+    i32 match_index;
+} EcsTableCacheRef;
+
 struct EcsTable {
     u64 id;
     EcsType type;
     EcsTableData data;
     EcsGraphNode node;
     u64 bloom_filter;
-    i32 *dirty_state;
+    // change tick of the last write per slot: 0 rows added, moved or removed, column + 1 for a column
+    u32 *dirty_state;
     i16 column_count;
     i16 *column_map;
+    EcsTableCacheRef *cache_refs;
+    i32 cache_ref_count;
+    i32 cache_ref_cap;
+    // rows per chunk with ecs_world_set_chunk_size, 0 otherwise
+    i32 chunk_rows;
+    // dirty_state per block of block_rows rows (a chunk when chunked, else ECS_CHANGE_BLOCK_ROWS):
+    // block_ticks[slot * block_cap + block]
+    u32 *block_ticks;
+    i32 block_rows;
+    i32 block_cap;
 };
 
 typedef struct EcsTablePage {
     EcsTable tables[ECS_TABLE_PAGE_SIZE];
 } EcsTablePage;
 
-typedef struct EcsTableMapBucket {
+/* open addressing with linear probing, power of two capacity.
+   hashes[i] == 0 marks an empty slot. keys borrow the table's own type array,
+   so the map never copies types. */
+typedef struct EcsTableMap {
+    u64 *hashes;
     EcsType *keys;
     EcsTable **values;
     i32 count;
     i32 capacity;
-} EcsTableMapBucket;
-
-typedef struct EcsTableMap {
-    EcsTableMapBucket *buckets;
-    i32 bucket_count;
-    ArenaAllocator *arena;
+    BlockAllocator *allocator;
 } EcsTableMap;
 
 force_inline u64 ecs_type_hash(const EcsType *type) {
-    return flecs_hash(type->array, type->count * (i32)sizeof(EcsEntity));
+    u64 hash = flecs_hash(type->array, type->count * (i32)sizeof(EcsEntity));
+    // 0 is reserved for empty table map slots
+    return hash ? hash : 1;
 }
 
 force_inline u64 ecs_bloom_bit(EcsEntity component) {
@@ -100,13 +126,18 @@ force_inline i32 ecs_type_compare(const EcsType *type_1, const EcsType *type_2)
     return 0;
 }
 
-void ecs_table_map_init(EcsTableMap *map, ArenaAllocator *arena);
+void ecs_table_map_init(EcsTableMap *map, BlockAllocator *allocator);
 EcsTable* ecs_table_map_get(EcsTableMap *map, const EcsType *type);
+/* type is stored by reference, its array must outlive the map (pass &table->type) */
 void ecs_table_map_set(EcsTableMap *map, const EcsType *type, EcsTable *table);
 
 void ecs_table_init(EcsWorld *world, EcsTable *table, const EcsType *type);
 i32 ecs_table_append(EcsWorld *world, EcsTable *table, EcsEntity entity);
+i32 ecs_table_append_n(EcsWorld *world, EcsTable *table, const EcsEntity *entities, i32 count);
+/* like append_n but leaves the new rows of every column unconstructed, the caller fills them */
+i32 ecs_table_grow_n(EcsWorld *world, EcsTable *table, const EcsEntity *entities, i32 count);
 void ecs_table_delete(EcsWorld *world, EcsTable *table, i32 row);
+void ecs_table_shrink(EcsWorld *world, EcsTable *table);
 void ecs_table_move(EcsWorld *world, EcsEntity entity, EcsTable *dst_table, EcsTable *src_table, i32 src_row, EcsTableDiff *diff);
 void* ecs_table_get_column(EcsTable *table, EcsEntity component, i32 *out_column_index);
 void* ecs_table_get_component(EcsTable *table, i32 row, i32 column_index);
@@ -118,6 +149,13 @@ EcsTable* ecs_table_traverse_remove(EcsWorld *world, EcsTable *table, EcsEntity
 
 void ecs_store_init(EcsWorld *world);
 EcsTable* ecs_store_get_table(EcsWorld *world, i32 index);
+void ecs_store_shrink(EcsWorld *world);
+/* optional chunked layout. column storage is ECS_COLUMN_ALIGNMENT aligned, chunks split a table
+   every chunk_rows rows, about chunk_size bytes of row data with a row count that keeps every
+   chunk of every column ECS_COLUMN_ALIGNMENT aligned. systems then hand lanes whole chunks
+   instead of an even row split, so kernels see aligned rows and lanes never write the same cache
+   line. 0 goes back to even row splits */
+void ecs_world_set_chunk_size(EcsWorld *world, u32 chunk_size);
 
 void ecs_add(EcsWorld *world, EcsEntity entity, EcsEntity component);
 void ecs_remove(EcsWorld *world, EcsEntity entity, EcsEntity component);
@@ -126,6 +164,30 @@ void* ecs_get(EcsWorld *world, EcsEntity entity, EcsEntity component);
 void* ecs_get_mut(EcsWorld *world, EcsEntity entity, EcsEntity component);
 void ecs_set_ptr(EcsWorld *world, EcsEntity entity, EcsEntity component, const void *ptr);
 
+/* ids: components of the new entities, any order. data[i]: count values for ids[i],
+   NULL entries (or data == NULL) are zero initialized. entities: optional, receives the ids */
+typedef struct EcsBulkDesc {
+    const EcsEntity *ids;
+    i32 id_count;
+    const void **data;
+    i32 count;
+    EcsEntity *entities;
+} EcsBulkDesc;
+
+/* creates desc->count entities in one table, returns the row of the first one (rows are contiguous) */
+i32 ecs_bulk_new(EcsWorld *world, const EcsBulkDesc *desc);
+/* deletes entities and compacts each affected table in one pass, keeps row order */
+void ecs_bulk_delete(EcsWorld *world, const EcsEntity *entities, i32 count);
+
+/* while deferred, ecs_entity_new/delete, ecs_add/remove and ecs_set_ptr are recorded in the calling
+   thread's command buffer instead of touching tables. ecs_progress defers for the duration of the frame */
+void ecs_defer_begin(EcsWorld *world);
+/* main thread only, with no other thread touching the world: merges all buffers and applies them
+   grouped by source/destination table */
+void ecs_defer_end(EcsWorld *world);
+b32 ecs_is_deferred(EcsWorld *world);
+void ecs_defer_push(EcsWorld *world, EcsCmdKind kind, EcsEntity entity, EcsEntity component, const void *value);
+
 #define ecs_set(world, entity, T, ...) \
     do { \
         T __temp = __VA_ARGS__; \
@@ -158,22 +220,69 @@ typedef struct EcsTerm {
     i16 inout;
     i8 field_index;
     i8 or_chain_length;
+    i8 changed;
 } EcsTerm;
 
+/* field_columns/field_sizes are resolved once when the table is matched, NULL/0 for fields
+   without a column. the EcsColumn is stable, its data pointer follows table resizes */
 typedef struct EcsQueryCacheMatch {
     EcsTable *table;
     i16 columns[ECS_QUERY_MAX_TERMS];
     u32 set_fields;
-    i32 *monitor;
-    struct EcsQueryCacheMatch *next;
+    u32 *monitor;
+    i32 ref_index;
+    u64 group_id;
+    u32 sorted_state[2];
+    EcsColumn *field_columns[ECS_QUERY_MAX_TERMS];
+    u32 field_sizes[ECS_QUERY_MAX_TERMS];
 } EcsQueryCacheMatch;
 
+/* dense match array partitioned in place: [0, active_count) tables with rows,
+   [active_count, match_count) empty tables. tables move across the split when
+   they gain their first row or lose their last one */
+/* run of rows [offset, offset + count) of one match, in order_by order */
+typedef struct EcsQuerySlice {
+    i32 match_index;
+    i32 offset;
+    i32 count;
+} EcsQuerySlice;
+
+/* range [first, first + count) of the walk: slices with order_by, otherwise order */
+typedef struct EcsQueryGroup {
+    u64 id;
+    i32 first;
+    i32 count;
+} EcsQueryGroup;
+
 typedef struct EcsQueryCache {
-    EcsQueryCacheMatch *first;
-    EcsQueryCacheMatch *last;
+    EcsQueryCacheMatch *matches;
     i32 match_count;
+    i32 match_cap;
+    i32 active_count;
+
+    // only used with group_by/order_by, rebuilt by ecs_query_cache_prepare
+    i32 *order;
+    i32 order_cap;
+    EcsQueryGroup *groups;
+    i32 group_count;
+    i32 group_cap;
+    EcsQuerySlice *slices;
+    i32 slice_count;
+    i32 slice_cap;
+    b32 order_dirty;
+    // a matched table is ordered another way by another cached query, warned once
+    b32 order_conflict;
+
+    // changed-only terms yield blocks stamped after changed_since, the tick of the previous prepare
+    u32 changed_since;
+    u32 changed_mark;
 } EcsQueryCache;
 
+/* group id of a matched table, e.g. a chunk or material id. group_id is the id passed to ecs_query_group_by */
+typedef u64 (*EcsGroupByCallback)(EcsWorld *world, EcsTable *table, EcsEntity group_id, void *ctx);
+/* <0, 0, >0 like qsort. ptrs point at the order_by component, NULL when the table doesn't have it */
+typedef i32 (*EcsOrderByCallback)(EcsEntity e1, const void *ptr1, EcsEntity e2, const void *ptr2);
+
 struct EcsQuery {
     EcsWorld *world;
     EcsTerm terms[ECS_QUERY_MAX_TERMS];
@@ -182,8 +291,17 @@ struct EcsQuery {
     u64 bloom_filter;
     u32 read_fields;
     u32 write_fields;
+    u32 changed_fields;
+    // terms on sparse components, by term index. tables match regardless, rows are filtered
+    u32 sparse_terms;
     EcsQueryCache cache;
     b32 is_cached;
+
+    EcsGroupByCallback group_by;
+    EcsEntity group_by_id;
+    void *group_by_ctx;
+    EcsOrderByCallback order_by;
+    EcsEntity order_by_component;
 };
 
 typedef struct EcsIter {
@@ -204,10 +322,20 @@ typedef struct EcsIter {
 
     EcsTableRecord *cur;
     EcsQueryCacheMatch *cache_cur;
+    i32 cache_index;
+    i32 cache_end;
+    // changed-only queries: next row of cache_cur to look at
+    i32 changed_row;
+    u32 changed_since;
+    // sparse terms: rows [sparse_row, sparse_end) of the current table run are left to filter
+    i32 sparse_row;
+    i32 sparse_end;
+    // uncached queries without a table term: next store table to look at
+    i32 store_index;
+    // lane whose share of the rows a system task runs, 0 outside systems
+    u32 lane;
 } EcsIter;
 
-#define ECS_MAX_SYSTEM_DEPS 64
-
 typedef enum {
     ECS_ITER_QUERY = 0,
     ECS_ITER_RANGE,
@@ -225,8 +353,11 @@ typedef enum {
 
 typedef void (*EcsSystemCallback)(EcsIter *it);
 
+/* depends_on is the transitively reduced set of earlier systems this one waits for, rebuilt by the
+   scheduler from the hazard graph (see ecs_system_graph_dump) */
 typedef struct EcsSystem {
     EcsEntity id;
+    i32 index;
     EcsQuery query;
     EcsSystemCallback callback;
     void *ctx;
@@ -253,8 +384,53 @@ typedef struct EcsSystemDesc {
     EcsIterMode iter_mode;
     EcsThreadMode thread_mode;
     EcsSyncMode sync_mode;
+    // optional, see ecs_query_order_by
+    EcsOrderByCallback order_by;
+    EcsEntity order_by_component;
 } EcsSystemDesc;
 
+/* one system on one thread in one frame. a thread can run tasks of other lanes, so a multi threaded
+   system's rows are split over threads the way the task queue handed them out */
+typedef struct EcsSystemProfile {
+    u64 wall_ns;
+    i32 rows;
+    // iterator runs, a table shows up once per chunk or filtered run
+    i32 tables;
+} EcsSystemProfile;
+
+/* one thread's share of one ecs_progress call */
+typedef struct EcsProfileFrame {
+    // counts ecs_progress calls since profiling was enabled, the same on every lane
+    u64 frame;
+    u64 wall_ns;
+    // blocked in lane_sync, both ecs_progress's own barriers and the task queue's
+    u64 wait_ns;
+    i32 system_count;
+    // indexed like world->systems
+    EcsSystemProfile *systems;
+} EcsProfileFrame;
+
+/* ring written only by its thread, head is published with a release store after a frame is complete */
+typedef struct EcsProfileLane {
+    EcsProfileFrame *frames;
+    EcsSystemProfile *systems;
+    u64 head;
+} EcsProfileLane;
+
+struct EcsProfiler {
+    EcsProfileLane lanes[ECS_MAX_THREADS];
+    i32 lane_count;
+    i32 frame_cap;
+    i32 system_cap;
+};
+
+/* the newest frames of every lane, lane major and oldest first: frames[lane * frame_count + f] */
+typedef struct EcsProfileCapture {
+    i32 lane_count;
+    i32 frame_count;
+    EcsProfileFrame *frames;
+} EcsProfileCapture;
+
 typedef struct EcsSystemRunData {
     EcsSystem *sys;
     f32 delta_time;
@@ -297,6 +473,15 @@ force_inline EcsTerm ecs_term_none(EcsEntity id) {
     return ecs_term_w_inout(id, EcsInOutNone);
 }
 
+/* read-only term that also filters: a cached query only yields the blocks of rows where this
+   column was written, or rows were added or moved, since the query last ran (see
+   ecs_table_mark_dirty). uncached queries ignore the filter. can't be combined with order_by */
+force_inline EcsTerm ecs_term_changed(EcsEntity id) {
+    EcsTerm t = ecs_term_w_inout(id, EcsIn);
+    t.changed = 1;
+    return t;
+}
+
 force_inline EcsTerm ecs_term_not(EcsEntity id) {
     EcsTerm t = {0};
     t.id = id;
@@ -338,23 +523,66 @@ void ecs_query_cache_init(EcsQuery *query);
 void ecs_query_cache_populate(EcsQuery *query);
 void ecs_query_cache_add_table(EcsQuery *query, EcsTable *table);
 void ecs_query_cache_remove_table(EcsQuery *query, EcsTable *table);
+/* group_by/order_by are set before ecs_query_cache_init. order_by sorts the table rows themselves, cached
+   queries that share a table must order it the same way or it's re-sorted every prepare, matching
+   such a table warns */
+void ecs_query_group_by(EcsQuery *query, EcsEntity group_id, EcsGroupByCallback callback, void *ctx);
+void ecs_query_order_by(EcsQuery *query, EcsEntity component, EcsOrderByCallback compare);
+/* re-sorts tables whose rows changed and rebuilds group/slice order. starts a new run for changed-only
+   terms. ecs_query_iter does it when the world isn't deferred, ecs_progress does it on the main
+   thread before the systems run */
+void ecs_query_cache_prepare(EcsQuery *query);
+/* limits a cached iterator to one group, call before the first ecs_iter_next */
+void ecs_iter_set_group(EcsIter *it, u64 group_id);
 b32 ecs_query_table_matches(EcsQuery *query, EcsTable *table, i16 *out_columns, u32 *out_set_fields);
 
-void ecs_table_mark_dirty(EcsTable *table, i32 column);
+/* stamps column (-1 is a no-op) with a new change tick, for the whole table or the blocks holding
+   rows [row, row + count). ecs_set and bulk/deferred writes stamp what they touch, systems writing
+   through ecs_field stamp what they wrote themselves, e.g. with ecs_iter_mark_dirty. thread safe
+   as long as no two threads write the same block */
+void ecs_table_mark_dirty(EcsWorld *world, EcsTable *table, i32 column);
+void ecs_table_mark_dirty_rows(EcsWorld *world, EcsTable *table, i32 column, i32 row, i32 count);
+/* stamps the rows the iterator currently points at for field_index */
+void ecs_iter_mark_dirty(EcsIter *it, i32 field_index);
 b32 ecs_query_changed(EcsQuery *query);
 b32 ecs_iter_changed(EcsIter *it);
 void ecs_query_sync(EcsQuery *query);
 void ecs_iter_sync(EcsIter *it);
 
+/* systems run in registration order. a later system waits for an earlier one when both access the
+   same column of a table they both match and at least one of them writes it (read after write,
+   write after read, write after write). terms on a sparse component conflict the same way, on every
+   table. the graph is extended as tables are created */
 EcsSystem* ecs_system_init(EcsWorld *world, const EcsSystemDesc *desc);
 EcsSystem* ecs_system_get(EcsWorld *world, i32 index);
+/* ordering the hazard graph can't see, e.g. through data outside the ecs. dependency registered first */
 void ecs_system_depends_on(EcsSystem *system, EcsSystem *dependency);
-b32 ecs_systems_conflict(EcsSystem *writer, EcsSystem *reader);
+/* true when the graph has a hazard or explicit edge from first to second, before transitive reduction */
+b32 ecs_systems_conflict(EcsSystem *first, EcsSystem *second);
+/* systems on the longest dependency chain of a frame */
+i32 ecs_system_graph_critical_path(EcsWorld *world);
+/* logs every system with the systems it waits for and the critical path */
+void ecs_system_graph_dump(EcsWorld *world);
 void ecs_progress(EcsWorld *world, f32 delta_time);
 
+/* keeps the last frame_count frames of per system, per thread timings (0 turns it off again).
+   the rings are sized on the next ecs_progress and start over when the lane count or the number of
+   systems outgrows them */
+void ecs_profile_enable(EcsWorld *world, i32 frame_count);
+/* copies up to max_frames of the newest complete frames into arena. safe to call while other
+   threads are in ecs_progress, frames overwritten during the copy are dropped */
+EcsProfileCapture ecs_profile_capture(EcsWorld *world, i32 max_frames, ArenaAllocator *arena);
+
 #define ecs_field(it, T, index) ((T*)ecs_iter_field((it), (index)))
 #define ecs_field_is_set(it, index) (((it)->set_fields & (1u << (index))) != 0)
 
+/* annotations read by the meta generator (other/multicore_by_default/meta). a HZ_SYSTEM function gets one
+   column pointer per HZ_READ/HZ_WRITE parameter, in field order, and the generator emits
+   <name>_Terms/_Register/_Run plus <name>_READ_FIELDS/_WRITE_FIELDS into <header>_generated.h */
+#define HZ_SYSTEM()
+#define HZ_READ()
+#define HZ_WRITE()
+
 #define ECS_SYSTEM(world, callback_fn, terms_arr, terms_count) \
     ecs_system_init((world), &(EcsSystemDesc){ \
         .terms = (terms_arr), \
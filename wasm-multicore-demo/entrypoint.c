@@ -5,6 +5,8 @@
 #include "gpu_backend.h"
 
 global Barrier frame_barrier;
+global LaneForShared frame_parallel_for[2];
+global u64 frame_broadcast_memory[2];
 global ThreadContext main_thread_ctx;
 global AppMemory *g_memory;
 global AppContext g_app_ctx;
@@ -65,6 +67,8 @@ int wasm_init(AppMemory *memory)
       .thread_idx = 0,
       .thread_count = g_app_ctx.num_threads,
       .barrier = &frame_barrier,
+      .broadcast_memory = frame_broadcast_memory,
+      .parallel_for = frame_parallel_for,
       .temp_arena = arena_from_buffer(
           ARENA_ALLOC_ARRAY(&g_app_ctx.arena, u8, MB(16)), MB(16)),
   };
@@ -77,6 +81,8 @@ int wasm_init(AppMemory *memory)
         .thread_idx = i,
         .thread_count = g_app_ctx.num_threads,
         .barrier = &frame_barrier,
+        .broadcast_memory = frame_broadcast_memory,
+        .parallel_for = frame_parallel_for,
         .temp_arena = arena_from_buffer(
             ARENA_ALLOC_ARRAY(&g_app_ctx.arena, u8, MB(16)), MB(16)),
     };
@@ -16,6 +16,8 @@ __declspec(dllexport) DWORD NvOptimusEnablement = 0x01;
 __declspec(dllexport) DWORD AmdPowerXpressRequestHighPerformance = 0x01;
 
 global Barrier frame_barrier;
+global LaneForShared frame_parallel_for[2];
+global u64 frame_broadcast_memory[2];
 global ThreadContext main_thread_ctx;
 global AppMemory *g_memory;
 global AppContext g_app_ctx;
@@ -408,6 +410,8 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prev_instance, LPSTR cmd_line,
       .thread_idx = 0,
       .thread_count = g_app_ctx.num_threads,
       .barrier = &frame_barrier,
+      .broadcast_memory = frame_broadcast_memory,
+      .parallel_for = frame_parallel_for,
       .temp_arena = arena_from_buffer(
           ARENA_ALLOC_ARRAY(&g_app_ctx.arena, u8, MB(64)), MB(64)),
   };
@@ -418,6 +422,8 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prev_instance, LPSTR cmd_line,
         .thread_idx = i,
         .thread_count = g_app_ctx.num_threads,
         .barrier = &frame_barrier,
+        .broadcast_memory = frame_broadcast_memory,
+        .parallel_for = frame_parallel_for,
         .temp_arena = arena_from_buffer(
             ARENA_ALLOC_ARRAY(&g_app_ctx.arena, u8, MB(64)), MB(64)),
     };
@@ -0,0 +1,114 @@
+#include "lib/memory.h"
+#include "lib/common.h"
+#include "lib/string.h"
+
+// size <= BLOCK_ALLOCATOR_MAX_SIZE
+internal u32 block_size_class(size_t size) {
+  u32 size_class = 0;
+  size_t class_size = BLOCK_ALLOCATOR_MIN_SIZE;
+  while (class_size < size) {
+    class_size <<= 1;
+    size_class++;
+  }
+  return size_class;
+}
+
+void block_allocator_init(BlockAllocator *block, ArenaAllocator *arena) {
+  assert(block);
+  assert(arena);
+
+  memset(block, 0, sizeof(BlockAllocator));
+  block->arena = arena;
+}
+
+size_t block_size_for(size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  if (size > BLOCK_ALLOCATOR_MAX_SIZE) {
+    return ALIGN_POW2(size, (size_t)BLOCK_ALLOCATOR_ALIGNMENT);
+  }
+  return (size_t)BLOCK_ALLOCATOR_MIN_SIZE << block_size_class(size);
+}
+
+void *block_alloc(BlockAllocator *block, size_t size) {
+  assert(block);
+
+  if (size == 0) {
+    return NULL;
+  }
+
+  size_t block_size = block_size_for(size);
+  if (block_size < size) {
+    return NULL;
+  }
+
+  if (size <= BLOCK_ALLOCATOR_MAX_SIZE) {
+    u32 size_class = block_size_class(size);
+    BlockFreeNode *node = block->free_lists[size_class];
+    if (node) {
+      block->free_lists[size_class] = node->next;
+      block->used_size += block_size;
+      return node;
+    }
+  }
+
+  void *ptr =
+      arena_alloc_align(block->arena, block_size, BLOCK_ALLOCATOR_ALIGNMENT);
+  if (!ptr) {
+    return NULL;
+  }
+  block->used_size += block_size;
+  block->total_size += block_size;
+  return ptr;
+}
+
+void block_free(BlockAllocator *block, void *ptr, size_t size) {
+  assert(block);
+
+  if (!ptr || size == 0) {
+    return;
+  }
+
+  size_t block_size = block_size_for(size);
+  debug_assert_msg(block->used_size >= block_size,
+                   "Block free of % bytes but only % bytes in use",
+                   FMT_UINT(block_size), FMT_UINT(block->used_size));
+  block->used_size -= block_size;
+
+  // oversized blocks stay in the arena until it's reset
+  if (size > BLOCK_ALLOCATOR_MAX_SIZE) {
+    return;
+  }
+
+  u32 size_class = block_size_class(size);
+  BlockFreeNode *node = (BlockFreeNode *)ptr;
+  node->next = block->free_lists[size_class];
+  block->free_lists[size_class] = node;
+}
+
+void *block_realloc(BlockAllocator *block, void *ptr, size_t old_size,
+                    size_t new_size) {
+  if (!ptr) {
+    return block_alloc(block, new_size);
+  }
+
+  if (new_size == 0) {
+    block_free(block, ptr, old_size);
+    return NULL;
+  }
+
+  // same size class: the block already fits
+  if (block_size_for(old_size) == block_size_for(new_size)) {
+    return ptr;
+  }
+
+  void *new_ptr = block_alloc(block, new_size);
+  if (!new_ptr) {
+    return NULL;
+  }
+
+  memcpy(new_ptr, ptr, MIN(old_size, new_size));
+  block_free(block, ptr, old_size);
+  return new_ptr;
+}
@@ -0,0 +1,328 @@
+/*
+    bench.h - Microbenchmark harness
+
+    OVERVIEW
+
+    --- REGISTER_BENCH / REGISTER_BENCH_MULTICORE mirror the test.h registration macros
+
+    --- single threaded benches run one at a time on the main thread so timings don't interfere
+
+    --- bench_arena() is a large scratch arena, reset after every bench
+
+    --- BenchSamples collects per-op timings in ns, bench_report logs min/median/p99/max/mean
+
+    --- multicore benches can count per-lane busy time with bench_lane_busy_add, bench_report_lanes
+        then also logs each lane's busy share of the summed sample time
+
+    --- when bench_runner_json_init was called every report is also kept as a JSON record, tagged
+        with the lane count, and bench_runner_write_json writes them out so runs can be diffed
+
+    USAGE
+        void bench_foo(void) {
+            BenchSamples samples = bench_samples_make(bench_arena(), 1000);
+            for (u32 i = 0; i < 1000; i++) {
+                u64 start = os_time_now();
+                foo();
+                bench_samples_push(&samples, os_time_diff(os_time_now(), start));
+            }
+            bench_report("foo", &samples);
+        }
+*/
+
+#ifndef H_BENCH
+#define H_BENCH
+
+#include "os/os.h"
+#include "assert.h"
+#include "memory.h"
+#include "thread_context.h"
+#include "string_builder.h"
+
+#define BENCH_MAX_BENCHES 64
+#define BENCH_MAX_LANES 64
+
+typedef void (*BenchFunc)(void);
+
+typedef struct {
+    BenchFunc func;
+    const char *name;
+    b32 multicore;
+} BenchEntry;
+
+// one cache line per lane so lanes adding their busy time don't share lines
+typedef struct {
+    u64 busy_ns;
+    u8 pad[56];
+} BenchLaneBusy;
+
+typedef struct {
+    BenchEntry benches[BENCH_MAX_BENCHES];
+    u32 bench_count;
+    ArenaAllocator arena;
+    // set for the later passes of a lane count sweep, single threaded benches already ran
+    b32 multicore_only;
+    BenchLaneBusy lanes[BENCH_MAX_LANES];
+    StringBuilder json;
+    u32 json_count;
+} BenchRunner;
+
+typedef struct {
+    u64 *samples;
+    u32 count;
+    u32 capacity;
+} BenchSamples;
+
+typedef struct {
+    u64 min_ns;
+    u64 median_ns;
+    u64 p99_ns;
+    u64 max_ns;
+    u64 mean_ns;
+    u32 count;
+} BenchStats;
+
+global BenchRunner g_bench_runner;
+
+#define REGISTER_BENCH(bench_func)                                             \
+  do {                                                                         \
+    BenchEntry *entry = &g_bench_runner.benches[g_bench_runner.bench_count++]; \
+    entry->func = bench_func;                                                  \
+    entry->name = #bench_func;                                                 \
+    entry->multicore = false;                                                  \
+  } while(0)
+
+#define REGISTER_BENCH_MULTICORE(bench_func)                                   \
+  do {                                                                         \
+    BenchEntry *entry = &g_bench_runner.benches[g_bench_runner.bench_count++]; \
+    entry->func = bench_func;                                                  \
+    entry->name = #bench_func;                                                 \
+    entry->multicore = true;                                                   \
+  } while(0)
+
+force_inline ArenaAllocator *bench_arena(void) {
+    return &g_bench_runner.arena;
+}
+
+internal BenchSamples bench_samples_make(ArenaAllocator *arena, u32 capacity) {
+    BenchSamples samples = {0};
+    samples.samples = ARENA_ALLOC_ARRAY(arena, u64, capacity);
+    samples.capacity = capacity;
+    return samples;
+}
+
+force_inline void bench_samples_push(BenchSamples *samples, u64 ns) {
+    debug_assert(samples->count < samples->capacity);
+    samples->samples[samples->count++] = ns;
+}
+
+internal void _bench_sift_down(u64 *values, u32 root, u32 count) {
+    for (;;) {
+        u32 child = root * 2 + 1;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1 < count && values[child + 1] > values[child]) {
+            child++;
+        }
+        if (values[root] >= values[child]) {
+            return;
+        }
+        u64 tmp = values[root];
+        values[root] = values[child];
+        values[child] = tmp;
+        root = child;
+    }
+}
+
+// heapsort: in place, no extra memory, fine for a few million samples
+internal void _bench_sort(u64 *values, u32 count) {
+    if (count < 2) {
+        return;
+    }
+    for (u32 i = count / 2; i-- > 0;) {
+        _bench_sift_down(values, i, count);
+    }
+    for (u32 end = count - 1; end > 0; end--) {
+        u64 tmp = values[0];
+        values[0] = values[end];
+        values[end] = tmp;
+        _bench_sift_down(values, 0, end);
+    }
+}
+
+/* sorts samples in place */
+internal BenchStats bench_samples_stats(BenchSamples *samples) {
+    BenchStats stats = {0};
+    u32 count = samples->count;
+    if (count == 0) {
+        return stats;
+    }
+
+    _bench_sort(samples->samples, count);
+
+    u64 total = 0;
+    for (u32 i = 0; i < count; i++) {
+        total += samples->samples[i];
+    }
+
+    stats.count = count;
+    stats.min_ns = samples->samples[0];
+    stats.max_ns = samples->samples[count - 1];
+    stats.median_ns = samples->samples[count / 2];
+    stats.p99_ns = samples->samples[((u64)count * 99) / 100];
+    stats.mean_ns = total / count;
+    return stats;
+}
+
+force_inline void bench_lane_busy_add(u64 ns) {
+    ThreadContext *tctx = tctx_current();
+    debug_assert(tctx->thread_idx < BENCH_MAX_LANES);
+    g_bench_runner.lanes[tctx->thread_idx].busy_ns += ns;
+}
+
+/* main thread only, between two lane_syncs */
+internal void bench_lane_busy_reset(void) {
+    for (u32 i = 0; i < BENCH_MAX_LANES; i++) {
+        g_bench_runner.lanes[i].busy_ns = 0;
+    }
+}
+
+internal void _bench_json_u64(StringBuilder *sb, u64 value) {
+    char digits[20];
+    u32 count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) {
+        sb_append_char(sb, digits[--count]);
+    }
+}
+
+internal void _bench_json_record(const char *name, BenchStats *stats, u32 lane_count, f64 *utilization) {
+    StringBuilder *sb = &g_bench_runner.json;
+    if (!sb->buffer) {
+        return;
+    }
+
+    sb_append(sb, g_bench_runner.json_count++ ? ",\n    {\"name\": \"" : "\n    {\"name\": \"");
+    sb_append(sb, name);
+    sb_append(sb, "\", \"threads\": ");
+    sb_append_u32(sb, tctx_current()->thread_count);
+    sb_append(sb, ", \"n\": ");
+    sb_append_u32(sb, stats->count);
+    sb_append(sb, ", \"min_ns\": ");
+    _bench_json_u64(sb, stats->min_ns);
+    sb_append(sb, ", \"median_ns\": ");
+    _bench_json_u64(sb, stats->median_ns);
+    sb_append(sb, ", \"p99_ns\": ");
+    _bench_json_u64(sb, stats->p99_ns);
+    sb_append(sb, ", \"max_ns\": ");
+    _bench_json_u64(sb, stats->max_ns);
+    sb_append(sb, ", \"mean_ns\": ");
+    _bench_json_u64(sb, stats->mean_ns);
+    if (utilization) {
+        sb_append(sb, ", \"utilization\": [");
+        for (u32 i = 0; i < lane_count; i++) {
+            if (i) {
+                sb_append(sb, ", ");
+            }
+            sb_append_f32(sb, utilization[i], 3);
+        }
+        sb_append_char(sb, ']');
+    }
+    sb_append_char(sb, '}');
+}
+
+internal void _bench_log_stats(const char *name, BenchStats *stats) {
+    LOG_INFO("[BENCH] % n=% min=%ns median=%ns p99=%ns max=%ns mean=%ns",
+             FMT_STR(name), FMT_UINT(stats->count), FMT_UINT(stats->min_ns),
+             FMT_UINT(stats->median_ns), FMT_UINT(stats->p99_ns),
+             FMT_UINT(stats->max_ns), FMT_UINT(stats->mean_ns));
+}
+
+internal void bench_report(const char *name, BenchSamples *samples) {
+    BenchStats stats = bench_samples_stats(samples);
+    _bench_log_stats(name, &stats);
+    _bench_json_record(name, &stats, 0, NULL);
+}
+
+/* main thread only. samples are whole frames, utilization is each lane's busy time over their sum */
+internal void bench_report_lanes(const char *name, BenchSamples *samples) {
+    u64 wall_ns = 0;
+    for (u32 i = 0; i < samples->count; i++) {
+        wall_ns += samples->samples[i];
+    }
+    BenchStats stats = bench_samples_stats(samples);
+    _bench_log_stats(name, &stats);
+
+    u32 lane_count = MIN(tctx_current()->thread_count, BENCH_MAX_LANES);
+    f64 utilization[BENCH_MAX_LANES];
+    f64 total = 0.0;
+    for (u32 i = 0; i < lane_count; i++) {
+        utilization[i] = wall_ns ? (f64)g_bench_runner.lanes[i].busy_ns / (f64)wall_ns : 0.0;
+        total += utilization[i];
+    }
+    LOG_INFO("[BENCH] % lanes=% utilization=%", FMT_STR(name), FMT_UINT(lane_count),
+             FMT_FLOAT((f32)(total / lane_count)));
+    _bench_json_record(name, &stats, lane_count, utilization);
+}
+
+internal void bench_runner_init(ArenaAllocator *arena, size_t scratch_size) {
+    g_bench_runner.bench_count = 0;
+    u8 *scratch = ARENA_ALLOC_ARRAY(arena, u8, scratch_size);
+    g_bench_runner.arena = arena_from_buffer(scratch, scratch_size);
+}
+
+/* reports from here on are also kept as JSON records, in a buffer of json_size bytes */
+internal void bench_runner_json_init(ArenaAllocator *arena, size_t json_size) {
+    StringBuilder *sb = &g_bench_runner.json;
+    sb_init(sb, ARENA_ALLOC_ARRAY(arena, char, json_size), json_size);
+    sb_append_format(sb, "{\n  \"processors\": %,\n  \"benches\": [", FMT_INT(os_get_processor_count()));
+    g_bench_runner.json_count = 0;
+}
+
+internal b32 bench_runner_write_json(const char *path) {
+    StringBuilder *sb = &g_bench_runner.json;
+    if (!sb->buffer) {
+        return false;
+    }
+    sb_append(sb, "\n  ]\n}\n");
+    return os_write_file(path, (u8 *)sb->buffer, sb->len);
+}
+
+internal void bench_runner_run(void) {
+    for (u32 i = 0; i < g_bench_runner.bench_count; i++) {
+        BenchEntry *entry = &g_bench_runner.benches[i];
+
+        if (g_bench_runner.multicore_only && !entry->multicore) {
+            continue;
+        }
+
+        if (entry->multicore) {
+            if (is_main_thread()) {
+                LOG_INFO("Running multicore bench: %", FMT_STR(entry->name));
+            }
+            lane_sync();
+
+            entry->func();
+
+            lane_sync();
+        } else if (is_main_thread()) {
+            LOG_INFO("Running bench: %", FMT_STR(entry->name));
+            entry->func();
+        }
+
+        if (is_main_thread()) {
+            arena_reset(&g_bench_runner.arena);
+        }
+        arena_reset(&tctx_current()->temp_arena);
+        lane_sync();
+    }
+
+    if (is_main_thread()) {
+        LOG_INFO("[DONE] % benches ran", FMT_UINT(g_bench_runner.bench_count));
+    }
+}
+
+#endif
@@ -36,29 +36,72 @@ ArenaAllocator arena_from_reserved_buffer(uint8 *buffer,
 
 #ifndef WASM
 ArenaAllocator arena_create(size_t reserve_size, size_t commit_size) {
-  ArenaAllocator arena = {0};
+  return arena_create_desc(&(ArenaDesc){
+      .reserve_size = reserve_size,
+      .commit_size = commit_size,
+  });
+}
 
-  u8 *buffer = os_reserve_memory(reserve_size);
+ArenaAllocator arena_create_desc(const ArenaDesc *desc) {
+  ArenaAllocator arena = {0};
+  size_t reserve_size = desc->reserve_size;
+  size_t commit_size =
+      desc->commit_size > 0 ? desc->commit_size : ARENA_DEFAULT_COMMIT_SIZE;
+
+  ArenaPages pages = desc->pages;
+  u8 *buffer = NULL;
+  if (pages == ARENA_PAGES_EXPLICIT_HUGE) {
+    buffer = os_reserve_memory_pages(reserve_size, OS_PAGES_EXPLICIT_HUGE);
+    if (!buffer) {
+      LOG_WARN("Huge page pool can't cover % kb, using transparent huge pages",
+               FMT_UINT(BYTES_TO_KB(reserve_size)));
+      pages = ARENA_PAGES_TRANSPARENT_HUGE;
+    }
+  }
+  if (pages != ARENA_PAGES_DEFAULT) {
+    // commits in whole huge pages, a partial one would fall back to small pages
+    size_t huge_size = os_get_huge_page_size();
+    reserve_size = align_forward(reserve_size, huge_size);
+    commit_size = align_forward(commit_size, huge_size);
+  }
+  if (!buffer) {
+    buffer = os_reserve_memory_pages(reserve_size,
+                                     pages == ARENA_PAGES_TRANSPARENT_HUGE
+                                         ? OS_PAGES_TRANSPARENT_HUGE
+                                         : OS_PAGES_DEFAULT);
+  }
   if (!buffer) {
     return arena;
   }
 
-  size_t initial_commit = commit_size > 0 ? commit_size : ARENA_DEFAULT_COMMIT_SIZE;
+  // bind before anything is faulted in so no page has to migrate
+  if (desc->numa_bind) {
+    os_bind_memory_numa(buffer, reserve_size, desc->numa_node);
+  }
+
+  // explicit huge pages are committed by the reserve already
+  size_t initial_commit =
+      pages == ARENA_PAGES_EXPLICIT_HUGE ? reserve_size : commit_size;
   if (initial_commit > reserve_size) {
     initial_commit = reserve_size;
   }
 
-  if (!os_commit_memory(buffer, initial_commit)) {
+  if (pages != ARENA_PAGES_EXPLICIT_HUGE &&
+      !os_commit_memory(buffer, initial_commit)) {
     os_free_memory(buffer, reserve_size);
     return arena;
   }
+  if (desc->prefault) {
+    os_prefault_memory(buffer, initial_commit);
+  }
 
   arena.buffer = buffer;
   arena.reserved = reserve_size;
   arena.committed = initial_commit;
   arena.offset = 0;
-  arena.commit_size = commit_size > 0 ? commit_size : ARENA_DEFAULT_COMMIT_SIZE;
+  arena.commit_size = commit_size;
   arena.owns_memory = true;
+  arena.prefault = desc->prefault;
 
   return arena;
 }
@@ -73,6 +116,7 @@ void arena_release(ArenaAllocator *arena) {
   arena->offset = 0;
   arena->commit_size = 0;
   arena->owns_memory = false;
+  arena->prefault = false;
 }
 #endif
 
@@ -129,6 +173,9 @@ void *arena_alloc_align(ArenaAllocator *a, size_t size, size_t align) {
     }
     size_t commit_amount = commit_to - a->committed;
     if (os_commit_memory(a->buffer + a->committed, commit_amount)) {
+      if (a->prefault) {
+        os_prefault_memory(a->buffer + a->committed, commit_amount);
+      }
       a->committed = commit_to;
       void *ptr = &a->buffer[offset];
       a->offset = offset + size;
@@ -5,6 +5,8 @@
 
     --- ArenaAllocator: bump allocator for sequential allocations, has to be freed all at once
 
+    --- BlockAllocator: power-of-two size classes with free-lists, backed by an arena
+
     --- Allocator: generic interface wrapping any allocator type
 
     USAGE
@@ -66,6 +68,7 @@
     .offset: current allocation offset (grows with each allocation)
     .commit_size: granularity for new commits (e.g., 64KB), 0 = no commit needed
     .owns_memory: whether arena should release memory on destroy
+    .prefault: new commits are faulted in right away instead of on first touch
 */
 typedef struct {
   uint8 *buffer;
@@ -74,8 +77,35 @@ typedef struct {
   size_t offset;
   size_t commit_size;
   b32 owns_memory;
+  b32 prefault;
 } ArenaAllocator;
 
+typedef enum {
+  ARENA_PAGES_DEFAULT,
+  // the kernel backs aligned huge page runs when it has them, commits stay lazy
+  ARENA_PAGES_TRANSPARENT_HUGE,
+  // from the preallocated huge page pool, the whole reserve is committed up
+  // front. falls back to transparent when the pool is short
+  ARENA_PAGES_EXPLICIT_HUGE,
+} ArenaPages;
+
+/*
+    ArenaDesc - options for arena_create_desc
+
+    .commit_size: 0 = ARENA_DEFAULT_COMMIT_SIZE, rounded up to the huge page size for huge pages
+    .prefault: fault every commit in bulk when it's made. pages land on the NUMA node of the
+               thread that faults them, so create the arena from the lane that owns it
+    .numa_bind: bind the whole reserve to .numa_node instead of leaving it to first touch
+*/
+typedef struct {
+  size_t reserve_size;
+  size_t commit_size;
+  ArenaPages pages;
+  b32 prefault;
+  b32 numa_bind;
+  u32 numa_node;
+} ArenaDesc;
+
 #define ARENA_DEFAULT_COMMIT_SIZE MB(64)
 
 /* returns remaining free space in arena */
@@ -87,6 +117,9 @@ HZ_ENGINE_API ArenaAllocator arena_from_buffer(uint8 *buffer, size_t capacity);
 /* create arena with virtual memory (reserve large, commit on demand) */
 HZ_ENGINE_API ArenaAllocator arena_create(size_t reserve_size, size_t commit_size);
 
+/* arena_create with page size, prefault and NUMA options, see ArenaDesc */
+HZ_ENGINE_API ArenaAllocator arena_create_desc(const ArenaDesc *desc);
+
 /* create arena from existing reserved buffer with commit-on-demand support */
 HZ_ENGINE_API ArenaAllocator arena_from_reserved_buffer(uint8 *buffer,
                                                          size_t reserved_size,
@@ -157,6 +190,54 @@ HZ_ENGINE_API size_t pool_free_size(PoolAllocator *pool);
 /* returns total allocated space in pool */
 HZ_ENGINE_API size_t pool_allocated_size(PoolAllocator *pool);
 
+/*
+    BlockAllocator - size-classed block allocator with per-class free-lists
+
+    Rounds every request up to a power of two (min 64 bytes) and carves new
+    blocks from a backing arena. Freed blocks go back to the free-list of
+    their size class and are handed out again before the arena grows, so
+    storage that is repeatedly grown, shrunk and released keeps a flat
+    footprint. Blocks are 64-byte aligned and NOT zeroed. Not thread-safe.
+
+    Requests past the largest class come straight from the arena, rounded up
+    to the alignment, and are never reused: freeing one only updates the
+    counters.
+*/
+#define BLOCK_ALLOCATOR_MIN_SIZE_BITS 6
+#define BLOCK_ALLOCATOR_MIN_SIZE (1 << BLOCK_ALLOCATOR_MIN_SIZE_BITS)
+#define BLOCK_ALLOCATOR_CLASS_COUNT 26
+#define BLOCK_ALLOCATOR_ALIGNMENT 64
+#define BLOCK_ALLOCATOR_MAX_SIZE                                               \
+  ((size_t)BLOCK_ALLOCATOR_MIN_SIZE << (BLOCK_ALLOCATOR_CLASS_COUNT - 1))
+
+typedef struct BlockFreeNode {
+  struct BlockFreeNode *next;
+} BlockFreeNode;
+
+typedef struct BlockAllocator {
+  ArenaAllocator *arena;
+  BlockFreeNode *free_lists[BLOCK_ALLOCATOR_CLASS_COUNT];
+  size_t used_size;
+  size_t total_size;
+} BlockAllocator;
+
+/* init block allocator that carves new blocks from arena */
+HZ_ENGINE_API void block_allocator_init(BlockAllocator *block,
+                                        ArenaAllocator *arena);
+
+/* returns the real size of the block that serves a request of size bytes */
+HZ_ENGINE_API size_t block_size_for(size_t size);
+
+/* allocate a block of at least size bytes, NULL if size is 0 */
+HZ_ENGINE_API void *block_alloc(BlockAllocator *block, size_t size);
+
+/* return block to its size class, size must match the size it was allocated with */
+HZ_ENGINE_API void block_free(BlockAllocator *block, void *ptr, size_t size);
+
+/* grow or shrink block, keeps min(old_size, new_size) bytes, frees when new_size is 0 */
+HZ_ENGINE_API void *block_realloc(BlockAllocator *block, void *ptr,
+                                  size_t old_size, size_t new_size);
+
 /*
     Allocator - generic allocator interface with function pointers
 
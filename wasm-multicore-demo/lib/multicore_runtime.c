@@ -3,6 +3,9 @@
 #include "lib/thread_context.h"
 #include "os/os.h"
 #include "thread.h"
+#if !defined(WASM)
+#include <stdlib.h>
+#endif
 
 typedef struct {
   ThreadContext *ctx;
@@ -25,13 +28,15 @@ void mcr_run(u8 thread_count, size_t temp_arena_size, MCREntrypointFunc func,
       ARENA_ALLOC_ARRAY(arena, MCREntrypointFnData, thread_count);
   Barrier barrier = barrier_alloc(thread_count);
 
-  u64 broadcast_memory = 0;
+  u64 broadcast_memory[2] = {0};
+  LaneForShared parallel_for[2] = {0};
   for (u8 i = 0; i < thread_count; i++) {
     thread_ctx_arr[i] = (ThreadContext){
         .thread_idx = i,
         .thread_count = thread_count,
         .barrier = &barrier,
-        .broadcast_memory = &broadcast_memory,
+        .broadcast_memory = broadcast_memory,
+        .parallel_for = parallel_for,
         .temp_arena = arena_from_buffer(
             ARENA_ALLOC_ARRAY(arena, u8, temp_arena_size), temp_arena_size),
     };
@@ -58,165 +63,370 @@ void mcr_run(u8 thread_count, size_t temp_arena_size, MCREntrypointFunc func,
   }
 }
 
+// backing memory for one segment of a growable queue array
+internal void *_mcr_segment_alloc(MCRTaskQueue *queue, size_t size) {
+  if (!queue->arena) {
+    ThreadContext *tctx = tctx_current();
+    void *segment = ARENA_ALLOC_ARRAY(&tctx->temp_arena, u8, size);
+    queue->deques[tctx->thread_idx].temp_arena_floor = tctx->temp_arena.offset;
+    return segment;
+  }
+  while (ins_atomic_u32_eval_assign(&queue->arena_lock, 1) != 0) {
+    cpu_pause();
+  }
+  void *segment = ARENA_ALLOC_ARRAY(queue->arena, u8, size);
+  ins_atomic_store_release(&queue->arena_lock, 0);
+  return segment;
+}
+
+// slot index of a segmented array, allocating its segment if index is the
+// segment's first slot
+internal void *_mcr_segment_slot(MCRTaskQueue *queue, void *inline_items,
+                                 void **segments, u64 index,
+                                 size_t item_size) {
+  if (index < MCR_TASK_QUEUE_SIZE) {
+    return (u8 *)inline_items + index * item_size;
+  }
+
+  u32 s = 1;
+  while (index >= ((u64)MCR_TASK_QUEUE_SIZE << s)) {
+    s++;
+  }
+  debug_assert_msg(s < MCR_TASK_QUEUE_SEGMENTS,
+      "MCRTaskQueue segment overflow: index=%", FMT_UINT((u32)index));
+  u64 segment_start = (u64)MCR_TASK_QUEUE_SIZE << (s - 1);
+
+  void *segment = (void *)ins_atomic_load_acquire64(&segments[s]);
+  if (!segment) {
+    if (index == segment_start) {
+      segment = _mcr_segment_alloc(queue, item_size * segment_start);
+      ins_atomic_store_release64(&segments[s], segment);
+    } else {
+      // the thread that claimed the first slot is still allocating it
+      while (!(segment = (void *)ins_atomic_load_acquire64(&segments[s]))) {
+        cpu_pause();
+      }
+    }
+  }
+  return (u8 *)segment + (index - segment_start) * item_size;
+}
+
+force_inline MCRTask *_mcr_queue_task(MCRTaskQueue *queue, u64 index) {
+  return (MCRTask *)_mcr_segment_slot(queue, queue->tasks,
+                                      (void **)queue->task_segments, index,
+                                      sizeof(MCRTask));
+}
+
+force_inline MCRTaskEdge *_mcr_queue_edge(MCRTaskQueue *queue, u64 index) {
+  return (MCRTaskEdge *)_mcr_segment_slot(queue, queue->edges,
+                                          (void **)queue->edge_segments, index,
+                                          sizeof(MCRTaskEdge));
+}
+
+force_inline MCRTaskHandle *_mcr_queue_ready(MCRTaskQueue *queue, u64 index) {
+  return (MCRTaskHandle *)_mcr_segment_slot(queue, queue->ready,
+                                            (void **)queue->ready_segments,
+                                            index, sizeof(MCRTaskHandle));
+}
+
+// a task resetting its temp arena below the queue memory in it would free
+// segments other lanes are still reading
+force_inline void _mcr_task_run(MCRTaskQueue *queue, MCRTask *task) {
+  task->mcr_func(task->user_data);
+  debug_assert_msg(tctx_current()->temp_arena.offset >=
+                       queue->deques[tctx_current()->thread_idx].temp_arena_floor,
+                   "MCR task reset the temp arena under queue memory, lane %",
+                   FMT_UINT(tctx_current()->thread_idx));
+}
+
+force_inline b32 _mcr_race_check_enabled(MCRTaskQueue *queue) {
+#if DEBUG
+  return queue->race_check != MCR_RACE_CHECK_OFF;
+#else
+  return queue->race_check == MCR_RACE_CHECK_LOG;
+#endif
+}
+
 MCRTaskHandle _mcr_queue_append(MCRTaskQueue *queue, MCRTaskFunc fn, void *data,
                                 MCRResourceAccess *resources,
                                 u8 resources_count, MCRTaskHandle *deps,
-                                u8 dep_count) {
+                                u32 dep_count) {
   u64 next_mcr_id = ins_atomic_u64_inc_eval(&queue->tasks_count) - 1;
 
-  debug_assert_msg(next_mcr_id < MCR_TASK_QUEUE_SIZE,
-      "MCRTaskQueue tasks_ptr overflow: task_id=% >= %", FMT_UINT(next_mcr_id), FMT_UINT(MCR_TASK_QUEUE_SIZE));
+  debug_assert_msg(next_mcr_id < UINT32_MAX,
+      "MCRTaskQueue task handle overflow: task_id=%", FMT_UINT((u32)next_mcr_id));
 
-  MCRTask task = (MCRTask){.mcr_func = (MCRTaskFunc)(fn), .user_data = data};
-  task.dependency_count_remaining = dep_count;
-
-  queue->tasks_ptr[next_mcr_id] = task;
+  MCRTask *task = _mcr_queue_task(queue, next_mcr_id);
+  *task = (MCRTask){.mcr_func = (MCRTaskFunc)(fn), .user_data = data};
+  task->dependency_count_remaining = (i32)dep_count;
 
   MCRTaskHandle this_mcr_handle = {
-      next_mcr_id,
+      (u32)next_mcr_id,
   };
-  // if we have dependencies, find dependent tasks and add this task to it's
-  // dependencies
+  // if we have dependencies, push this task on each dependency's dependents
+  // list. nothing walks the lists until mcr_queue_process, so swapping the
+  // head in is enough
   if (dep_count > 0) {
-    for (u8 i = 0; i < dep_count; i++) {
-      MCRTaskHandle dependency_mcr_handle = deps[i];
-      MCRTask *dependency_task = &queue->tasks_ptr[dependency_mcr_handle.h[0]];
-      u32 next_dependent_id =
-          ins_atomic_u32_inc_eval(&dependency_task->dependents_count) - 1;
-      dependency_task->dependent_mcr_ids[next_dependent_id] = this_mcr_handle;
+    for (u32 i = 0; i < dep_count; i++) {
+      MCRTask *dependency_task = _mcr_queue_task(queue, deps[i].h[0]);
+      u64 edge_id = ins_atomic_u64_inc_eval(&queue->edges_count) - 1;
+      MCRTaskEdge *edge = _mcr_queue_edge(queue, edge_id);
+      edge->dependent = this_mcr_handle;
+      edge->next = ins_atomic_u32_eval_assign(&dependency_task->dependents_head,
+                                              (u32)edge_id + 1);
     }
   } else {
     u64 next_ready_id = ins_atomic_u64_inc_eval(&queue->ready_count) - 1;
-    debug_assert_msg(next_ready_id < MCR_TASK_QUEUE_SIZE,
-        "MCRTaskQueue ready_queue overflow: ready_id=% >= %", FMT_UINT(next_ready_id), FMT_UINT(MCR_TASK_QUEUE_SIZE));
-    queue->ready_queue[next_ready_id] = this_mcr_handle;
+    *_mcr_queue_ready(queue, next_ready_id) = this_mcr_handle;
   }
 
-#if DEBUG
-  if (resources == NULL) {
-    resources_count = 0;
+  if (resources && resources_count > 0 && _mcr_race_check_enabled(queue)) {
+    task->resources_count = resources_count;
+    task->resources = ARENA_ALLOC_ARRAY(&tctx_current()->temp_arena,
+                                        MCRResourceAccess, resources_count);
+    memcpy(task->resources, resources,
+           sizeof(MCRResourceAccess) * resources_count);
+    ins_atomic_u64_add_eval(&queue->accesses_count, resources_count);
   }
 
-  // store resources for race detection
-  task.resources_count = resources_count;
-  memcpy(task.resources, resources,
-         sizeof(MCRResourceAccess) * resources_count);
-
-  // re-assign task
-  queue->tasks_ptr[next_mcr_id] = task;
-
-  // Check for data race conditions against all existing tasks
-  for (u8 other_mcr_idx = 0; other_mcr_idx < next_mcr_id; other_mcr_idx++) {
-    MCRTask *other_task = &queue->tasks_ptr[other_mcr_idx];
-
-    // Check each resource in this task against each resource in other task
-    for (u8 i = 0; i < resources_count; i++) {
-      MCRResourceAccess *my_resource = &task.resources[i];
-
-      for (u8 j = 0; j < other_task->resources_count; j++) {
-        MCRResourceAccess *other_resource = &other_task->resources[j];
-
-        // Check if memory regions overlap
-        u64 my_start = (u64)my_resource->ptr;
-        u64 my_end = my_start + my_resource->size;
-        u64 other_start = (u64)other_resource->ptr;
-        u64 other_end = other_start + other_resource->size;
-
-        b32 overlaps = (my_start < other_end) && (other_start < my_end);
-
-        if (overlaps) {
-          // Check if there's a conflict (at least one WRITE)
-          b32 has_conflict =
-              (my_resource->access_mode == MCR_RESOURCE_TYPE_WRITE) ||
-              (other_resource->access_mode == MCR_RESOURCE_TYPE_WRITE);
-
-          if (has_conflict) {
-            // Verify the other task is in our dependency chain
-            b32 is_dependency = 0;
-            for (u8 d = 0; d < dep_count; d++) {
-              if (deps[d].h[0] == other_mcr_idx) {
-                is_dependency = 1;
-                break;
-              }
-            }
-
-            if (!is_dependency) {
-              LOG_ERROR(
-                  "RACE CONDITION DETECTED:\n"
-                  "  Task %d conflicts with Task %d\n"
-                  "  Memory region: [%p - %p] overlaps [%p - %p]\n"
-                  "  Access modes: Task %d = %s, Task %d = %s\n"
-                  "  Task %d should depend on Task %d\n",
-                  FMT_UINT(next_mcr_id), FMT_UINT(other_mcr_idx),
-                  FMT_UINT(my_start), FMT_UINT(my_end), FMT_UINT(other_start),
-                  FMT_UINT(other_end), FMT_UINT(next_mcr_id),
-                  FMT_STR(my_resource->access_mode == MCR_RESOURCE_TYPE_WRITE
-                              ? "WRITE"
-                              : "READ"),
-                  FMT_UINT(other_mcr_idx),
-                  FMT_STR(other_resource->access_mode == MCR_RESOURCE_TYPE_WRITE
-                              ? "WRITE"
-                              : "READ"),
-                  FMT_UINT(next_mcr_id), FMT_UINT(other_mcr_idx));
-#ifndef WASM
-              exit(1);
-#endif
-            }
-          }
+  return this_mcr_handle;
+}
+
+typedef struct {
+  u64 start;
+  u64 end;
+  u32 task;
+  b32 write;
+} MCRAccessInterval;
+
+// bottom-up merge sort by start address, returns whichever of values and
+// scratch holds the result. accesses are appended roughly in address order
+// often enough that runs already in order are copied without merging
+internal MCRAccessInterval *_mcr_sort_intervals(MCRAccessInterval *values,
+                                                MCRAccessInterval *scratch,
+                                                u64 count) {
+  MCRAccessInterval *src = values;
+  MCRAccessInterval *dst = scratch;
+  for (u64 width = 1; width < count; width *= 2) {
+    for (u64 left = 0; left < count; left += width * 2) {
+      u64 mid = MIN(left + width, count);
+      u64 right = MIN(left + width * 2, count);
+      if (mid == right || src[mid - 1].start <= src[mid].start) {
+        memcpy(dst + left, src + left, sizeof(MCRAccessInterval) * (right - left));
+        continue;
+      }
+      u64 a = left;
+      u64 b = mid;
+      for (u64 k = left; k < right; k++) {
+        if (a < mid && (b >= right || src[a].start <= src[b].start)) {
+          dst[k] = src[a++];
+        } else {
+          dst[k] = src[b++];
         }
       }
     }
+    MCRAccessInterval *tmp = src;
+    src = dst;
+    dst = tmp;
   }
+  return src;
+}
+
+// main lane only, between the appends and the first task
+internal void _mcr_queue_check_races(MCRTaskQueue *queue) {
+  ArenaAllocator *arena = &tctx_current()->temp_arena;
+  size_t arena_offset = arena->offset;
+  u64 tasks_count = queue->tasks_count;
+
+  // only tasks that declared resources get a reachability bit
+  u32 *participant = ARENA_ALLOC_ARRAY(arena, u32, tasks_count);
+  MCRAccessInterval *intervals =
+      ARENA_ALLOC_ARRAY(arena, MCRAccessInterval, queue->accesses_count);
+  u32 participant_count = 0;
+  u64 interval_count = 0;
+  for (u64 t = 0; t < tasks_count; t++) {
+    MCRTask *task = _mcr_queue_task(queue, t);
+    participant[t] = task->resources_count ? participant_count++ : UINT32_MAX;
+    for (u32 r = 0; r < task->resources_count; r++) {
+      MCRResourceAccess *access = &task->resources[r];
+      if (access->size == 0) {
+        continue;
+      }
+      intervals[interval_count++] = (MCRAccessInterval){
+          .start = (u64)access->ptr,
+          .end = (u64)access->ptr + access->size,
+          .task = (u32)t,
+          .write = access->access_mode == MCR_RESOURCE_TYPE_WRITE,
+      };
+    }
+  }
+
+  u64 words = (participant_count + 63) / 64;
+  size_t bitset_size = sizeof(u64) * words * tasks_count;
+  b32 fits = bitset_size +
+                 (sizeof(MCRAccessInterval) + sizeof(u32)) * interval_count +
+                 KB(1) <=
+             arena_free_size(arena);
+  debug_assert_msg(fits,
+                   "MCR race check: % tasks x % checked tasks needs % KB of "
+                   "temp arena, % KB free",
+                   FMT_UINT(tasks_count), FMT_UINT(participant_count),
+                   FMT_UINT(bitset_size / KB(1)),
+                   FMT_UINT(arena_free_size(arena) / KB(1)));
+  if (!fits) {
+    LOG_WARN("MCR race check skipped: % tasks x % checked tasks needs % KB of "
+             "temp arena",
+             FMT_UINT(tasks_count), FMT_UINT(participant_count),
+             FMT_UINT(bitset_size / KB(1)));
+    arena->offset = arena_offset;
+    return;
+  }
+
+  // ancestors of every task, as participant bits. a dependency always has a
+  // lower id than its dependent, so one pass in id order sees all of them
+  u64 *ancestors = ARENA_ALLOC_ARRAY(arena, u64, words * tasks_count);
+  for (u64 t = 0; t < tasks_count; t++) {
+    u64 *task_ancestors = ancestors + t * words;
+    MCRTask *task = _mcr_queue_task(queue, t);
+    for (u32 edge_id = task->dependents_head; edge_id != 0;) {
+      MCRTaskEdge *edge = _mcr_queue_edge(queue, edge_id - 1);
+      u64 *dependent_ancestors = ancestors + edge->dependent.h[0] * words;
+      for (u64 w = 0; w < words; w++) {
+        dependent_ancestors[w] |= task_ancestors[w];
+      }
+      if (participant[t] != UINT32_MAX) {
+        dependent_ancestors[participant[t] / 64] |= 1ull << (participant[t] % 64);
+      }
+      edge_id = edge->next;
+    }
+  }
+
+  // sweep: active holds the intervals that started before the current one
+  // and haven't ended yet
+  intervals = _mcr_sort_intervals(
+      intervals, ARENA_ALLOC_ARRAY(arena, MCRAccessInterval, interval_count),
+      interval_count);
+  u32 *active = ARENA_ALLOC_ARRAY(arena, u32, interval_count);
+  u64 active_count = 0;
+  for (u64 i = 0; i < interval_count; i++) {
+    MCRAccessInterval *current = &intervals[i];
+
+    u64 kept = 0;
+    for (u64 a = 0; a < active_count; a++) {
+      if (intervals[active[a]].end > current->start) {
+        active[kept++] = active[a];
+      }
+    }
+    active_count = kept;
+
+    for (u64 a = 0; a < active_count; a++) {
+      MCRAccessInterval *other = &intervals[active[a]];
+      if (other->task == current->task || !(other->write || current->write)) {
+        continue;
+      }
+      u32 first = MIN(other->task, current->task);
+      u32 second = MAX(other->task, current->task);
+      u32 bit = participant[first];
+      if (ancestors[second * words + bit / 64] & (1ull << (bit % 64))) {
+        continue;
+      }
+
+      queue->races_found++;
+      MCRAccessInterval *first_access = other->task == first ? other : current;
+      MCRAccessInterval *second_access = other->task == first ? current : other;
+      LOG_ERROR("RACE CONDITION DETECTED:\n"
+                "  Task % conflicts with Task %\n"
+                "  Memory region: [% - %] overlaps [% - %]\n"
+                "  Access modes: Task % = %, Task % = %\n"
+                "  Task % should depend on Task %\n",
+                FMT_UINT(second), FMT_UINT(first),
+                FMT_HEX(second_access->start), FMT_HEX(second_access->end),
+                FMT_HEX(first_access->start), FMT_HEX(first_access->end),
+                FMT_UINT(second), FMT_STR(second_access->write ? "WRITE" : "READ"),
+                FMT_UINT(first), FMT_STR(first_access->write ? "WRITE" : "READ"),
+                FMT_UINT(second), FMT_UINT(first));
+#if DEBUG && !defined(WASM)
+      if (queue->race_check == MCR_RACE_CHECK_DEFAULT) {
+        exit(1);
+      }
 #endif
+    }
+    active[active_count++] = (u32)i;
+  }
 
-  return this_mcr_handle;
+  arena->offset = arena_offset;
 }
 
-void mcr_queue_process(MCRTaskQueue *queue) {
-  ThreadContext *tctx = tctx_current();
-  queue->ready_counter = 0;
-  queue->next_ready_count = 0;
+// empties the queue once every lane is done processing it
+internal void _mcr_queue_reset(MCRTaskQueue *queue) {
+  if (is_main_thread()) {
+    queue->ready_counter = 0;
+    queue->ready_count = 0;
+    queue->tasks_count = 0;
+    queue->edges_count = 0;
+    queue->accesses_count = 0;
+    // next_ready_count is zero by now and other lanes may still be reading it
+    queue->tasks_done = 0;
+    for (u32 i = 0; i < MCR_MAX_LANES; i++) {
+      queue->deques[i].top = 0;
+      queue->deques[i].bottom = 0;
+    }
+    // temp arena segments go away with the frame, deques go back to inline
+    if (!queue->arena) {
+      memset(queue->task_segments, 0, sizeof(queue->task_segments));
+      memset(queue->edge_segments, 0, sizeof(queue->edge_segments));
+      memset(queue->ready_segments, 0, sizeof(queue->ready_segments));
+      for (u32 i = 0; i < MCR_MAX_LANES; i++) {
+        queue->deques[i].buffer = NULL;
+        queue->deques[i].temp_arena_floor = 0;
+      }
+    }
+  }
   lane_sync();
-  // todo: change to verbose
-  //  printf("thread %d: start processing queue\n", tctx->thread_idx);
+}
+
+internal void _mcr_queue_process_waves(MCRTaskQueue *queue) {
+  // every task lands in ready once, so its segments can all be there before
+  // the first task runs instead of being allocated mid wave
+  if (is_main_thread()) {
+    for (u64 start = MCR_TASK_QUEUE_SIZE; start < queue->tasks_count;
+         start <<= 1) {
+      _mcr_queue_ready(queue, start);
+    }
+  }
+  // the wave counters are already zero, from _mcr_queue_reset or the last
+  // wave boundary
+  lane_sync();
+
+  // the current wave is ready[wave_start, wave_end), tasks it makes ready go
+  // right after it. every lane tracks the bounds itself, they only move at syncs
+  u64 wave_start = 0;
+  u64 wave_end = queue->ready_count;
 
 process_queue_loop:
   for (;;) {
-    u64 ready_idx = ins_atomic_u64_inc_eval(&queue->ready_counter) - 1;
+    u64 ready_idx = wave_start + ins_atomic_u64_inc_eval(&queue->ready_counter) - 1;
     // we have ready tasks
-    if (ready_idx < queue->ready_count) {
-      MCRTaskHandle ready_mcr_handle = queue->ready_queue[ready_idx];
-      // todo: change to verbose
-      //  printf("thread %d: executing task handle %d (%d)\n", tctx->thread_idx,
-      //         ready_idx, ready_mcr_handle.h[0]);
+    if (ready_idx < wave_end) {
+      MCRTaskHandle ready_mcr_handle = *_mcr_queue_ready(queue, ready_idx);
 
       // note: should we assume valid task here?
-      MCRTask *task = &queue->tasks_ptr[ready_mcr_handle.h[0]];
-      task->mcr_func(task->user_data);
+      MCRTask *task = _mcr_queue_task(queue, ready_mcr_handle.h[0]);
+      _mcr_task_run(queue, task);
 
-      for (u32 i = 0; i < task->dependents_count; i++) {
-        MCRTaskHandle dependent_handle = task->dependent_mcr_ids[i];
-        MCRTask *dependent = &queue->tasks_ptr[dependent_handle.h[0]];
-        // todo: what if this wraps to max u32?
+      for (u32 edge_id = task->dependents_head; edge_id != 0;) {
+        MCRTaskEdge *edge = _mcr_queue_edge(queue, edge_id - 1);
+        MCRTask *dependent = _mcr_queue_task(queue, edge->dependent.h[0]);
         i32 dependency_count_remaining =
             ins_atomic_u32_dec_eval(&dependent->dependency_count_remaining);
-        // add to the ready queue
+        // add to the ready queue, after the current wave
         if (dependency_count_remaining == 0) {
-          // todo: change to verbose
-          // printf("thread %d: adding task %d to ready queue\n",
-          // tctx->thread_idx,
-          //        dependent_handle.h[0]);
-
           u64 next_ready_id =
               ins_atomic_u64_inc_eval(&queue->next_ready_count) - 1;
-          debug_assert_msg(next_ready_id < MCR_TASK_QUEUE_SIZE,
-              "MCRTaskQueue next_ready_queue overflow: ready_id=% >= %", FMT_UINT(next_ready_id), FMT_UINT(MCR_TASK_QUEUE_SIZE));
-          queue->next_ready_queue[next_ready_id] = dependent_handle;
+          *_mcr_queue_ready(queue, wave_end + next_ready_id) = edge->dependent;
         }
+        edge_id = edge->next;
       }
-      // todo: change to verbose
-      //  printf("thread %d: done executing task %d\n", tctx->thread_idx,
-      //         ready_mcr_handle.h[0]);
     } else {
       // done
       break;
@@ -226,34 +436,183 @@ process_queue_loop:
   // we need sync here to make a sure a thread doesn't early exit before next
   // ready queue has been appended
   lane_sync();
-  // printf("thread %d: finished processing ready queue, checking for next ready
-  // "
-  //        "queue. count %d\n",
-  //        tctx->thread_idx, queue->next_ready_count);
-
-  if (queue->next_ready_count > 0) {
-    // sync here to prevent main thread from gettin ghere to fast and seting
-    // next_ready_count = 0
+
+  u64 next_ready_count = queue->next_ready_count;
+  if (next_ready_count > 0) {
+    // sync here to prevent main thread from getting here too fast and resetting
+    // next_ready_count before every lane read it
     lane_sync();
     if (is_main_thread()) {
-      // todo: too big
-      memcpy(queue->ready_queue, queue->next_ready_queue,
-             sizeof(MCRTaskHandle) * queue->next_ready_count);
-      queue->ready_count = queue->next_ready_count;
       queue->ready_counter = 0;
       queue->next_ready_count = 0;
     }
+    wave_start = wave_end;
+    wave_end += next_ready_count;
     // sync so every thread has shared memory
     lane_sync();
     goto process_queue_loop;
   }
 
-  // todo: change to verbose
-  //  printf("thread %d: done processing queue\n", tctx->thread_idx);
+  _mcr_queue_reset(queue);
+}
+
+// failed steal rounds an idle lane spins through before it starts sleeping
+#define MCR_STEAL_SPIN_ROUNDS 64
+#define MCR_STEAL_SLEEP_US 10
+
+// owner only, before the deque takes any task. a lane never holds more than
+// the whole queue, so after this pushes can't run out of room
+internal void _mcr_deque_reserve(MCRTaskQueue *queue, MCRDeque *deque,
+                                 u64 count) {
+  if (!deque->buffer) {
+    deque->inline_buffer.capacity = MCR_TASK_QUEUE_SIZE;
+    deque->inline_buffer.items = deque->inline_items;
+    deque->buffer = &deque->inline_buffer;
+  }
+  if (deque->buffer->capacity >= count) {
+    return;
+  }
+
+  u64 capacity = deque->buffer->capacity;
+  while (capacity < count) {
+    capacity <<= 1;
+  }
+  MCRDequeBuffer *buffer = (MCRDequeBuffer *)_mcr_segment_alloc(
+      queue, sizeof(MCRDequeBuffer) + sizeof(u32) * capacity);
+  buffer->capacity = capacity;
+  buffer->items = (u32 *)(buffer + 1);
+  ins_atomic_store_release64(&deque->buffer, buffer);
+}
+
+// owner only
+internal void _mcr_deque_push(MCRDeque *deque, u32 task_id) {
+  i64 bottom = deque->bottom;
+  MCRDequeBuffer *buffer = deque->buffer;
+  debug_assert_msg((u64)(bottom - ins_atomic_load_acquire64(&deque->top)) <
+                       buffer->capacity,
+                   "MCRDeque overflow: capacity=%", FMT_UINT(buffer->capacity));
+  buffer->items[(u64)bottom & (buffer->capacity - 1)] = task_id;
+  ins_atomic_store_release64(&deque->bottom, bottom + 1);
+}
+
+// owner only, takes the newest task
+internal b32 _mcr_deque_pop(MCRDeque *deque, u32 *task_id) {
+  i64 bottom = deque->bottom - 1;
+  // full fence, thieves must see the claim on bottom before we read top
+  ins_atomic_u64_eval_assign(&deque->bottom, bottom);
+  i64 top = ins_atomic_load_acquire64(&deque->top);
+  if (top > bottom) {
+    ins_atomic_store_release64(&deque->bottom, bottom + 1);
+    return false;
+  }
+
+  MCRDequeBuffer *buffer = deque->buffer;
+  *task_id = buffer->items[(u64)bottom & (buffer->capacity - 1)];
+  if (top < bottom) {
+    return true;
+  }
+
+  // last task, race the thieves for it
+  b32 won = ins_atomic_u64_eval_cond_assign(&deque->top, top + 1, top) ==
+            (u64)top;
+  ins_atomic_store_release64(&deque->bottom, bottom + 1);
+  return won;
+}
+
+// any lane, takes the oldest task
+internal b32 _mcr_deque_steal(MCRDeque *deque, u32 *task_id) {
+  i64 top = ins_atomic_load_acquire64(&deque->top);
+  memory_fence();
+  i64 bottom = ins_atomic_load_acquire64(&deque->bottom);
+  if (top >= bottom) {
+    return false;
+  }
+
+  MCRDequeBuffer *buffer =
+      (MCRDequeBuffer *)ins_atomic_load_acquire64(&deque->buffer);
+  u32 id = buffer->items[(u64)top & (buffer->capacity - 1)];
+  if (ins_atomic_u64_eval_cond_assign(&deque->top, top + 1, top) !=
+      (u64)top) {
+    // another thief or the owner got it first
+    return false;
+  }
+  *task_id = id;
+  return true;
+}
+
+internal void _mcr_queue_process_steal(MCRTaskQueue *queue) {
+  ThreadContext *tctx = tctx_current();
+  debug_assert_msg(tctx->thread_count <= MCR_MAX_LANES,
+      "mcr_queue_process: % lanes, work stealing supports up to %",
+      FMT_UINT(tctx->thread_count), FMT_UINT(MCR_MAX_LANES));
+  lane_sync();
+
+  u32 lane = tctx->thread_idx;
+  u32 lane_count = tctx->thread_count;
+  MCRDeque *deque = &queue->deques[lane];
+  u64 tasks_count = queue->tasks_count;
+  _mcr_deque_reserve(queue, deque, tasks_count);
+
+  // deal the roots out, each lane's first ones sit at the top of its deque
+  // where thieves take from
+  Range_u64 roots = lane_range(queue->ready_count);
+  for (u64 i = roots.min; i < roots.max; i++) {
+    _mcr_deque_push(deque, _mcr_queue_ready(queue, i)->h[0]);
+  }
+
+  u32 idle_rounds = 0;
+  for (;;) {
+    u32 task_id;
+    b32 found = _mcr_deque_pop(deque, &task_id);
+    for (u32 i = 1; !found && i < lane_count; i++) {
+      found = _mcr_deque_steal(&queue->deques[(lane + i) % lane_count],
+                               &task_id);
+    }
+
+    if (!found) {
+      if (ins_atomic_load_acquire64(&queue->tasks_done) >= tasks_count) {
+        break;
+      }
+      if (++idle_rounds > MCR_STEAL_SPIN_ROUNDS) {
+        os_sleep(MCR_STEAL_SLEEP_US);
+      } else {
+        cpu_pause();
+      }
+      continue;
+    }
+    idle_rounds = 0;
+
+    MCRTask *task = _mcr_queue_task(queue, task_id);
+    _mcr_task_run(queue, task);
+
+    for (u32 edge_id = task->dependents_head; edge_id != 0;) {
+      MCRTaskEdge *edge = _mcr_queue_edge(queue, edge_id - 1);
+      MCRTask *dependent = _mcr_queue_task(queue, edge->dependent.h[0]);
+      i32 dependency_count_remaining =
+          ins_atomic_u32_dec_eval(&dependent->dependency_count_remaining);
+      if (dependency_count_remaining == 0) {
+        _mcr_deque_push(deque, edge->dependent.h[0]);
+      }
+      edge_id = edge->next;
+    }
+    ins_atomic_u64_inc_eval(&queue->tasks_done);
+  }
 
-  queue->ready_counter = 0;
-  queue->ready_count = 0;
-  queue->tasks_count = 0;
-  queue->next_ready_count = 0;
   lane_sync();
+  _mcr_queue_reset(queue);
+}
+
+void mcr_queue_process(MCRTaskQueue *queue) {
+  if (_mcr_race_check_enabled(queue)) {
+    // every lane is done appending, both schedules sync again before running
+    lane_sync();
+    if (is_main_thread() && queue->accesses_count > 0) {
+      _mcr_queue_check_races(queue);
+    }
+  }
+  if (queue->schedule == MCR_SCHEDULE_WAVES) {
+    _mcr_queue_process_waves(queue);
+  } else {
+    _mcr_queue_process_steal(queue);
+  }
 }
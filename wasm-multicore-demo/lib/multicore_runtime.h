@@ -21,7 +21,7 @@ typedef struct {
 typedef void (*MCRTaskFunc)(void *);
 
 typedef struct {
-  u8 h[1];
+  u32 h[1];
 } MCRTaskHandle;
 
 typedef struct {
@@ -31,16 +31,20 @@ typedef struct {
   // Dependencies: how many dependencies I'm waiting on
   i32 dependency_count_remaining;
 
-  // Dependents: who's waiting for me
-  MCRTaskHandle dependent_mcr_ids[32];
-  u32 dependents_count;
+  // Dependents: who's waiting for me, edge index + 1 of the newest one, 0 when none
+  u32 dependents_head;
 
-#if DEBUG
-  MCRResourceAccess resources[16];
+  // copied to the appending thread's temp arena, only kept while races are checked
+  MCRResourceAccess *resources;
   u32 resources_count;
-#endif
 } MCRTask;
 
+typedef struct {
+  MCRTaskHandle dependent;
+  // edge index + 1 of the next dependent of the same task, 0 ends the list
+  u32 next;
+} MCRTaskEdge;
+
 force_inline MCRResourceAccess
 mcr_resource_access_create(MCRResourceAccessType type, void *ptr, u64 size) {
   MCRResourceAccess resource_access = {
@@ -48,18 +52,112 @@ mcr_resource_access_create(MCRResourceAccessType type, void *ptr, u64 size) {
   return resource_access;
 }
 
+// tasks, edges and ready slots a queue holds inline before it allocates
 #define MCR_TASK_QUEUE_SIZE 256
+// segment 0 is the inline array, segment s > 0 holds the next MCR_TASK_QUEUE_SIZE << (s - 1) items
+#define MCR_TASK_QUEUE_SEGMENTS 24
 
+typedef enum {
+  // DEBUG builds check and stop at the first race, other builds don't check
+  MCR_RACE_CHECK_DEFAULT,
+  MCR_RACE_CHECK_OFF,
+  // check in any build, log every race and count it in races_found
+  MCR_RACE_CHECK_LOG,
+} MCRRaceCheck;
+
+// lanes a queue keeps a work-stealing deque for
+#define MCR_MAX_LANES 64
+
+typedef enum {
+  // each lane runs tasks off its own deque, pushes the dependents they make
+  // ready onto it and steals from other lanes when it runs dry
+  MCR_SCHEDULE_STEAL,
+  // lanes run the ready tasks in waves and sync between them, the tasks a
+  // wave makes ready wait for the whole wave
+  MCR_SCHEDULE_WAVES,
+} MCRSchedule;
+
+typedef struct {
+  // power of two
+  u64 capacity;
+  u32 *items;
+} MCRDequeBuffer;
+
+/*
+  Chase-Lev deque of task ids. The owning lane pushes and pops at bottom,
+  other lanes steal at top. It starts on the inline buffer; before any task
+  runs the owner makes room for every task in the queue, publishing a bigger
+  buffer if needed, so pushes never grow it while tasks run.
+*/
+typedef struct {
+  i64 top;
+  i64 bottom;
+  MCRDequeBuffer *buffer;
+  // end of the queue memory this lane put in its temp arena
+  u64 temp_arena_floor;
+  u8 pad[32];
+
+  MCRDequeBuffer inline_buffer;
+  u32 inline_items[MCR_TASK_QUEUE_SIZE];
+} MCRDeque;
+
+/*
+  Tasks, dependency edges and ready slots live in segmented arrays: the first
+  MCR_TASK_QUEUE_SIZE inline, every segment after that as big as all before it,
+  so handles never move while lanes append concurrently. The thread that claims
+  the first slot of a segment allocates it, others claiming slots in it wait
+  until it's published.
+
+  Without an arena the segments come from the allocating thread's temp arena
+  and are dropped when mcr_queue_process returns, so they grow again every
+  frame. With one they come from it, under a spin lock, and are kept for the
+  next frames. Set arena before the first append and don't change it. The
+  work-stealing deque buffers follow the same rule.
+
+  All of it is allocated before the first task runs. Tasks can use their
+  lane's temp arena, but must not reset it below the queue memory in it while
+  the queue is processing; DEBUG builds assert that after every task.
+*/
 typedef struct {
-  MCRTask tasks_ptr[MCR_TASK_QUEUE_SIZE];
+  MCRTask tasks[MCR_TASK_QUEUE_SIZE];
+  MCRTask *task_segments[MCR_TASK_QUEUE_SEGMENTS];
   u64 tasks_count;
 
-  MCRTaskHandle ready_queue[MCR_TASK_QUEUE_SIZE];
+  MCRTaskEdge edges[MCR_TASK_QUEUE_SIZE];
+  MCRTaskEdge *edge_segments[MCR_TASK_QUEUE_SEGMENTS];
+  u64 edges_count;
+
+  // tasks ready to run in wave order: the roots, then every task that became
+  // ready during a wave after the wave it ran in
+  MCRTaskHandle ready[MCR_TASK_QUEUE_SIZE];
+  MCRTaskHandle *ready_segments[MCR_TASK_QUEUE_SEGMENTS];
   u64 ready_count;
   u64 ready_counter;
-
-  MCRTaskHandle next_ready_queue[MCR_TASK_QUEUE_SIZE];
   u64 next_ready_count;
+
+  MCRSchedule schedule;
+  MCRDeque deques[MCR_MAX_LANES];
+  u64 tasks_done;
+
+  /*
+    Before running, mcr_queue_process can check the resources tasks declared:
+    accesses are sorted by address and swept for overlaps, an overlap with a
+    write is a race unless the DAG orders the two tasks, which is looked up in
+    per-task ancestor bitsets. Time is the sort, O(n log n) in the accesses,
+    plus the sweep: every interval still active when another one starts
+    overlaps it, so each one is visited once per overlap and once more when
+    it's dropped. Building the bitsets is O(edges x resource-declaring tasks
+    / 64). They take tasks x resource-declaring tasks bits of the main lane's
+    temp arena, quadratic when most tasks declare resources; DEBUG builds
+    assert they fit, other builds log and skip the check.
+  */
+  MCRRaceCheck race_check;
+  u64 accesses_count;
+  // never reset by the queue
+  u32 races_found;
+
+  ArenaAllocator *arena;
+  u32 arena_lock;
 } MCRTaskQueue;
 
 #define MCR_ACCESS_READ(ptr, size)                                             \
@@ -71,13 +169,17 @@ typedef struct {
 MCRTaskHandle _mcr_queue_append(MCRTaskQueue *queue, MCRTaskFunc fn, void *data,
                                 MCRResourceAccess *resources,
                                 u8 resources_count, MCRTaskHandle *deps,
-                                u8 dep_count);
+                                u32 dep_count);
 
 #define mcr_queue_append(queue, fn, data, resources, resources_count, deps,    \
                          deps_count)                                           \
   _mcr_queue_append((queue), (MCRTaskFunc)(fn), (void *)(data), resources,     \
                     resources_count, deps, deps_count)
 
+/*
+  Runs every appended task following queue->schedule, then empties the queue.
+  Every lane calls it, after all of them are done appending.
+*/
 void mcr_queue_process(MCRTaskQueue *queue);
 
 void mcr_run(u8 thread_count, size_t temp_arena_size, MCREntrypointFunc func,
@@ -251,7 +251,7 @@ TaskSystem task_system_init(u32 worker_count, Allocator *allocator) {
     sys.worker_contexts[i] = (ThreadContext){
         .thread_idx = (u8)(i + 1),
         .thread_count = (u8)(worker_count + 1),
-        .broadcast_memory = &sys.broadcast_memory,
+        .broadcast_memory = sys.broadcast_memory,
         .barrier = &sys.barrier,
         .temp_arena = arena_from_buffer(arena_mem, WORKER_ARENA_SIZE),
         .task_system = &sys,
@@ -262,7 +262,7 @@ TaskSystem task_system_init(u32 worker_count, Allocator *allocator) {
   sys.main_thread_context = (ThreadContext){
       .thread_idx = 0,
       .thread_count = (u8)(worker_count + 1),
-      .broadcast_memory = &sys.broadcast_memory,
+      .broadcast_memory = sys.broadcast_memory,
       .barrier = &sys.barrier,
       .temp_arena = arena_from_buffer(main_arena_mem, WORKER_ARENA_SIZE),
       .task_system = &sys,
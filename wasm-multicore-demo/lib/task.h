@@ -70,7 +70,8 @@ typedef struct TaskSystem {
   u32 worker_count;
 
   Barrier barrier;
-  u64 broadcast_memory;
+  // two slots, lane_sync_u64 alternates between them
+  u64 broadcast_memory[2];
 
   TaskQueue queue;
 
@@ -20,20 +20,35 @@ b32 is_main_thread() {
 ThreadContext *tctx_current() { return tctx_thread_local; }
 void tctx_set_current(ThreadContext *ctx) { tctx_thread_local = ctx; }
 
+internal void _lane_barrier_wait(ThreadContext *ctx) {
+  if (ctx->time_syncs) {
+    u64 start = os_time_now();
+    barrier_wait(*ctx->barrier);
+    ctx->sync_wait_ns += os_time_diff(os_time_now(), start);
+  } else {
+    barrier_wait(*ctx->barrier);
+  }
+}
+
+// one barrier: the broadcaster writes the slot of this call before arriving,
+// the others read it after leaving. the next call writes the other slot, and
+// the one after that can't start before every lane got past this read
 void _lane_sync_u64(ThreadContext *ctx, u32 broadcast_thread_idx,
                     u64 *value_ptr) {
+  u64 *slot = &ctx->broadcast_memory[ctx->broadcast_calls & 1];
+  ctx->broadcast_calls++;
+
   if (value_ptr && ctx->thread_idx == broadcast_thread_idx) {
-    memcpy(ctx->broadcast_memory, value_ptr, sizeof(u64));
+    memcpy(slot, value_ptr, sizeof(u64));
   }
-  barrier_wait(*ctx->barrier);
+  _lane_barrier_wait(ctx);
 
   if (value_ptr && ctx->thread_idx != broadcast_thread_idx) {
-    memcpy(value_ptr, ctx->broadcast_memory, sizeof(u64));
+    memcpy(value_ptr, slot, sizeof(u64));
   }
-  barrier_wait(*ctx->barrier);
 }
 
-void _lane_sync(ThreadContext *ctx) { barrier_wait(*ctx->barrier); }
+void _lane_sync(ThreadContext *ctx) { _lane_barrier_wait(ctx); }
 
 Range_u64 _lane_range(u32 thread_idx, u32 thread_count, u64 values_count) {
   u64 values_per_thread = values_count / thread_count;
@@ -53,3 +68,65 @@ Range_u64 _lane_range(u32 thread_idx, u32 thread_count, u64 values_count) {
   };
   return range;
 }
+
+// chunks are the remaining work split over this many times the lane count
+#define LANE_FOR_CHUNKS_PER_LANE 2
+
+void _lane_parallel_for(ThreadContext *ctx, LaneForDesc *desc, LaneForFunc fn,
+                        void *user_data) {
+  LaneForShared *shared = &ctx->parallel_for[ctx->parallel_for_calls & 1];
+  // the other slot was last used by the previous call, which every lane left
+  // at its closing sync, so it's free to reset for the next one
+  if (ctx->thread_idx == 0) {
+    ctx->parallel_for[(ctx->parallel_for_calls + 1) & 1] = (LaneForShared){0};
+  }
+  ctx->parallel_for_calls++;
+
+  u64 count = desc->count;
+  u64 min_grain = MAX(desc->min_grain, 1);
+  u64 split = (u64)ctx->thread_count * LANE_FOR_CHUNKS_PER_LANE;
+
+  u64 total_cost = desc->total_cost;
+  if (desc->costs && total_cost == 0) {
+    Range_u64 range = _lane_range(ctx->thread_idx, ctx->thread_count, count);
+    u64 lane_cost = 0;
+    for (u64 i = range.min; i < range.max; i++) {
+      lane_cost += desc->costs[i];
+    }
+    ins_atomic_u64_add_eval(&shared->total_cost, lane_cost);
+    _lane_sync(ctx);
+    total_cost = shared->total_cost;
+  }
+
+  for (;;) {
+    u64 begin = ins_atomic_load_acquire64(&shared->cursor);
+    if (begin >= count) {
+      break;
+    }
+
+    u64 end;
+    u64 chunk_cost = 0;
+    if (desc->costs) {
+      u64 claimed = ins_atomic_load_acquire64(&shared->cost_claimed);
+      u64 target = total_cost > claimed ? (total_cost - claimed) / split : 0;
+      end = begin;
+      while (end < count && (end - begin < min_grain || chunk_cost < target)) {
+        chunk_cost += desc->costs[end++];
+      }
+    } else {
+      u64 chunk = MAX((count - begin) / split, min_grain);
+      end = MIN(begin + chunk, count);
+    }
+
+    if (ins_atomic_u64_eval_cond_assign(&shared->cursor, end, begin) != begin) {
+      // another lane claimed first, size the chunk again from where it left off
+      continue;
+    }
+    if (chunk_cost) {
+      ins_atomic_u64_add_eval(&shared->cost_claimed, chunk_cost);
+    }
+    fn((Range_u64){.min = begin, .max = end}, user_data);
+  }
+
+  _lane_sync(ctx);
+}
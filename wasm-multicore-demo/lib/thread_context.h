@@ -37,6 +37,7 @@
 #define ins_atomic_store_release(x,v)           _InterlockedExchange((volatile LONG *)(x), (LONG)(v))
 #define ins_atomic_load_acquire64(x)            _InterlockedOr64((volatile __int64 *)(x), 0)
 #define ins_atomic_store_release64(x,v)         _InterlockedExchange64((volatile __int64 *)(x), (__int64)(v))
+#define ins_atomic_u64_eval_cond_assign(x,k,c)  InterlockedCompareExchange64((__int64 *)(x),(k),(c))
 #else
 #define thread_static __thread
 #define ins_atomic_u64_inc_eval(x)              (__atomic_fetch_add((u64 *)(x), 1, __ATOMIC_SEQ_CST) + 1)
@@ -51,6 +52,8 @@
 #define ins_atomic_store_release(x,v)           __atomic_store_n((x), (v), __ATOMIC_RELEASE)
 #define ins_atomic_load_acquire64(x)            __atomic_load_n((x), __ATOMIC_ACQUIRE)
 #define ins_atomic_store_release64(x,v)         __atomic_store_n((x), (v), __ATOMIC_RELEASE)
+// stores k if *x == c, evaluates to the value *x had
+#define ins_atomic_u64_eval_cond_assign(x,k,c)  ({ u64 _ins_old = (u64)(c); __atomic_compare_exchange_n((u64 *)(x), &_ins_old, (u64)(k), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); _ins_old; })
 #endif
 
 force_inline void cpu_pause() {
@@ -73,12 +76,27 @@ force_inline void cpu_pause() {
 
 typedef struct TaskSystem TaskSystem;
 
+// shared state of one lane_parallel_for call
+typedef struct {
+  u64 cursor;
+  u64 cost_claimed;
+  u64 total_cost;
+} LaneForShared;
+
 typedef struct ThreadContext {
   u8 thread_idx;
   u8 thread_count;
+  // two slots shared by all lanes, consecutive lane_sync_u64 calls alternate
   u64 *broadcast_memory;
+  u32 broadcast_calls;
   Barrier *barrier;
+  // two slots shared by all lanes, consecutive lane_parallel_for calls alternate
+  LaneForShared *parallel_for;
+  u32 parallel_for_calls;
   ArenaAllocator temp_arena;
+  // while time_syncs is set every lane_sync adds the time it blocked to sync_wait_ns
+  b32 time_syncs;
+  u64 sync_wait_ns;
 } ThreadContext;
 
 i8 os_core_count();
@@ -103,4 +121,31 @@ Range_u64 _lane_range(u32 thread_idx, u32 thread_count, u64 values_count);
 #define lane_range_for(thread_idx, thread_count, values_count)                 \
   _lane_range((thread_idx), (thread_count), (values_count))
 
+typedef void (*LaneForFunc)(Range_u64 range, void *user_data);
+
+typedef struct {
+  u64 count;
+  // smallest chunk handed out, 0 means 1
+  u64 min_grain;
+  // optional per-item cost hint, chunks are cut to an even share of the
+  // remaining cost instead of the remaining count
+  const u32 *costs;
+  // sum of costs if the caller already has it, summed by the lanes when 0
+  u64 total_cost;
+} LaneForDesc;
+
+/*
+  Every lane calls it with the same desc. Lanes claim chunks of [0, count)
+  off a shared cursor until it runs out: each chunk is the remaining work
+  split over twice the lane count, so chunks start big and shrink towards
+  min_grain, and a lane stuck on expensive items doesn't hold the rest
+  back. Returns once every item is done, it ends with a lane_sync.
+*/
+void _lane_parallel_for(ThreadContext *ctx, LaneForDesc *desc, LaneForFunc fn,
+                        void *user_data);
+
+#define lane_parallel_for(desc, fn, user_data)                                 \
+  _lane_parallel_for(tctx_current(), (desc), (LaneForFunc)(fn),                \
+                     (void *)(user_data))
+
 #endif
@@ -3,6 +3,7 @@
 #include "lib/common.c"
 #include "lib/memory.c"
 #include "lib/allocator_pool.c"
+#include "lib/allocator_block.c"
 #include "lib/string_builder.c"
 #include "lib/thread_context.h"
 #include "os/os.h"
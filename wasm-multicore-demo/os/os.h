@@ -168,6 +168,11 @@ OsFileReadState os_check_read_file(OsFileOp *op);
 i32 os_get_file_size(OsFileOp *op);
 b32 os_get_file_data(OsFileOp *op, _out_ PlatformFileData *data,
                      Allocator *allocator);
+// frees a finished op without taking its data: one that ended in
+// OS_FILE_READ_STATE_ERROR, or whose os_get_file_data returned false. a
+// successful os_get_file_data frees the op itself, it can't be used after
+// either
+void os_release_file_op(OsFileOp *op);
 
 typedef void *OsDynLib;
 typedef void *OsDynSymbol;
@@ -212,6 +217,22 @@ u8 *os_reserve_memory(size_t size);
 b32 os_commit_memory(void *ptr, size_t size);
 u32 os_get_page_size(void);
 
+typedef enum {
+  OS_PAGES_DEFAULT,
+  OS_PAGES_TRANSPARENT_HUGE,
+  OS_PAGES_EXPLICIT_HUGE,
+} OsPageKind;
+
+u32 os_get_huge_page_size(void);
+u32 os_get_numa_node_count(void);
+// os_reserve_memory with a page kind. huge kinds round size up to
+// os_get_huge_page_size, explicit huge pages come back already committed and
+// NULL when the pool can't cover the whole size
+u8 *os_reserve_memory_pages(size_t size, OsPageKind kind);
+// faults a committed range in now, in bulk, instead of page by page on first touch
+void os_prefault_memory(void *ptr, size_t size);
+b32 os_bind_memory_numa(void *ptr, size_t size, u32 node);
+
 const char *os_get_compressed_texture_format_suffix(void);
 
 u32 os_mic_get_available_samples(void);
@@ -0,0 +1,1824 @@
+#include "lib/typedefs.h"
+
+// pthread_timedjoin_np and pthread_setname_np need _GNU_SOURCE, defined by the build before any
+// system header gets included
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lib/thread.h"
+#include "lib/thread_context.h"
+#include "lib/string_builder.h"
+#include "os.h"
+
+typedef enum {
+  OS_LNX_ENTITY_NULL,
+  OS_LNX_ENTITY_THREAD,
+  OS_LNX_ENTITY_MUTEX,
+  OS_LNX_ENTITY_SEMAPHORE,
+  OS_LNX_ENTITY_RW_MUTEX,
+  OS_LNX_ENTITY_COND_VAR,
+  OS_LNX_ENTITY_BARRIER,
+} OsLinuxEntityKind;
+
+#define OS_LNX_MAX_PATH 512
+
+typedef struct OsLinuxEntity OsLinuxEntity;
+struct OsLinuxEntity {
+  OsLinuxEntity *next;
+  OsLinuxEntityKind kind;
+  union {
+    struct {
+      pthread_t handle;
+      ThreadFunc func;
+      void *arg;
+    } thread;
+    pthread_mutex_t mutex;
+    sem_t semaphore;
+    pthread_rwlock_t rw_mutex;
+    pthread_cond_t cond_var;
+    struct {
+      u32 count;
+      u32 spin_count;
+      u32 arrived;
+      // bumped by the last lane to arrive, waiters sleep on it
+      u32 generation;
+      u32 sleepers;
+    } barrier;
+  };
+};
+
+// async reads live outside the entity pool, a loading screen can have thousands in flight
+typedef struct OsLinuxFileOp OsLinuxFileOp;
+struct OsLinuxFileOp {
+  OsLinuxFileOp *next;
+  OsFileReadState state;
+  i32 fd;
+  // io_uring: open and statx go out together, the read waits for both
+  u32 open_pending;
+  b32 failed;
+  u8 *buffer;
+  u32 buffer_len;
+  u32 read_offset;
+  b32 buffer_in_arena;
+  struct statx statx;
+  char file_path[OS_LNX_MAX_PATH];
+};
+
+typedef enum {
+  OS_LNX_FILE_IO_NONE,
+  OS_LNX_FILE_IO_URING,
+  OS_LNX_FILE_IO_THREADS,
+} OsLinuxFileIoBackend;
+
+typedef struct {
+  b32 ready;
+  i32 fd;
+  u32 sq_entries;
+  u32 cq_entries;
+  u32 *sq_head;
+  u32 *sq_tail;
+  u32 *sq_array;
+  u32 sq_mask;
+  struct io_uring_sqe *sqes;
+  u32 *cq_head;
+  u32 *cq_tail;
+  u32 cq_mask;
+  struct io_uring_cqe *cqes;
+  // submitted requests whose completion wasn't reaped yet, kept under
+  // cq_entries so the completion ring never overflows
+  u32 inflight;
+  // prefix of the file arena that reads can target with READ_FIXED
+  size_t registered_size;
+} OsLinuxUring;
+
+#define OS_LNX_ENTITY_POOL_SIZE 256
+#define OS_LNX_ENTITY_POOL_MEMORY_SIZE                                         \
+  (sizeof(OsLinuxEntity) * OS_LNX_ENTITY_POOL_SIZE)
+
+typedef struct {
+  b32 initialized;
+
+  u32 processor_count;
+  u32 page_size;
+  u32 huge_page_size;
+  u32 numa_node_count;
+
+  pthread_mutex_t entity_mutex;
+  u8 entity_memory[OS_LNX_ENTITY_POOL_MEMORY_SIZE];
+  PoolAllocator entity_pool;
+  OsLinuxEntity *entity_free;
+
+  // async reads, file_io_mutex guards everything below
+  pthread_mutex_t file_io_mutex;
+  pthread_cond_t file_io_cond;
+  OsLinuxFileIoBackend file_io_backend;
+  u32 file_workers_started;
+  OsLinuxFileOp *file_op_free;
+  // started but not yet handed to the ring or a worker
+  OsLinuxFileOp *file_op_head;
+  OsLinuxFileOp *file_op_tail;
+  OsLinuxUring uring;
+  // every read lands here, reset once the last buffer was copied out
+  ArenaAllocator file_arena;
+  u32 file_arena_live;
+  // syscalls made on behalf of async reads, for the file io bench
+  u64 file_io_syscalls;
+} OsLinuxState;
+
+global OsLinuxState os_lnx_state = {0};
+
+#define os_lnx_assert_state_initialized() debug_assert(os_lnx_state.initialized)
+
+internal OsLinuxEntity *os_lnx_entity_alloc(OsLinuxEntityKind kind) {
+  os_lnx_assert_state_initialized();
+  OsLinuxEntity *result = NULL;
+  pthread_mutex_lock(&os_lnx_state.entity_mutex);
+  {
+    if (os_lnx_state.entity_free) {
+      result = os_lnx_state.entity_free;
+      os_lnx_state.entity_free = result->next;
+    } else {
+      result = (OsLinuxEntity *)pool_alloc(&os_lnx_state.entity_pool);
+    }
+    if (result) {
+      memset(result, 0, sizeof(OsLinuxEntity));
+    }
+  }
+  pthread_mutex_unlock(&os_lnx_state.entity_mutex);
+  if (result) {
+    result->kind = kind;
+  }
+  return result;
+}
+
+internal void os_lnx_entity_release(OsLinuxEntity *entity) {
+  if (!entity)
+    return;
+  os_lnx_assert_state_initialized();
+  entity->kind = OS_LNX_ENTITY_NULL;
+  pthread_mutex_lock(&os_lnx_state.entity_mutex);
+  entity->next = os_lnx_state.entity_free;
+  os_lnx_state.entity_free = entity;
+  pthread_mutex_unlock(&os_lnx_state.entity_mutex);
+}
+
+// absolute CLOCK_REALTIME deadline for the timed pthread waits
+internal struct timespec os_lnx_deadline(u64 timeout_us) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  u64 nsec = (u64)ts.tv_nsec + (timeout_us % 1000000) * 1000;
+  ts.tv_sec += (time_t)(timeout_us / 1000000 + nsec / 1000000000);
+  ts.tv_nsec = (long)(nsec % 1000000000);
+  return ts;
+}
+
+b32 os_is_mobile() { return false; }
+
+OSThermalState os_get_thermal_state(void) { return OS_THERMAL_STATE_UNKNOWN; }
+
+// small sysfs file into buffer, 0 terminated, returns the length
+internal u32 os_lnx_read_sys_file(const char *path, char *buffer, u32 size) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+  ssize_t len = read(fd, buffer, size - 1);
+  close(fd);
+  len = MAX(len, 0);
+  buffer[len] = 0;
+  return (u32)len;
+}
+
+// PMD huge page size and node count. node/possible is a list like 0 or 0-3,2
+// so the last number is the highest node
+internal void os_lnx_read_memory_topology(void) {
+  char buffer[64];
+  u64 huge_page_size = 0;
+  os_lnx_read_sys_file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size",
+                       buffer, sizeof(buffer));
+  for (char *c = buffer; *c >= '0' && *c <= '9'; c++) {
+    huge_page_size = huge_page_size * 10 + (u64)(*c - '0');
+  }
+  os_lnx_state.huge_page_size =
+      huge_page_size > 0 && huge_page_size <= GB(1) ? (u32)huge_page_size
+                                                    : MB(2);
+
+  u32 highest_node = 0;
+  u32 value = 0;
+  u32 len = os_lnx_read_sys_file("/sys/devices/system/node/possible", buffer,
+                                 sizeof(buffer));
+  for (u32 i = 0; i < len; i++) {
+    if (buffer[i] >= '0' && buffer[i] <= '9') {
+      value = value * 10 + (u32)(buffer[i] - '0');
+    } else {
+      highest_node = MAX(highest_node, value);
+      value = 0;
+    }
+  }
+  os_lnx_state.numa_node_count = MAX(highest_node, value) + 1;
+}
+
+void os_init(void) {
+  if (os_lnx_state.initialized)
+    return;
+
+  long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+  os_lnx_state.processor_count = processor_count > 0 ? (u32)processor_count : 1;
+  long page_size = sysconf(_SC_PAGESIZE);
+  os_lnx_state.page_size = page_size > 0 ? (u32)page_size : 4096;
+  os_lnx_read_memory_topology();
+
+  pthread_mutex_init(&os_lnx_state.entity_mutex, NULL);
+  os_lnx_state.entity_pool =
+      pool_from_buffer(os_lnx_state.entity_memory,
+                       OS_LNX_ENTITY_POOL_MEMORY_SIZE, sizeof(OsLinuxEntity));
+  os_lnx_state.entity_free = NULL;
+
+  pthread_mutex_init(&os_lnx_state.file_io_mutex, NULL);
+  pthread_cond_init(&os_lnx_state.file_io_cond, NULL);
+
+  os_lnx_state.initialized = true;
+}
+
+internal void *os_lnx_thread_wrapper(void *arg) {
+  OsLinuxEntity *entity = (OsLinuxEntity *)arg;
+  entity->thread.func(entity->thread.arg);
+  return NULL;
+}
+
+Thread os_thread_launch(ThreadFunc func, void *arg) {
+  Thread result = {0};
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_THREAD);
+  if (!entity)
+    return result;
+
+  entity->thread.func = func;
+  entity->thread.arg = arg;
+  if (pthread_create(&entity->thread.handle, NULL, os_lnx_thread_wrapper,
+                     entity) != 0) {
+    os_lnx_entity_release(entity);
+    return result;
+  }
+
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+b32 os_thread_join(Thread t, u64 timeout_us) {
+  if (t.v[0] == 0)
+    return false;
+  OsLinuxEntity *entity = (OsLinuxEntity *)t.v[0];
+  int err;
+  if (timeout_us == 0) {
+    err = pthread_join(entity->thread.handle, NULL);
+  } else {
+    struct timespec deadline = os_lnx_deadline(timeout_us);
+    err = pthread_timedjoin_np(entity->thread.handle, NULL, &deadline);
+  }
+  if (err != 0) {
+    return false;
+  }
+  os_lnx_entity_release(entity);
+  return true;
+}
+
+void os_thread_detach(Thread t) {
+  if (t.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)t.v[0];
+  pthread_detach(entity->thread.handle);
+  os_lnx_entity_release(entity);
+}
+
+void os_thread_set_name(Thread t, const char *name) {
+  if (t.v[0] == 0 || !name)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)t.v[0];
+  // the kernel caps thread names at 15 characters
+  char short_name[16];
+  strncpy(short_name, name, sizeof(short_name) - 1);
+  short_name[sizeof(short_name) - 1] = 0;
+  pthread_setname_np(entity->thread.handle, short_name);
+}
+
+Mutex os_mutex_alloc(void) {
+  Mutex result = {0};
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_MUTEX);
+  if (!entity)
+    return result;
+
+  pthread_mutex_init(&entity->mutex, NULL);
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+void os_mutex_release(Mutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_mutex_destroy(&entity->mutex);
+  os_lnx_entity_release(entity);
+}
+
+void os_mutex_take(Mutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_mutex_lock(&entity->mutex);
+}
+
+void os_mutex_drop(Mutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_mutex_unlock(&entity->mutex);
+}
+
+Semaphore os_semaphore_alloc(i32 initial_count) {
+  Semaphore result = {0};
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_SEMAPHORE);
+  if (!entity)
+    return result;
+
+  sem_init(&entity->semaphore, 0, (unsigned int)initial_count);
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+void os_semaphore_release(Semaphore s) {
+  if (s.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)s.v[0];
+  sem_destroy(&entity->semaphore);
+  os_lnx_entity_release(entity);
+}
+
+void os_semaphore_take(Semaphore s) {
+  if (s.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)s.v[0];
+  while (sem_wait(&entity->semaphore) != 0 && errno == EINTR) {
+  }
+}
+
+void os_semaphore_drop(Semaphore s) {
+  if (s.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)s.v[0];
+  sem_post(&entity->semaphore);
+}
+
+RWMutex os_rw_mutex_alloc(void) {
+  RWMutex result = {0};
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_RW_MUTEX);
+  if (!entity)
+    return result;
+
+  pthread_rwlock_init(&entity->rw_mutex, NULL);
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+void os_rw_mutex_release(RWMutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_rwlock_destroy(&entity->rw_mutex);
+  os_lnx_entity_release(entity);
+}
+
+void os_rw_mutex_take_r(RWMutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_rwlock_rdlock(&entity->rw_mutex);
+}
+
+void os_rw_mutex_drop_r(RWMutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_rwlock_unlock(&entity->rw_mutex);
+}
+
+void os_rw_mutex_take_w(RWMutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_rwlock_wrlock(&entity->rw_mutex);
+}
+
+void os_rw_mutex_drop_w(RWMutex m) {
+  if (m.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)m.v[0];
+  pthread_rwlock_unlock(&entity->rw_mutex);
+}
+
+CondVar os_cond_var_alloc(void) {
+  CondVar result = {0};
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_COND_VAR);
+  if (!entity)
+    return result;
+
+  pthread_cond_init(&entity->cond_var, NULL);
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+void os_cond_var_release(CondVar c) {
+  if (c.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)c.v[0];
+  pthread_cond_destroy(&entity->cond_var);
+  os_lnx_entity_release(entity);
+}
+
+b32 os_cond_var_wait(CondVar c, Mutex m, u64 timeout_us) {
+  if (c.v[0] == 0 || m.v[0] == 0)
+    return false;
+  OsLinuxEntity *entity = (OsLinuxEntity *)c.v[0];
+  OsLinuxEntity *mutex_entity = (OsLinuxEntity *)m.v[0];
+  if (timeout_us == 0) {
+    return pthread_cond_wait(&entity->cond_var, &mutex_entity->mutex) == 0;
+  }
+  struct timespec deadline = os_lnx_deadline(timeout_us);
+  return pthread_cond_timedwait(&entity->cond_var, &mutex_entity->mutex,
+                                &deadline) == 0;
+}
+
+void os_cond_var_signal(CondVar c) {
+  if (c.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)c.v[0];
+  pthread_cond_signal(&entity->cond_var);
+}
+
+void os_cond_var_broadcast(CondVar c) {
+  if (c.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)c.v[0];
+  pthread_cond_broadcast(&entity->cond_var);
+}
+
+// rounds a lane spins on the barrier generation before it sleeps on the futex
+#define OS_LNX_BARRIER_SPIN_COUNT 4096
+
+internal void os_lnx_futex_wait(u32 *addr, u32 expected) {
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+internal void os_lnx_futex_wake_all(u32 *addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+}
+
+Barrier os_barrier_alloc(u32 count) {
+  Barrier result = {0};
+  if (count == 0)
+    return result;
+  OsLinuxEntity *entity = os_lnx_entity_alloc(OS_LNX_ENTITY_BARRIER);
+  if (!entity)
+    return result;
+
+  entity->barrier.count = count;
+  // with more lanes than cores the lane we'd spin for may be waiting for our core
+  entity->barrier.spin_count =
+      count <= os_lnx_state.processor_count ? OS_LNX_BARRIER_SPIN_COUNT : 0;
+  entity->barrier.arrived = 0;
+  entity->barrier.generation = 0;
+  entity->barrier.sleepers = 0;
+  result.v[0] = (u64)entity;
+  return result;
+}
+
+void os_barrier_release(Barrier b) {
+  if (b.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)b.v[0];
+  os_lnx_entity_release(entity);
+}
+
+// sense reversing: every lane reads the generation before arriving, the last
+// one resets the count and bumps the generation, the others wait for it to
+// change. they spin first, a lane sync is usually short, then sleep on a futex
+void os_barrier_wait(Barrier b) {
+  if (b.v[0] == 0)
+    return;
+  OsLinuxEntity *entity = (OsLinuxEntity *)b.v[0];
+  u32 generation = ins_atomic_load_acquire(&entity->barrier.generation);
+
+  if (ins_atomic_u32_inc_eval(&entity->barrier.arrived) ==
+      entity->barrier.count) {
+    entity->barrier.arrived = 0;
+    ins_atomic_u32_inc_eval(&entity->barrier.generation);
+    // a full RMW, a lane that went to sleep before the bump must be seen
+    if (ins_atomic_u32_add_eval(&entity->barrier.sleepers, 0) > 0) {
+      os_lnx_futex_wake_all(&entity->barrier.generation);
+    }
+    return;
+  }
+
+  for (u32 i = 0; i < entity->barrier.spin_count; i++) {
+    if (ins_atomic_load_acquire(&entity->barrier.generation) != generation) {
+      return;
+    }
+    cpu_pause();
+  }
+
+  ins_atomic_u32_inc_eval(&entity->barrier.sleepers);
+  while (ins_atomic_load_acquire(&entity->barrier.generation) == generation) {
+    os_lnx_futex_wait(&entity->barrier.generation, generation);
+  }
+  ins_atomic_u32_dec_eval(&entity->barrier.sleepers);
+}
+
+// handlers run on their own stack so a stack overflow can still be reported
+#define OS_LNX_CRASH_STACK_SIZE KB(64)
+global u8 os_lnx_crash_stack[OS_LNX_CRASH_STACK_SIZE];
+
+internal void os_lnx_crash_write(const char *str) {
+  ssize_t unused = write(STDERR_FILENO, str, strlen(str));
+  UNUSED(unused);
+}
+
+internal const char *os_lnx_signal_name(int sig) {
+  switch (sig) {
+  case SIGSEGV:
+    return "SIGSEGV";
+  case SIGBUS:
+    return "SIGBUS";
+  case SIGFPE:
+    return "SIGFPE";
+  case SIGILL:
+    return "SIGILL";
+  case SIGABRT:
+    return "SIGABRT";
+  default:
+    return "signal";
+  }
+}
+
+// only async signal safe calls from here: write, backtrace after it was warmed
+// up, and fmt_string which formats into the stack buffer
+internal void os_lnx_crash_handler(int sig, siginfo_t *info, void *ucontext) {
+  UNUSED(ucontext);
+  char buffer[256];
+  FmtArg args[] = {FMT_STR(os_lnx_signal_name(sig)), FMT_UINT(sig),
+                   FMT_HEX((u64)info->si_addr)};
+  FmtArgs fmt_args = {args, ARRAY_SIZE(args)};
+  fmt_string(buffer, sizeof(buffer),
+             "\n=== CRASH: % (signal %) at address % ===\n", &fmt_args);
+  os_lnx_crash_write(buffer);
+
+  void *frames[64];
+  int frame_count = backtrace(frames, ARRAY_SIZE(frames));
+  backtrace_symbols_fd(frames, frame_count, STDERR_FILENO);
+  os_lnx_crash_write("===========================\n");
+
+  // SA_RESETHAND put the default action back, re-raise for the core dump and
+  // the exit status
+  raise(sig);
+}
+
+void os_install_crash_handler(void) {
+  // the first backtrace loads libgcc, which allocates. not inside a handler
+  void *warmup[1];
+  backtrace(warmup, 1);
+
+  stack_t stack = {0};
+  stack.ss_sp = os_lnx_crash_stack;
+  stack.ss_size = sizeof(os_lnx_crash_stack);
+  sigaltstack(&stack, NULL);
+
+  struct sigaction action = {0};
+  action.sa_sigaction = os_lnx_crash_handler;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND;
+  sigemptyset(&action.sa_mask);
+
+  int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+  for (u32 i = 0; i < ARRAY_SIZE(signals); i++) {
+    sigaction(signals[i], &action, NULL);
+  }
+}
+
+void assert_log(u8 log_level, const char *fmt, const FmtArgs *args,
+                const char *file_name, uint32 line_number) {
+  os_log(log_level, fmt, args, file_name, line_number);
+}
+
+void os_log(LogLevel log_level, const char *fmt, const FmtArgs *args,
+            const char *file_name, uint32 line_number) {
+  char buffer[1024];
+  fmt_string(buffer, sizeof(buffer), fmt, args);
+
+  const char *level_str;
+  const char *color_start = "";
+  const char *color_end = "";
+  FILE *output;
+
+  switch (log_level) {
+  case LOGLEVEL_INFO:
+    level_str = "INFO";
+    output = stdout;
+    break;
+  case LOGLEVEL_WARN:
+    level_str = "WARN";
+    output = stderr;
+    if (isatty(fileno(stderr))) {
+      color_start = "\033[33m";
+      color_end = "\033[0m";
+    }
+    break;
+  case LOGLEVEL_ERROR:
+    level_str = "ERROR";
+    output = stderr;
+    if (isatty(fileno(stderr))) {
+      color_start = "\033[31m";
+      color_end = "\033[0m";
+    }
+    break;
+  default:
+    level_str = "UNKNOWN";
+    output = stderr;
+    break;
+  }
+
+  fprintf(output, "%s[%s] %s:%u: %s%s\n", color_start, level_str, file_name,
+          line_number, buffer, color_end);
+  fflush(output);
+}
+
+bool32 os_write_file(const char *file_path, u8 *buffer, size_t buffer_len) {
+  int fd = open(file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_ERROR("Error opening file for writing: %", FMT_STR(file_path));
+    return false;
+  }
+
+  size_t written = 0;
+  while (written < buffer_len) {
+    ssize_t n = write(fd, buffer + written, buffer_len - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_ERROR("Error writing to file: %", FMT_STR(file_path));
+      close(fd);
+      return false;
+    }
+    written += (size_t)n;
+  }
+
+  close(fd);
+  return true;
+}
+
+bool32 os_create_dir(const char *dir_path) {
+  char path[4096];
+  size_t len = strlen(dir_path);
+  if (len == 0 || len >= sizeof(path)) {
+    return false;
+  }
+  memcpy(path, dir_path, len + 1);
+
+  // mkdir -p: create every parent first
+  for (size_t i = 1; i < len; i++) {
+    if (path[i] == '/') {
+      path[i] = 0;
+      if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+      path[i] = '/';
+    }
+  }
+  return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+PlatformFileData os_read_file(const char *file_path, Allocator *allocator) {
+  PlatformFileData result = {0};
+
+  int fd = open(file_path, O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open file: %", FMT_STR(file_path));
+    return result;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG_ERROR("Failed to get file size: %", FMT_STR(file_path));
+    close(fd);
+    return result;
+  }
+
+  result.buffer = ALLOC_ARRAY(allocator, uint8, st.st_size);
+  if (!result.buffer) {
+    LOG_ERROR("Failed to allocate memory for file: %", FMT_STR(file_path));
+    close(fd);
+    return result;
+  }
+
+  size_t total = 0;
+  while (total < (size_t)st.st_size) {
+    ssize_t n = read(fd, result.buffer + total, (size_t)st.st_size - total);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_ERROR("Failed to read file completely: %", FMT_STR(file_path));
+      close(fd);
+      return result;
+    }
+    total += (size_t)n;
+  }
+
+  close(fd);
+  result.buffer_len = (uint32)st.st_size;
+  result.success = true;
+  return result;
+}
+
+// async reads: os_start_read_file queues the op, a backend drains the queue.
+// io_uring batches open, statx, read and close requests and os_check_read_file
+// reaps the completion ring from shared memory, entering the kernel only when
+// there are new requests to submit. kernels without io_uring get a few worker
+// threads doing open/fstat/pread instead. both land the data in the file arena
+
+#define OS_LNX_FILE_OP_BLOCK_COUNT 256
+#define OS_LNX_FILE_ARENA_SIZE MB(32)
+#define OS_LNX_FILE_ARENA_ALIGN 64
+#define OS_LNX_FILE_WORKERS_MAX 8
+#define OS_LNX_URING_ENTRIES 256
+
+// low bits of a request's user_data, the op pointer is in the rest
+typedef enum {
+  OS_LNX_URING_TAG_OPEN,
+  OS_LNX_URING_TAG_STATX,
+  OS_LNX_URING_TAG_READ,
+  OS_LNX_URING_TAG_CLOSE,
+} OsLinuxUringTag;
+
+#define OS_LNX_URING_TAG_MASK 7ull
+
+#define os_lnx_file_io_syscall()                                               \
+  ins_atomic_u64_inc_eval(&os_lnx_state.file_io_syscalls)
+
+// file_io_mutex held
+internal OsLinuxFileOp *os_lnx_file_op_alloc(void) {
+  if (!os_lnx_state.file_op_free) {
+    os_lnx_file_io_syscall();
+    OsLinuxFileOp *block = (OsLinuxFileOp *)os_allocate_memory(
+        sizeof(OsLinuxFileOp) * OS_LNX_FILE_OP_BLOCK_COUNT);
+    if (!block) {
+      return NULL;
+    }
+    for (u32 i = 0; i < OS_LNX_FILE_OP_BLOCK_COUNT; i++) {
+      block[i].next = os_lnx_state.file_op_free;
+      os_lnx_state.file_op_free = &block[i];
+    }
+  }
+  OsLinuxFileOp *op = os_lnx_state.file_op_free;
+  os_lnx_state.file_op_free = op->next;
+  memset(op, 0, offsetof(OsLinuxFileOp, file_path));
+  op->fd = -1;
+  op->state = OS_FILE_READ_STATE_IN_PROGRESS;
+  return op;
+}
+
+// file_io_mutex held. small files share the arena, the rare one that doesn't
+// fit gets its own pages
+internal u8 *os_lnx_file_buffer_alloc(OsLinuxFileOp *op) {
+  ArenaAllocator *arena = &os_lnx_state.file_arena;
+  size_t size = MAX(op->buffer_len, 1);
+  if (arena_free_size(arena) >= size + OS_LNX_FILE_ARENA_ALIGN) {
+    op->buffer_in_arena = true;
+    os_lnx_state.file_arena_live++;
+    return arena_alloc_align(arena, size, OS_LNX_FILE_ARENA_ALIGN);
+  }
+  op->buffer_in_arena = false;
+  os_lnx_file_io_syscall();
+  return os_allocate_memory(size);
+}
+
+// file_io_mutex held
+internal void os_lnx_file_buffer_free(OsLinuxFileOp *op) {
+  if (!op->buffer) {
+    return;
+  }
+  if (op->buffer_in_arena) {
+    if (--os_lnx_state.file_arena_live == 0) {
+      arena_reset(&os_lnx_state.file_arena);
+    }
+  } else {
+    os_lnx_file_io_syscall();
+    os_free_memory(op->buffer, MAX(op->buffer_len, 1));
+  }
+  op->buffer = NULL;
+}
+
+internal b32 os_lnx_uring_init(OsLinuxUring *ring) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  i32 fd = (i32)syscall(__NR_io_uring_setup, OS_LNX_URING_ENTRIES, &params);
+  if (fd < 0) {
+    LOG_WARN("io_uring unavailable (errno %), reading files on worker threads",
+             FMT_INT(errno));
+    return false;
+  }
+  // both rings in one mapping came in 5.4, openat and statx requests in 5.6
+  // together with RW_CUR_POS
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP) ||
+      !(params.features & IORING_FEAT_RW_CUR_POS)) {
+    LOG_WARN("io_uring too old, reading files on worker threads");
+    close(fd);
+    return false;
+  }
+
+  size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+  size_t cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  u8 *rings = mmap(NULL, MAX(sq_size, cq_size), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (rings == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  void *sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe),
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    munmap(rings, MAX(sq_size, cq_size));
+    close(fd);
+    return false;
+  }
+
+  ring->fd = fd;
+  ring->sq_entries = params.sq_entries;
+  ring->cq_entries = params.cq_entries;
+  ring->sq_head = (u32 *)(rings + params.sq_off.head);
+  ring->sq_tail = (u32 *)(rings + params.sq_off.tail);
+  ring->sq_array = (u32 *)(rings + params.sq_off.array);
+  ring->sq_mask = *(u32 *)(rings + params.sq_off.ring_mask);
+  ring->sqes = (struct io_uring_sqe *)sqes;
+  ring->cq_head = (u32 *)(rings + params.cq_off.head);
+  ring->cq_tail = (u32 *)(rings + params.cq_off.tail);
+  ring->cq_mask = *(u32 *)(rings + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+
+  // registered pages are pinned and count against RLIMIT_MEMLOCK, take the
+  // biggest prefix of the arena the limit allows. reads past it still work,
+  // the kernel just maps the pages per request
+  ArenaAllocator *arena = &os_lnx_state.file_arena;
+  for (size_t size = arena->reserved; size >= MB(1); size /= 2) {
+    struct iovec iov = {.iov_base = arena->buffer, .iov_len = size};
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &iov,
+                1) == 0) {
+      ring->registered_size = size;
+      break;
+    }
+  }
+
+  ring->ready = true;
+  return true;
+}
+
+// file_io_mutex held. hands every queued request to the kernel in one call
+internal i32 os_lnx_uring_submit(OsLinuxUring *ring) {
+  u32 pending = *ring->sq_tail - ins_atomic_load_acquire(ring->sq_head);
+  if (pending == 0) {
+    return 0;
+  }
+  os_lnx_file_io_syscall();
+  i32 submitted =
+      (i32)syscall(__NR_io_uring_enter, ring->fd, pending, 0, 0, NULL, 0);
+  if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+    LOG_ERROR("io_uring_enter failed, errno %", FMT_INT(errno));
+  }
+  return submitted;
+}
+
+// file_io_mutex held. only submits when the ring is full, otherwise requests
+// wait for the next pump
+internal b32 os_lnx_uring_push(OsLinuxUring *ring, struct io_uring_sqe *sqe) {
+  u32 tail = *ring->sq_tail;
+  while (tail - ins_atomic_load_acquire(ring->sq_head) == ring->sq_entries) {
+    if (os_lnx_uring_submit(ring) <= 0) {
+      return false;
+    }
+  }
+  u32 index = tail & ring->sq_mask;
+  ring->sqes[index] = *sqe;
+  ring->sq_array[index] = index;
+  ins_atomic_store_release(ring->sq_tail, tail + 1);
+  ring->inflight++;
+  return true;
+}
+
+internal void os_lnx_uring_close(OsLinuxUring *ring, i32 fd) {
+  struct io_uring_sqe sqe = {0};
+  sqe.opcode = IORING_OP_CLOSE;
+  sqe.fd = fd;
+  sqe.user_data = OS_LNX_URING_TAG_CLOSE;
+  if (!os_lnx_uring_push(ring, &sqe)) {
+    close(fd);
+  }
+}
+
+internal void os_lnx_uring_finish(OsLinuxUring *ring, OsLinuxFileOp *op,
+                                  OsFileReadState state) {
+  if (op->fd >= 0) {
+    os_lnx_uring_close(ring, op->fd);
+    op->fd = -1;
+  }
+  if (state == OS_FILE_READ_STATE_ERROR) {
+    os_lnx_file_buffer_free(op);
+  }
+  ins_atomic_store_release(&op->state, state);
+}
+
+internal void os_lnx_uring_read(OsLinuxUring *ring, OsLinuxFileOp *op) {
+  struct io_uring_sqe sqe = {0};
+  u8 *dst = op->buffer + op->read_offset;
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = op->fd;
+  sqe.addr = (u64)(uintptr)dst;
+  sqe.len = op->buffer_len - op->read_offset;
+  sqe.off = op->read_offset;
+  sqe.user_data = (u64)(uintptr)op | OS_LNX_URING_TAG_READ;
+  u8 *registered_end = os_lnx_state.file_arena.buffer + ring->registered_size;
+  if (op->buffer_in_arena && dst + sqe.len <= registered_end) {
+    sqe.opcode = IORING_OP_READ_FIXED;
+    sqe.buf_index = 0;
+  }
+  if (!os_lnx_uring_push(ring, &sqe)) {
+    os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_ERROR);
+  }
+}
+
+internal void os_lnx_uring_start(OsLinuxUring *ring, OsLinuxFileOp *op) {
+  struct io_uring_sqe open = {0};
+  open.opcode = IORING_OP_OPENAT;
+  open.fd = AT_FDCWD;
+  open.addr = (u64)(uintptr)op->file_path;
+  open.open_flags = O_RDONLY | O_CLOEXEC;
+  open.user_data = (u64)(uintptr)op | OS_LNX_URING_TAG_OPEN;
+
+  struct io_uring_sqe stat = {0};
+  stat.opcode = IORING_OP_STATX;
+  stat.fd = AT_FDCWD;
+  stat.addr = (u64)(uintptr)op->file_path;
+  stat.len = STATX_SIZE;
+  stat.off = (u64)(uintptr)&op->statx;
+  stat.user_data = (u64)(uintptr)op | OS_LNX_URING_TAG_STATX;
+
+  op->open_pending = 0;
+  if (os_lnx_uring_push(ring, &open)) {
+    op->open_pending++;
+  } else {
+    op->failed = true;
+  }
+  if (os_lnx_uring_push(ring, &stat)) {
+    op->open_pending++;
+  } else {
+    op->failed = true;
+  }
+  if (op->open_pending == 0) {
+    os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_ERROR);
+  }
+}
+
+internal void os_lnx_uring_opened(OsLinuxUring *ring, OsLinuxFileOp *op) {
+  if (op->failed || op->statx.stx_size > UINT32_MAX) {
+    os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_ERROR);
+    return;
+  }
+  op->buffer_len = (u32)op->statx.stx_size;
+  op->buffer = os_lnx_file_buffer_alloc(op);
+  if (!op->buffer) {
+    os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_ERROR);
+  } else if (op->buffer_len == 0) {
+    os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_COMPLETED);
+  } else {
+    os_lnx_uring_read(ring, op);
+  }
+}
+
+internal void os_lnx_uring_complete(OsLinuxUring *ring,
+                                    struct io_uring_cqe cqe) {
+  ring->inflight--;
+  OsLinuxUringTag tag = (OsLinuxUringTag)(cqe.user_data & OS_LNX_URING_TAG_MASK);
+  OsLinuxFileOp *op =
+      (OsLinuxFileOp *)(uintptr)(cqe.user_data & ~OS_LNX_URING_TAG_MASK);
+
+  switch (tag) {
+  case OS_LNX_URING_TAG_OPEN:
+  case OS_LNX_URING_TAG_STATX:
+    if (cqe.res < 0) {
+      op->failed = true;
+    } else if (tag == OS_LNX_URING_TAG_OPEN) {
+      op->fd = cqe.res;
+    }
+    if (--op->open_pending == 0) {
+      os_lnx_uring_opened(ring, op);
+    }
+    break;
+  case OS_LNX_URING_TAG_READ:
+    if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+      os_lnx_uring_read(ring, op);
+    } else if (cqe.res <= 0) {
+      // 0 means the file shrank since statx
+      os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_ERROR);
+    } else {
+      op->read_offset += (u32)cqe.res;
+      if (op->read_offset < op->buffer_len) {
+        os_lnx_uring_read(ring, op);
+      } else {
+        os_lnx_uring_finish(ring, op, OS_FILE_READ_STATE_COMPLETED);
+      }
+    }
+    break;
+  case OS_LNX_URING_TAG_CLOSE:
+    break;
+  }
+}
+
+// file_io_mutex held. reaps completions, starts queued ops while the
+// completion ring has room for their requests and submits the batch. reads
+// served from the page cache complete inside the submit, so loop until the
+// kernel has nothing new for us
+internal void os_lnx_uring_pump(OsLinuxUring *ring) {
+  for (;;) {
+    u32 head = *ring->cq_head;
+    u32 tail = ins_atomic_load_acquire(ring->cq_tail);
+    for (; head != tail; head++) {
+      struct io_uring_cqe cqe = ring->cqes[head & ring->cq_mask];
+      ins_atomic_store_release(ring->cq_head, head + 1);
+      os_lnx_uring_complete(ring, cqe);
+    }
+
+    // open and statx, each completion after that queues at most one request
+    while (os_lnx_state.file_op_head && ring->inflight + 2 <= ring->cq_entries) {
+      OsLinuxFileOp *op = os_lnx_state.file_op_head;
+      os_lnx_state.file_op_head = op->next;
+      if (!os_lnx_state.file_op_head) {
+        os_lnx_state.file_op_tail = NULL;
+      }
+      os_lnx_uring_start(ring, op);
+    }
+
+    if (os_lnx_uring_submit(ring) <= 0) {
+      break;
+    }
+  }
+}
+
+// worker thread fallback: the whole file in one go, the caller copies it out
+// with os_get_file_data
+internal void os_lnx_file_op_run(OsLinuxFileOp *op) {
+  OsFileReadState state = OS_FILE_READ_STATE_ERROR;
+  os_lnx_file_io_syscall();
+  int fd = open(op->file_path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd >= 0 && (os_lnx_file_io_syscall(), fstat(fd, &st) == 0) &&
+      st.st_size <= UINT32_MAX) {
+    op->buffer_len = (u32)st.st_size;
+    pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+    op->buffer = os_lnx_file_buffer_alloc(op);
+    pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+
+    while (op->buffer && op->read_offset < op->buffer_len) {
+      os_lnx_file_io_syscall();
+      ssize_t n = pread(fd, op->buffer + op->read_offset,
+                        op->buffer_len - op->read_offset, op->read_offset);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      op->read_offset += (u32)n;
+    }
+    if (op->buffer && op->read_offset == op->buffer_len) {
+      state = OS_FILE_READ_STATE_COMPLETED;
+    } else {
+      pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+      os_lnx_file_buffer_free(op);
+      pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+    }
+  }
+  if (fd >= 0) {
+    os_lnx_file_io_syscall();
+    close(fd);
+  }
+  ins_atomic_store_release(&op->state, state);
+}
+
+internal void *os_lnx_file_op_worker(void *arg) {
+  UNUSED(arg);
+  for (;;) {
+    pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+    while (!os_lnx_state.file_op_head) {
+      pthread_cond_wait(&os_lnx_state.file_io_cond,
+                        &os_lnx_state.file_io_mutex);
+    }
+    OsLinuxFileOp *op = os_lnx_state.file_op_head;
+    os_lnx_state.file_op_head = op->next;
+    if (!os_lnx_state.file_op_head) {
+      os_lnx_state.file_op_tail = NULL;
+    }
+    pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+
+    os_lnx_file_op_run(op);
+  }
+  return NULL;
+}
+
+// file_io_mutex held. the arena and the backend are set up by the first read.
+// switching backends is only safe while no read is in flight, the file io
+// bench uses it to compare the two
+internal b32 os_lnx_file_io_use(OsLinuxFileIoBackend backend) {
+  if (!os_lnx_state.file_arena.buffer) {
+    u8 *memory = os_allocate_memory(OS_LNX_FILE_ARENA_SIZE);
+    if (!memory) {
+      return false;
+    }
+    os_lnx_state.file_arena = arena_from_buffer(memory, OS_LNX_FILE_ARENA_SIZE);
+  }
+
+  if (backend == OS_LNX_FILE_IO_URING) {
+    if (!os_lnx_state.uring.ready && !os_lnx_uring_init(&os_lnx_state.uring)) {
+      return false;
+    }
+  } else {
+    // io bound, so more workers than cores is fine
+    u32 worker_count =
+        MIN(MAX(os_lnx_state.processor_count, 2), OS_LNX_FILE_WORKERS_MAX);
+    for (; os_lnx_state.file_workers_started < worker_count;
+         os_lnx_state.file_workers_started++) {
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, os_lnx_file_op_worker, NULL) != 0) {
+        break;
+      }
+      pthread_detach(thread);
+      pthread_setname_np(thread, "os_file_read");
+    }
+    if (os_lnx_state.file_workers_started == 0) {
+      return false;
+    }
+  }
+  os_lnx_state.file_io_backend = backend;
+  return true;
+}
+
+// finished ops only, the backend is done with them
+internal void os_lnx_file_op_free(OsLinuxFileOp *op) {
+  pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+  os_lnx_file_buffer_free(op);
+  op->next = os_lnx_state.file_op_free;
+  os_lnx_state.file_op_free = op;
+  pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+}
+
+OsFileOp *os_start_read_file(const char *file_path) {
+  size_t path_len = strlen(file_path);
+  if (path_len >= OS_LNX_MAX_PATH) {
+    return NULL;
+  }
+
+  OsLinuxFileOp *op = NULL;
+  pthread_mutex_lock(&os_lnx_state.file_io_mutex);
+  if (os_lnx_state.file_io_backend == OS_LNX_FILE_IO_NONE &&
+      !os_lnx_file_io_use(OS_LNX_FILE_IO_URING)) {
+    os_lnx_file_io_use(OS_LNX_FILE_IO_THREADS);
+  }
+  if (os_lnx_state.file_io_backend != OS_LNX_FILE_IO_NONE) {
+    op = os_lnx_file_op_alloc();
+  }
+  if (op) {
+    memcpy(op->file_path, file_path, path_len + 1);
+    if (os_lnx_state.file_op_tail) {
+      os_lnx_state.file_op_tail->next = op;
+    } else {
+      os_lnx_state.file_op_head = op;
+    }
+    os_lnx_state.file_op_tail = op;
+    // io_uring ops wait for the next os_check_read_file to go out in a batch
+    if (os_lnx_state.file_io_backend == OS_LNX_FILE_IO_THREADS) {
+      pthread_cond_signal(&os_lnx_state.file_io_cond);
+    }
+  }
+  pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+
+  return (OsFileOp *)op;
+}
+
+OsFileReadState os_check_read_file(OsFileOp *op) {
+  if (!op)
+    return OS_FILE_READ_STATE_ERROR;
+  OsLinuxFileOp *file_op = (OsLinuxFileOp *)op;
+  OsFileReadState state = ins_atomic_load_acquire(&file_op->state);
+  // whichever lane gets the lock reaps for everyone, the others just poll
+  if (state == OS_FILE_READ_STATE_IN_PROGRESS &&
+      os_lnx_state.file_io_backend == OS_LNX_FILE_IO_URING &&
+      pthread_mutex_trylock(&os_lnx_state.file_io_mutex) == 0) {
+    os_lnx_uring_pump(&os_lnx_state.uring);
+    pthread_mutex_unlock(&os_lnx_state.file_io_mutex);
+    state = ins_atomic_load_acquire(&file_op->state);
+  }
+  return state;
+}
+
+i32 os_get_file_size(OsFileOp *op) {
+  if (!op)
+    return -1;
+  OsLinuxFileOp *file_op = (OsLinuxFileOp *)op;
+  OsFileReadState state = ins_atomic_load_acquire(&file_op->state);
+  return (state == OS_FILE_READ_STATE_COMPLETED) ? (i32)file_op->buffer_len
+                                                 : -1;
+}
+
+b32 os_get_file_data(OsFileOp *op, _out_ PlatformFileData *data,
+                     Allocator *allocator) {
+  if (!op)
+    return false;
+  OsLinuxFileOp *file_op = (OsLinuxFileOp *)op;
+  OsFileReadState state = ins_atomic_load_acquire(&file_op->state);
+
+  if (state != OS_FILE_READ_STATE_COMPLETED || !file_op->buffer) {
+    return false;
+  }
+
+  data->buffer_len = file_op->buffer_len;
+  data->buffer = ALLOC_ARRAY(allocator, u8, file_op->buffer_len);
+  if (!data->buffer) {
+    return false;
+  }
+
+  memcpy(data->buffer, file_op->buffer, file_op->buffer_len);
+  data->success = true;
+
+  os_lnx_file_op_free(file_op);
+  return true;
+}
+
+void os_release_file_op(OsFileOp *op) {
+  if (!op)
+    return;
+  OsLinuxFileOp *file_op = (OsLinuxFileOp *)op;
+  debug_assert_msg(ins_atomic_load_acquire(&file_op->state) !=
+                       OS_FILE_READ_STATE_IN_PROGRESS,
+                   "os_release_file_op: % is still being read",
+                   FMT_STR(file_op->file_path));
+  os_lnx_file_op_free(file_op);
+}
+
+OsDynLib os_dynlib_load(const char *path) {
+  OsDynLib lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!lib) {
+    LOG_ERROR("os_dynlib_load failed: %", FMT_STR(dlerror()));
+  }
+  return lib;
+}
+
+void os_dynlib_unload(OsDynLib lib) {
+  if (lib) {
+    dlclose(lib);
+  }
+}
+
+OsDynSymbol os_dynlib_get_symbol(OsDynLib lib, const char *symbol_name) {
+  if (!lib)
+    return NULL;
+  return (OsDynSymbol)dlsym(lib, symbol_name);
+}
+
+OsFileInfo os_file_info(const char *path) {
+  OsFileInfo info = {0};
+  struct stat st;
+  if (stat(path, &st) == 0) {
+    info.modification_time = (i64)st.st_mtime;
+    info.exists = true;
+  } else {
+    info.exists = false;
+  }
+  return info;
+}
+
+b32 os_file_copy(const char *src_path, const char *dst_path) {
+  int src = open(src_path, O_RDONLY | O_CLOEXEC);
+  if (src < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(src, &st) != 0) {
+    close(src);
+    return false;
+  }
+  int dst =
+      open(dst_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+  if (dst < 0) {
+    close(src);
+    return false;
+  }
+
+  // the kernel copies page cache to page cache, nothing goes through us
+  b32 success = true;
+  off_t offset = 0;
+  while (offset < st.st_size) {
+    ssize_t n = sendfile(dst, src, &offset, (size_t)(st.st_size - offset));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      success = false;
+      break;
+    }
+  }
+
+  close(src);
+  close(dst);
+  return success;
+}
+
+b32 os_file_remove(const char *path) { return unlink(path) == 0; }
+
+b32 os_file_exists(const char *path) { return access(path, F_OK) == 0; }
+
+internal b32 os_lnx_is_dot_entry(const char *name) {
+  return (name[0] == '.' && name[1] == 0) ||
+         (name[0] == '.' && name[1] == '.' && name[2] == 0);
+}
+
+// d_type is DT_UNKNOWN on some filesystems and DT_LNK doesn't say what the
+// link points at, stat answers both
+internal b32 os_lnx_entry_is_dir(const char *full_path, struct dirent *entry) {
+  if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK) {
+    return entry->d_type == DT_DIR;
+  }
+  struct stat st;
+  return stat(full_path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+internal b32 os_lnx_join_path(char *out, const char *directory,
+                              const char *name) {
+  int len = snprintf(out, OS_LNX_MAX_PATH, "%s/%s", directory, name);
+  return len > 0 && len < OS_LNX_MAX_PATH;
+}
+
+static b32 copy_directory_recursive(const char *src_path,
+                                    const char *dst_path) {
+  if (!os_create_dir(dst_path)) {
+    return false;
+  }
+
+  DIR *dir = opendir(src_path);
+  if (!dir) {
+    return false;
+  }
+
+  b32 success = true;
+  struct dirent *entry;
+  while (success && (entry = readdir(dir)) != NULL) {
+    if (os_lnx_is_dot_entry(entry->d_name)) {
+      continue;
+    }
+
+    char src_full[OS_LNX_MAX_PATH];
+    char dst_full[OS_LNX_MAX_PATH];
+    if (!os_lnx_join_path(src_full, src_path, entry->d_name) ||
+        !os_lnx_join_path(dst_full, dst_path, entry->d_name)) {
+      success = false;
+      break;
+    }
+
+    if (os_lnx_entry_is_dir(src_full, entry)) {
+      success = copy_directory_recursive(src_full, dst_full);
+    } else {
+      success = os_file_copy(src_full, dst_full);
+    }
+  }
+
+  closedir(dir);
+  return success;
+}
+
+b32 os_directory_copy(const char *src_path, const char *dst_path) {
+  return copy_directory_recursive(src_path, dst_path);
+}
+
+static b32 remove_directory_recursive(const char *path) {
+  DIR *dir = opendir(path);
+  if (!dir) {
+    return false;
+  }
+
+  b32 success = true;
+  struct dirent *entry;
+  while (success && (entry = readdir(dir)) != NULL) {
+    if (os_lnx_is_dot_entry(entry->d_name)) {
+      continue;
+    }
+
+    char full_path[OS_LNX_MAX_PATH];
+    if (!os_lnx_join_path(full_path, path, entry->d_name)) {
+      success = false;
+      break;
+    }
+
+    // links are removed, never followed
+    if (entry->d_type == DT_DIR) {
+      success = remove_directory_recursive(full_path);
+    } else if (entry->d_type == DT_UNKNOWN) {
+      struct stat st;
+      if (lstat(full_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        success = remove_directory_recursive(full_path);
+      } else {
+        success = unlink(full_path) == 0;
+      }
+    } else {
+      success = unlink(full_path) == 0;
+    }
+  }
+
+  closedir(dir);
+
+  if (success) {
+    return rmdir(path) == 0;
+  }
+  return false;
+}
+
+b32 os_directory_remove(const char *path) {
+  return remove_directory_recursive(path);
+}
+
+b32 os_system(const char *command) {
+  int status = system(command);
+  return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+b32 os_symlink(const char *target_path, const char *link_path) {
+  unlink(link_path);
+  rmdir(link_path);
+  // relative targets resolve against the link's directory, like on windows
+  return symlink(target_path, link_path) == 0;
+}
+
+b32 os_symlink_remove(const char *link_path) {
+  struct stat st;
+  if (lstat(link_path, &st) != 0 || !S_ISLNK(st.st_mode)) {
+    return false;
+  }
+  return unlink(link_path) == 0;
+}
+
+// up to 256 entries, paths are directory/name
+internal OsFileList os_lnx_list_entries(const char *directory,
+                                        const char *extension, b32 want_dirs,
+                                        Allocator *allocator) {
+  OsFileList result = {0};
+  u32 ext_len = extension ? str_len(extension) : 0;
+
+  DIR *dir = opendir(directory);
+  if (!dir) {
+    return result;
+  }
+
+  int count = 0;
+  int capacity = 256;
+
+  u32 arena_size = (u32)(capacity * sizeof(char *) + capacity * OS_LNX_MAX_PATH);
+  char *arena = allocator->alloc_alloc(allocator->ctx, arena_size, 8);
+  char **paths = (char **)arena;
+  char *string_pool = arena + capacity * sizeof(char *);
+  u32 pool_offset = 0;
+
+  struct dirent *entry;
+  while (count < capacity && (entry = readdir(dir)) != NULL) {
+    if (os_lnx_is_dot_entry(entry->d_name)) {
+      continue;
+    }
+
+    char *full_path = string_pool + pool_offset;
+    if (!os_lnx_join_path(full_path, directory, entry->d_name)) {
+      continue;
+    }
+    if (os_lnx_entry_is_dir(full_path, entry) != want_dirs) {
+      continue;
+    }
+
+    u32 name_len = str_len(entry->d_name);
+    b32 matches_ext = (ext_len == 0);
+    if (!matches_ext && name_len >= ext_len) {
+      matches_ext = memcmp(entry->d_name + name_len - ext_len, extension,
+                           ext_len) == 0;
+    }
+    if (!matches_ext) {
+      continue;
+    }
+
+    paths[count++] = full_path;
+    pool_offset += str_len(full_path) + 1;
+  }
+
+  closedir(dir);
+
+  result.paths = paths;
+  result.count = count;
+  return result;
+}
+
+OsFileList os_list_files(const char *directory, const char *extension,
+                         Allocator *allocator) {
+  return os_lnx_list_entries(directory, extension, false, allocator);
+}
+
+OsFileList os_list_dirs(const char *directory, Allocator *allocator) {
+  return os_lnx_list_entries(directory, NULL, true, allocator);
+}
+
+b32 os_file_set_executable(const char *path) {
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    return false;
+  }
+  return chmod(path, st.st_mode | S_IXUSR | S_IXGRP | S_IXOTH) == 0;
+}
+
+char *os_cwd(char *buffer, u32 buffer_size) {
+  return getcwd(buffer, buffer_size);
+}
+
+void os_time_init(void) { os_init(); }
+
+u64 os_time_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+}
+
+u64 os_time_diff(u64 new_ticks, u64 old_ticks) {
+  if (new_ticks > old_ticks) {
+    return new_ticks - old_ticks;
+  } else {
+    return 1;
+  }
+}
+
+f64 os_ticks_to_ms(u64 ticks) { return (f64)ticks / 1000000.0; }
+
+f64 os_ticks_to_us(u64 ticks) { return (f64)ticks / 1000.0; }
+
+f64 os_ticks_to_ns(u64 ticks) { return (f64)ticks; }
+
+void os_sleep(u64 microseconds) {
+  struct timespec ts = {
+      .tv_sec = (time_t)(microseconds / 1000000),
+      .tv_nsec = (long)(microseconds % 1000000) * 1000,
+  };
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+i32 os_get_processor_count(void) {
+  os_lnx_assert_state_initialized();
+  return (i32)os_lnx_state.processor_count;
+}
+
+u8 *os_allocate_memory(size_t size) {
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    LOG_ERROR("mmap failed. Size: %, Error: %", FMT_UINT(size),
+              FMT_UINT(errno));
+    return NULL;
+  }
+  return memory;
+}
+
+void os_free_memory(void *ptr, size_t size) {
+  if (ptr) {
+    if (munmap(ptr, size) != 0) {
+      LOG_ERROR("munmap failed. Error: %", FMT_UINT(errno));
+    }
+  }
+}
+
+u8 *os_reserve_memory(size_t size) {
+  void *memory = mmap(NULL, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    LOG_ERROR("mmap (reserve) failed. Size: %, Error: %", FMT_UINT(size),
+              FMT_UINT(errno));
+    return NULL;
+  }
+  return memory;
+}
+
+b32 os_commit_memory(void *ptr, size_t size) {
+  if (mprotect(ptr, size, PROT_READ | PROT_WRITE) != 0) {
+    LOG_ERROR("mprotect (commit) failed. Size: %, Error: %", FMT_UINT(size),
+              FMT_UINT(errno));
+    return false;
+  }
+  return true;
+}
+
+u32 os_get_page_size(void) {
+  os_lnx_assert_state_initialized();
+  return os_lnx_state.page_size;
+}
+
+u32 os_get_huge_page_size(void) {
+  os_lnx_assert_state_initialized();
+  return os_lnx_state.huge_page_size;
+}
+
+u32 os_get_numa_node_count(void) {
+  os_lnx_assert_state_initialized();
+  return os_lnx_state.numa_node_count;
+}
+
+u8 *os_reserve_memory_pages(size_t size, OsPageKind kind) {
+  if (kind == OS_PAGES_DEFAULT) {
+    return os_reserve_memory(size);
+  }
+  size_t huge_size = os_get_huge_page_size();
+  size = align_forward(size, huge_size);
+
+  if (kind == OS_PAGES_EXPLICIT_HUGE) {
+    // without MAP_NORESERVE the pool is charged for the whole size here, so a
+    // short pool fails now instead of SIGBUS on some later touch
+    void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return memory == MAP_FAILED ? NULL : memory;
+  }
+
+  // transparent huge pages need huge page aligned runs, over reserve and trim
+  u8 *memory = os_reserve_memory(size + huge_size);
+  if (!memory) {
+    return NULL;
+  }
+  u8 *aligned = (u8 *)align_forward((uintptr)memory, huge_size);
+  if (aligned > memory) {
+    munmap(memory, (size_t)(aligned - memory));
+  }
+  size_t tail = (size_t)(memory + size + huge_size - (aligned + size));
+  if (tail > 0) {
+    munmap(aligned + size, tail);
+  }
+  // the advice sticks to the range through later commits
+  if (madvise(aligned, size, MADV_HUGEPAGE) != 0) {
+    LOG_WARN("madvise(MADV_HUGEPAGE) failed, errno %", FMT_INT(errno));
+  }
+  return aligned;
+}
+
+void os_prefault_memory(void *ptr, size_t size) {
+  // one call for the whole range since 5.14, before that touch every page
+  if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+  u32 page_size = os_get_page_size();
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    volatile u8 *page = (volatile u8 *)ptr + offset;
+    *page = *page;
+  }
+}
+
+b32 os_bind_memory_numa(void *ptr, size_t size, u32 node) {
+  if (node >= os_get_numa_node_count() || node >= 64) {
+    return false;
+  }
+  // MPOL_MF_MOVE also migrates whatever was already faulted in elsewhere.
+  // the kernel reads maxnode - 1 bits of the mask
+  unsigned long mask = 1ul << node;
+  if (syscall(__NR_mbind, ptr, size, MPOL_BIND, &mask, 64 + 1, MPOL_MF_MOVE) !=
+      0) {
+    LOG_WARN("mbind to node % failed, errno %", FMT_UINT(node), FMT_INT(errno));
+    return false;
+  }
+  return true;
+}
+
+// BC/DXT is what desktop GPUs on Linux sample natively
+const char *os_get_compressed_texture_format_suffix(void) { return "_dxt5"; }
+
+OsKeyboardRect os_get_keyboard_rect(f32 time) {
+  UNUSED(time);
+  OsKeyboardRect rect = {0};
+  return rect;
+}
+
+OsSafeAreaInsets os_get_safe_area(void) {
+  OsSafeAreaInsets insets = {0};
+  return insets;
+}
+
+// no http client on the native build, requests fail like on a machine offline
+PlatformHttpRequestOp os_start_http_request(HttpMethod method, const char *url,
+                                            int url_len, const char *headers,
+                                            int headers_len, const char *body,
+                                            int body_len) {
+  UNUSED(method);
+  UNUSED(url);
+  UNUSED(url_len);
+  UNUSED(headers);
+  UNUSED(headers_len);
+  UNUSED(body);
+  UNUSED(body_len);
+  return -1;
+}
+
+HttpOpState os_check_http_request(PlatformHttpRequestOp op_id) {
+  UNUSED(op_id);
+  return HTTP_OP_ERROR;
+}
+
+int32 os_get_http_response_info(PlatformHttpRequestOp op_id,
+                                _out_ int32 *status_code,
+                                _out_ int32 *headers_len,
+                                _out_ int32 *body_len) {
+  UNUSED(op_id);
+  UNUSED(status_code);
+  UNUSED(headers_len);
+  UNUSED(body_len);
+  return -1;
+}
+
+int32 os_get_http_body(PlatformHttpRequestOp op_id, char *buffer,
+                       int32 buffer_len) {
+  UNUSED(op_id);
+  UNUSED(buffer);
+  UNUSED(buffer_len);
+  return -1;
+}
+
+PlatformHttpStreamOp os_start_http_stream(HttpMethod method, const char *url,
+                                          int url_len, const char *headers,
+                                          int headers_len, const char *body,
+                                          int body_len) {
+  UNUSED(method);
+  UNUSED(url);
+  UNUSED(url_len);
+  UNUSED(headers);
+  UNUSED(headers_len);
+  UNUSED(body);
+  UNUSED(body_len);
+  return -1;
+}
+
+HttpStreamState os_check_http_stream(PlatformHttpStreamOp op_id) {
+  UNUSED(op_id);
+  return HTTP_STREAM_ERROR;
+}
+
+int32 os_get_http_stream_info(PlatformHttpStreamOp op_id,
+                              _out_ int32 *status_code) {
+  UNUSED(op_id);
+  UNUSED(status_code);
+  return -1;
+}
+
+int32 os_get_http_stream_chunk_size(PlatformHttpStreamOp op_id) {
+  UNUSED(op_id);
+  return 0;
+}
+
+int32 os_get_http_stream_chunk(PlatformHttpStreamOp op_id, char *buffer,
+                               int32 buffer_len, _out_ bool32 *is_final) {
+  UNUSED(op_id);
+  UNUSED(buffer);
+  UNUSED(buffer_len);
+  UNUSED(is_final);
+  return -1;
+}
+
+u32 os_mic_get_available_samples(void) { return 0; }
+u32 os_mic_read_samples(i16 *buffer, u32 max_samples) {
+  UNUSED(buffer);
+  UNUSED(max_samples);
+  return 0;
+}
+void os_mic_start_recording(void) {}
+void os_mic_stop_recording(void) {}
+u32 os_mic_get_sample_rate(void) { return 48000; }
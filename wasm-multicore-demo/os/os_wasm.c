@@ -966,6 +966,27 @@ void *os_get_heap_base(void) {
   return base;
 }
 
+WASM_IMPORT(js_time_now) extern f64 js_time_now(void);
+
+void os_time_init(void) {}
+
+// performance.now() in ms, converted to ns ticks like the win32 backend
+u64 os_time_now(void) { return (u64)(js_time_now() * 1000000.0); }
+
+u64 os_time_diff(u64 new_ticks, u64 old_ticks) {
+  if (new_ticks > old_ticks) {
+    return new_ticks - old_ticks;
+  } else {
+    return 1;
+  }
+}
+
+f64 os_ticks_to_ms(u64 ticks) { return (f64)ticks / 1000000.0; }
+
+f64 os_ticks_to_us(u64 ticks) { return (f64)ticks / 1000.0; }
+
+f64 os_ticks_to_ns(u64 ticks) { return (f64)ticks; }
+
 global i32 g_sleep_futex = 0;
 
 void os_sleep(u64 microseconds) {
@@ -981,6 +1002,7 @@ WASM_IMPORT(_os_check_read_file) extern i32 _os_check_read_file(i32 op_id);
 WASM_IMPORT(_os_get_file_size) extern i32 _os_get_file_size(i32 op_id);
 WASM_IMPORT(_os_get_file_data)
 extern i32 _os_get_file_data(i32 op_id, u8 *buffer, i32 buffer_len);
+WASM_IMPORT(_os_release_file_op) extern void _os_release_file_op(i32 op_id);
 
 struct OsFileOp {
   i32 op_id;
@@ -1035,6 +1057,12 @@ b32 os_get_file_data(OsFileOp *op, _out_ PlatformFileData *data,
   return true;
 }
 
+void os_release_file_op(OsFileOp *op) {
+  if (!op)
+    return;
+  _os_release_file_op((i32)(uintptr)op);
+}
+
 // Memory
 // void *os_allocate_memory(size_t size) { return malloc(size); }
 //
@@ -1279,6 +1279,22 @@ b32 os_get_file_data(OsFileOp *op, _out_ PlatformFileData *data,
   return true;
 }
 
+void os_release_file_op(OsFileOp *op) {
+  if (!op)
+    return;
+  OsWin32Entity *entity = (OsWin32Entity *)op;
+  if (entity->file_op.file_handle != INVALID_HANDLE_VALUE) {
+    CloseHandle(entity->file_op.file_handle);
+    entity->file_op.file_handle = INVALID_HANDLE_VALUE;
+  }
+  if (entity->file_op.buffer) {
+    os_free_memory(entity->file_op.buffer, entity->file_op.buffer_len);
+    entity->file_op.buffer = NULL;
+    entity->file_op.buffer_len = 0;
+  }
+  os_w32_entity_release(entity);
+}
+
 OsDynLib os_dynlib_load(const char *path) {
   OsDynLib lib = LoadLibraryA(path);
   if (!lib) {
@@ -1806,6 +1822,44 @@ u32 os_get_page_size(void) {
   return os_w32_state.page_size;
 }
 
+u32 os_get_huge_page_size(void) {
+  SIZE_T large_page = GetLargePageMinimum();
+  return large_page ? (u32)large_page : MB(2);
+}
+
+u32 os_get_numa_node_count(void) {
+  ULONG highest_node = 0;
+  return GetNumaHighestNodeNumber(&highest_node) ? (u32)highest_node + 1 : 1;
+}
+
+u8 *os_reserve_memory_pages(size_t size, OsPageKind kind) {
+  // no transparent huge pages on windows, those reserve like default pages
+  if (kind != OS_PAGES_EXPLICIT_HUGE) {
+    return os_reserve_memory(size);
+  }
+  // large pages need SeLockMemoryPrivilege and must be committed on reserve
+  size = align_forward(size, os_get_huge_page_size());
+  return VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                      PAGE_READWRITE);
+}
+
+void os_prefault_memory(void *ptr, size_t size) {
+  u32 page_size = os_get_page_size();
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    volatile u8 *page = (volatile u8 *)ptr + offset;
+    *page = *page;
+  }
+}
+
+b32 os_bind_memory_numa(void *ptr, size_t size, u32 node) {
+  // the node is picked when VirtualAllocExNuma reserves, a live range can't be
+  // rebound. pages still land on the first toucher's node
+  UNUSED(ptr);
+  UNUSED(size);
+  UNUSED(node);
+  return false;
+}
+
 const char *os_get_compressed_texture_format_suffix(void) { return "_dxt5"; }
 
 OsKeyboardRect os_get_keyboard_rect(f32 time) {
@@ -138,10 +138,15 @@ export function createFileSystemFunctions(memory: WebAssembly.Memory) {
         return 0;
     }
 
+    function _os_release_file_op(opId: number): void {
+        completedFileReads.delete(opId);
+    }
+
     return {
         _os_start_read_file,
         _os_check_read_file,
         _os_get_file_size,
         _os_get_file_data,
+        _os_release_file_op,
     };
 }
@@ -86,6 +86,7 @@ export interface LogImports {
         lineNumber: number,
     ) => void;
     js_get_core_count: () => number;
+    js_time_now: () => number;
 }
 
 // WASI stubs - minimal implementations for wasi-threads libc
@@ -147,5 +148,6 @@ export function createLogImports(memory: WebAssembly.Memory, prefix?: string): L
             console.error(`${logPrefix} ${fileName}:${lineNumber}: ${message}`);
         },
         js_get_core_count: () => OS_CORES,
+        js_time_now: () => performance.now(),
     };
 }
@@ -1,4 +1,4 @@
-// Run with: npx tsx test-runner.ts
+// Run with: npx tsx test-runner.ts [bench]
 
 import { chromium } from "playwright";
 import { spawn, ChildProcess, execSync } from "child_process";
@@ -10,7 +10,8 @@ const __dirname = path.dirname(__filename);
 
 const PORT = 3000;
 const URL = `http://localhost:${PORT}`;
-const TIMEOUT_MS = 30000;
+const BENCH = process.argv[2] === "bench";
+const TIMEOUT_MS = BENCH ? 300000 : 30000;
 
 async function main() {
     const projectDir = __dirname;
@@ -18,8 +19,8 @@ async function main() {
     let browser: Awaited<ReturnType<typeof chromium.launch>> | null = null;
 
     try {
-        console.log("Building tests...");
-        execSync("make test", { cwd: projectDir, stdio: "inherit" });
+        console.log(BENCH ? "Building benches..." : "Building tests...");
+        execSync(BENCH ? "make bench" : "make test", { cwd: projectDir, stdio: "inherit" });
 
         console.log("Starting server...");
         server = spawn("bun", ["server.ts"], {
@@ -38,7 +39,7 @@ async function main() {
             const text = msg.text();
             console.log(`[WASM] ${text}`);
 
-            if (text.includes("[PASS]")) {
+            if (text.includes("[PASS]") || text.includes("[DONE]")) {
                 result = "pass";
             } else if (text.includes("[FAIL]")) {
                 result = "fail";
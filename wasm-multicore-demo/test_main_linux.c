@@ -0,0 +1,42 @@
+#include "lib/string.c"
+#include "lib/common.c"
+#include "lib/memory.c"
+#include "lib/allocator_block.c"
+#include "lib/allocator_pool.c"
+#include "lib/string_builder.c"
+#include "lib/thread_context.h"
+#include "os/os.h"
+#include "os/os_linux.c"
+#include "lib/thread.c"
+#include "lib/thread_context.c"
+#include "lib/multicore_runtime.c"
+#include "lib/handle.c"
+#include "lib/math.h"
+#include "context.c"
+#include "tests/test_runner.c"
+
+/*
+    Native test runner, no browser needed. Runs the same tests as test_main.c on one lane per
+    core and exits with 1 when any of them failed.
+
+    usage: test
+*/
+
+#define TEST_LINUX_HEAP_SIZE GB(2)
+
+int main(void) {
+    os_init();
+    os_time_init();
+    os_install_crash_handler();
+
+    // committed up front, the kernel only backs the pages the tests touch
+    AppMemory memory = {0};
+    memory.heap_size = TEST_LINUX_HEAP_SIZE;
+    memory.heap = os_reserve_memory(memory.heap_size);
+    if (!memory.heap || !os_commit_memory(memory.heap, memory.heap_size)) {
+        return 1;
+    }
+
+    wasm_init(&memory);
+    return g_test_runner.tests_failed > 0 ? 1 : 0;
+}
@@ -97,4 +97,38 @@ void test_ecs_add_remove(void) {
     assert_true(ecs_has(&world, e3, ecs_id(ARHealth)));
 
     assert_true(world.store.table_count >= 4);
+
+    // hi ids (plain entities used as tags) go through the hashed edge map
+    EcsEntity tags[64];
+    for (i32 i = 0; i < 64; i++) {
+        tags[i] = ecs_entity_new(&world);
+    }
+
+    EcsEntity e6 = ecs_entity_new(&world);
+    ecs_add(&world, e6, ecs_id(ARPosition));
+    ARPosition pos6 = { 6.0f, 7.0f };
+    ecs_set_ptr(&world, e6, ecs_id(ARPosition), &pos6);
+    EcsTable *base = ecs_entity_get_record(&world, e6)->table;
+
+    for (i32 i = 0; i < 64; i++) {
+        ecs_add(&world, e6, tags[i]);
+        assert_true(ecs_has(&world, e6, tags[i]));
+        ecs_remove(&world, e6, tags[i]);
+        assert_false(ecs_has(&world, e6, tags[i]));
+        assert_true(ecs_entity_get_record(&world, e6)->table == base);
+    }
+    assert_eq(base->node.add.hi_count, 64);
+    assert_true(base->node.add.hi_cap >= 128);
+
+    for (i32 i = 0; i < 64; i++) {
+        EcsTableDiff *diff = NULL;
+        EcsTable *with_tag = ecs_table_traverse_add(&world, base, tags[i], &diff);
+        assert_true(with_tag != base);
+        assert_true(diff != NULL);
+        assert_true(ecs_table_traverse_remove(&world, with_tag, tags[i], NULL) == base);
+    }
+
+    ARPosition *p6 = (ARPosition*)ecs_get(&world, e6, ecs_id(ARPosition));
+    assert_eq((u32)p6->x, 6);
+    assert_eq((u32)p6->y, 7);
 }
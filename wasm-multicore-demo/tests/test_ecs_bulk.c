@@ -0,0 +1,109 @@
+typedef struct { f32 x; f32 y; } BulkPosition;
+typedef struct { f32 x; f32 y; } BulkVelocity;
+typedef struct { u8 dummy; } BulkTag;
+
+void ecs_world_init_full_bulk(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+void test_ecs_bulk(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_bulk(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, BulkPosition);
+    ECS_COMPONENT(&world, BulkVelocity);
+    ECS_COMPONENT(&world, BulkTag);
+    i32 base_count = ecs_entity_count(&world);
+
+    const i32 count = 100;
+    BulkPosition positions[100];
+    for (i32 i = 0; i < count; i++) {
+        positions[i] = (BulkPosition){ (f32)i, (f32)(i * 2) };
+    }
+
+    // ids out of order on purpose, velocity left zeroed
+    EcsEntity ids[] = { ecs_id(BulkVelocity), ecs_id(BulkPosition) };
+    const void *data[] = { NULL, positions };
+    EcsEntity entities[100];
+
+    i32 first_row = ecs_bulk_new(&world, &(EcsBulkDesc){
+        .ids = ids,
+        .id_count = 2,
+        .data = data,
+        .count = count,
+        .entities = entities,
+    });
+    assert_eq(first_row, 0);
+    assert_eq(ecs_entity_count(&world), base_count + count);
+
+    EcsTable *table = ecs_entity_get_record(&world, entities[0])->table;
+    assert_eq(table->data.count, count);
+    assert_eq(table->type.count, 2);
+
+    for (i32 i = 0; i < count; i++) {
+        assert_true(ecs_entity_is_alive(&world, entities[i]));
+        EcsRecord *record = ecs_entity_get_record(&world, entities[i]);
+        assert_true(record->table == table);
+        assert_eq(record->row, (u32)i);
+
+        BulkPosition *p = ecs_get_component(&world, entities[i], BulkPosition);
+        BulkVelocity *v = ecs_get_component(&world, entities[i], BulkVelocity);
+        assert_eq((u32)p->x, (u32)i);
+        assert_eq((u32)p->y, (u32)(i * 2));
+        assert_eq((u32)v->x, 0);
+    }
+
+    // single entities and bulk entities share the table
+    EcsEntity single = ecs_entity_new(&world);
+    ecs_add(&world, single, ecs_id(BulkPosition));
+    ecs_add(&world, single, ecs_id(BulkVelocity));
+    assert_true(ecs_entity_get_record(&world, single)->table == table);
+    assert_eq(table->data.count, count + 1);
+
+    // delete every even entity in one go, survivors keep their order
+    EcsEntity to_delete[50];
+    for (i32 i = 0; i < 50; i++) {
+        to_delete[i] = entities[i * 2];
+    }
+    ecs_bulk_delete(&world, to_delete, 50);
+
+    assert_eq(table->data.count, 51);
+    assert_eq(ecs_entity_count(&world), base_count + 51);
+    for (i32 i = 0; i < 50; i++) {
+        assert_false(ecs_entity_is_alive(&world, entities[i * 2]));
+
+        EcsEntity e = entities[i * 2 + 1];
+        EcsRecord *record = ecs_entity_get_record(&world, e);
+        assert_eq(record->row, (u32)i);
+        assert_eq(table->data.entities[i], e);
+        BulkPosition *p = ecs_get_component(&world, e, BulkPosition);
+        assert_eq((u32)p->x, (u32)(i * 2 + 1));
+    }
+    assert_eq(ecs_entity_get_record(&world, single)->row, 50);
+
+    // recycled ids come back first with a bumped generation
+    EcsEntity respawned[60];
+    ecs_bulk_new(&world, &(EcsBulkDesc){
+        .ids = (EcsEntity[]){ ecs_id(BulkPosition), ecs_id(BulkTag) },
+        .id_count = 2,
+        .count = 60,
+        .entities = respawned,
+    });
+    assert_eq(ecs_entity_count(&world), base_count + 111);
+    for (i32 i = 0; i < 60; i++) {
+        assert_true(ecs_entity_is_alive(&world, respawned[i]));
+        assert_true(ecs_has(&world, respawned[i], ecs_id(BulkTag)));
+        assert_false(ecs_has(&world, respawned[i], ecs_id(BulkVelocity)));
+    }
+    assert_true(ecs_entity_generation(respawned[0]) > 0);
+
+    // single delete removes the row too
+    ecs_entity_delete(&world, single);
+    assert_eq(table->data.count, 50);
+    assert_false(ecs_entity_is_alive(&world, single));
+    assert_eq(table->data.entities[49], entities[99]);
+    assert_eq(ecs_entity_get_record(&world, entities[99])->row, 49);
+}
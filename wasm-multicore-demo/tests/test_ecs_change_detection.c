@@ -112,3 +112,146 @@ void test_ecs_change_detection(void) {
         assert_false(ecs_iter_changed(&it));
     }
 }
+
+// rows and runs a changed-only iteration yields, offset of the first run
+internal i32 cd_changed_rows(EcsQuery *query, i32 *out_runs, i32 *out_offset) {
+    i32 rows = 0;
+    *out_runs = 0;
+    *out_offset = -1;
+    EcsIter it = ecs_query_iter(query);
+    while (ecs_iter_next(&it)) {
+        if (*out_runs == 0) {
+            *out_offset = it.offset;
+        }
+        (*out_runs)++;
+        rows += it.count;
+    }
+    return rows;
+}
+
+void test_ecs_changed_filter(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_cd(&world, &tctx->temp_arena);
+
+    EcsEntity comp_position = ecs_component_register(&world, sizeof(CDPosition), _Alignof(CDPosition), "CDPosition");
+    EcsEntity comp_velocity = ecs_component_register(&world, sizeof(CDVelocity), _Alignof(CDVelocity), "CDVelocity");
+
+    EcsEntity entities[1000];
+    EcsEntity ids[] = { comp_position, comp_velocity };
+    ecs_bulk_new(&world, &(EcsBulkDesc){ .ids = ids, .id_count = 2, .count = 1000, .entities = entities });
+    EcsTable *table = ecs_entity_get_record(&world, entities[0])->table;
+    assert_eq(table->block_rows, ECS_CHANGE_BLOCK_ROWS);
+
+    EcsQuery query;
+    EcsTerm terms[] = { ecs_term_changed(comp_position), ecs_term_in(comp_velocity) };
+    ecs_query_init_terms(&query, &world, terms, 2);
+    ecs_query_cache_init(&query);
+
+    // first run: every row is new
+    i32 runs, offset;
+    assert_eq(cd_changed_rows(&query, &runs, &offset), 1000);
+    assert_eq(runs, 1);
+    assert_eq(cd_changed_rows(&query, &runs, &offset), 0);
+
+    // one write: only its block
+    ecs_set_ptr(&world, entities[300], comp_position, &(CDPosition){ 1.0f, 1.0f });
+    assert_eq(cd_changed_rows(&query, &runs, &offset), ECS_CHANGE_BLOCK_ROWS);
+    assert_eq(offset, ECS_CHANGE_BLOCK_ROWS);
+
+    // columns without a changed term don't count
+    ecs_set_ptr(&world, entities[10], comp_velocity, &(CDVelocity){ 1.0f, 1.0f });
+    assert_eq(cd_changed_rows(&query, &runs, &offset), 0);
+
+    // adjacent blocks merge into one run, the last one is partial
+    ecs_table_mark_dirty_rows(&world, table, ecs_table_get_column_index(table, comp_position), 700, 100);
+    assert_eq(cd_changed_rows(&query, &runs, &offset), 1000 - 2 * ECS_CHANGE_BLOCK_ROWS);
+    assert_eq(runs, 1);
+    assert_eq(offset, 2 * ECS_CHANGE_BLOCK_ROWS);
+
+    // a delete moves the last row into the hole
+    ecs_entity_delete(&world, entities[10]);
+    assert_eq(cd_changed_rows(&query, &runs, &offset), ECS_CHANGE_BLOCK_ROWS);
+    assert_eq(offset, 0);
+
+    // the monitor api sees the same stamps
+    ecs_query_sync(&query);
+    assert_false(ecs_query_changed(&query));
+    ecs_set_ptr(&world, entities[999], comp_position, &(CDPosition){ 1.0f, 1.0f });
+    assert_true(ecs_query_changed(&query));
+}
+
+global EcsWorld g_cd_world;
+global EcsEntity g_cd_entities[1000];
+global EcsEntity g_cd_position_id;
+global b32 g_cd_write;
+global u32 g_cd_seen;
+
+void CDWriteSystem(EcsIter *it) {
+    CDPosition *p = ecs_field(it, CDPosition, 0);
+    if (!g_cd_write) {
+        return;
+    }
+    for (i32 i = 0; i < it->count; i++) {
+        p[i].x += 1.0f;
+    }
+    ecs_iter_mark_dirty(it, 0);
+}
+
+void CDChangedSystem(EcsIter *it) {
+    ins_atomic_u32_add_eval(&g_cd_seen, (u32)it->count);
+}
+
+void test_ecs_changed_systems(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_cd_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_cd(world, &tctx->temp_arena);
+        ECS_COMPONENT(world, CDPosition);
+        g_cd_position_id = ecs_id(CDPosition);
+        for (i32 i = 0; i < 1000; i++) {
+            g_cd_entities[i] = ecs_entity_new(world);
+            ecs_set(world, g_cd_entities[i], CDPosition, { 0.0f, 0.0f });
+        }
+
+        EcsTerm write_terms[] = { ecs_term_inout(ecs_id(CDPosition)) };
+        ECS_SYSTEM(world, CDWriteSystem, write_terms, 1);
+        EcsTerm changed_terms[] = { ecs_term_changed(ecs_id(CDPosition)) };
+        ECS_SYSTEM(world, CDChangedSystem, changed_terms, 1);
+        g_cd_write = true;
+        g_cd_seen = 0;
+    }
+    lane_sync();
+
+    // sees the writes of the same frame
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_cd_seen, 1000);
+        g_cd_write = false;
+        g_cd_seen = 0;
+    }
+    lane_sync();
+
+    // and once more the frame after, then nothing
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_cd_seen, 1000);
+        g_cd_seen = 0;
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_cd_seen, 0);
+        ecs_set_ptr(world, g_cd_entities[600], g_cd_position_id, &(CDPosition){ 1.0f, 1.0f });
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_cd_seen, ECS_CHANGE_BLOCK_ROWS);
+    }
+    lane_sync();
+}
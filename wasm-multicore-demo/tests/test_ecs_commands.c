@@ -0,0 +1,195 @@
+typedef struct { f32 x; f32 y; } CmdPosition;
+typedef struct { f32 x; f32 y; } CmdVelocity;
+typedef struct { u8 dummy; } CmdTag;
+
+global EcsWorld g_cmd_world;
+global EcsEntity g_cmd_position_id;
+global EcsEntity g_cmd_velocity_id;
+global EcsEntity g_cmd_tag_id;
+global EcsEntity g_cmd_spawned[ECS_MAX_THREADS];
+
+void ecs_world_init_full_cmd(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+void test_ecs_commands(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_cmd(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, CmdPosition);
+    ECS_COMPONENT(&world, CmdVelocity);
+    ECS_COMPONENT(&world, CmdTag);
+    i32 base_count = ecs_entity_count(&world);
+
+    EcsEntity a = ecs_entity_new(&world);
+    ecs_set(&world, a, CmdPosition, { 1.0f, 2.0f });
+    EcsEntity b = ecs_entity_new(&world);
+    ecs_set(&world, b, CmdPosition, { 3.0f, 4.0f });
+    EcsEntity c = ecs_entity_new(&world);
+    ecs_set(&world, c, CmdPosition, { 5.0f, 6.0f });
+    EcsTable *position_table = ecs_entity_get_record(&world, a)->table;
+
+    ecs_defer_begin(&world);
+    assert_true(ecs_is_deferred(&world));
+
+    ecs_set(&world, a, CmdVelocity, { 7.0f, 8.0f });
+    ecs_add(&world, b, ecs_id(CmdTag));
+    ecs_set(&world, b, CmdVelocity, { 9.0f, 9.0f });
+    ecs_remove(&world, b, ecs_id(CmdVelocity));
+    ecs_entity_delete(&world, c);
+    EcsEntity d = ecs_entity_new(&world);
+    ecs_set(&world, d, CmdPosition, { 10.0f, 11.0f });
+    ecs_add(&world, d, ecs_id(CmdTag));
+
+    // nothing lands before the merge
+    assert_false(ecs_has(&world, a, ecs_id(CmdVelocity)));
+    assert_false(ecs_has(&world, b, ecs_id(CmdTag)));
+    assert_true(ecs_entity_is_alive(&world, c));
+    assert_false(ecs_entity_is_alive(&world, d));
+    assert_true(ecs_get_mut(&world, a, ecs_id(CmdVelocity)) == NULL);
+    assert_eq(position_table->data.count, 3);
+
+    ecs_defer_end(&world);
+    assert_false(ecs_is_deferred(&world));
+    assert_eq(ecs_entity_count(&world), base_count + 3);
+
+    CmdVelocity *va = ecs_get_component(&world, a, CmdVelocity);
+    assert_true(va != NULL);
+    assert_eq((u32)va->x, 7);
+    assert_eq((u32)ecs_get_component(&world, a, CmdPosition)->y, 2);
+
+    // set followed by remove leaves no component behind
+    assert_true(ecs_has(&world, b, ecs_id(CmdTag)));
+    assert_false(ecs_has(&world, b, ecs_id(CmdVelocity)));
+    assert_eq((u32)ecs_get_component(&world, b, CmdPosition)->x, 3);
+
+    assert_false(ecs_entity_is_alive(&world, c));
+    assert_eq(position_table->data.count, 0);
+
+    assert_true(ecs_entity_is_alive(&world, d));
+    assert_true(ecs_has(&world, d, ecs_id(CmdTag)));
+    assert_true(ecs_entity_get_record(&world, d)->table == ecs_entity_get_record(&world, b)->table);
+    assert_eq((u32)ecs_get_component(&world, d, CmdPosition)->y, 11);
+
+    // nothing recorded, nothing to do
+    ecs_defer_begin(&world);
+    ecs_defer_end(&world);
+    assert_eq(ecs_entity_count(&world), base_count + 3);
+
+    // deferred creates revive c and d before taking new ids
+    ecs_entity_delete(&world, d);
+    u64 max_id = world.entity_index.max_id;
+    ecs_defer_begin(&world);
+    EcsEntity e = ecs_entity_new(&world);
+    EcsEntity f = ecs_entity_new(&world);
+    EcsEntity g = ecs_entity_new(&world);
+    ecs_defer_end(&world);
+    assert_eq(ecs_entity_count(&world), base_count + 5);
+    assert_true(ecs_entity_is_alive(&world, e));
+    assert_true(ecs_entity_is_alive(&world, f));
+    assert_true(ecs_entity_is_alive(&world, g));
+    assert_false(ecs_entity_is_alive(&world, c));
+    assert_false(ecs_entity_is_alive(&world, d));
+    b32 e_recycled = ecs_entity_index(e) == ecs_entity_index(c) || ecs_entity_index(e) == ecs_entity_index(d);
+    b32 f_recycled = ecs_entity_index(f) == ecs_entity_index(c) || ecs_entity_index(f) == ecs_entity_index(d);
+    assert_true(e_recycled && f_recycled && e != f);
+    assert_eq((u64)g, max_id + 1);
+}
+
+void CmdSplitSystem(EcsIter *it) {
+    CmdPosition *p = ecs_field(it, CmdPosition, 0);
+    for (i32 i = 0; i < it->count; i++) {
+        EcsEntity e = it->entities[i];
+        u32 value = (u32)p[i].x;
+        if (value % 5 == 0) {
+            ecs_entity_delete(it->world, e);
+        } else if (value % 2 == 0) {
+            ecs_add(it->world, e, g_cmd_tag_id);
+            ecs_set_ptr(it->world, e, g_cmd_velocity_id, &(CmdVelocity){ (f32)value, 0.0f });
+        }
+    }
+}
+
+// one slot per lane, the task may run on any thread
+void CmdSpawnSystem(EcsIter *it) {
+    for (i32 i = 0; i < it->count; i++) {
+        i32 slot = it->offset + i;
+        EcsEntity e = ecs_entity_new(it->world);
+        ecs_set_ptr(it->world, e, g_cmd_velocity_id, &(CmdVelocity){ -1.0f, (f32)slot });
+        g_cmd_spawned[slot] = e;
+    }
+}
+
+void test_ecs_commands_multi(void) {
+    ThreadContext *tctx = tctx_current();
+    const i32 count = 1000;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_cmd(&g_cmd_world, &tctx->temp_arena);
+        g_cmd_position_id = ecs_component_register(&g_cmd_world, sizeof(CmdPosition), _Alignof(CmdPosition), "CmdPosition");
+        g_cmd_velocity_id = ecs_component_register(&g_cmd_world, sizeof(CmdVelocity), _Alignof(CmdVelocity), "CmdVelocity");
+        g_cmd_tag_id = ecs_component_register(&g_cmd_world, sizeof(CmdTag), _Alignof(CmdTag), "CmdTag");
+
+        for (i32 i = 0; i < count; i++) {
+            EcsEntity e = ecs_entity_new(&g_cmd_world);
+            ecs_set_ptr(&g_cmd_world, e, g_cmd_position_id, &(CmdPosition){ (f32)i, 0.0f });
+        }
+
+        EcsTerm split_terms[] = { ecs_term_in(g_cmd_position_id) };
+        ecs_system_init(&g_cmd_world, &(EcsSystemDesc){
+            .terms = split_terms,
+            .term_count = 1,
+            .callback = CmdSplitSystem,
+            .name = "CmdSplitSystem",
+        });
+
+        ecs_system_init(&g_cmd_world, &(EcsSystemDesc){
+            .iter_count = (i32)tctx->thread_count,
+            .iter_mode = ECS_ITER_RANGE,
+            .callback = CmdSpawnSystem,
+            .name = "CmdSpawnSystem",
+        });
+    }
+
+    lane_sync();
+
+    ecs_progress(&g_cmd_world, 0.016f);
+
+    if (is_main_thread()) {
+        assert_false(ecs_is_deferred(&g_cmd_world));
+
+        EcsQuery query;
+        ecs_query_init(&query, &g_cmd_world, (EcsEntity[]){ g_cmd_position_id }, 1);
+        i32 seen = 0;
+        EcsIter it = ecs_query_iter(&query);
+        while (ecs_iter_next(&it)) {
+            CmdPosition *p = ecs_field(&it, CmdPosition, 0);
+            for (i32 i = 0; i < it.count; i++) {
+                EcsEntity e = it.entities[i];
+                u32 value = (u32)p[i].x;
+                assert_true(value % 5 != 0);
+                b32 even = value % 2 == 0;
+                assert_eq(ecs_has(&g_cmd_world, e, g_cmd_tag_id), even);
+                if (even) {
+                    CmdVelocity *v = (CmdVelocity *)ecs_get(&g_cmd_world, e, g_cmd_velocity_id);
+                    assert_eq((u32)v->x, value);
+                }
+                seen++;
+            }
+        }
+        // multiples of 5 are gone
+        assert_eq(seen, count - count / 5);
+
+        for (i32 t = 0; t < (i32)tctx->thread_count; t++) {
+            EcsEntity e = g_cmd_spawned[t];
+            assert_true(ecs_entity_is_alive(&g_cmd_world, e));
+            CmdVelocity *v = (CmdVelocity *)ecs_get(&g_cmd_world, e, g_cmd_velocity_id);
+            assert_eq((u32)v->y, (u32)t);
+        }
+    }
+
+    lane_sync();
+}
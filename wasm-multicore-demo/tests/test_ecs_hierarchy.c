@@ -0,0 +1,117 @@
+global EcsWorld g_hier_world;
+global EcsEntity *g_hier_nodes;
+
+#define HIER_NODE_COUNT 2000
+#define HIER_FANOUT 4
+
+void ecs_world_init_full_hier(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+    ecs_hierarchy_init(world);
+}
+
+void test_ecs_hierarchy(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_hier(&world, &tctx->temp_arena);
+
+    EcsEntity root = ecs_entity_new(&world);
+    EcsEntity a = ecs_entity_new(&world);
+    EcsEntity b = ecs_entity_new(&world);
+    EcsEntity c = ecs_entity_new(&world);
+    EcsEntity other = ecs_entity_new(&world);
+
+    ecs_child_of(&world, a, root);
+    ecs_child_of(&world, b, a);
+    ecs_child_of(&world, c, a);
+    assert_eq(ecs_depth(&world, root), 0);
+    assert_eq(ecs_depth(&world, a), 1);
+    assert_eq(ecs_depth(&world, b), 2);
+    assert_true(ecs_parent(&world, b) == a);
+    assert_true(ecs_parent(&world, root) == ECS_ENTITY_INVALID);
+
+    // one table per depth, siblings share theirs
+    EcsTable *table_a = ecs_entity_get_record(&world, a)->table;
+    EcsTable *table_b = ecs_entity_get_record(&world, b)->table;
+    assert_true(table_a != table_b);
+    assert_true(table_b == ecs_entity_get_record(&world, c)->table);
+    assert_true(ecs_has(&world, b, world.hierarchy->depth_tags[2]));
+
+    // moving a subtree one level down re-tags everything below it
+    ecs_child_of(&world, other, root);
+    ecs_child_of(&world, a, other);
+    assert_eq(ecs_depth(&world, a), 2);
+    assert_eq(ecs_depth(&world, b), 3);
+    assert_eq(ecs_depth(&world, c), 3);
+    assert_false(ecs_has(&world, b, world.hierarchy->depth_tags[2]));
+    assert_true(ecs_has(&world, c, world.hierarchy->depth_tags[3]));
+
+    // detaching makes a new root of the subtree
+    ecs_child_of(&world, a, ECS_ENTITY_INVALID);
+    assert_eq(ecs_depth(&world, a), 0);
+    assert_false(ecs_has(&world, a, world.hierarchy->child_of));
+    assert_false(ecs_has(&world, a, world.hierarchy->depth_tags[2]));
+    assert_eq(ecs_depth(&world, b), 1);
+    assert_true(ecs_entity_get_record(&world, b)->table == ecs_entity_get_record(&world, other)->table);
+}
+
+internal void hier_set_local(EcsWorld *world, EcsEntity e, f32 x) {
+    EcsLocalTransform local;
+    glm_translate_make(local.value, (vec3){ x, 0.0f, 0.0f });
+    ecs_set_ptr(world, e, world->hierarchy->local_transform, &local);
+    ecs_add(world, e, world->hierarchy->world_transform);
+}
+
+// every node translates by 1 on x, so world x = depth + 1
+internal void hier_check_world(EcsWorld *world) {
+    for (i32 i = 0; i < HIER_NODE_COUNT; i++) {
+        EcsEntity e = g_hier_nodes[i];
+        EcsWorldTransform *wt = (EcsWorldTransform *)ecs_get(world, e, world->hierarchy->world_transform);
+        i32 depth = ecs_depth(world, e);
+        assert_eq((i32)wt->value[3][0], depth + 1);
+        EcsEntity parent = ecs_parent(world, e);
+        if (parent != ECS_ENTITY_INVALID) {
+            assert_eq(depth, ecs_depth(world, parent) + 1);
+        }
+    }
+}
+
+void test_ecs_hierarchy_propagate(void) {
+    ThreadContext *tctx = tctx_current();
+
+    if (is_main_thread()) {
+        ecs_world_init_full_hier(&g_hier_world, &tctx->temp_arena);
+        g_hier_nodes = ARENA_ALLOC_ARRAY(&tctx->temp_arena, EcsEntity, HIER_NODE_COUNT);
+
+        // nodes created after their parent, parent of i is (i - 1) / HIER_FANOUT
+        for (i32 i = 0; i < HIER_NODE_COUNT; i++) {
+            g_hier_nodes[i] = ecs_entity_new(&g_hier_world);
+            hier_set_local(&g_hier_world, g_hier_nodes[i], 1.0f);
+            if (i > 0) {
+                ecs_child_of(&g_hier_world, g_hier_nodes[i], g_hier_nodes[(i - 1) / HIER_FANOUT]);
+            }
+        }
+        assert_eq(g_hier_world.hierarchy->max_depth, 6);
+    }
+    lane_sync();
+
+    ecs_transform_propagate(&g_hier_world);
+
+    if (is_main_thread()) {
+        hier_check_world(&g_hier_world);
+
+        // node 1's subtree moves under node 2, one level deeper
+        ecs_child_of(&g_hier_world, g_hier_nodes[1], g_hier_nodes[2]);
+        assert_eq(ecs_depth(&g_hier_world, g_hier_nodes[1]), 2);
+        assert_eq(g_hier_world.hierarchy->max_depth, 7);
+    }
+    lane_sync();
+
+    ecs_transform_propagate(&g_hier_world);
+
+    if (is_main_thread()) {
+        hier_check_world(&g_hier_world);
+    }
+    lane_sync();
+}
@@ -0,0 +1,158 @@
+typedef struct { u32 magic; i32 value; } HookOwned;
+typedef struct { f32 x; f32 y; } HookPosition;
+
+#define HOOK_MAGIC 0xA11CEu
+
+typedef struct {
+    i32 live;
+    i32 ctor_calls;
+    i32 dtor_calls;
+    i32 move_calls;
+    i32 copy_calls;
+} HookCounters;
+
+global HookCounters g_hook_counters;
+
+void hook_owned_ctor(void *ptr, i32 count, const EcsTypeInfo *ti) {
+    UNUSED(ti);
+    HookOwned *items = (HookOwned *)ptr;
+    for (i32 i = 0; i < count; i++) {
+        items[i] = (HookOwned){ HOOK_MAGIC, 0 };
+    }
+    g_hook_counters.live += count;
+    g_hook_counters.ctor_calls++;
+}
+
+void hook_owned_dtor(void *ptr, i32 count, const EcsTypeInfo *ti) {
+    UNUSED(ti);
+    HookOwned *items = (HookOwned *)ptr;
+    for (i32 i = 0; i < count; i++) {
+        debug_assert(items[i].magic == HOOK_MAGIC);
+        items[i].magic = 0;
+    }
+    g_hook_counters.live -= count;
+    g_hook_counters.dtor_calls++;
+}
+
+void hook_owned_copy(void *dst, const void *src, i32 count, const EcsTypeInfo *ti) {
+    UNUSED(ti);
+    HookOwned *d = (HookOwned *)dst;
+    const HookOwned *s = (const HookOwned *)src;
+    for (i32 i = 0; i < count; i++) {
+        debug_assert(d[i].magic == HOOK_MAGIC);
+        d[i].value = s[i].value;
+    }
+    g_hook_counters.copy_calls++;
+}
+
+void hook_owned_move(void *dst, void *src, i32 count, const EcsTypeInfo *ti) {
+    UNUSED(ti);
+    HookOwned *d = (HookOwned *)dst;
+    HookOwned *s = (HookOwned *)src;
+    for (i32 i = 0; i < count; i++) {
+        debug_assert(s[i].magic == HOOK_MAGIC);
+        d[i] = s[i];
+        s[i].magic = 0;
+    }
+    g_hook_counters.move_calls++;
+}
+
+void ecs_world_init_full_hooks(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+void test_ecs_hooks(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_hooks(&world, &tctx->temp_arena);
+    g_hook_counters = (HookCounters){0};
+
+    ECS_COMPONENT(&world, HookOwned);
+    ECS_COMPONENT(&world, HookPosition);
+    ecs_component_set_hooks(&world, ecs_id(HookOwned), &(EcsTypeHooks){
+        .ctor = hook_owned_ctor,
+        .dtor = hook_owned_dtor,
+        .copy = hook_owned_copy,
+        .move = hook_owned_move,
+    });
+
+    // add constructs, set copies into the constructed value
+    EcsEntity a = ecs_entity_new(&world);
+    ecs_add(&world, a, ecs_id(HookOwned));
+    assert_eq(g_hook_counters.live, 1);
+    ecs_set(&world, a, HookOwned, { HOOK_MAGIC, 7 });
+    assert_eq(g_hook_counters.copy_calls, 1);
+    assert_eq(ecs_get_component(&world, a, HookOwned)->value, 7);
+
+    // table moves relocate instead of constructing a second copy
+    ecs_add(&world, a, ecs_id(HookPosition));
+    assert_eq(g_hook_counters.live, 1);
+    assert_eq(ecs_get_component(&world, a, HookOwned)->value, 7);
+    ecs_remove(&world, a, ecs_id(HookPosition));
+    assert_eq(g_hook_counters.live, 1);
+    ecs_remove(&world, a, ecs_id(HookOwned));
+    assert_eq(g_hook_counters.live, 0);
+
+    // bulk paths call hooks once per column span
+    g_hook_counters.ctor_calls = 0;
+    g_hook_counters.dtor_calls = 0;
+    g_hook_counters.copy_calls = 0;
+
+    const i32 count = 100;
+    HookOwned values[100];
+    for (i32 i = 0; i < count; i++) {
+        values[i] = (HookOwned){ HOOK_MAGIC, i };
+    }
+    EcsEntity entities[100];
+    ecs_bulk_new(&world, &(EcsBulkDesc){
+        .ids = (EcsEntity[]){ ecs_id(HookOwned), ecs_id(HookPosition) },
+        .id_count = 2,
+        .data = (const void *[]){ values, NULL },
+        .count = count,
+        .entities = entities,
+    });
+    assert_eq(g_hook_counters.live, count);
+    assert_eq(g_hook_counters.ctor_calls, 1);
+    assert_eq(g_hook_counters.copy_calls, 1);
+
+    // growing the table past its capacity goes through the move hook, values survive
+    EcsTable *table = ecs_entity_get_record(&world, entities[0])->table;
+    for (i32 i = 0; i < count; i++) {
+        assert_eq(ecs_get_component(&world, entities[i], HookOwned)->value, i);
+    }
+
+    // deleting the first half destroys it as one span and slides the rest down
+    ecs_bulk_delete(&world, entities, count / 2);
+    assert_eq(g_hook_counters.live, count / 2);
+    assert_eq(g_hook_counters.dtor_calls, 1);
+    assert_eq(table->data.count, count / 2);
+    for (i32 i = count / 2; i < count; i++) {
+        HookOwned *owned = ecs_get_component(&world, entities[i], HookOwned);
+        assert_eq(owned->magic, HOOK_MAGIC);
+        assert_eq(owned->value, i);
+    }
+
+    // single delete destroys its row and relocates the last one into the hole
+    ecs_entity_delete(&world, entities[count / 2]);
+    assert_eq(g_hook_counters.live, count / 2 - 1);
+    assert_eq(ecs_get_component(&world, entities[count - 1], HookOwned)->value, count - 1);
+
+    // deferred sets hold a constructed copy until the merge
+    EcsEntity b = entities[count - 1];
+    ecs_defer_begin(&world);
+    ecs_set(&world, b, HookOwned, { HOOK_MAGIC, 1000 });
+    ecs_set(&world, entities[count - 2], HookOwned, { HOOK_MAGIC, 2000 });
+    ecs_remove(&world, entities[count - 2], ecs_id(HookOwned));
+    assert_eq(g_hook_counters.live, count / 2 + 1);
+    ecs_defer_end(&world);
+    assert_eq(g_hook_counters.live, count / 2 - 2);
+    assert_eq(ecs_get_component(&world, b, HookOwned)->value, 1000);
+    assert_false(ecs_has(&world, entities[count - 2], ecs_id(HookOwned)));
+
+    // types without hooks keep the plain memset/memcpy path
+    const EcsTypeInfo *ti = ecs_type_info_get(&world, ecs_id(HookPosition));
+    assert_true(ti->hooks.ctor == NULL && ti->hooks.move == NULL);
+    assert_eq((u32)ecs_get_component(&world, b, HookPosition)->x, 0);
+}
@@ -0,0 +1,101 @@
+#include "tests/test_ecs_meta_systems.h"
+#include "tests/test_ecs_meta_systems_generated.h"
+
+#define META_ENTITY_COUNT 200
+
+global EcsWorld g_meta_world;
+global u32 g_meta_counted;
+
+void MetaMoveSystem(EcsIter *it, MetaPosition *positions, const MetaVelocity *velocities) {
+    for (i32 i = 0; i < it->count; i++) {
+        positions[i].x += velocities[i].x * it->delta_time;
+        positions[i].y += velocities[i].y * it->delta_time;
+    }
+}
+
+void MetaDampSystem(EcsIter *it, MetaVelocity *velocities, const MetaDamping *damping) {
+    for (i32 i = 0; i < it->count; i++) {
+        velocities[i].x *= damping[i].value;
+        velocities[i].y *= damping[i].value;
+    }
+}
+
+void MetaCountSystem(const MetaDamping *damping, EcsIter *it) {
+    UNUSED(damping);
+    ins_atomic_u32_add_eval(&g_meta_counted, (u32)it->count);
+}
+
+// generated terms carry the exact access, so the hazard graph matches the hand written equivalent
+void test_ecs_meta_systems(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_meta_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_sys(world, &tctx->temp_arena);
+        ECS_COMPONENT_DEFINE(world, MetaPosition);
+        ECS_COMPONENT_DEFINE(world, MetaVelocity);
+        ECS_COMPONENT_DEFINE(world, MetaDamping);
+        g_meta_counted = 0;
+
+        for (i32 i = 0; i < META_ENTITY_COUNT; i++) {
+            EcsEntity e = ecs_entity_new(world);
+            ecs_set(world, e, MetaPosition, { .x = 0.0f, .y = 0.0f });
+            ecs_set(world, e, MetaVelocity, { .x = (f32)i, .y = 1.0f });
+            // half the entities move without damping
+            if (i % 2 == 0) {
+                ecs_set(world, e, MetaDamping, { .value = 0.5f });
+            }
+        }
+
+        EcsSystem *move = MetaMoveSystem_Register(world, NULL);
+        EcsSystem *damp = MetaDampSystem_Register(world, NULL);
+        EcsSystem *count = MetaCountSystem_Register(world, &(EcsSystemDesc){
+            .thread_mode = ECS_THREAD_SINGLE,
+        });
+
+        assert_eq(move->query.read_fields, MetaMoveSystem_READ_FIELDS);
+        assert_eq(move->query.write_fields, MetaMoveSystem_WRITE_FIELDS);
+        assert_eq(damp->query.read_fields, MetaDampSystem_READ_FIELDS);
+        assert_eq(damp->query.write_fields, MetaDampSystem_WRITE_FIELDS);
+        assert_eq(count->query.write_fields, 0);
+        assert_eq(count->thread_mode, ECS_THREAD_SINGLE);
+        assert_true(str_equal(count->name, "MetaCountSystem"));
+
+        // damp writes the velocity move reads, count only reads damping
+        assert_eq(move->depends_on_count, 0);
+        assert_eq(damp->depends_on_count, 1);
+        assert_true(damp->depends_on[0] == move);
+        assert_eq(count->depends_on_count, 0);
+    }
+    lane_sync();
+
+    ecs_progress(world, 1.0f);
+    ecs_progress(world, 1.0f);
+    lane_sync();
+
+    if (is_main_thread()) {
+        // two frames over the damped half
+        assert_eq(g_meta_counted, META_ENTITY_COUNT);
+
+        EcsQuery query = {0};
+        EcsTerm terms[MetaMoveSystem_TERM_COUNT];
+        MetaMoveSystem_Terms(terms);
+        ecs_query_init_terms(&query, world, terms, MetaMoveSystem_TERM_COUNT);
+
+        i32 rows = 0;
+        EcsIter it = ecs_query_iter(&query);
+        while (ecs_iter_next(&it)) {
+            MetaPosition *p = ecs_field(&it, MetaPosition, 0);
+            MetaVelocity *v = ecs_field(&it, MetaVelocity, 1);
+            for (i32 i = 0; i < it.count; i++) {
+                // the second frame moves by the first frame's damped velocity
+                f32 damping = p[i].y < 2.0f ? 0.5f : 1.0f;
+                assert_true(p[i].y == 1.0f + damping);
+                assert_true(v[i].y == damping * damping);
+                rows++;
+            }
+        }
+        assert_eq(rows, META_ENTITY_COUNT);
+    }
+    lane_sync();
+}
@@ -0,0 +1,27 @@
+#ifndef H_TEST_ECS_META_SYSTEMS
+#define H_TEST_ECS_META_SYSTEMS
+
+#include "ecs/ecs_table.h"
+
+// regenerate test_ecs_meta_systems_generated.h with make ecs-meta
+
+typedef struct { f32 x; f32 y; } MetaPosition;
+typedef struct { f32 x; f32 y; } MetaVelocity;
+typedef struct { f32 value; } MetaDamping;
+
+ECS_COMPONENT_DECLARE(MetaPosition);
+ECS_COMPONENT_DECLARE(MetaVelocity);
+ECS_COMPONENT_DECLARE(MetaDamping);
+
+HZ_SYSTEM()
+void MetaMoveSystem(EcsIter *it, HZ_READ() HZ_WRITE() MetaPosition *positions,
+                    HZ_READ() const MetaVelocity *velocities);
+
+HZ_SYSTEM()
+void MetaDampSystem(EcsIter *it, HZ_WRITE() MetaVelocity *velocities,
+                    HZ_READ() const MetaDamping *damping);
+
+HZ_SYSTEM()
+void MetaCountSystem(HZ_READ() const MetaDamping *damping, EcsIter *it);
+
+#endif
@@ -0,0 +1,96 @@
+// ==== GENERATED FILE DO NOT EDIT ====
+
+#ifndef H_test_ecs_meta_systems_GEN
+#define H_test_ecs_meta_systems_GEN
+#include <stdarg.h>
+#include "lib/multicore_runtime.h"
+#include "test_ecs_meta_systems.h"
+
+#define MetaMoveSystem_TERM_COUNT 2
+#define MetaMoveSystem_READ_FIELDS 3u
+#define MetaMoveSystem_WRITE_FIELDS 1u
+
+void _MetaMoveSystem_Run(EcsIter* it) {
+    MetaPosition* positions = ecs_field(it, MetaPosition, 0);
+    const MetaVelocity* velocities = ecs_field(it, MetaVelocity, 1);
+    MetaMoveSystem(it, positions, velocities);
+}
+
+void MetaMoveSystem_Terms(EcsTerm* terms) {
+    terms[0] = ecs_term_inout(ecs_id(MetaPosition));
+    terms[1] = ecs_term_in(ecs_id(MetaVelocity));
+}
+
+EcsSystem* MetaMoveSystem_Register(EcsWorld* world, const EcsSystemDesc* desc) {
+    EcsSystemDesc system_desc = {0};
+    if (desc) {
+        system_desc = *desc;
+    }
+    EcsTerm terms[MetaMoveSystem_TERM_COUNT];
+    MetaMoveSystem_Terms(terms);
+    system_desc.terms = terms;
+    system_desc.term_count = MetaMoveSystem_TERM_COUNT;
+    system_desc.callback = _MetaMoveSystem_Run;
+    system_desc.name = "MetaMoveSystem";
+    return ecs_system_init(world, &system_desc);
+}
+
+#define MetaDampSystem_TERM_COUNT 2
+#define MetaDampSystem_READ_FIELDS 2u
+#define MetaDampSystem_WRITE_FIELDS 1u
+
+void _MetaDampSystem_Run(EcsIter* it) {
+    MetaVelocity* velocities = ecs_field(it, MetaVelocity, 0);
+    const MetaDamping* damping = ecs_field(it, MetaDamping, 1);
+    MetaDampSystem(it, velocities, damping);
+}
+
+void MetaDampSystem_Terms(EcsTerm* terms) {
+    terms[0] = ecs_term_out(ecs_id(MetaVelocity));
+    terms[1] = ecs_term_in(ecs_id(MetaDamping));
+}
+
+EcsSystem* MetaDampSystem_Register(EcsWorld* world, const EcsSystemDesc* desc) {
+    EcsSystemDesc system_desc = {0};
+    if (desc) {
+        system_desc = *desc;
+    }
+    EcsTerm terms[MetaDampSystem_TERM_COUNT];
+    MetaDampSystem_Terms(terms);
+    system_desc.terms = terms;
+    system_desc.term_count = MetaDampSystem_TERM_COUNT;
+    system_desc.callback = _MetaDampSystem_Run;
+    system_desc.name = "MetaDampSystem";
+    return ecs_system_init(world, &system_desc);
+}
+
+#define MetaCountSystem_TERM_COUNT 1
+#define MetaCountSystem_READ_FIELDS 1u
+#define MetaCountSystem_WRITE_FIELDS 0u
+
+void _MetaCountSystem_Run(EcsIter* it) {
+    const MetaDamping* damping = ecs_field(it, MetaDamping, 0);
+    MetaCountSystem(damping, it);
+}
+
+void MetaCountSystem_Terms(EcsTerm* terms) {
+    terms[0] = ecs_term_in(ecs_id(MetaDamping));
+}
+
+EcsSystem* MetaCountSystem_Register(EcsWorld* world, const EcsSystemDesc* desc) {
+    EcsSystemDesc system_desc = {0};
+    if (desc) {
+        system_desc = *desc;
+    }
+    EcsTerm terms[MetaCountSystem_TERM_COUNT];
+    MetaCountSystem_Terms(terms);
+    system_desc.terms = terms;
+    system_desc.term_count = MetaCountSystem_TERM_COUNT;
+    system_desc.callback = _MetaCountSystem_Run;
+    system_desc.name = "MetaCountSystem";
+    return ecs_system_init(world, &system_desc);
+}
+
+#endif
+// ==== GENERATED FILE DO NOT EDIT ====
+
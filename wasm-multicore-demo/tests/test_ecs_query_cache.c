@@ -76,3 +76,76 @@ void test_ecs_query_cache(void) {
 
     assert_eq(move_query.cache.match_count, 2);
 }
+
+void test_ecs_query_cache_partition(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_qc(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, QCPosition);
+    ECS_COMPONENT(&world, QCVelocity);
+
+    // the query exists before any table, every matching table is appended as it is created
+    EcsQuery query;
+    ecs_query_init(&query, &world, (EcsEntity[]){ ecs_id(QCPosition) }, 1);
+    ecs_query_cache_init(&query);
+    assert_eq(query.cache.match_count, 0);
+
+    const i32 table_count = 300;
+    EcsEntity entities[300];
+    for (i32 i = 0; i < table_count; i++) {
+        EcsEntity tag = ecs_entity_new(&world);
+        entities[i] = ecs_entity_new(&world);
+        ecs_set(&world, entities[i], QCPosition, { .x = (f32)i, .y = 0.0f });
+        ecs_add(&world, entities[i], tag);
+    }
+
+    // [QCPosition] itself is matched but empty, every tagged table has one row
+    assert_eq(query.cache.match_count, table_count + 1);
+    assert_eq(query.cache.active_count, table_count);
+
+    EcsIter it = ecs_query_iter(&query);
+    i32 total = 0;
+    f32 sum = 0.0f;
+    while (ecs_iter_next(&it)) {
+        QCPosition *p = ecs_field(&it, QCPosition, 0);
+        for (i32 i = 0; i < it.count; i++) {
+            sum += p[i].x;
+        }
+        total += it.count;
+    }
+    assert_eq(total, table_count);
+    assert_eq((u32)sum, (u32)(table_count * (table_count - 1) / 2));
+
+    // emptied tables drop out of the walk without leaving the cache
+    for (i32 i = 0; i < table_count; i += 2) {
+        ecs_entity_delete(&world, entities[i]);
+    }
+    assert_eq(query.cache.match_count, table_count + 1);
+    assert_eq(query.cache.active_count, table_count / 2);
+
+    it = ecs_query_iter(&query);
+    i32 visited = 0;
+    while (ecs_iter_next(&it)) {
+        assert_true(it.count > 0);
+        visited++;
+    }
+    assert_eq(visited, table_count / 2);
+
+    // back references stay valid through the swaps
+    for (i32 m = 0; m < query.cache.match_count; m++) {
+        EcsQueryCacheMatch *match = &query.cache.matches[m];
+        EcsTableCacheRef *ref = &match->table->cache_refs[match->ref_index];
+        assert_true(ref->query == &query);
+        assert_eq(ref->match_index, m);
+        assert_eq(m < query.cache.active_count, match->table->data.count > 0);
+    }
+
+    ecs_bulk_new(&world, &(EcsBulkDesc){
+        .ids = (EcsEntity[]){ ecs_id(QCPosition) },
+        .id_count = 1,
+        .count = 10,
+    });
+    assert_eq(query.cache.active_count, table_count / 2 + 1);
+}
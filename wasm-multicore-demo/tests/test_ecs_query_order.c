@@ -0,0 +1,259 @@
+typedef struct { f32 x; f32 y; } OrdPosition;
+typedef struct { i32 value; } OrdDepth;
+
+typedef struct {
+    EcsEntity tags[4];
+} OrdGroupCtx;
+
+void ecs_world_init_full_ord(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+// group = index of the tag the table has, tagless tables go to group 100
+u64 ord_group_by_tag(EcsWorld *world, EcsTable *table, EcsEntity group_id, void *ctx) {
+    UNUSED(world);
+    UNUSED(group_id);
+    OrdGroupCtx *group_ctx = (OrdGroupCtx *)ctx;
+    for (i32 i = 0; i < 4; i++) {
+        if (ecs_table_has_component(table, group_ctx->tags[i])) {
+            return (u64)i;
+        }
+    }
+    return 100;
+}
+
+i32 ord_compare_depth(EcsEntity e1, const void *ptr1, EcsEntity e2, const void *ptr2) {
+    UNUSED(e1);
+    UNUSED(e2);
+    i32 a = ((const OrdDepth *)ptr1)->value;
+    i32 b = ((const OrdDepth *)ptr2)->value;
+    return (a > b) - (a < b);
+}
+
+internal void ord_assert_sorted(EcsWorld *world, EcsQuery *query, i32 expected_count) {
+    EcsIter it = ecs_query_iter(query);
+    i32 total = 0;
+    i32 prev = -1000000;
+    while (ecs_iter_next(&it)) {
+        OrdDepth *depth = ecs_field(&it, OrdDepth, 0);
+        for (i32 i = 0; i < it.count; i++) {
+            assert_true(depth[i].value >= prev);
+            prev = depth[i].value;
+            // rows were moved, records must follow
+            OrdDepth *via_record = (OrdDepth *)ecs_get(world, it.entities[i], query->order_by_component);
+            assert_true(via_record == &depth[i]);
+        }
+        total += it.count;
+    }
+    assert_eq(total, expected_count);
+}
+
+void test_ecs_query_group_by(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_ord(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, OrdPosition);
+
+    OrdGroupCtx group_ctx;
+    for (i32 i = 0; i < 4; i++) {
+        group_ctx.tags[i] = ecs_entity_new(&world);
+    }
+
+    EcsQuery query;
+    ecs_query_init(&query, &world, (EcsEntity[]){ ecs_id(OrdPosition) }, 1);
+    ecs_query_group_by(&query, 0, ord_group_by_tag, &group_ctx);
+    ecs_query_cache_init(&query);
+
+    // group g gets g + 1 entities, created in reverse group order
+    for (i32 g = 3; g >= 0; g--) {
+        for (i32 i = 0; i <= g; i++) {
+            EcsEntity e = ecs_entity_new(&world);
+            ecs_set(&world, e, OrdPosition, { (f32)g, 0.0f });
+            ecs_add(&world, e, group_ctx.tags[g]);
+        }
+    }
+    EcsEntity untagged = ecs_entity_new(&world);
+    ecs_set(&world, untagged, OrdPosition, { 100.0f, 0.0f });
+
+    // full iteration walks groups in id order
+    EcsIter it = ecs_query_iter(&query);
+    i32 prev_group = -1;
+    i32 total = 0;
+    while (ecs_iter_next(&it)) {
+        OrdPosition *p = ecs_field(&it, OrdPosition, 0);
+        assert_true((i32)p[0].x >= prev_group);
+        prev_group = (i32)p[0].x;
+        total += it.count;
+    }
+    assert_eq(total, 11);
+    assert_eq(query.cache.group_count, 5);
+
+    for (i32 g = 0; g < 4; g++) {
+        it = ecs_query_iter(&query);
+        ecs_iter_set_group(&it, (u64)g);
+        i32 count = 0;
+        while (ecs_iter_next(&it)) {
+            OrdPosition *p = ecs_field(&it, OrdPosition, 0);
+            for (i32 i = 0; i < it.count; i++) {
+                assert_eq((i32)p[i].x, g);
+            }
+            count += it.count;
+        }
+        assert_eq(count, g + 1);
+    }
+
+    it = ecs_query_iter(&query);
+    ecs_iter_set_group(&it, 42);
+    assert_false(ecs_iter_next(&it));
+
+    // an emptied table leaves its group
+    ecs_entity_delete(&world, untagged);
+    it = ecs_query_iter(&query);
+    ecs_iter_set_group(&it, 100);
+    assert_false(ecs_iter_next(&it));
+    assert_eq(query.cache.group_count, 4);
+}
+
+void test_ecs_query_order_by(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_ord(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, OrdDepth);
+    ECS_COMPONENT(&world, OrdPosition);
+    EcsEntity tag = ecs_entity_new(&world);
+
+    EcsQuery query;
+    ecs_query_init(&query, &world, (EcsEntity[]){ ecs_id(OrdDepth) }, 1);
+    ecs_query_order_by(&query, ecs_id(OrdDepth), ord_compare_depth);
+    ecs_query_cache_init(&query);
+
+    // three tables with interleaved depths
+    const i32 count = 90;
+    EcsEntity entities[90];
+    for (i32 i = 0; i < count; i++) {
+        EcsEntity e = ecs_entity_new(&world);
+        ecs_set(&world, e, OrdDepth, { (i * 37) % count });
+        if (i % 3 == 1) {
+            ecs_add(&world, e, ecs_id(OrdPosition));
+        } else if (i % 3 == 2) {
+            ecs_add(&world, e, tag);
+        }
+        entities[i] = e;
+    }
+    ord_assert_sorted(&world, &query, count);
+    i32 slices_before = query.cache.slice_count;
+    assert_true(slices_before > 3);
+
+    // untouched tables are not re-sorted
+    EcsTable *tagged = ecs_entity_get_record(&world, entities[2])->table;
+    u32 tagged_state = tagged->dirty_state[0];
+    ecs_set(&world, entities[0], OrdDepth, { -5 });
+    ecs_set(&world, entities[3], OrdDepth, { 1000 });
+    ord_assert_sorted(&world, &query, count);
+    assert_eq(tagged->dirty_state[0], tagged_state);
+
+    // new rows and deleted rows
+    ecs_entity_delete(&world, entities[4]);
+    EcsEntity late = ecs_entity_new(&world);
+    ecs_set(&world, late, OrdDepth, { 45 });
+    ord_assert_sorted(&world, &query, count);
+
+    // the first slice starts with the lowest depth
+    EcsIter it = ecs_query_iter(&query);
+    assert_true(ecs_iter_next(&it));
+    assert_eq(it.entities[0], entities[0]);
+}
+
+typedef struct { u32 lane; } OrdOwner;
+
+global EcsWorld g_ord_world;
+global EcsEntity g_ord_entities[300];
+global EcsEntity g_ord_depth_id;
+global u32 g_ord_rows;
+global u32 g_ord_foreign_rows;
+
+void OrdClaimSystem(EcsIter *it) {
+    OrdOwner *owner = ecs_field(it, OrdOwner, 0);
+    for (i32 i = 0; i < it->count; i++) {
+        owner[i].lane = it->lane;
+    }
+}
+
+void OrdSortedReadSystem(EcsIter *it) {
+    const OrdOwner *owner = ecs_field(it, OrdOwner, 1);
+    u32 foreign = 0;
+    for (i32 i = 0; i < it->count; i++) {
+        foreign += owner[i].lane != it->lane;
+    }
+    ins_atomic_u32_add_eval(&g_ord_rows, (u32)it->count);
+    ins_atomic_u32_add_eval(&g_ord_foreign_rows, foreign);
+}
+
+// lane j of the sorted reader only waits for lane j of the writer, so it must get the same rows
+// of each table even though its slices start mid-table
+void test_ecs_order_by_systems(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_ord_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_ord(world, &tctx->temp_arena);
+        ECS_COMPONENT(world, OrdDepth);
+        ECS_COMPONENT(world, OrdOwner);
+        ECS_COMPONENT(world, OrdPosition);
+        g_ord_depth_id = ecs_id(OrdDepth);
+        EcsEntity tag = ecs_entity_new(world);
+
+        // three tables with interleaved depths, so most slices are a row or two
+        for (i32 i = 0; i < 300; i++) {
+            EcsEntity e = ecs_entity_new(world);
+            ecs_set(world, e, OrdDepth, { (i * 37) % 300 });
+            ecs_add(world, e, ecs_id(OrdOwner));
+            if (i % 3 == 1) {
+                ecs_add(world, e, ecs_id(OrdPosition));
+            } else if (i % 3 == 2) {
+                ecs_add(world, e, tag);
+            }
+            g_ord_entities[i] = e;
+        }
+
+        EcsTerm claim_terms[] = { ecs_term_out(ecs_id(OrdOwner)) };
+        ECS_SYSTEM(world, OrdClaimSystem, claim_terms, 1);
+        EcsTerm read_terms[] = { ecs_term_in(ecs_id(OrdDepth)), ecs_term_in(ecs_id(OrdOwner)) };
+        ecs_system_init(world, &(EcsSystemDesc){
+            .terms = read_terms,
+            .term_count = 2,
+            .callback = OrdSortedReadSystem,
+            .name = "OrdSortedReadSystem",
+            .order_by = ord_compare_depth,
+            .order_by_component = ecs_id(OrdDepth),
+        });
+        g_ord_rows = 0;
+        g_ord_foreign_rows = 0;
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_ord_rows, 300);
+        assert_eq(g_ord_foreign_rows, 0);
+
+        // re-sorted rows keep the split
+        for (i32 i = 0; i < 300; i += 7) {
+            ecs_set_ptr(world, g_ord_entities[i], g_ord_depth_id, &(OrdDepth){ 300 - i });
+        }
+        g_ord_rows = 0;
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_ord_rows, 300);
+        assert_eq(g_ord_foreign_rows, 0);
+    }
+    lane_sync();
+}
@@ -0,0 +1,111 @@
+typedef struct { f32 x; f32 y; } SnapPosition;
+typedef struct { f32 x; f32 y; } SnapVelocity;
+typedef struct { i32 value; } SnapHealth;
+
+void ecs_world_init_full_snap(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+global EcsEntity g_snap_position_id;
+global EcsEntity g_snap_velocity_id;
+global EcsEntity g_snap_health_id;
+
+// same order in every world, so ids line up
+internal void snap_register(EcsWorld *world) {
+    g_snap_position_id = ecs_component_register(world, sizeof(SnapPosition), _Alignof(SnapPosition), "SnapPosition");
+    g_snap_velocity_id = ecs_component_register(world, sizeof(SnapVelocity), _Alignof(SnapVelocity), "SnapVelocity");
+    g_snap_health_id = ecs_component_register(world, sizeof(SnapHealth), _Alignof(SnapHealth), "SnapHealth");
+}
+
+void test_ecs_snapshot(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld src;
+    ecs_world_init_full_snap(&src, &tctx->temp_arena);
+    snap_register(&src);
+    EcsEntity position_id = g_snap_position_id;
+    EcsEntity velocity_id = g_snap_velocity_id;
+    EcsEntity health_id = g_snap_health_id;
+    EcsEntity tag = ecs_entity_new(&src);
+
+    const i32 count = 300;
+    EcsEntity entities[300];
+    for (i32 i = 0; i < count; i++) {
+        EcsEntity e = ecs_entity_new(&src);
+        ecs_set_ptr(&src, e, position_id, &(SnapPosition){ (f32)i, (f32)-i });
+        if (i % 2) {
+            ecs_set_ptr(&src, e, velocity_id, &(SnapVelocity){ 1.0f, (f32)i });
+        }
+        if (i % 3 == 0) {
+            ecs_set_ptr(&src, e, health_id, &(SnapHealth){ i * 10 });
+            ecs_add(&src, e, tag);
+        }
+        entities[i] = e;
+    }
+
+    // dead ids and their bumped generations travel with the snapshot
+    for (i32 i = 0; i < count; i += 7) {
+        ecs_entity_delete(&src, entities[i]);
+    }
+
+    EcsSnapshotHeader *snapshot = ecs_world_snapshot(&src, &tctx->temp_arena);
+    assert_eq(snapshot->magic, ECS_SNAPSHOT_MAGIC);
+
+    // offsets only: the blob still loads after being moved
+    u8 *moved = (u8 *)arena_alloc_align(&tctx->temp_arena, snapshot->size, ECS_SNAPSHOT_ALIGNMENT);
+    memcpy(moved, snapshot, snapshot->size);
+    memset(snapshot, 0, snapshot->size);
+
+    EcsWorld dst;
+    ecs_world_init_full_snap(&dst, &tctx->temp_arena);
+    snap_register(&dst);
+    EcsQuery query;
+    ecs_query_init(&query, &dst, (EcsEntity[]){ position_id, velocity_id }, 2);
+    ecs_query_cache_init(&query);
+
+    assert_true(ecs_world_restore(&dst, (EcsSnapshotHeader *)moved));
+    assert_eq(ecs_entity_count(&dst), ecs_entity_count(&src));
+
+    for (i32 i = 0; i < count; i++) {
+        EcsEntity e = entities[i];
+        if (i % 7 == 0) {
+            assert_false(ecs_entity_is_alive(&dst, e));
+            continue;
+        }
+        assert_true(ecs_entity_is_alive(&dst, e));
+        SnapPosition *p = (SnapPosition *)ecs_get(&dst, e, position_id);
+        assert_eq((i32)p->x, i);
+        assert_eq((i32)p->y, -i);
+        assert_eq(ecs_has(&dst, e, velocity_id), (b32)(i % 2));
+        assert_eq(ecs_has(&dst, e, tag), i % 3 == 0);
+        if (i % 3 == 0) {
+            assert_eq(((SnapHealth *)ecs_get(&dst, e, health_id))->value, i * 10);
+        }
+    }
+
+    // queries created before the restore see the restored tables
+    i32 total = 0;
+    EcsIter it = ecs_query_iter(&query);
+    while (ecs_iter_next(&it)) {
+        SnapVelocity *v = ecs_field(&it, SnapVelocity, 1);
+        for (i32 i = 0; i < it.count; i++) {
+            assert_eq((i32)v[i].y % 2, 1);
+        }
+        total += it.count;
+    }
+    assert_eq(total, count / 2 - count / 14);
+
+    // both worlds hand out the same recycled id next
+    EcsEntity next_src = ecs_entity_new(&src);
+    EcsEntity next_dst = ecs_entity_new(&dst);
+    assert_true(next_src == next_dst);
+    assert_true(ecs_entity_generation(next_dst) > 0);
+
+    // a world with a different component layout is rejected
+    EcsWorld other;
+    ecs_world_init_full_snap(&other, &tctx->temp_arena);
+    ecs_component_register(&other, sizeof(SnapVelocity), _Alignof(SnapVelocity), "SnapVelocity");
+    ecs_component_register(&other, sizeof(SnapPosition), _Alignof(SnapPosition), "SnapPosition");
+    assert_false(ecs_world_restore(&other, (EcsSnapshotHeader *)moved));
+}
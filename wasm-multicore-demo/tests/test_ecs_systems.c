@@ -2,6 +2,8 @@ typedef struct { f32 value; } SysAlpha;
 typedef struct { f32 value; } SysBeta;
 typedef struct { f32 value; } SysGamma;
 typedef struct { f32 value; } SysDelta;
+typedef struct { u8 dummy; } SysTagA;
+typedef struct { u8 dummy; } SysTagB;
 
 void ecs_world_init_full_sys(EcsWorld *world, ArenaAllocator *arena) {
     ecs_world_init(world, arena);
@@ -90,8 +92,268 @@ void test_ecs_systems(void) {
     assert_eq(sys_a->depends_on_count, 0);
     assert_eq(sys_b->depends_on_count, 1);
     assert_eq(sys_c->depends_on_count, 1);
-    assert_eq(sys_d->depends_on_count, 3);
-    assert_eq(sys_e->depends_on_count, 2);
+    // d reads everything a, b and c wrote but c already waits for b, which waits for a
+    assert_eq(sys_d->depends_on_count, 1);
+    assert_true(sys_d->depends_on[0] == sys_c);
+    assert_true(ecs_systems_conflict(sys_a, sys_d));
+    assert_eq(sys_e->depends_on_count, 1);
+    assert_true(sys_e->depends_on[0] == sys_b);
 
     assert_eq(world.system_count, 5);
 }
+
+void SysNoop(EcsIter *it) {
+    UNUSED(it);
+}
+
+internal EcsSystem* sys_graph_system(EcsWorld *world, EcsTerm *terms, i32 term_count, EcsThreadMode thread_mode) {
+    return ecs_system_init(world, &(EcsSystemDesc){
+        .terms = terms,
+        .term_count = term_count,
+        .callback = SysNoop,
+        .name = "SysNoop",
+        .thread_mode = thread_mode,
+    });
+}
+
+void test_ecs_system_graph(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_sys(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, SysAlpha);
+    ECS_COMPONENT(&world, SysBeta);
+    ECS_COMPONENT(&world, SysTagA);
+    ECS_COMPONENT(&world, SysTagB);
+    EcsEntity tag_a = ecs_id(SysTagA);
+    EcsEntity tag_b = ecs_id(SysTagB);
+
+    EcsEntity in_a = ecs_entity_new(&world);
+    ecs_set(&world, in_a, SysAlpha, { .value = 0.0f });
+    ecs_add(&world, in_a, tag_a);
+    EcsEntity in_b = ecs_entity_new(&world);
+    ecs_set(&world, in_b, SysAlpha, { .value = 0.0f });
+    ecs_add(&world, in_b, tag_b);
+
+    // 0 and 1 write Alpha on tables that don't overlap yet
+    EcsTerm write_a[] = { ecs_term_out(ecs_id(SysAlpha)), ecs_term_none(tag_a) };
+    EcsSystem *s0 = sys_graph_system(&world, write_a, 2, ECS_THREAD_MULTI);
+    EcsTerm write_b[] = { ecs_term_inout(ecs_id(SysAlpha)), ecs_term_none(tag_b) };
+    EcsSystem *s1 = sys_graph_system(&world, write_b, 2, ECS_THREAD_MULTI);
+    EcsTerm read_all[] = { ecs_term_in(ecs_id(SysAlpha)) };
+    EcsSystem *s2 = sys_graph_system(&world, read_all, 1, ECS_THREAD_MULTI);
+    // write after read with 2, write after write with 0 and 1
+    EcsTerm write_all[] = { ecs_term_out(ecs_id(SysAlpha)) };
+    EcsSystem *s3 = sys_graph_system(&world, write_all, 1, ECS_THREAD_MULTI);
+
+    assert_false(ecs_systems_conflict(s0, s1));
+    assert_eq(s1->depends_on_count, 0);
+    assert_eq(s2->depends_on_count, 2);
+    assert_true(ecs_systems_conflict(s2, s3));
+    assert_true(ecs_systems_conflict(s0, s3));
+    assert_eq(s3->depends_on_count, 1);
+    assert_true(s3->depends_on[0] == s2);
+    assert_eq(ecs_system_graph_critical_path(&world), 3);
+
+    // a table with both tags orders 0 before 1, and 2 then only needs to wait for 1
+    EcsEntity in_ab = ecs_entity_new(&world);
+    ecs_set(&world, in_ab, SysAlpha, { .value = 0.0f });
+    ecs_add(&world, in_ab, tag_a);
+    ecs_add(&world, in_ab, tag_b);
+    assert_true(ecs_systems_conflict(s0, s1));
+    assert_eq(s1->depends_on_count, 1);
+    assert_eq(s2->depends_on_count, 1);
+    assert_true(s2->depends_on[0] == s1);
+    assert_eq(ecs_system_graph_critical_path(&world), 4);
+
+    // a single threaded system in between only covers lane 0 of a multi threaded one
+    EcsTerm write_beta[] = { ecs_term_out(ecs_id(SysBeta)) };
+    EcsSystem *s4 = sys_graph_system(&world, write_beta, 1, ECS_THREAD_MULTI);
+    EcsTerm read_beta[] = { ecs_term_in(ecs_id(SysBeta)) };
+    EcsSystem *s5 = sys_graph_system(&world, read_beta, 1, ECS_THREAD_SINGLE);
+    EcsSystem *s6 = sys_graph_system(&world, write_beta, 1, ECS_THREAD_MULTI);
+    assert_eq(s4->depends_on_count, 0);
+    assert_eq(s5->depends_on_count, 0);
+    assert_eq(s6->depends_on_count, 0);
+
+    EcsEntity with_beta = ecs_entity_new(&world);
+    ecs_set(&world, with_beta, SysBeta, { .value = 0.0f });
+    assert_eq(s5->depends_on_count, 1);
+    assert_eq(s6->depends_on_count, 2);
+
+    // explicit edges go through the same reduction
+    ecs_system_depends_on(s4, s3);
+    assert_eq(s4->depends_on_count, 1);
+    assert_eq(ecs_system_graph_critical_path(&world), 7);
+
+    // sparse terms meet on the whole set, whatever tables the systems match
+    ECS_COMPONENT(&world, SysDelta);
+    assert_true(ecs_component_set_sparse(&world, ecs_id(SysDelta)));
+    EcsTerm filter_a[] = { ecs_term_none(tag_a), ecs_term_none(ecs_id(SysDelta)) };
+    EcsSystem *s7 = sys_graph_system(&world, filter_a, 2, ECS_THREAD_MULTI);
+    EcsTerm filter_beta[] = { ecs_term_none(ecs_id(SysBeta)), ecs_term_none(ecs_id(SysDelta)) };
+    EcsSystem *s8 = sys_graph_system(&world, filter_beta, 2, ECS_THREAD_MULTI);
+    EcsTerm write_delta[] = { ecs_term_none(ecs_id(SysBeta)), ecs_term_out(ecs_id(SysDelta)) };
+    EcsSystem *s9 = sys_graph_system(&world, write_delta, 2, ECS_THREAD_MULTI);
+    assert_false(ecs_systems_conflict(s7, s8));
+    assert_true(ecs_systems_conflict(s7, s9));
+    assert_true(ecs_systems_conflict(s8, s9));
+    assert_eq(s9->depends_on_count, 2);
+}
+
+global EcsWorld g_sys_deps_world;
+global u32 g_sys_deps_runs;
+
+void SysDepsCount(EcsIter *it) {
+    UNUSED(it);
+    ins_atomic_u32_add_eval(&g_sys_deps_runs, 1);
+}
+
+// readers never reduce each other away, a writer after all of them waits on every one, barriers
+// take a handle per lane
+void test_ecs_system_many_deps(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_sys_deps_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_sys(world, &tctx->temp_arena);
+        ECS_COMPONENT(world, SysGamma);
+        EcsEntity e = ecs_entity_new(world);
+        ecs_set(world, e, SysGamma, { .value = 0.0f });
+
+        EcsTerm read_gamma[] = { ecs_term_in(ecs_id(SysGamma)) };
+        for (i32 i = 0; i < 80; i++) {
+            ecs_system_init(world, &(EcsSystemDesc){
+                .terms = read_gamma,
+                .term_count = 1,
+                .callback = SysNoop,
+                .name = "SysNoop",
+                .sync_mode = i % 10 == 0 ? ECS_SYNC_BARRIER : ECS_SYNC_NONE,
+            });
+        }
+        EcsTerm write_gamma[] = { ecs_term_out(ecs_id(SysGamma)) };
+        EcsSystem *writer = ecs_system_init(world, &(EcsSystemDesc){
+            .terms = write_gamma,
+            .term_count = 1,
+            .callback = SysDepsCount,
+            .name = "SysDepsCount",
+            .thread_mode = ECS_THREAD_SINGLE,
+        });
+        assert_eq(writer->depends_on_count, 80);
+        g_sys_deps_runs = 0;
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        assert_eq(g_sys_deps_runs, 1);
+    }
+    lane_sync();
+}
+
+global EcsWorld g_sys_profile_world;
+
+void test_ecs_system_profile(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_sys_profile_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_sys(world, &tctx->temp_arena);
+        ECS_COMPONENT(world, SysAlpha);
+        ECS_COMPONENT(world, SysBeta);
+        ECS_COMPONENT(world, SysTagA);
+        ECS_COMPONENT(world, SysTagB);
+
+        // alpha on three tables, beta on one of them
+        for (i32 i = 0; i < 300; i++) {
+            EcsEntity e = ecs_entity_new(world);
+            ecs_set(world, e, SysAlpha, { .value = 0.0f });
+            if (i % 3 == 1) {
+                ecs_add(world, e, ecs_id(SysTagA));
+            } else if (i % 3 == 2) {
+                ecs_add(world, e, ecs_id(SysTagB));
+                ecs_set(world, e, SysBeta, { .value = 0.0f });
+            }
+        }
+
+        EcsTerm terms_a[] = { ecs_term_out(ecs_id(SysAlpha)) };
+        sys_graph_system(world, terms_a, 1, ECS_THREAD_MULTI);
+        EcsTerm terms_b[] = { ecs_term_in(ecs_id(SysBeta)) };
+        sys_graph_system(world, terms_b, 1, ECS_THREAD_SINGLE);
+        ecs_profile_enable(world, 4);
+    }
+    lane_sync();
+
+    for (i32 frame = 0; frame < 6; frame++) {
+        ecs_progress(world, 0.016f);
+    }
+    // lanes publish their frame after ecs_progress's last barrier
+    lane_sync();
+
+    if (is_main_thread()) {
+        EcsProfileCapture capture = ecs_profile_capture(world, 8, &tctx->temp_arena);
+        assert_eq(capture.lane_count, tctx->thread_count);
+        assert_eq(capture.frame_count, 4);
+
+        for (i32 f = 0; f < capture.frame_count; f++) {
+            i32 rows[2] = {0};
+            i32 tables[2] = {0};
+            i32 lanes_with_b = 0;
+            for (i32 l = 0; l < capture.lane_count; l++) {
+                EcsProfileFrame *frame = &capture.frames[l * capture.frame_count + f];
+                assert_eq(frame->frame, (u64)(2 + f));
+                assert_eq(frame->system_count, 2);
+                assert_true(frame->wall_ns > 0);
+                assert_true(frame->wait_ns <= frame->wall_ns);
+                for (i32 s = 0; s < 2; s++) {
+                    rows[s] += frame->systems[s].rows;
+                    tables[s] += frame->systems[s].tables;
+                }
+                lanes_with_b += frame->systems[1].rows > 0;
+            }
+            // every lane's slice of alpha adds up to the whole tables, the single threaded system runs once
+            assert_eq(rows[0], 300);
+            assert_true(tables[0] >= 3);
+            assert_eq(rows[1], 100);
+            assert_eq(tables[1], 1);
+            assert_eq(lanes_with_b, 1);
+        }
+
+        // past the first system_cap the rings grow and keep what they recorded
+        EcsEntity beta = world->systems[1]->query.terms[0].id;
+        for (i32 i = 0; i < 16; i++) {
+            EcsTerm terms[] = { ecs_term_in(beta) };
+            sys_graph_system(world, terms, 1, ECS_THREAD_SINGLE);
+        }
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    lane_sync();
+
+    if (is_main_thread()) {
+        EcsProfileCapture capture = ecs_profile_capture(world, 8, &tctx->temp_arena);
+        assert_eq(capture.frame_count, 4);
+        i32 rows = 0;
+        for (i32 l = 0; l < capture.lane_count; l++) {
+            EcsProfileFrame *oldest = &capture.frames[l * capture.frame_count];
+            EcsProfileFrame *newest = &capture.frames[l * capture.frame_count + 3];
+            assert_eq(oldest->frame, (u64)3);
+            assert_eq(oldest->system_count, 2);
+            assert_eq(newest->system_count, 18);
+            rows += oldest->systems[0].rows;
+        }
+        assert_eq(rows, 300);
+
+        ecs_profile_enable(world, 0);
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    if (is_main_thread()) {
+        EcsProfileCapture capture = ecs_profile_capture(world, 8, &tctx->temp_arena);
+        assert_eq(capture.frame_count, 0);
+    }
+    lane_sync();
+}
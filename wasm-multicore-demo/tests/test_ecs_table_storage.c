@@ -0,0 +1,255 @@
+typedef struct { f32 x; f32 y; } TsPosition;
+typedef struct { f32 x; f32 y; } TsVelocity;
+
+void ecs_world_init_full_ts(EcsWorld *world, ArenaAllocator *arena) {
+    ecs_world_init(world, arena);
+    ecs_store_init(world);
+}
+
+void test_ecs_table_storage(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_ts(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, TsPosition);
+    ECS_COMPONENT(&world, TsVelocity);
+
+    EcsEntity type_ids[] = { ecs_id(TsPosition), ecs_id(TsVelocity) };
+    EcsType type = { .array = type_ids, .count = 2 };
+    EcsTable *table = ecs_table_find_or_create(&world, &type);
+
+    i32 pos_col_idx;
+    ecs_table_get_column(table, ecs_id(TsPosition), &pos_col_idx);
+
+    EcsEntity entities[1000];
+    for (i32 i = 0; i < 1000; i++) {
+        entities[i] = ecs_entity_new(&world);
+        i32 row = ecs_table_append(&world, table, entities[i]);
+        TsPosition *p = (TsPosition*)ecs_table_get_component(table, row, pos_col_idx);
+        *p = (TsPosition){ (f32)i, 0.0f };
+    }
+    assert_eq(table->data.count, 1000);
+    assert_eq(table->data.size, 1024);
+
+    size_t used_full = world.allocator.used_size;
+    size_t total_full = world.allocator.total_size;
+
+    for (i32 i = 0; i < 990; i++) {
+        ecs_table_delete(&world, table, table->data.count - 1);
+    }
+    assert_eq(table->data.count, 10);
+
+    ecs_table_shrink(&world, table);
+    assert_eq(table->data.size, 16);
+    assert_true(world.allocator.used_size < used_full);
+
+    for (i32 i = 0; i < 10; i++) {
+        TsPosition *p = (TsPosition*)ecs_table_get_component(table, i, pos_col_idx);
+        assert_eq((u32)p->x, (u32)i);
+        assert_eq(table->data.entities[i], entities[i]);
+    }
+
+    // empty tables release all of their storage
+    while (table->data.count > 0) {
+        ecs_table_delete(&world, table, table->data.count - 1);
+    }
+    ecs_store_shrink(&world);
+    assert_eq(table->data.size, 0);
+    assert_true(table->data.entities == NULL);
+    assert_true(table->data.columns[0].data == NULL);
+
+    // growing again reuses freed blocks instead of carving new ones
+    for (i32 i = 0; i < 1000; i++) {
+        ecs_table_append(&world, table, entities[i]);
+    }
+    assert_eq(table->data.count, 1000);
+    assert_eq(world.allocator.total_size, total_full);
+    assert_eq(world.allocator.used_size, used_full);
+}
+
+typedef struct { f32 x; f32 y; f32 z; } TsScale;
+
+global EcsWorld g_ts_chunk_world;
+global EcsEntity g_ts_chunk_entities[1338];
+global EcsEntity g_ts_chunk_position_id;
+global u32 g_ts_chunk_misaligned;
+
+void TsChunkSystem(EcsIter *it) {
+    TsPosition *p = ecs_field(it, TsPosition, 0);
+    if ((size_t)p % ECS_COLUMN_ALIGNMENT != 0 || it->offset % it->table->chunk_rows != 0) {
+        ins_atomic_u32_inc_eval(&g_ts_chunk_misaligned);
+    }
+    for (i32 i = 0; i < it->count; i++) {
+        p[i].x += 1.0f;
+    }
+}
+
+void test_ecs_chunked_layout(void) {
+    ThreadContext *tctx = tctx_current();
+    EcsWorld *world = &g_ts_chunk_world;
+
+    if (is_main_thread()) {
+        ecs_world_init_full_ts(world, &tctx->temp_arena);
+        ecs_world_set_chunk_size(world, 1024);
+        ECS_COMPONENT(world, TsPosition);
+        ECS_COMPONENT(world, TsVelocity);
+        ECS_COMPONENT(world, TsScale);
+        g_ts_chunk_position_id = ecs_id(TsPosition);
+        g_ts_chunk_misaligned = 0;
+
+        // 1000 rows of [Position, Velocity], 333 with Scale too, 5 with Position only
+        for (i32 i = 0; i < 1338; i++) {
+            EcsEntity e = ecs_entity_new(world);
+            ecs_set(world, e, TsPosition, { (f32)i, 0.0f });
+            if (i < 1333) {
+                ecs_set(world, e, TsVelocity, { 1.0f, 0.0f });
+            }
+            if (i >= 1000 && i < 1333) {
+                ecs_set(world, e, TsScale, { 1.0f, 1.0f, 1.0f });
+            }
+            g_ts_chunk_entities[i] = e;
+        }
+
+        // 24 byte rows of 8 byte columns: multiples of 8 rows. the 12 byte column needs 16
+        EcsRecord *r = ecs_entity_get_record(world, g_ts_chunk_entities[0]);
+        assert_eq(r->table->chunk_rows, 40);
+        r = ecs_entity_get_record(world, g_ts_chunk_entities[1000]);
+        assert_eq(r->table->chunk_rows, 16);
+        r = ecs_entity_get_record(world, g_ts_chunk_entities[1333]);
+        assert_eq(r->table->chunk_rows, 64);
+
+        EcsTerm terms[] = { ecs_term_inout(ecs_id(TsPosition)) };
+        ecs_system_init(world, &(EcsSystemDesc){
+            .terms = terms,
+            .term_count = 1,
+            .callback = TsChunkSystem,
+            .name = "TsChunkSystem",
+        });
+    }
+    lane_sync();
+
+    ecs_progress(world, 0.016f);
+    ecs_progress(world, 0.016f);
+
+    if (is_main_thread()) {
+        assert_eq(g_ts_chunk_misaligned, 0);
+        for (i32 i = 0; i < 1338; i++) {
+            TsPosition *p = (TsPosition *)ecs_get(world, g_ts_chunk_entities[i], g_ts_chunk_position_id);
+            assert_eq((i32)p->x, i + 2);
+        }
+    }
+    lane_sync();
+}
+
+typedef struct { u8 dummy; } TsSelected;
+typedef struct { i32 value; } TsThreat;
+
+internal i32 ts_query_count(EcsQuery *query, EcsEntity selected, b32 expect_selected, EcsWorld *world) {
+    i32 total = 0;
+    EcsIter it = ecs_query_iter(query);
+    while (ecs_iter_next(&it)) {
+        for (i32 i = 0; i < it.count; i++) {
+            if (ecs_has(world, it.entities[i], selected) != expect_selected) {
+                return -1;
+            }
+        }
+        total += it.count;
+    }
+    return total;
+}
+
+void test_ecs_sparse_storage(void) {
+    ThreadContext *tctx = tctx_current();
+
+    EcsWorld world;
+    ecs_world_init_full_ts(&world, &tctx->temp_arena);
+
+    ECS_COMPONENT(&world, TsPosition);
+    ECS_COMPONENT(&world, TsVelocity);
+    ECS_COMPONENT(&world, TsSelected);
+    ECS_COMPONENT(&world, TsThreat);
+    assert_true(ecs_component_set_sparse(&world, ecs_id(TsSelected)));
+    assert_true(ecs_component_set_sparse(&world, ecs_id(TsThreat)));
+    EcsEntity selected = ecs_id(TsSelected);
+
+    EcsQuery with_query;
+    EcsTerm with_terms[] = { ecs_term_in(ecs_id(TsPosition)), ecs_term_none(selected) };
+    ecs_query_init_terms(&with_query, &world, with_terms, 2);
+    ecs_query_cache_init(&with_query);
+    EcsQuery without_query;
+    EcsTerm without_terms[] = { ecs_term_in(ecs_id(TsPosition)), ecs_term_not(selected) };
+    ecs_query_init_terms(&without_query, &world, without_terms, 2);
+
+    EcsEntity entities[100];
+    for (i32 i = 0; i < 100; i++) {
+        entities[i] = ecs_entity_new(&world);
+        ecs_set(&world, entities[i], TsPosition, { (f32)i, 0.0f });
+        ecs_set(&world, entities[i], TsVelocity, { 1.0f, 0.0f });
+    }
+    EcsTable *table = ecs_entity_get_record(&world, entities[0])->table;
+
+    // adds and removes never move the entity
+    for (i32 i = 0; i < 100; i += 3) {
+        ecs_add(&world, entities[i], selected);
+    }
+    ecs_set(&world, entities[7], TsThreat, { 42 });
+    assert_true(ecs_entity_get_record(&world, entities[3])->table == table);
+    assert_eq(ecs_entity_get_record(&world, entities[3])->row, 3);
+    assert_eq(table->data.count, 100);
+    assert_true(ecs_has(&world, entities[3], selected));
+    assert_false(ecs_has(&world, entities[4], selected));
+    assert_eq(((TsThreat *)ecs_get(&world, entities[7], ecs_id(TsThreat)))->value, 42);
+    assert_true(ecs_get(&world, entities[8], ecs_id(TsThreat)) == NULL);
+
+    // cached and uncached queries filter per row
+    assert_eq(ts_query_count(&with_query, selected, true, &world), 34);
+    assert_eq(ts_query_count(&without_query, selected, false, &world), 66);
+
+    ecs_remove(&world, entities[0], selected);
+    ecs_entity_delete(&world, entities[3]);
+    assert_eq(ecs_component_sparse(&world, selected)->count - 1, 32);
+    assert_eq(ts_query_count(&with_query, selected, true, &world), 32);
+    assert_eq(ts_query_count(&without_query, selected, false, &world), 67);
+
+    // deferred commands apply in recording order
+    ecs_defer_begin(&world);
+    ecs_add(&world, entities[1], selected);
+    ecs_add(&world, entities[2], selected);
+    ecs_remove(&world, entities[2], selected);
+    ecs_set(&world, entities[8], TsThreat, { 7 });
+    assert_false(ecs_has(&world, entities[1], selected));
+    ecs_defer_end(&world);
+    assert_true(ecs_has(&world, entities[1], selected));
+    assert_false(ecs_has(&world, entities[2], selected));
+    assert_eq(((TsThreat *)ecs_get(&world, entities[8], ecs_id(TsThreat)))->value, 7);
+    assert_eq(table->data.count, 99);
+
+    // members travel with snapshots
+    EcsSnapshotHeader *snapshot = ecs_world_snapshot(&world, &tctx->temp_arena);
+    EcsWorld dst;
+    ecs_world_init_full_ts(&dst, &tctx->temp_arena);
+    ECS_COMPONENT_DEFINE(&dst, TsPosition);
+    ECS_COMPONENT_DEFINE(&dst, TsVelocity);
+    ECS_COMPONENT_DEFINE(&dst, TsSelected);
+    ECS_COMPONENT_DEFINE(&dst, TsThreat);
+    ecs_component_set_sparse(&dst, ecs_id(TsSelected));
+    ecs_component_set_sparse(&dst, ecs_id(TsThreat));
+    assert_true(ecs_world_restore(&dst, snapshot));
+    for (i32 i = 0; i < 100; i++) {
+        assert_eq(ecs_has(&dst, entities[i], selected), ecs_has(&world, entities[i], selected));
+    }
+    assert_eq(((TsThreat *)ecs_get(&dst, entities[7], ecs_id(TsThreat)))->value, 42);
+
+    // sparse terms alone match every table, cached or not
+    EcsEntity lone = ecs_entity_new(&world);
+    ecs_set(&world, lone, TsVelocity, { 0.0f, 0.0f });
+    ecs_add(&world, lone, selected);
+    i32 selected_count = ecs_component_sparse(&world, selected)->count - 1;
+    EcsTerm selected_terms[] = { ecs_term_none(selected) };
+    EcsQuery selected_query;
+    ecs_query_init_terms(&selected_query, &world, selected_terms, 1);
+    assert_eq(ts_query_count(&selected_query, selected, true, &world), selected_count);
+    ecs_query_cache_init(&selected_query);
+    assert_eq(ts_query_count(&selected_query, selected, true, &world), selected_count);
+}
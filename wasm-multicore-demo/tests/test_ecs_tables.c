@@ -83,4 +83,33 @@ void test_ecs_tables(void) {
     assert_eq(rec_e3->row, 1);
 
     assert_true(world.store.table_count >= 3);
+
+    // table map grows past its initial capacity and keeps every archetype reachable
+    EcsEntity extra[8];
+    for (i32 i = 0; i < 8; i++) {
+        extra[i] = ecs_component_register(&world, sizeof(f32), _Alignof(f32), "TblExtra");
+    }
+
+    EcsTable *tables[256];
+    EcsEntity ids[8];
+    for (i32 bits = 1; bits < 256; bits++) {
+        EcsType type = { .array = ids, .count = 0 };
+        for (i32 i = 0; i < 8; i++) {
+            if (bits & (1 << i)) {
+                ids[type.count++] = extra[i];
+            }
+        }
+        tables[bits] = ecs_table_find_or_create(&world, &type);
+    }
+    assert_true(world.store.table_map->capacity > ECS_TABLE_MAP_INITIAL_CAPACITY);
+
+    for (i32 bits = 1; bits < 256; bits++) {
+        EcsType type = { .array = ids, .count = 0 };
+        for (i32 i = 0; i < 8; i++) {
+            if (bits & (1 << i)) {
+                ids[type.count++] = extra[i];
+            }
+        }
+        assert_true(ecs_table_map_get(world.store.table_map, &type) == tables[bits]);
+    }
 }
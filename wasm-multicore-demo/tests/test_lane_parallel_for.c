@@ -0,0 +1,43 @@
+#define PFOR_TEST_COUNT 10007
+
+global u32 *g_pfor_hits;
+global u32 *g_pfor_costs;
+
+internal void pfor_test_visit(Range_u64 range, void *user_data) {
+    UNUSED(user_data);
+    for (u64 i = range.min; i < range.max; i++) {
+        ins_atomic_u32_inc_eval(&g_pfor_hits[i]);
+    }
+}
+
+// every item is visited exactly once, with and without cost hints, over back to back calls
+void test_lane_parallel_for(void) {
+    if (is_main_thread()) {
+        g_pfor_hits = ARENA_ALLOC_ARRAY(&tctx_current()->temp_arena, u32, PFOR_TEST_COUNT);
+        g_pfor_costs = ARENA_ALLOC_ARRAY(&tctx_current()->temp_arena, u32, PFOR_TEST_COUNT);
+        for (u32 i = 0; i < PFOR_TEST_COUNT; i++) {
+            // a few items cost a lot more than the rest
+            g_pfor_costs[i] = i % 97 == 0 ? 1000 : 1;
+        }
+    }
+    lane_sync();
+
+    LaneForDesc descs[] = {
+        { .count = PFOR_TEST_COUNT },
+        { .count = PFOR_TEST_COUNT, .min_grain = 64 },
+        { .count = PFOR_TEST_COUNT, .costs = g_pfor_costs },
+        { .count = PFOR_TEST_COUNT, .costs = g_pfor_costs, .min_grain = 16 },
+        { .count = 3, .min_grain = 8 },
+        { .count = 0 },
+    };
+    for (u32 d = 0; d < ARRAY_SIZE(descs); d++) {
+        lane_parallel_for(&descs[d], pfor_test_visit, NULL);
+    }
+
+    if (is_main_thread()) {
+        for (u32 i = 0; i < PFOR_TEST_COUNT; i++) {
+            u32 expected = i < 3 ? 5 : 4;
+            assert_eq(g_pfor_hits[i], expected);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#define MCR_STRESS_TASKS 100000
+#define MCR_STRESS_PHASES 4
+#define MCR_STRESS_MAX_DEPS 4
+
+typedef struct {
+    u32 id;
+    u32 dep_count;
+    u32 deps[MCR_STRESS_MAX_DEPS];
+} McrStressTask;
+
+global MCRTaskQueue g_mcr_stress_queue;
+global McrStressTask *g_mcr_stress_tasks;
+global MCRTaskHandle *g_mcr_stress_handles;
+global u32 *g_mcr_stress_runs;
+
+internal u32 mcr_stress_hash(u32 x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+internal void mcr_stress_task(McrStressTask *task) {
+    for (u32 i = 0; i < task->dep_count; i++) {
+        assert_eq(ins_atomic_load_acquire(&g_mcr_stress_runs[task->deps[i]]), 1);
+    }
+    ins_atomic_u32_inc_eval(&g_mcr_stress_runs[task->id]);
+}
+
+// a random DAG far past the inline queue size, appended from every lane in phases.
+// deps point at earlier phases and at the lane's own previous task, so the graph
+// has both wide waves and long chains
+internal void mcr_stress_run(MCRSchedule schedule) {
+    u32 per_phase = MCR_STRESS_TASKS / MCR_STRESS_PHASES;
+
+    if (is_main_thread()) {
+        g_mcr_stress_queue.schedule = schedule;
+        memset(g_mcr_stress_runs, 0, sizeof(u32) * MCR_STRESS_TASKS);
+    }
+    lane_sync();
+
+    for (u32 phase = 0; phase < MCR_STRESS_PHASES; phase++) {
+        u32 phase_start = phase * per_phase;
+        Range_u64 range = lane_range(per_phase);
+        for (u64 i = range.min; i < range.max; i++) {
+            u32 id = phase_start + (u32)i;
+            McrStressTask *task = &g_mcr_stress_tasks[id];
+            task->id = id;
+            task->dep_count = 0;
+
+            u32 hash = mcr_stress_hash(id);
+            u32 dep_count = phase_start > 0 ? hash % (MCR_STRESS_MAX_DEPS + 1) : 0;
+            for (u32 d = 0; d < dep_count; d++) {
+                task->deps[task->dep_count++] = mcr_stress_hash(hash + d) % phase_start;
+            }
+            if (i > range.min && hash % 3 == 0 && task->dep_count < MCR_STRESS_MAX_DEPS) {
+                task->deps[task->dep_count++] = id - 1;
+            }
+
+            MCRTaskHandle deps[MCR_STRESS_MAX_DEPS];
+            for (u32 d = 0; d < task->dep_count; d++) {
+                deps[d] = g_mcr_stress_handles[task->deps[d]];
+            }
+            g_mcr_stress_handles[id] = mcr_queue_append(&g_mcr_stress_queue, mcr_stress_task, task,
+                                                        NULL, 0, deps, task->dep_count);
+        }
+        lane_sync();
+    }
+
+    assert_eq(g_mcr_stress_queue.tasks_count, MCR_STRESS_TASKS);
+    lane_sync();
+
+    mcr_queue_process(&g_mcr_stress_queue);
+
+    if (is_main_thread()) {
+        u32 ran_once = 0;
+        for (u32 i = 0; i < MCR_STRESS_TASKS; i++) {
+            ran_once += g_mcr_stress_runs[i] == 1;
+        }
+        assert_eq(ran_once, MCR_STRESS_TASKS);
+        assert_eq(g_mcr_stress_queue.tasks_count, 0);
+    }
+    lane_sync();
+}
+
+void test_mcr_queue_stress(void) {
+    if (is_main_thread()) {
+        memset(&g_mcr_stress_queue, 0, sizeof(MCRTaskQueue));
+        g_mcr_stress_queue.arena = g_test_runner.arena;
+        g_mcr_stress_tasks = ARENA_ALLOC_ARRAY(g_test_runner.arena, McrStressTask, MCR_STRESS_TASKS);
+        g_mcr_stress_handles = ARENA_ALLOC_ARRAY(g_test_runner.arena, MCRTaskHandle, MCR_STRESS_TASKS);
+        g_mcr_stress_runs = ARENA_ALLOC_ARRAY(g_test_runner.arena, u32, MCR_STRESS_TASKS);
+    }
+    lane_sync();
+
+    mcr_stress_run(MCR_SCHEDULE_STEAL);
+    mcr_stress_run(MCR_SCHEDULE_WAVES);
+}
+
+internal void mcr_race_task(void *data) {
+    UNUSED(data);
+}
+
+// overlapping accesses only count when the DAG leaves the two tasks unordered
+void test_mcr_queue_races(void) {
+    local_shared MCRTaskQueue queue;
+    local_shared u8 buffer[256];
+
+    if (is_main_thread()) {
+        memset(&queue, 0, sizeof(MCRTaskQueue));
+        queue.race_check = MCR_RACE_CHECK_LOG;
+
+        MCRResourceAccess write_a[] = { MCR_ACCESS_WRITE(buffer, 64) };
+        MCRTaskHandle a = mcr_queue_append(&queue, mcr_race_task, NULL, write_a, 1, NULL, 0);
+
+        // overlaps a, no path between them: the only race
+        MCRResourceAccess write_b[] = { MCR_ACCESS_WRITE(buffer + 32, 64) };
+        mcr_queue_append(&queue, mcr_race_task, NULL, write_b, 1, NULL, 0);
+
+        // ordered after a directly, then transitively through a task without resources
+        MCRResourceAccess read_c[] = { MCR_ACCESS_READ(buffer, 16) };
+        MCRTaskHandle c = mcr_queue_append(&queue, mcr_race_task, NULL, read_c, 1, &a, 1);
+        MCRTaskHandle link = mcr_queue_append(&queue, mcr_race_task, NULL, NULL, 0, &c, 1);
+        MCRResourceAccess write_d[] = { MCR_ACCESS_WRITE(buffer, 8) };
+        mcr_queue_append(&queue, mcr_race_task, NULL, write_d, 1, &link, 1);
+
+        // reads never race, adjacent ranges don't overlap
+        MCRResourceAccess access_e[] = { MCR_ACCESS_READ(buffer + 128, 64), MCR_ACCESS_WRITE(buffer + 224, 32) };
+        mcr_queue_append(&queue, mcr_race_task, NULL, access_e, 2, NULL, 0);
+        MCRResourceAccess read_f[] = { MCR_ACCESS_READ(buffer + 128, 96) };
+        mcr_queue_append(&queue, mcr_race_task, NULL, read_f, 1, NULL, 0);
+    }
+    lane_sync();
+
+    mcr_queue_process(&queue);
+
+    if (is_main_thread()) {
+        assert_eq(queue.races_found, 1);
+        assert_eq(queue.accesses_count, 0);
+    }
+}
@@ -6,17 +6,29 @@
 
 #include "ecs/ecs_entity.c"
 #include "ecs/ecs_table.c"
+#include "ecs/ecs_hierarchy.c"
+#include "ecs/ecs_snapshot.c"
 
 #include "tests/test_ecs.c"
 #include "tests/test_ecs_components.c"
 #include "tests/test_ecs_tables.c"
+#include "tests/test_ecs_table_storage.c"
 #include "tests/test_ecs_add_remove.c"
+#include "tests/test_ecs_bulk.c"
+#include "tests/test_ecs_commands.c"
+#include "tests/test_ecs_hooks.c"
 #include "tests/test_ecs_query.c"
 #include "tests/test_ecs_query_cache.c"
+#include "tests/test_ecs_query_order.c"
 #include "tests/test_ecs_inout.c"
 #include "tests/test_ecs_change_detection.c"
 #include "tests/test_ecs_systems.c"
+#include "tests/test_ecs_meta_systems.c"
 #include "tests/test_ecs_entity_index.c"
+#include "tests/test_ecs_hierarchy.c"
+#include "tests/test_ecs_snapshot.c"
+#include "tests/test_mcr_queue.c"
+#include "tests/test_lane_parallel_for.c"
 
 global AppContext g_test_app_ctx;
 
@@ -25,14 +37,37 @@ void register_tests(void)
     REGISTER_TEST(test_ecs);
     REGISTER_TEST(test_ecs_components);
     REGISTER_TEST(test_ecs_tables);
+    REGISTER_TEST(test_ecs_table_storage);
+    REGISTER_TEST_MULTICORE(test_ecs_chunked_layout);
+    REGISTER_TEST(test_ecs_sparse_storage);
     REGISTER_TEST(test_ecs_add_remove);
+    REGISTER_TEST(test_ecs_bulk);
     REGISTER_TEST(test_ecs_query);
     REGISTER_TEST(test_ecs_query_cache);
+    REGISTER_TEST(test_ecs_query_cache_partition);
+    REGISTER_TEST(test_ecs_query_group_by);
+    REGISTER_TEST(test_ecs_query_order_by);
+    REGISTER_TEST_MULTICORE(test_ecs_order_by_systems);
     REGISTER_TEST(test_ecs_inout);
     REGISTER_TEST(test_ecs_change_detection);
+    REGISTER_TEST(test_ecs_changed_filter);
+    REGISTER_TEST_MULTICORE(test_ecs_changed_systems);
     REGISTER_TEST(test_ecs_systems);
+    REGISTER_TEST(test_ecs_system_graph);
+    REGISTER_TEST_MULTICORE(test_ecs_system_many_deps);
+    REGISTER_TEST_MULTICORE(test_ecs_system_profile);
+    REGISTER_TEST_MULTICORE(test_ecs_meta_systems);
     REGISTER_TEST_MULTICORE(test_ecs_entity_index_single);
     REGISTER_TEST_MULTICORE(test_ecs_entity_index_multi);
+    REGISTER_TEST(test_ecs_commands);
+    REGISTER_TEST(test_ecs_hooks);
+    REGISTER_TEST_MULTICORE(test_ecs_commands_multi);
+    REGISTER_TEST(test_ecs_hierarchy);
+    REGISTER_TEST_MULTICORE(test_ecs_hierarchy_propagate);
+    REGISTER_TEST(test_ecs_snapshot);
+    REGISTER_TEST_MULTICORE(test_mcr_queue_stress);
+    REGISTER_TEST_MULTICORE(test_mcr_queue_races);
+    REGISTER_TEST_MULTICORE(test_lane_parallel_for);
 }
 
 void test_main(void)